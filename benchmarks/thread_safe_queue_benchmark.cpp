@@ -0,0 +1,305 @@
+#include "trlc/threadsafe/mpmc_queue.hpp"
+#include "trlc/threadsafe/mutex.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/queue_stats.hpp"
+#include "trlc/threadsafe/segmented_queue.hpp"
+#include "trlc/threadsafe/spsc_queue.hpp"
+
+#include <array>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t CAPACITY{1024};            ///< Size of the bounded queues.
+constexpr int64_t ITEMS_PER_ITERATION{1 << 14}; ///< Elements moved through the queue per throughput iteration.
+
+/**
+ * @brief Element of the benchmarks, `SIZE` bytes copied on every push and pop.
+ */
+template<std::size_t SIZE>
+struct Payload
+{
+    static_assert(SIZE >= sizeof(uint64_t), "Payload holds at least a sequence number");
+
+    std::array<uint64_t, SIZE / sizeof(uint64_t)> words{}; ///< Word 0 is the sequence number, `STOP` ends a consumer.
+
+    static constexpr uint64_t STOP{~uint64_t{0}};
+};
+
+template<std::size_t SIZE>
+using StatsQueue = trlc::threadsafe::Queue<Payload<SIZE>, std::allocator<Payload<SIZE>>, trlc::threadsafe::QueueStats>;
+
+template<std::size_t SIZE>
+using PiQueue = trlc::threadsafe::Queue<Payload<SIZE>, std::allocator<Payload<SIZE>>, trlc::threadsafe::NoQueueStats,
+                                        trlc::threadsafe::PriorityInheritanceMutex>;
+
+template<typename QueueType>
+typename QueueType::Settings settings(const int64_t discard, const int64_t control)
+{
+    typename QueueType::Settings settings;
+    settings.size = CAPACITY;
+    settings.discard = static_cast<typename QueueType::Discard>(discard);
+    settings.control = static_cast<typename QueueType::Control>(control);
+    return settings;
+}
+
+template<typename QueueType>
+void reportLatency(benchmark::State&, QueueType&)
+{
+}
+
+template<std::size_t SIZE>
+void reportLatency(benchmark::State& state, StatsQueue<SIZE>& queue)
+{
+    const trlc::threadsafe::QueueStatsSnapshot snapshot{queue.stats().snapshot()};
+    state.counters["p50_ns"] = static_cast<double>(snapshot.latency.percentile(0.50).count());
+    state.counters["p99_ns"] = static_cast<double>(snapshot.latency.percentile(0.99).count());
+    state.counters["p999_ns"] = static_cast<double>(snapshot.latency.percentile(0.999).count());
+}
+
+/**
+ * @brief Push and pop from a single thread, the cost of one uncontended operation pair.
+ *
+ * Arguments: discard policy, control policy.
+ */
+template<typename QueueType, std::size_t SIZE>
+void BM_PushPop(benchmark::State& state)
+{
+    QueueType queue{settings<QueueType>(state.range(0), state.range(1))};
+    queue.openPush();
+    queue.openPop();
+    Payload<SIZE> elem{};
+    for (auto _ : state)
+    {
+        queue.push(elem);
+        queue.pop(elem);
+        benchmark::DoNotOptimize(elem);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(SIZE));
+}
+
+/**
+ * @brief Reserve, commit, peek and release from a single thread, the in-place counterpart of `BM_PushPop`.
+ *
+ * Only the sequence number is written and read, the rest of the payload never leaves the ring.
+ */
+template<typename QueueType, std::size_t SIZE>
+void BM_ReserveCommit(benchmark::State& state)
+{
+    QueueType queue{settings<QueueType>(static_cast<int64_t>(QueueType::Discard::NO_DISCARD),
+                                        static_cast<int64_t>(QueueType::Control::NO_CONTROL))};
+    uint64_t sequence{0};
+    for (auto _ : state)
+    {
+        typename QueueType::Reservation reserved{queue.reserve()};
+        reserved->words[0] = sequence++;
+        queue.commit(reserved);
+        typename QueueType::Reservation peeked{queue.peek()};
+        benchmark::DoNotOptimize(peeked->words[0]);
+        queue.release(peeked);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(SIZE));
+}
+
+/**
+ * @brief Push and pop from the first thread while every other thread polls `readyToPop`, as a `Selector` does.
+ *
+ * The pollers only read the queue, so the time over `BM_PushPop` is the coherence traffic between the lines
+ * written on every operation and those read by the pollers.
+ */
+template<typename QueueType, std::size_t SIZE>
+void BM_PushPopPolled(benchmark::State& state)
+{
+    static QueueType queue{settings<QueueType>(static_cast<int64_t>(QueueType::Discard::NO_DISCARD),
+                                               static_cast<int64_t>(QueueType::Control::NO_CONTROL))};
+    if (state.thread_index() == 0)
+    {
+        Payload<SIZE> elem{};
+        for (auto _ : state)
+        {
+            queue.push(elem);
+            queue.pop(elem);
+            benchmark::DoNotOptimize(elem);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    else
+    {
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(queue.readyToPop());
+        }
+    }
+}
+
+/**
+ * @brief Move a batch of elements from producer to consumer threads, the throughput under contention.
+ *
+ * Arguments: producers, consumers, discard policy. Consumers end on a `STOP` element pushed once every
+ * producer is done, so the discarded elements are reported apart from the popped ones.
+ */
+template<typename QueueType, std::size_t SIZE>
+void BM_Throughput(benchmark::State& state)
+{
+    const int64_t producers{state.range(0)};
+    const int64_t consumers{state.range(1)};
+    QueueType queue{settings<QueueType>(state.range(2), static_cast<int64_t>(QueueType::Control::NO_CONTROL))};
+    int64_t popped{0};
+    for (auto _ : state)
+    {
+        std::atomic<int64_t> count{0};
+        std::vector<std::thread> threads{};
+        for (int64_t consumer = 0; consumer < consumers; ++consumer)
+        {
+            threads.emplace_back(
+                [&]() -> void
+                {
+                    int64_t local{0};
+                    Payload<SIZE> elem{};
+                    while (queue.pop(elem) && elem.words[0] != Payload<SIZE>::STOP)
+                    {
+                        ++local;
+                    }
+                    count.fetch_add(local, std::memory_order_relaxed);
+                });
+        }
+        std::vector<std::thread> producer_threads{};
+        for (int64_t producer = 0; producer < producers; ++producer)
+        {
+            producer_threads.emplace_back(
+                [&]() -> void
+                {
+                    Payload<SIZE> elem{};
+                    for (int64_t index = 0; index < ITEMS_PER_ITERATION / producers; ++index)
+                    {
+                        elem.words[0] = static_cast<uint64_t>(index);
+                        queue.push(elem);
+                    }
+                });
+        }
+        for (std::thread& thread : producer_threads)
+        {
+            thread.join();
+        }
+        Payload<SIZE> stop{};
+        stop.words[0] = Payload<SIZE>::STOP;
+        for (int64_t consumer = 0; consumer < consumers; ++consumer)
+        {
+            // DISCARD_NEWEST drops a push into a full queue, retry until the consumers made room.
+            while (!queue.push(stop))
+            {
+                std::this_thread::yield();
+            }
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        popped += count.load();
+    }
+    const int64_t pushed{state.iterations() * (ITEMS_PER_ITERATION / producers) * producers};
+    state.SetItemsProcessed(popped);
+    state.SetBytesProcessed(popped * static_cast<int64_t>(SIZE));
+    state.counters["dropped"] = benchmark::Counter(static_cast<double>(pushed - popped) / static_cast<double>(pushed));
+    reportLatency(state, queue);
+}
+
+/**
+ * @brief Bounce one element between two threads through a request and a response queue.
+ *
+ * The time per iteration is a full round trip, i.e. two push-to-pop hand-overs including the wake-ups.
+ */
+template<typename QueueType, std::size_t SIZE>
+void BM_RoundTrip(benchmark::State& state)
+{
+    const int64_t discard{static_cast<int64_t>(QueueType::Discard::NO_DISCARD)};
+    const int64_t control{static_cast<int64_t>(QueueType::Control::NO_CONTROL)};
+    QueueType request{settings<QueueType>(discard, control)};
+    QueueType response{settings<QueueType>(discard, control)};
+    std::thread echo{[&]() -> void
+                     {
+                         Payload<SIZE> elem{};
+                         while (request.pop(elem) && elem.words[0] != Payload<SIZE>::STOP)
+                         {
+                             response.push(elem);
+                         }
+                     }};
+    Payload<SIZE> elem{};
+    for (auto _ : state)
+    {
+        request.push(elem);
+        response.pop(elem);
+    }
+    elem.words[0] = Payload<SIZE>::STOP;
+    request.push(elem);
+    echo.join();
+    state.SetItemsProcessed(state.iterations());
+}
+
+using trlc::threadsafe::MpmcQueue;
+using trlc::threadsafe::Queue;
+using trlc::threadsafe::SegmentedQueue;
+using trlc::threadsafe::SpscQueue;
+
+// Discard: DISCARD_OLDEST = 0, DISCARD_NEWEST = 1, NO_DISCARD = 2.
+// Control: PUSH = 1, POP = 2, FULL_CONTROL = 3, NO_CONTROL = 4.
+const std::vector<int64_t> DISCARDS{0, 1, 2};
+const std::vector<int64_t> CONTROLS{1, 2, 3, 4};
+const std::vector<int64_t> THREADS{1, 2, 4};
+
+BENCHMARK_TEMPLATE(BM_PushPop, Queue<Payload<8>>, 8)->ArgsProduct({DISCARDS, CONTROLS})->ArgNames({"discard", "control"});
+BENCHMARK_TEMPLATE(BM_PushPop, Queue<Payload<64>>, 64)->ArgsProduct({DISCARDS, CONTROLS})->ArgNames({"discard", "control"});
+BENCHMARK_TEMPLATE(BM_PushPop, Queue<Payload<1024>>, 1024)->ArgsProduct({DISCARDS, CONTROLS})->ArgNames({"discard", "control"});
+BENCHMARK_TEMPLATE(BM_PushPop, PiQueue<8>, 8)->ArgsProduct({{2}, {4}})->ArgNames({"discard", "control"});
+BENCHMARK_TEMPLATE(BM_PushPop, MpmcQueue<Payload<8>>, 8)->ArgsProduct({DISCARDS, {4}})->ArgNames({"discard", "control"});
+BENCHMARK_TEMPLATE(BM_PushPop, MpmcQueue<Payload<64>>, 64)->ArgsProduct({DISCARDS, {4}})->ArgNames({"discard", "control"});
+BENCHMARK_TEMPLATE(BM_PushPop, SegmentedQueue<Payload<8>>, 8)->ArgsProduct({DISCARDS, {4}})->ArgNames({"discard", "control"});
+
+BENCHMARK_TEMPLATE(BM_PushPop, MpmcQueue<Payload<1024>>, 1024)->ArgsProduct({{2}, {4}})->ArgNames({"discard", "control"});
+
+BENCHMARK_TEMPLATE(BM_ReserveCommit, SpscQueue<Payload<1024>>, 1024);
+BENCHMARK_TEMPLATE(BM_ReserveCommit, MpmcQueue<Payload<64>>, 64);
+BENCHMARK_TEMPLATE(BM_ReserveCommit, MpmcQueue<Payload<1024>>, 1024);
+
+BENCHMARK_TEMPLATE(BM_PushPopPolled, Queue<Payload<8>>, 8)->ThreadRange(1, 4)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Throughput, Queue<Payload<8>>, 8)
+    ->ArgsProduct({THREADS, THREADS, DISCARDS})
+    ->ArgNames({"producers", "consumers", "discard"})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, Queue<Payload<1024>>, 1024)
+    ->ArgsProduct({THREADS, THREADS, {2}})
+    ->ArgNames({"producers", "consumers", "discard"})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, MpmcQueue<Payload<8>>, 8)
+    ->ArgsProduct({THREADS, THREADS, DISCARDS})
+    ->ArgNames({"producers", "consumers", "discard"})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, SegmentedQueue<Payload<8>>, 8)
+    ->ArgsProduct({THREADS, THREADS, DISCARDS})
+    ->ArgNames({"producers", "consumers", "discard"})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, PiQueue<8>, 8)
+    ->ArgsProduct({THREADS, THREADS, {2}})
+    ->ArgNames({"producers", "consumers", "discard"})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, StatsQueue<8>, 8)
+    ->ArgsProduct({THREADS, THREADS, {2}})
+    ->ArgNames({"producers", "consumers", "discard"})
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_RoundTrip, Queue<Payload<8>>, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RoundTrip, Queue<Payload<1024>>, 1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RoundTrip, MpmcQueue<Payload<8>>, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RoundTrip, SegmentedQueue<Payload<8>>, 8)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,135 @@
+#include "trlc/threadsafe/parallel.hpp"
+#include "trlc/threadsafe/thread.hpp"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using trlc::threadsafe::Thread;
+using trlc::threadsafe::ThreadPool;
+
+void noop() {}
+
+/**
+ * @brief Run an empty function once and wait for it, the cost of starting and joining a worker.
+ *
+ * Argument: whether the runtime stats are enabled.
+ */
+void BM_StartStopOnce(benchmark::State& state)
+{
+    Thread thread{"bench once"};
+    thread.enableStats(state.range(0) != 0);
+    thread.invoke(noop);
+    for (auto _ : state)
+    {
+        thread.run(Thread::RunMode::ONCE);
+        thread.stop();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Start an empty loop and stop it right away, the cost of the loop start, the stop request and the join.
+ *
+ * Argument: whether the runtime stats are enabled.
+ */
+void BM_StartStopLoop(benchmark::State& state)
+{
+    Thread thread{"bench loop"};
+    thread.enableStats(state.range(0) != 0);
+    thread.invoke(noop);
+    for (auto _ : state)
+    {
+        thread.run(Thread::RunMode::LOOP);
+        thread.stop();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Submit a task returning a value and wait for its future, the cost of `submit` on top of a run.
+ */
+void BM_SubmitGet(benchmark::State& state)
+{
+    Thread thread{"bench submit"};
+    for (auto _ : state)
+    {
+        auto future{thread.submit([]() -> int
+                                  { return 1; })};
+        benchmark::DoNotOptimize(future.get());
+        thread.stop();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Sum a vector of 16M integers over a pool, against `std::accumulate` on the calling thread.
+ *
+ * Argument: number of workers, 0 for the sequential baseline.
+ */
+void BM_ParallelReduce(benchmark::State& state)
+{
+    std::vector<int64_t> values(std::size_t{1} << 24);
+    std::iota(values.begin(), values.end(), 0);
+    ThreadPool::Settings settings;
+    settings.size = static_cast<std::size_t>(std::max<int64_t>(state.range(0), 1));
+    ThreadPool pool(settings);
+    for (auto _ : state)
+    {
+        if (state.range(0) == 0)
+        {
+            benchmark::DoNotOptimize(std::accumulate(values.begin(), values.end(), int64_t{0}));
+        }
+        else
+        {
+            benchmark::DoNotOptimize(trlc::threadsafe::parallelReduce(pool, values.begin(), values.end(), int64_t{0}, std::plus<>{}));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(values.size()));
+}
+
+/**
+ * @brief Sort 4M random integers over a pool, against `std::sort` on the calling thread.
+ *
+ * Argument: number of workers, 0 for the sequential baseline.
+ */
+void BM_ParallelSort(benchmark::State& state)
+{
+    std::vector<uint32_t> input(std::size_t{1} << 22);
+    std::mt19937 random{42};
+    std::generate(input.begin(), input.end(), random);
+    ThreadPool::Settings settings;
+    settings.size = static_cast<std::size_t>(std::max<int64_t>(state.range(0), 1));
+    ThreadPool pool(settings);
+    std::vector<uint32_t> values;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        values = input;
+        state.ResumeTiming();
+        if (state.range(0) == 0)
+        {
+            std::sort(values.begin(), values.end());
+        }
+        else
+        {
+            trlc::threadsafe::parallelSort(pool, values.begin(), values.end());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+
+BENCHMARK(BM_StartStopOnce)->Arg(0)->Arg(1)->ArgName("stats")->UseRealTime();
+BENCHMARK(BM_StartStopLoop)->Arg(0)->Arg(1)->ArgName("stats")->UseRealTime();
+BENCHMARK(BM_SubmitGet)->UseRealTime();
+BENCHMARK(BM_ParallelReduce)->Arg(0)->Arg(1)->Arg(4)->ArgName("workers")->UseRealTime();
+BENCHMARK(BM_ParallelSort)->Arg(0)->Arg(1)->Arg(4)->ArgName("workers")->UseRealTime()->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,89 @@
+#include "trlc/threadsafe/variable.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+namespace
+{
+
+using trlc::threadsafe::Atomic;
+using trlc::threadsafe::Rcu;
+using trlc::threadsafe::SeqLock;
+using trlc::threadsafe::Variable;
+
+/**
+ * @brief Value too large for a lock-free `std::atomic`, so that every lock policy applies to it.
+ */
+struct Point
+{
+    int64_t x{0}; ///< First coordinate.
+    int64_t y{0}; ///< Second coordinate, always equal to `x`.
+};
+
+/**
+ * @brief Read the value from every thread, the cost of the read path alone.
+ */
+template<typename VariableType>
+void BM_Read(benchmark::State& state)
+{
+    static VariableType variable{};
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(variable.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Write the value from the first thread while every other thread reads it.
+ *
+ * The writer and the readers report their operations apart, as the `writes` and `reads` rate counters.
+ */
+template<typename VariableType>
+void BM_ReadWrite(benchmark::State& state)
+{
+    static VariableType variable{};
+    const bool writer{state.thread_index() == 0};
+    int64_t count{0};
+    for (auto _ : state)
+    {
+        if (writer)
+        {
+            ++count;
+            if constexpr (std::is_same_v<typename VariableType::Type, Point>)
+            {
+                variable = Point{count, count};
+            }
+            else
+            {
+                variable = count;
+            }
+        }
+        else
+        {
+            benchmark::DoNotOptimize(variable.get());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["writes"] = benchmark::Counter(writer ? static_cast<double>(state.iterations()) : 0.0, benchmark::Counter::kIsRate);
+    state.counters["reads"] = benchmark::Counter(writer ? 0.0 : static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_TEMPLATE(BM_Read, Variable<int64_t, Atomic>)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_Read, Variable<int64_t, std::mutex>)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_Read, Variable<Point, std::mutex>)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_Read, Variable<Point, std::shared_mutex>)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_Read, Variable<Point, SeqLock>)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_Read, Variable<Point, Rcu>)->ThreadRange(1, 8);
+
+BENCHMARK_TEMPLATE(BM_ReadWrite, Variable<int64_t, Atomic>)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadWrite, Variable<int64_t, std::mutex>)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadWrite, Variable<Point, std::mutex>)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadWrite, Variable<Point, std::shared_mutex>)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadWrite, Variable<Point, SeqLock>)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadWrite, Variable<Point, Rcu>)->ThreadRange(2, 8)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,70 @@
+#include "trlc/threadsafe/wait.hpp"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <thread>
+
+namespace
+{
+
+using trlc::threadsafe::Wait;
+
+/**
+ * @brief Notify a `Wait` nobody waits on, the cost paid by a signaling thread on the fast path.
+ */
+void BM_NotifyNoWaiter(benchmark::State& state)
+{
+    Wait wait{static_cast<Wait::Strategy>(state.range(0))};
+    for (auto _ : state)
+    {
+        wait.notifyOne();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Wake a thread blocked on a `Wait` and get woken back, per strategy.
+ *
+ * The time per iteration is a round trip of two notify-to-wake hand-overs, so the notify-to-wake latency
+ * is half of it and is reported as the `wake_ns` counter.
+ */
+void BM_NotifyWake(benchmark::State& state)
+{
+    const Wait::Strategy strategy{static_cast<Wait::Strategy>(state.range(0))};
+    Wait ping{strategy};
+    Wait pong{strategy};
+    std::atomic<uint64_t> pinged{0};
+    std::atomic<uint64_t> ponged{0};
+    std::thread echo{[&]() -> void
+                     {
+                         uint64_t seen{0};
+                         while (ping.wait([&]() -> bool
+                                          { return pinged.load(std::memory_order_acquire) != seen; })
+                                == Wait::Status::SUCCESS)
+                         {
+                             seen = pinged.load(std::memory_order_acquire);
+                             ponged.store(seen, std::memory_order_release);
+                             pong.notifyOne();
+                         }
+                     }};
+    uint64_t sequence{0};
+    for (auto _ : state)
+    {
+        pinged.store(++sequence, std::memory_order_release);
+        ping.notifyOne();
+        pong.wait([&]() -> bool
+                  { return ponged.load(std::memory_order_acquire) == sequence; });
+    }
+    ping.exit();
+    echo.join();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["wake_ns"] = benchmark::Counter(static_cast<double>(state.iterations()) * 2.0 * 1e-9,
+                                                   benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// Strategy: BLOCK = 0, SPIN = 1, ADAPTIVE = 2.
+BENCHMARK(BM_NotifyNoWaiter)->DenseRange(0, 2)->ArgName("strategy");
+BENCHMARK(BM_NotifyWake)->DenseRange(0, 2)->ArgName("strategy")->UseRealTime();
+
+} // namespace
@@ -1,6 +1,12 @@
 #pragma once
+#include <cstddef>
+#include <thread>
 #include <type_traits>
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
 #define UNCOPYABLE(classname)                        \
     classname(const classname&) = delete;            \
     classname& operator=(const classname&) = delete; \
@@ -39,4 +45,52 @@ CREATE_HAS_COMPARISON_OPERATOR_TRAIT(!=, not_equal);
 CREATE_HAS_COMPARISON_OPERATOR_TRAIT(<, less);
 CREATE_HAS_COMPARISON_OPERATOR_TRAIT(<=, less_or_equal);
 CREATE_HAS_COMPARISON_OPERATOR_TRAIT(>, greater);
-CREATE_HAS_COMPARISON_OPERATOR_TRAIT(>=, greater_or_equal);
\ No newline at end of file
+CREATE_HAS_COMPARISON_OPERATOR_TRAIT(>=, greater_or_equal);
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Size of a cache line used to separate data written by different threads.
+ *
+ * `std::hardware_destructive_interference_size` is not used on purpose: its value may change between
+ * compiler versions and flags, which would silently change the layout of types shared between translation units.
+ */
+inline constexpr std::size_t CACHE_LINE_SIZE{64};
+
+/**
+ * @brief Round a value up to the next power of two.
+ * @param value The value to round up.
+ * @return The smallest power of two greater than or equal to `value` (1 for 0).
+ */
+constexpr std::size_t nextPowerOfTwo(std::size_t value)
+{
+    std::size_t result{1};
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Hint the processor that the calling thread is busy-waiting.
+ *
+ * Emits `pause` on x86 and `yield` on ARM, which reduces power and frees pipeline resources for a
+ * sibling hyper-thread. Falls back to `std::this_thread::yield()` on other architectures.
+ */
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+} // namespace threadsafe
+} // namespace trlc
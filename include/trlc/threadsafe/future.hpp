@@ -0,0 +1,710 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+template<typename T>
+class Future;
+
+template<typename T>
+class Promise;
+
+namespace detail
+{
+
+/**
+ * @brief Placeholder value stored by the shared state of `Future<void>`.
+ */
+struct Unit
+{
+};
+
+template<typename T>
+using FutureValue = std::conditional_t<std::is_void_v<T>, Unit, T>;
+
+/**
+ * @brief Exception a future completed with, handed to continuations in place of the value.
+ */
+struct Failure
+{
+    std::exception_ptr error;
+};
+
+/**
+ * @brief Type-erased, move-only continuation receiving the value or the exception of a future.
+ */
+template<typename Value>
+class Continuation
+{
+public:
+    virtual ~Continuation() = default;
+    virtual void run(Value&& value) = 0;
+    virtual void fail(std::exception_ptr error) = 0;
+};
+
+template<typename Value, typename F>
+class ContinuationImpl final : public Continuation<Value>
+{
+public:
+    explicit ContinuationImpl(F&& func)
+        : m_func{std::move(func)}
+    {
+    }
+
+    void run(Value&& value) override
+    {
+        m_func(std::move(value));
+    }
+
+    void fail(std::exception_ptr error) override
+    {
+        m_func(Failure{std::move(error)});
+    }
+
+private:
+    F m_func;
+};
+
+/**
+ * @brief State shared by a `Promise` and its `Future`.
+ *
+ * The value or the exception is either stored for `Future::get` or handed directly to the continuation
+ * registered by `Future::then`. A promise destroyed without a value leaves the state ready but empty
+ * ("broken"), in which case the continuation is dropped without being called.
+ */
+template<typename T>
+class FutureState
+{
+public:
+    using Value = FutureValue<T>;
+    using ContinuationPtr = std::unique_ptr<Continuation<Value>>;
+
+    FutureState() = default;
+
+    // Make this class uncopyable
+    UNCOPYABLE(FutureState);
+
+    bool setValue(Value&& value)
+    {
+        ContinuationPtr continuation{};
+        {
+            std::lock_guard<std::mutex> lock{m_lock};
+            if (m_done)
+            {
+                return false;
+            }
+            m_done = true;
+            if (m_continuation)
+            {
+                continuation = std::move(m_continuation);
+            }
+            else
+            {
+                m_value.emplace(std::move(value));
+            }
+        }
+        m_ready.store(true, std::memory_order_release);
+        m_wait.notify();
+        if (continuation)
+        {
+            continuation->run(std::move(value));
+        }
+        return true;
+    }
+
+    bool setException(std::exception_ptr error)
+    {
+        ContinuationPtr continuation{};
+        {
+            std::lock_guard<std::mutex> lock{m_lock};
+            if (m_done)
+            {
+                return false;
+            }
+            m_done = true;
+            if (m_continuation)
+            {
+                continuation = std::move(m_continuation);
+            }
+            else
+            {
+                m_exception = error;
+            }
+        }
+        m_ready.store(true, std::memory_order_release);
+        m_wait.notify();
+        if (continuation)
+        {
+            continuation->fail(std::move(error));
+        }
+        return true;
+    }
+
+    void abandon()
+    {
+        ContinuationPtr continuation{};
+        {
+            std::lock_guard<std::mutex> lock{m_lock};
+            if (m_done)
+            {
+                return;
+            }
+            m_done = true;
+            continuation = std::move(m_continuation);
+        }
+        m_ready.store(true, std::memory_order_release);
+        m_wait.notify();
+    }
+
+    void setContinuation(ContinuationPtr continuation)
+    {
+        std::optional<Value> value{};
+        std::exception_ptr error{};
+        {
+            std::lock_guard<std::mutex> lock{m_lock};
+            if (!m_done)
+            {
+                m_continuation = std::move(continuation);
+                return;
+            }
+            value.swap(m_value);
+            std::swap(error, m_exception);
+        }
+        if (value)
+        {
+            continuation->run(std::move(*value));
+        }
+        else if (error)
+        {
+            continuation->fail(std::move(error));
+        }
+    }
+
+    bool ready() const
+    {
+        return m_ready.load(std::memory_order_acquire);
+    }
+
+    void wait()
+    {
+        m_wait.wait([this]() -> bool
+                    { return ready(); });
+    }
+
+    bool waitFor(const uint32_t timeout_ms)
+    {
+        return m_wait.waitFor(std::chrono::milliseconds(timeout_ms), [this]() -> bool
+                              { return ready(); }) == Wait::Status::SUCCESS;
+    }
+
+    std::optional<Value> take()
+    {
+        std::optional<Value> value{};
+        std::exception_ptr error{};
+        {
+            std::lock_guard<std::mutex> lock{m_lock};
+            value.swap(m_value);
+            std::swap(error, m_exception);
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+        return value;
+    }
+
+private:
+    std::mutex m_lock{};              ///< Mutex protecting the value and the continuation.
+    bool m_done{false};               ///< Whether a value was set or the promise was abandoned.
+    std::optional<Value> m_value{};   ///< Value waiting for `take`.
+    std::exception_ptr m_exception{}; ///< Exception waiting for `take`.
+    ContinuationPtr m_continuation{}; ///< Continuation waiting for the value.
+    std::atomic<bool> m_ready{false}; ///< Lock-free copy of `m_done` for waiters.
+    Wait m_wait{};                    ///< Wait channel for `wait` and `waitFor` callers.
+};
+
+/**
+ * @brief Access to the shared state of a future for the combinators.
+ */
+struct FutureAccess
+{
+    /**
+     * @brief Consume a future and register a continuation called with its value or with a `Failure`.
+     */
+    template<typename T, typename F>
+    static void attach(Future<T>& future, F&& func);
+};
+
+/**
+ * @brief Register one continuation per future storing its value at the matching tuple index.
+ *
+ * The first exception completes the combined future, which is never completed with a value afterwards
+ * since the failed future does not count down.
+ */
+template<typename Context, std::size_t... Is, typename... Ts>
+void attachWhenAll(const std::shared_ptr<Context>& context, std::index_sequence<Is...>, Future<Ts>&... futures)
+{
+    (FutureAccess::attach(futures, [context](auto&& result)
+                          {
+        if constexpr (std::is_same_v<std::decay_t<decltype(result)>, Failure>)
+        {
+            context->promise.setException(result.error);
+        }
+        else
+        {
+            std::get<Is>(context->values).emplace(std::move(result));
+            if (context->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                context->complete();
+            }
+        } }),
+     ...);
+}
+
+} // namespace detail
+
+/**
+ * @brief Typed result of an asynchronous operation, completed by a `Promise`.
+ *
+ * A future is move-only and yields its value once. Continuations registered with `then` run on the
+ * thread that completes the promise, or immediately on the caller if the value is already there, so
+ * stages can be chained without blocking a thread in `get`.
+ *
+ * @tparam T Type of the result, may be `void`.
+ */
+template<typename T>
+class Future
+{
+public:
+    static constexpr uint32_t WAIT_FOREVER = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief Constructs an invalid future without shared state.
+     */
+    Future() = default;
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+    Future(Future&&) noexcept = default;
+    Future& operator=(Future&&) noexcept = default;
+
+    /**
+     * @brief Check whether the future refers to a shared state.
+     * @return `true` if the future is valid, `false` if it was default constructed or consumed by `then`.
+     */
+    bool valid() const;
+
+    /**
+     * @brief Check whether the promise was completed or abandoned.
+     * @return `true` if `get` will not block, `false` otherwise.
+     */
+    bool ready() const;
+
+    /**
+     * @brief Block until the promise is completed or abandoned.
+     */
+    void wait() const;
+
+    /**
+     * @brief Block until the promise is completed or abandoned, or until the timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the future is ready, `false` if the timeout was reached.
+     */
+    bool waitFor(const uint32_t timeout_ms) const;
+
+    /**
+     * @brief Block until the result is available and move it out.
+     *
+     * An exception the promise was completed with is rethrown, once like the value.
+     *
+     * @return For a non-void `T`, the value, or `std::nullopt` if the promise was abandoned or the value was
+     *         already taken. For `void`, `true` if the promise was completed, `false` otherwise.
+     */
+    auto get();
+
+    /**
+     * @brief Chain a continuation receiving the result of this future.
+     *
+     * The future is consumed and becomes invalid. If the promise is abandoned, the continuation is not
+     * called and the returned future is abandoned as well. If the promise fails, or the continuation
+     * throws, the returned future fails with the same exception.
+     *
+     * @tparam F Callable taking `T` (nothing for `void`).
+     * @param func The continuation.
+     * @return A future for the result of `func`.
+     */
+    template<typename F>
+    auto then(F&& func);
+
+private:
+    template<typename U>
+    friend class Promise;
+    friend struct detail::FutureAccess;
+
+    using State = detail::FutureState<T>;
+
+    explicit Future(std::shared_ptr<State> state)
+        : m_state{std::move(state)}
+    {
+    }
+
+    std::shared_ptr<State> m_state{}; ///< State shared with the promise.
+};
+
+/**
+ * @brief Producer side of a `Future`.
+ *
+ * Destroying a promise without setting a value abandons its future.
+ *
+ * @tparam T Type of the result, may be `void`.
+ */
+template<typename T>
+class Promise
+{
+public:
+    /**
+     * @brief Constructs a promise with a fresh shared state.
+     */
+    Promise()
+        : m_state{std::make_shared<State>()}
+    {
+    }
+
+    /**
+     * @brief Destructor that abandons the future if no value was set.
+     */
+    ~Promise()
+    {
+        if (m_state)
+        {
+            m_state->abandon();
+        }
+    }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+    Promise(Promise&&) noexcept = default;
+
+    Promise& operator=(Promise&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_state)
+            {
+                m_state->abandon();
+            }
+            m_state = std::move(other.m_state);
+            m_future_retrieved = other.m_future_retrieved;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Returns the future associated with this promise.
+     * @return The future on the first call, an invalid future afterwards.
+     */
+    Future<T> getFuture()
+    {
+        if (!m_state || m_future_retrieved)
+        {
+            return Future<T>{};
+        }
+        m_future_retrieved = true;
+        return Future<T>{m_state};
+    }
+
+    /**
+     * @brief Complete the future with a value constructed from `args` (nothing for `void`).
+     * @param args Arguments forwarded to the constructor of the value.
+     * @return `true` if the value was set, `false` if a value was already set.
+     */
+    template<typename... Args>
+    bool setValue(Args&&... args)
+    {
+        if (!m_state)
+        {
+            return false;
+        }
+        return m_state->setValue(Value(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Complete the future with an exception, rethrown by `Future::get`.
+     * @param error The exception, usually `std::current_exception()`.
+     * @return `true` if the exception was set, `false` if a value was already set.
+     */
+    bool setException(std::exception_ptr error)
+    {
+        if (!m_state)
+        {
+            return false;
+        }
+        return m_state->setException(std::move(error));
+    }
+
+private:
+    using State = detail::FutureState<T>;
+    using Value = detail::FutureValue<T>;
+
+    std::shared_ptr<State> m_state{}; ///< State shared with the future.
+    bool m_future_retrieved{false};   ///< Whether `getFuture` was already called.
+};
+
+template<typename T>
+bool Future<T>::valid() const
+{
+    return m_state != nullptr;
+}
+
+template<typename T>
+bool Future<T>::ready() const
+{
+    return m_state && m_state->ready();
+}
+
+template<typename T>
+void Future<T>::wait() const
+{
+    if (m_state)
+    {
+        m_state->wait();
+    }
+}
+
+template<typename T>
+bool Future<T>::waitFor(const uint32_t timeout_ms) const
+{
+    if (!m_state)
+    {
+        return false;
+    }
+    return m_state->waitFor(timeout_ms);
+}
+
+template<typename T>
+auto Future<T>::get()
+{
+    if constexpr (std::is_void_v<T>)
+    {
+        if (!m_state)
+        {
+            return false;
+        }
+        m_state->wait();
+        return m_state->take().has_value();
+    }
+    else
+    {
+        if (!m_state)
+        {
+            return std::optional<T>{};
+        }
+        m_state->wait();
+        return m_state->take();
+    }
+}
+
+template<typename T>
+template<typename F>
+auto Future<T>::then(F&& func)
+{
+    using Func = std::decay_t<F>;
+    using Result = std::conditional_t<std::is_void_v<T>, std::invoke_result<Func&>, std::invoke_result<Func&, detail::FutureValue<T>&&>>;
+    using R = typename Result::type;
+    using Value = detail::FutureValue<T>;
+
+    Promise<R> promise{};
+    Future<R> future{promise.getFuture()};
+    if (!m_state)
+    {
+        return future; // Abandoned right away.
+    }
+
+    auto continuation = [func = Func(std::forward<F>(func)), promise = std::move(promise)](auto&& result) mutable
+    {
+        if constexpr (std::is_same_v<std::decay_t<decltype(result)>, detail::Failure>)
+        {
+            promise.setException(result.error);
+        }
+        else
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T> && std::is_void_v<R>)
+                {
+                    func();
+                    promise.setValue();
+                }
+                else if constexpr (std::is_void_v<T>)
+                {
+                    promise.setValue(func());
+                }
+                else if constexpr (std::is_void_v<R>)
+                {
+                    func(std::forward<Value>(result));
+                    promise.setValue();
+                }
+                else
+                {
+                    promise.setValue(func(std::forward<Value>(result)));
+                }
+            }
+            catch (...)
+            {
+                promise.setException(std::current_exception());
+            }
+        }
+    };
+    detail::FutureAccess::attach(*this, std::move(continuation));
+    return future;
+}
+
+namespace detail
+{
+
+template<typename T, typename F>
+void FutureAccess::attach(Future<T>& future, F&& func)
+{
+    using Func = std::decay_t<F>;
+    if (!future.m_state)
+    {
+        return;
+    }
+    std::shared_ptr<typename Future<T>::State> state{std::move(future.m_state)};
+    state->setContinuation(std::make_unique<ContinuationImpl<FutureValue<T>, Func>>(Func(std::forward<F>(func))));
+}
+
+} // namespace detail
+
+/**
+ * @brief Combine futures of the same type into a future of all their results.
+ *
+ * The combined future is abandoned if any of the futures is abandoned, and fails with the first
+ * exception of the futures.
+ *
+ * @tparam T Type of the results, may be `void`.
+ * @param futures The futures to combine, consumed by the call.
+ * @return A future of the results in the order of `futures`, or `Future<void>` for `void` futures.
+ */
+template<typename T>
+auto whenAll(std::vector<Future<T>> futures)
+{
+    using Value = detail::FutureValue<T>;
+    using R = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+    struct Context
+    {
+        std::vector<std::optional<Value>> values;
+        std::atomic<std::size_t> remaining;
+        Promise<R> promise{};
+
+        explicit Context(const std::size_t count)
+            : values(count)
+            , remaining{count}
+        {
+        }
+
+        void complete()
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                promise.setValue();
+            }
+            else
+            {
+                std::vector<T> results{};
+                results.reserve(values.size());
+                for (std::optional<Value>& value : values)
+                {
+                    results.push_back(std::move(*value));
+                }
+                promise.setValue(std::move(results));
+            }
+        }
+    };
+
+    auto context{std::make_shared<Context>(futures.size())};
+    Future<R> future{context->promise.getFuture()};
+    if (futures.empty())
+    {
+        context->complete();
+        return future;
+    }
+    for (std::size_t index = 0; index < futures.size(); ++index)
+    {
+        // A failed future does not count down, so that the combined future is never completed afterwards.
+        detail::FutureAccess::attach(futures[index], [context, index](auto&& result)
+                                     {
+            if constexpr (std::is_same_v<std::decay_t<decltype(result)>, detail::Failure>)
+            {
+                context->promise.setException(result.error);
+            }
+            else
+            {
+                context->values[index].emplace(std::move(result));
+                if (context->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    context->complete();
+                }
+            } });
+    }
+    return future;
+}
+
+/**
+ * @brief Combine futures of different types into a future of a tuple of their results.
+ *
+ * The combined future is abandoned if any of the futures is abandoned, and fails with the first
+ * exception of the futures.
+ *
+ * @tparam Ts Types of the results, must not be `void`.
+ * @param futures The futures to combine, consumed by the call.
+ * @return A future of a tuple of the results in argument order.
+ */
+template<typename... Ts>
+Future<std::tuple<Ts...>> whenAll(Future<Ts>... futures)
+{
+    static_assert(sizeof...(Ts) > 0, "whenAll requires at least one future");
+    static_assert(!std::disjunction_v<std::is_void<Ts>...>, "Use the vector overload to combine void futures");
+
+    struct Context
+    {
+        std::tuple<std::optional<Ts>...> values{};
+        std::atomic<std::size_t> remaining{sizeof...(Ts)};
+        Promise<std::tuple<Ts...>> promise{};
+
+        void complete()
+        {
+            promise.setValue(std::apply([](std::optional<Ts>&... value)
+                                        { return std::tuple<Ts...>(std::move(*value)...); },
+                                        values));
+        }
+    };
+
+    auto context{std::make_shared<Context>()};
+    Future<std::tuple<Ts...>> future{context->promise.getFuture()};
+    detail::attachWhenAll(context, std::index_sequence_for<Ts...>{}, futures...);
+    return future;
+}
+
+} // namespace threadsafe
+} // namespace trlc
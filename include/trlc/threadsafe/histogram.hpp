@@ -0,0 +1,108 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Copy of the buckets of a `DurationHistogram`.
+ */
+struct DurationHistogramSnapshot
+{
+    static constexpr std::size_t BUCKETS{40}; ///< Bucket `i` counts durations in [2^i, 2^(i+1)) ns, bucket 0 also counts 0 ns.
+
+    std::array<uint64_t, BUCKETS> buckets{}; ///< Number of durations per bucket.
+
+    /**
+     * @brief Returns the number of durations in the histogram.
+     * @return The sum of the buckets.
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief Returns an upper bound of a percentile, at the resolution of the buckets.
+     * @param fraction The percentile as a fraction, e.g. `0.99`.
+     * @return The upper bound of the bucket holding the percentile, zero if the histogram is empty.
+     */
+    std::chrono::nanoseconds percentile(const double fraction) const;
+};
+
+/**
+ * @brief A histogram of durations with power-of-two buckets, recorded with relaxed atomics.
+ *
+ * Recording is a bit scan and one uncontended increment, so it can sit on hot paths and be read from other
+ * threads at any time.
+ */
+class DurationHistogram
+{
+public:
+    using Snapshot = DurationHistogramSnapshot;
+
+    /**
+     * @brief Default constructor.
+     */
+    DurationHistogram() = default;
+
+    // Make this class uncopyable
+    UNCOPYABLE(DurationHistogram);
+
+    /**
+     * @brief Record a duration.
+     * @param duration The duration, negative durations count as zero.
+     */
+    void record(const std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Copy the buckets.
+     * @return The current buckets.
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Reset every bucket to zero.
+     */
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, Snapshot::BUCKETS> m_buckets{}; ///< Number of durations per bucket.
+
+    static std::size_t bucket(const uint64_t ns); ///< Bucket of a duration.
+};
+
+inline void DurationHistogram::record(const std::chrono::nanoseconds duration)
+{
+    const uint64_t ns{duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0};
+    m_buckets[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+inline std::size_t DurationHistogram::bucket(const uint64_t ns)
+{
+    if (ns < 2)
+    {
+        return 0;
+    }
+#if defined(_MSC_VER)
+    unsigned long index{0};
+    _BitScanReverse64(&index, ns);
+    const std::size_t bucket{static_cast<std::size_t>(index)};
+#else
+    const std::size_t bucket{static_cast<std::size_t>(63 - __builtin_clzll(ns))};
+#endif
+    return bucket < Snapshot::BUCKETS ? bucket : Snapshot::BUCKETS - 1;
+}
+
+} // namespace threadsafe
+} // namespace trlc
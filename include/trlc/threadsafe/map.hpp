@@ -0,0 +1,319 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief A thread-safe hash map split into independently locked shards.
+ *
+ * Each key belongs to one shard, chosen from the high bits of its mixed hash, and each shard is an
+ * `std::unordered_map` guarded by its own `std::shared_mutex` on its own cache line. Lookups take a shared
+ * lock on a single shard, so readers never contend and writers only contend with operations on the same
+ * shard. Values are returned by copy because references would outlive the shard lock.
+ *
+ * @tparam Key Type of the keys.
+ * @tparam Value Type of the values.
+ * @tparam Shards Number of shards, a power of two.
+ * @tparam Hash Hash function of the keys.
+ */
+template<typename Key, typename Value, std::size_t Shards = 16, typename Hash = std::hash<Key>>
+class Map
+{
+    static_assert(Shards > 0 && (Shards & (Shards - 1)) == 0, "The number of shards must be a power of two");
+
+public:
+    using Shard = std::unordered_map<Key, Value, Hash>;
+
+    /**
+     * @brief Default constructor.
+     */
+    Map() = default;
+
+    // Make this class uncopyable
+    UNCOPYABLE(Map);
+
+    /**
+     * @brief Look up the value of a key.
+     * @param key The key to look up.
+     * @return A copy of the value, or `std::nullopt` if the key is not present.
+     */
+    std::optional<Value> find(const Key& key) const;
+
+    /**
+     * @brief Check whether a key is present.
+     * @param key The key to look up.
+     * @return `true` if the key is present, `false` otherwise.
+     */
+    bool contains(const Key& key) const;
+
+    /**
+     * @brief Insert a value, or replace the value of a key that is already present.
+     * @param key The key.
+     * @param value The value.
+     * @return `true` if the key was inserted, `false` if its value was replaced.
+     */
+    template<typename V>
+    bool insertOrAssign(const Key& key, V&& value);
+
+    /**
+     * @brief Remove a key.
+     * @param key The key to remove.
+     * @return `true` if the key was removed, `false` if it was not present.
+     */
+    bool erase(const Key& key);
+
+    /**
+     * @brief Return the value of a key, inserting the result of `factory` first if the key is not present.
+     *
+     * `factory` is called at most once, under the exclusive lock of the key's shard, and must not access
+     * the map.
+     *
+     * @param key The key.
+     * @param factory Callable returning the value to insert.
+     * @return A copy of the value of the key.
+     */
+    template<typename F>
+    Value computeIfAbsent(const Key& key, F&& factory);
+
+    /**
+     * @brief Call `func` with each key and value, one shard at a time under its shared lock.
+     *
+     * The shards are visited one after another, so the visit is not a snapshot of the whole map.
+     * `func` must not access the map.
+     *
+     * @param func Callable receiving a `const Key&` and a `const Value&`.
+     */
+    template<typename F>
+    void visit(F&& func) const;
+
+    /**
+     * @brief Call `func` with the whole content of one shard under its shared lock.
+     * @param index The shard index, below `shardCount()`.
+     * @param func Callable receiving a `const Shard&`.
+     */
+    template<typename F>
+    void visitShard(const std::size_t index, F&& func) const;
+
+    /**
+     * @brief Returns the number of elements, summed shard by shard.
+     * @return The number of elements.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Check whether the map is empty.
+     * @return `true` if no shard holds an element, `false` otherwise.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Remove every element.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of shards.
+     * @return The number of shards.
+     */
+    static constexpr std::size_t shardCount()
+    {
+        return Shards;
+    }
+
+private:
+    /**
+     * @brief A shard and its lock, on their own cache lines.
+     */
+    struct alignas(CACHE_LINE_SIZE) Bucket
+    {
+        mutable std::shared_mutex lock{}; ///< Guards `map`.
+        Shard map{};                      ///< Elements of this shard.
+    };
+
+    Bucket m_buckets[Shards]{}; ///< The shards.
+
+    static std::size_t shardIndex(const std::size_t hash); ///< Map a hash to a shard.
+    static const Hash& hasher();                           ///< Shared hash function.
+    Bucket& bucket(const Key& key);                        ///< Shard of a key.
+    const Bucket& bucket(const Key& key) const;            ///< Shard of a key.
+};
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+std::optional<Value> Map<Key, Value, Shards, Hash>::find(const Key& key) const
+{
+    const Bucket& shard{bucket(key)};
+    std::shared_lock<std::shared_mutex> guard{shard.lock};
+    const auto it{shard.map.find(key)};
+    if (it == shard.map.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+bool Map<Key, Value, Shards, Hash>::contains(const Key& key) const
+{
+    const Bucket& shard{bucket(key)};
+    std::shared_lock<std::shared_mutex> guard{shard.lock};
+    return shard.map.find(key) != shard.map.end();
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+template<typename V>
+bool Map<Key, Value, Shards, Hash>::insertOrAssign(const Key& key, V&& value)
+{
+    Bucket& shard{bucket(key)};
+    std::lock_guard<std::shared_mutex> guard{shard.lock};
+    return shard.map.insert_or_assign(key, std::forward<V>(value)).second;
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+bool Map<Key, Value, Shards, Hash>::erase(const Key& key)
+{
+    Bucket& shard{bucket(key)};
+    std::lock_guard<std::shared_mutex> guard{shard.lock};
+    return shard.map.erase(key) > 0;
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+template<typename F>
+Value Map<Key, Value, Shards, Hash>::computeIfAbsent(const Key& key, F&& factory)
+{
+    Bucket& shard{bucket(key)};
+    {
+        // Most calls find the key, try under the shared lock first.
+        std::shared_lock<std::shared_mutex> guard{shard.lock};
+        const auto it{shard.map.find(key)};
+        if (it != shard.map.end())
+        {
+            return it->second;
+        }
+    }
+    std::lock_guard<std::shared_mutex> guard{shard.lock};
+    auto it{shard.map.find(key)};
+    if (it == shard.map.end())
+    {
+        it = shard.map.emplace(key, std::forward<F>(factory)()).first;
+    }
+    return it->second;
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+template<typename F>
+void Map<Key, Value, Shards, Hash>::visit(F&& func) const
+{
+    for (const Bucket& shard : m_buckets)
+    {
+        std::shared_lock<std::shared_mutex> guard{shard.lock};
+        for (const auto& [key, value] : shard.map)
+        {
+            func(key, value);
+        }
+    }
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+template<typename F>
+void Map<Key, Value, Shards, Hash>::visitShard(const std::size_t index, F&& func) const
+{
+    if (index >= Shards)
+    {
+        return;
+    }
+    const Bucket& shard{m_buckets[index]};
+    std::shared_lock<std::shared_mutex> guard{shard.lock};
+    std::forward<F>(func)(shard.map);
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+std::size_t Map<Key, Value, Shards, Hash>::size() const
+{
+    std::size_t count{0};
+    for (const Bucket& shard : m_buckets)
+    {
+        std::shared_lock<std::shared_mutex> guard{shard.lock};
+        count += shard.map.size();
+    }
+    return count;
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+bool Map<Key, Value, Shards, Hash>::empty() const
+{
+    for (const Bucket& shard : m_buckets)
+    {
+        std::shared_lock<std::shared_mutex> guard{shard.lock};
+        if (!shard.map.empty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+void Map<Key, Value, Shards, Hash>::clear()
+{
+    for (Bucket& shard : m_buckets)
+    {
+        std::lock_guard<std::shared_mutex> guard{shard.lock};
+        shard.map.clear();
+    }
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+std::size_t Map<Key, Value, Shards, Hash>::shardIndex(const std::size_t hash)
+{
+    if constexpr (Shards == 1)
+    {
+        return 0;
+    }
+    else
+    {
+        // Fibonacci hashing spreads identity hashes such as std::hash<int>, the high bits pick the shard
+        // while the unordered_map buckets use the low bits of the original hash.
+        constexpr uint64_t MULTIPLIER{0x9E3779B97F4A7C15ULL};
+        std::size_t bits{0};
+        while ((std::size_t{1} << bits) < Shards)
+        {
+            ++bits;
+        }
+        return static_cast<std::size_t>((static_cast<uint64_t>(hash) * MULTIPLIER) >> (64 - bits));
+    }
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+const Hash& Map<Key, Value, Shards, Hash>::hasher()
+{
+    static const Hash hash{};
+    return hash;
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+typename Map<Key, Value, Shards, Hash>::Bucket& Map<Key, Value, Shards, Hash>::bucket(const Key& key)
+{
+    return m_buckets[shardIndex(hasher()(key))];
+}
+
+template<typename Key, typename Value, std::size_t Shards, typename Hash>
+const typename Map<Key, Value, Shards, Hash>::Bucket& Map<Key, Value, Shards, Hash>::bucket(const Key& key) const
+{
+    return m_buckets[shardIndex(hasher()(key))];
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,1261 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/numa.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Lock-free bounded multi-producer/multi-consumer queue.
+ *
+ * The MpmcQueue class offers the same API and `Settings` semantics as `Queue`, but it is backed by a
+ * preallocated power-of-two array of slots. Each slot carries a sequence number telling producers and
+ * consumers whether it is free or holds an element for the current lap (Vyukov's bounded queue), so
+ * producers only contend on the tail index and consumers only on the head index. Threads fall back to
+ * blocking on `Wait` only when the ring is actually empty or full.
+ *
+ * @tparam T Type of elements stored in the queue.
+ */
+template<typename T>
+class MpmcQueue
+{
+public:
+    using DiscardedCallback = typename Queue<T>::DiscardedCallback;
+    using Discard = typename Queue<T>::Discard;
+    using Control = typename Queue<T>::Control;
+    using Settings = typename Queue<T>::Settings;
+    static constexpr uint32_t WAIT_FOREVER = Queue<T>::WAIT_FOREVER;
+    static constexpr std::size_t DEFAULT_CAPACITY{1024}; ///< Capacity used when `Settings::size` is unbounded.
+
+    /**
+     * @brief Slot of the ring held between `reserve` and `commit`, or between `peek` and `release`.
+     *
+     * Gives access to the element in place in the ring. Empty when nothing could be reserved or peeked.
+     * It is move-only so that a slot is committed or released once, and it must not outlive its queue.
+     */
+    class Reservation
+    {
+    public:
+        Reservation() = default;
+
+        /**
+         * @brief Destructor that drops a slot neither committed nor released.
+         *
+         * A reserved element is destroyed and its position is published as skipped, so that consumers step
+         * over it. A peeked element is released.
+         */
+        ~Reservation()
+        {
+            if (m_elem != nullptr)
+            {
+                m_queue->drop(*this);
+            }
+        }
+
+        Reservation(Reservation&& other) noexcept
+            : m_queue{other.m_queue}
+            , m_elem{std::exchange(other.m_elem, nullptr)}
+            , m_pos{other.m_pos}
+            , m_peeked{other.m_peeked}
+        {
+        }
+
+        Reservation& operator=(Reservation&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (m_elem != nullptr)
+                {
+                    m_queue->drop(*this);
+                }
+                m_queue = other.m_queue;
+                m_elem = std::exchange(other.m_elem, nullptr);
+                m_pos = other.m_pos;
+                m_peeked = other.m_peeked;
+            }
+            return *this;
+        }
+
+        Reservation(const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+
+        explicit operator bool() const
+        {
+            return m_elem != nullptr;
+        }
+
+        T& operator*() const
+        {
+            return *m_elem;
+        }
+
+        T* operator->() const
+        {
+            return m_elem;
+        }
+
+    private:
+        friend class MpmcQueue;
+
+        Reservation(MpmcQueue* queue, T* elem, const std::size_t pos, const bool peeked)
+            : m_queue{queue}
+            , m_elem{elem}
+            , m_pos{pos}
+            , m_peeked{peeked}
+        {
+        }
+
+        MpmcQueue* m_queue{nullptr}; ///< Queue owning the slot.
+        T* m_elem{nullptr};          ///< Element in the ring.
+        std::size_t m_pos{0};        ///< Position of the slot.
+        bool m_peeked{false};        ///< Whether the slot was peeked rather than reserved.
+    };
+
+    /**
+     * @brief Constructor that accepts queue settings.
+     *
+     * The ring is sized to the next power of two of `settings.size`. An unbounded size falls back to
+     * `DEFAULT_CAPACITY` because the ring cannot grow after construction.
+     *
+     * @param settings Settings to configure the queue behavior.
+     */
+    explicit MpmcQueue(const Settings& settings);
+
+    /**
+     * @brief Destructor that signal a exit waiting operation and destroys the remaining elements.
+     */
+    ~MpmcQueue();
+
+    // Make this class uncopyable
+    UNCOPYABLE(MpmcQueue);
+
+    /**
+     * @brief Set the callback for discarded elements.
+     * @param discarded_callback Function to be called when an element is discarded.
+     */
+    void setDiscardedCallback(DiscardedCallback discarded_callback);
+
+    /**
+     * @brief Open the queue for push operations.
+     */
+    void openPush();
+
+    /**
+     * @brief Close the queue for push operations.
+     */
+    void closePush();
+
+    /**
+     * @brief Open the queue for pop operations.
+     */
+    void openPop();
+
+    /**
+     * @brief Close the queue for pop operations.
+     */
+    void closePop();
+
+    /**
+     * @brief Attempts to push an element into the queue with an optional timeout.
+     *
+     * Discard policies behave as in `Queue::push`.
+     *
+     * @param elem The element to push into the queue.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` if the queue was full and no discard
+     *         was allowed, or if the queue was closed for push operations.
+     */
+    bool push(const T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to move an element into the queue with an optional timeout.
+     * @param elem The element to move into the queue.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    bool push(T&& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to push an element into the queue, waiting at most `timeout`.
+     * @param elem The element to push into the queue.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool push(const T& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to move an element into the queue, waiting at most `timeout`.
+     * @param elem The element to move into the queue.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool push(T&& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to push an element into the queue, waiting at most until `deadline`.
+     * @param elem The element to push into the queue.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool push(const T& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Attempts to move an element into the queue, waiting at most until `deadline`.
+     * @param elem The element to move into the queue.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool push(T&& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Constructs an element in place in the ring, waiting forever for room if needed.
+     *
+     * The arguments are only consumed once a slot has been claimed.
+     *
+     * @tparam Args Types of the arguments forwarded to the constructor of `T`.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool emplace(Args&&... args);
+
+    /**
+     * @brief Reserves a slot of the ring so that the element is written in place, with an optional timeout.
+     *
+     * The element is default-initialized, so the storage of a trivial type is handed over as is and no
+     * payload is copied. Control and discard policies behave as in `push`, except that `DISCARD_NEWEST` has
+     * no element to hand to the discarded callback. Consumers do not see the element until `commit`, and
+     * the ones reaching its position meanwhile find the queue empty, so the slot must be committed promptly.
+     *
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return The reserved slot, empty if the queue was full and no discard was allowed, or if the queue was
+     *         closed for push operations.
+     */
+    Reservation reserve(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Reserves a slot of the ring, waiting at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return The reserved slot, empty if none could be reserved.
+     */
+    template<class Rep, class Period>
+    Reservation reserve(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Reserves a slot of the ring, waiting at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return The reserved slot, empty if none could be reserved.
+     */
+    template<class C, class Duration>
+    Reservation reserve(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Publishes a reserved slot to the consumers.
+     *
+     * A reservation can be committed even once the queue is closed for push operations. One dropped without
+     * a commit is destroyed and its position skipped by the consumers.
+     *
+     * @param reservation The slot returned by `reserve`, empty on return.
+     * @return `true` if the element was published, `false` if the reservation was empty.
+     */
+    bool commit(Reservation& reservation);
+
+    /**
+     * @brief Attempts to pop an element from the queue with an optional timeout.
+     *
+     * @param elem Reference where the popped element will be stored.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` if the queue was
+     *         empty and the timeout was reached or the queue was closed for pop operations.
+     */
+    bool pop(T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to pop an element from the queue, waiting at most `timeout`.
+     * @param elem Reference where the popped element will be stored.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool pop(T& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to pop an element from the queue, waiting at most until `deadline`.
+     * @param elem Reference where the popped element will be stored.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool pop(T& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Pops an element from the queue without blocking.
+     *
+     * The element is move-constructed out of the ring.
+     *
+     * @return The popped element, or `std::nullopt` if the queue was empty or closed for pop operations.
+     */
+    std::optional<T> tryPop();
+
+    /**
+     * @brief Claims the oldest element to access it in place, with an optional timeout.
+     *
+     * The slot stays out of reach of the producers until `release`, so the ring fills up behind it. A
+     * producer reaching the slot waits for its release under every discard policy, since discarding would
+     * not free it, so the peeking thread itself must not push into a full ring without a timeout.
+     *
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return The slot of the claimed element, empty if the queue was empty and the timeout was reached or
+     *         the queue was closed for pop operations.
+     */
+    Reservation peek(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Gives access in place to the oldest element, waiting at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return The slot of the oldest element, empty if none could be peeked.
+     */
+    template<class Rep, class Period>
+    Reservation peek(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Gives access in place to the oldest element, waiting at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return The slot of the oldest element, empty if none could be peeked.
+     */
+    template<class C, class Duration>
+    Reservation peek(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Destroys a peeked element and hands its slot back to the producers.
+     *
+     * A peeked element dropped without a release is released by its destructor.
+     *
+     * @param reservation The slot returned by `peek`, empty on return.
+     * @return `true` if the slot was released, `false` if the reservation was empty.
+     */
+    bool release(Reservation& reservation);
+
+    /**
+     * @brief Waits until the queue is open for pushing or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for push operations within the timeout period, `false` otherwise.
+     */
+    bool waitPushOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Waits until the queue is open for pushing, at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the queue is open for push operations, `false` if the timeout was reached.
+     */
+    template<class Rep, class Period>
+    bool waitPushOpen(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Waits until the queue is open for pushing, at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the queue is open for push operations, `false` if the deadline was reached.
+     */
+    template<class C, class Duration>
+    bool waitPushOpen(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Waits until the queue is open for popping or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for pop operations within the timeout period, `false` otherwise.
+     */
+    bool waitPopOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Waits until the queue is open for popping, at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the queue is open for pop operations, `false` if the timeout was reached.
+     */
+    template<class Rep, class Period>
+    bool waitPopOpen(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Waits until the queue is open for popping, at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the queue is open for pop operations, `false` if the deadline was reached.
+     */
+    template<class C, class Duration>
+    bool waitPopOpen(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Returns the maximum number of elements the queue holds.
+     * @return The capacity of the queue.
+     */
+    std::size_t capacity() const;
+
+private:
+    using Clock = Wait::Clock;
+
+    /**
+     * @brief One element of the ring with its sequence number.
+     *
+     * A slot at index `i` is free for the producer of position `p` when `sequence == p`, and holds the
+     * element of position `p` when `sequence == p + 1`. A dropped reservation publishes its position with
+     * `skipped` set and no element, the consumer claiming it frees the slot and moves on.
+     */
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence{0};
+        bool skipped{false}; ///< Written before `sequence` is published, read after it is claimed.
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // Rarely changing state shared by both sides.
+    const Settings m_settings;                ///< Queue settings.
+    const std::size_t m_capacity;             ///< Maximum number of elements.
+    const std::size_t m_mask;                 ///< Mask mapping a position to a slot.
+    NumaArray<Slot> m_slots;                  ///< Ring storage.
+    std::atomic<bool> m_open_push{false};     ///< Flag indicating whether push is open.
+    std::atomic<bool> m_open_pop{false};      ///< Flag indicating whether pop is open.
+    DiscardedCallback m_discarded_callback{}; ///< Callback for discarded elements.
+    Wait m_wait{};                            ///< Wait mechanism for blocking operations.
+
+    // Consumer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_head{0}; ///< Next position to dequeue.
+    std::atomic<uint32_t> m_pop_waiters{0};                      ///< Number of threads blocked in pop.
+
+    // Producer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail{0}; ///< Next position to enqueue.
+    std::atomic<uint32_t> m_push_waiters{0};                     ///< Number of threads blocked in push.
+
+    void onDiscarded(const T& elem);                      ///< Handle discarded elements.
+    bool pushControllable() const;                        ///< Check if push is controllable.
+    bool popControllable() const;                         ///< Check if pop is controllable.
+    bool waitToPush(const Clock::time_point deadline);    ///< Wait for push availability.
+    bool waitToPop(const Clock::time_point deadline);     ///< Wait for pop availability.
+    bool waitNotFull(const Clock::time_point deadline);   ///< Block until the tail slot is free or push closes.
+    bool atCapacity() const;                              ///< Check whether `m_capacity` positions are claimed and not dequeued.
+    bool full() const;                                    ///< Check whether the ring looks full, also on a slot still in use.
+    bool empty() const;                                   ///< Check whether the ring looks empty.
+    T* slotValue(Slot& slot) const;                       ///< Element storage of a slot.
+    Reservation claimTail();                              ///< Claim a free slot, empty if the ring is full.
+    Reservation claimHead();                              ///< Claim the oldest element, stepping over skipped positions.
+    void publish(Reservation& reservation);               ///< Hand a reserved element to the consumers.
+    void skip(Reservation& reservation);                  ///< Publish a reserved position without an element.
+    void vacate(Reservation& reservation);                ///< Destroy a claimed element and hand its slot to the producers.
+    void drop(Reservation& reservation);                  ///< Drop a reservation neither committed nor released.
+    void discardOldest();                                 ///< Hand the oldest element to the discarded callback.
+    void notifyPush();                                    ///< Wake blocked producers if there are any.
+    void notifyPop();                                     ///< Wake blocked consumers if there are any.
+    static Clock::time_point deadline(const uint32_t ms); ///< Convert a timeout to a deadline, `Wait::NO_DEADLINE` for `WAIT_FOREVER`.
+
+    /**
+     * @brief Internal push method constructing the element from `args`.
+     * @param push_deadline The time point to give up at, `Wait::NO_DEADLINE` to wait indefinitely.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool enqueue(const Clock::time_point push_deadline, Args&&... args);
+
+    Reservation reserveUntil(const Clock::time_point push_deadline); ///< Reserve a slot, waiting at most until a deadline.
+    bool popUntil(T& elem, const Clock::time_point pop_deadline);    ///< Pop an element, waiting at most until a deadline.
+    Reservation peekUntil(const Clock::time_point pop_deadline);     ///< Peek the oldest element, waiting at most until a deadline.
+    bool waitPushOpenUntil(const Clock::time_point deadline);        ///< Wait for push to open, at most until a deadline.
+    bool waitPopOpenUntil(const Clock::time_point deadline);         ///< Wait for pop to open, at most until a deadline.
+
+    /**
+     * @brief Non-blocking push.
+     * @param args Arguments forwarded to the constructor of `T` once a slot is claimed.
+     * @return `true` if the element was pushed, `false` if the ring was full.
+     */
+    template<typename... Args>
+    bool tryEnqueue(Args&&... args);
+
+    /**
+     * @brief Non-blocking pop.
+     * @param consume Callable receiving the claimed element to move it out; it is destroyed afterwards.
+     * @return `true` if an element was claimed, `false` if the ring was empty.
+     */
+    template<typename F>
+    bool dequeue(F&& consume);
+
+    /**
+     * @brief Hand an element that was never inserted to the discarded callback.
+     * @param args The element, or the arguments to construct it from.
+     */
+    template<typename... Args>
+    void discardNewest(Args&&... args);
+};
+
+template<typename T>
+MpmcQueue<T>::MpmcQueue(const Settings& settings)
+    : m_settings{settings}
+    , m_capacity{settings.size == std::numeric_limits<std::size_t>::max() ? DEFAULT_CAPACITY : (settings.size == 0 ? 1 : settings.size)}
+    , m_mask{nextPowerOfTwo(m_capacity) - 1}
+    , m_slots{makeNumaArray<Slot>(m_mask + 1, settings.numa_node)}
+    , m_wait{settings.wait_strategy}
+{
+    for (std::size_t index = 0; index <= m_mask; ++index)
+    {
+        m_slots[index].sequence.store(index, std::memory_order_relaxed);
+    }
+    if (!pushControllable())
+    {
+        m_open_push.store(true, std::memory_order_release);
+    }
+    if (!popControllable())
+    {
+        m_open_pop.store(true, std::memory_order_release);
+    }
+}
+
+template<typename T>
+MpmcQueue<T>::~MpmcQueue()
+{
+    m_open_pop.store(false, std::memory_order_release);
+    m_open_push.store(false, std::memory_order_release);
+    m_wait.notify();
+
+    while (dequeue([](T&) {}))
+    {
+    }
+}
+
+template<typename T>
+void MpmcQueue<T>::setDiscardedCallback(DiscardedCallback discarded_callback)
+{
+    m_discarded_callback = discarded_callback;
+}
+
+template<typename T>
+void MpmcQueue<T>::onDiscarded(const T& elem)
+{
+    if (m_discarded_callback)
+    {
+        m_discarded_callback(elem);
+    }
+}
+
+template<typename T>
+std::size_t MpmcQueue<T>::capacity() const
+{
+    return m_capacity;
+}
+
+template<typename T>
+bool MpmcQueue<T>::push(const T& elem, const uint32_t timeout_ms)
+{
+    return enqueue(deadline(timeout_ms), elem);
+}
+
+template<typename T>
+bool MpmcQueue<T>::push(T&& elem, const uint32_t timeout_ms)
+{
+    return enqueue(deadline(timeout_ms), std::move(elem));
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool MpmcQueue<T>::push(const T& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return enqueue(Wait::deadlineAfter(timeout), elem);
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool MpmcQueue<T>::push(T&& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return enqueue(Wait::deadlineAfter(timeout), std::move(elem));
+}
+
+template<typename T>
+template<class C, class Duration>
+bool MpmcQueue<T>::push(const T& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return enqueue(Wait::toDeadline(deadline), elem);
+}
+
+template<typename T>
+template<class C, class Duration>
+bool MpmcQueue<T>::push(T&& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return enqueue(Wait::toDeadline(deadline), std::move(elem));
+}
+
+template<typename T>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::reserve(const uint32_t timeout_ms)
+{
+    return reserveUntil(deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::reserve(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return reserveUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::reserve(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return reserveUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T>
+bool MpmcQueue<T>::pop(T& elem, const uint32_t timeout_ms)
+{
+    return popUntil(elem, deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool MpmcQueue<T>::pop(T& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return popUntil(elem, Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+bool MpmcQueue<T>::pop(T& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return popUntil(elem, Wait::toDeadline(deadline));
+}
+
+template<typename T>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::peek(const uint32_t timeout_ms)
+{
+    return peekUntil(deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::peek(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return peekUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::peek(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return peekUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T>
+bool MpmcQueue<T>::waitPushOpen(const uint32_t timeout_ms)
+{
+    return waitPushOpenUntil(deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool MpmcQueue<T>::waitPushOpen(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return waitPushOpenUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+bool MpmcQueue<T>::waitPushOpen(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return waitPushOpenUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T>
+bool MpmcQueue<T>::waitPopOpen(const uint32_t timeout_ms)
+{
+    return waitPopOpenUntil(deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool MpmcQueue<T>::waitPopOpen(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return waitPopOpenUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+bool MpmcQueue<T>::waitPopOpen(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return waitPopOpenUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T>
+template<typename... Args>
+bool MpmcQueue<T>::emplace(Args&&... args)
+{
+    return enqueue(Wait::NO_DEADLINE, std::forward<Args>(args)...);
+}
+
+template<typename T>
+template<typename... Args>
+bool MpmcQueue<T>::enqueue(const Clock::time_point push_deadline, Args&&... args)
+{
+    while (true)
+    {
+        if (!waitToPush(push_deadline))
+        {
+            return false;
+        }
+        if (tryEnqueue(std::forward<Args>(args)...))
+        {
+            notifyPop();
+            return true;
+        }
+        if (!atCapacity())
+        {
+            // A consumer still holds the slot of the previous lap, discarding would not free it.
+            if (!waitNotFull(push_deadline))
+            {
+                return false;
+            }
+            continue;
+        }
+        if (m_settings.discard == Discard::DISCARD_NEWEST)
+        {
+            discardNewest(std::forward<Args>(args)...);
+            return false;
+        }
+        if (m_settings.discard == Discard::DISCARD_OLDEST)
+        {
+            discardOldest();
+        }
+    }
+}
+
+template<typename T>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::reserveUntil(const Clock::time_point push_deadline)
+{
+    while (true)
+    {
+        if (!waitToPush(push_deadline))
+        {
+            return Reservation{};
+        }
+        Reservation reservation{claimTail()};
+        if (reservation)
+        {
+            try
+            {
+                new (reservation.m_elem) T;
+            }
+            catch (...)
+            {
+                skip(reservation);
+                throw;
+            }
+            return reservation;
+        }
+        if (!atCapacity())
+        {
+            // A consumer still holds the slot of the previous lap, discarding would not free it.
+            if (!waitNotFull(push_deadline))
+            {
+                return Reservation{};
+            }
+            continue;
+        }
+        if (m_settings.discard == Discard::DISCARD_NEWEST)
+        {
+            return Reservation{};
+        }
+        if (m_settings.discard == Discard::DISCARD_OLDEST)
+        {
+            discardOldest();
+        }
+    }
+}
+
+template<typename T>
+bool MpmcQueue<T>::commit(Reservation& reservation)
+{
+    if (!reservation)
+    {
+        return false;
+    }
+    publish(reservation);
+    notifyPop();
+    return true;
+}
+
+template<typename T>
+void MpmcQueue<T>::discardOldest()
+{
+    std::optional<T> discarded_elem{};
+    if (dequeue([&discarded_elem](T& oldest)
+                { discarded_elem.emplace(std::move(oldest)); }))
+    {
+        onDiscarded(*discarded_elem);
+    }
+}
+
+template<typename T>
+template<typename... Args>
+void MpmcQueue<T>::discardNewest(Args&&... args)
+{
+    if (!m_discarded_callback)
+    {
+        return;
+    }
+    if constexpr (sizeof...(Args) == 1 && std::conjunction_v<std::is_same<std::decay_t<Args>, T>...>)
+    {
+        onDiscarded(args...);
+    }
+    else
+    {
+        onDiscarded(T(std::forward<Args>(args)...));
+    }
+}
+
+template<typename T>
+bool MpmcQueue<T>::popUntil(T& elem, const Clock::time_point pop_deadline)
+{
+    while (true)
+    {
+        if (!waitToPop(pop_deadline))
+        {
+            return false;
+        }
+        if (dequeue([&elem](T& value)
+                    { elem = std::move(value); }))
+        {
+            notifyPush();
+            return true;
+        }
+    }
+}
+
+template<typename T>
+std::optional<T> MpmcQueue<T>::tryPop()
+{
+    std::optional<T> elem{};
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return elem;
+    }
+    if (dequeue([&elem](T& value)
+                { elem.emplace(std::move(value)); }))
+    {
+        notifyPush();
+    }
+    return elem;
+}
+
+template<typename T>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::peekUntil(const Clock::time_point pop_deadline)
+{
+    while (true)
+    {
+        if (!waitToPop(pop_deadline))
+        {
+            return Reservation{};
+        }
+        Reservation reservation{claimHead()};
+        if (reservation)
+        {
+            return reservation;
+        }
+    }
+}
+
+template<typename T>
+bool MpmcQueue<T>::release(Reservation& reservation)
+{
+    if (!reservation)
+    {
+        return false;
+    }
+    vacate(reservation);
+    notifyPush();
+    return true;
+}
+
+template<typename T>
+template<typename... Args>
+bool MpmcQueue<T>::tryEnqueue(Args&&... args)
+{
+    Reservation reservation{claimTail()};
+    if (!reservation)
+    {
+        return false;
+    }
+    try
+    {
+        new (reservation.m_elem) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        skip(reservation);
+        throw;
+    }
+    publish(reservation);
+    return true;
+}
+
+template<typename T>
+template<typename F>
+bool MpmcQueue<T>::dequeue(F&& consume)
+{
+    Reservation reservation{claimHead()};
+    if (!reservation)
+    {
+        return false;
+    }
+    consume(*reservation);
+    vacate(reservation);
+    return true;
+}
+
+template<typename T>
+void MpmcQueue<T>::publish(Reservation& reservation)
+{
+    m_slots[reservation.m_pos & m_mask].sequence.store(reservation.m_pos + 1, std::memory_order_release);
+    reservation.m_elem = nullptr;
+}
+
+template<typename T>
+void MpmcQueue<T>::skip(Reservation& reservation)
+{
+    m_slots[reservation.m_pos & m_mask].skipped = true;
+    publish(reservation);
+}
+
+template<typename T>
+void MpmcQueue<T>::vacate(Reservation& reservation)
+{
+    reservation->~T();
+    m_slots[reservation.m_pos & m_mask].sequence.store(reservation.m_pos + m_mask + 1, std::memory_order_release);
+    reservation.m_elem = nullptr;
+}
+
+template<typename T>
+void MpmcQueue<T>::drop(Reservation& reservation)
+{
+    if (reservation.m_peeked)
+    {
+        release(reservation);
+        return;
+    }
+    // The tail has moved past the position, consumers step over it instead.
+    reservation->~T();
+    skip(reservation);
+    notifyPop();
+}
+
+template<typename T>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::claimTail()
+{
+    std::size_t pos{m_tail.load(std::memory_order_relaxed)};
+    while (true)
+    {
+        const std::size_t head{m_head.load(std::memory_order_acquire)};
+        if (head <= pos && pos - head >= m_capacity)
+        {
+            return Reservation{};
+        }
+        Slot& slot{m_slots[pos & m_mask]};
+        const std::size_t sequence{slot.sequence.load(std::memory_order_acquire)};
+        const std::intptr_t diff{static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos)};
+        if (diff == 0)
+        {
+            if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                return Reservation{this, slotValue(slot), pos, false};
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds the element of the previous lap.
+            return Reservation{};
+        }
+        else
+        {
+            pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+typename MpmcQueue<T>::Reservation MpmcQueue<T>::claimHead()
+{
+    std::size_t pos{m_head.load(std::memory_order_relaxed)};
+    while (true)
+    {
+        Slot& slot{m_slots[pos & m_mask]};
+        const std::size_t sequence{slot.sequence.load(std::memory_order_acquire)};
+        const std::intptr_t diff{static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1)};
+        if (diff == 0)
+        {
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                if (!slot.skipped)
+                {
+                    return Reservation{this, slotValue(slot), pos, true};
+                }
+                // A dropped reservation, free its slot and claim the next position.
+                slot.skipped = false;
+                slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                notifyPush();
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+        else if (diff < 0)
+        {
+            // The producer of this position has not published its element yet.
+            return Reservation{};
+        }
+        else
+        {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+bool MpmcQueue<T>::atCapacity() const
+{
+    const std::size_t pos{m_tail.load(std::memory_order_acquire)};
+    const std::size_t head{m_head.load(std::memory_order_acquire)};
+    return head <= pos && pos - head >= m_capacity;
+}
+
+template<typename T>
+bool MpmcQueue<T>::full() const
+{
+    if (atCapacity())
+    {
+        return true;
+    }
+    const std::size_t pos{m_tail.load(std::memory_order_acquire)};
+    const std::size_t sequence{m_slots[pos & m_mask].sequence.load(std::memory_order_acquire)};
+    return static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos) < 0;
+}
+
+template<typename T>
+bool MpmcQueue<T>::empty() const
+{
+    const std::size_t pos{m_head.load(std::memory_order_acquire)};
+    const std::size_t sequence{m_slots[pos & m_mask].sequence.load(std::memory_order_acquire)};
+    return static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1) < 0;
+}
+
+template<typename T>
+T* MpmcQueue<T>::slotValue(Slot& slot) const
+{
+    return std::launder(reinterpret_cast<T*>(slot.storage));
+}
+
+template<typename T>
+void MpmcQueue<T>::notifyPush()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_push_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        m_wait.notify();
+    }
+}
+
+template<typename T>
+void MpmcQueue<T>::notifyPop()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_pop_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        m_wait.notify();
+    }
+}
+
+template<typename T>
+typename MpmcQueue<T>::Clock::time_point MpmcQueue<T>::deadline(const uint32_t ms)
+{
+    if (ms == WAIT_FOREVER)
+    {
+        return Wait::NO_DEADLINE;
+    }
+    return Wait::deadlineAfter(std::chrono::milliseconds(ms));
+}
+
+template<typename T>
+bool MpmcQueue<T>::pushControllable() const
+{
+    if (m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::PUSH)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+bool MpmcQueue<T>::popControllable() const
+{
+    if (m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::POP)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+void MpmcQueue<T>::openPush()
+{
+    if (!pushControllable())
+    {
+        return;
+    }
+    m_open_push.store(true, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void MpmcQueue<T>::closePush()
+{
+    if (!pushControllable())
+    {
+        return;
+    }
+    m_open_push.store(false, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void MpmcQueue<T>::openPop()
+{
+    if (!popControllable())
+    {
+        return;
+    }
+    m_open_pop.store(true, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void MpmcQueue<T>::closePop()
+{
+    if (!popControllable())
+    {
+        return;
+    }
+    m_open_pop.store(false, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+bool MpmcQueue<T>::waitToPush(const Clock::time_point deadline)
+{
+    if (!m_open_push.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    if (m_settings.discard != Discard::NO_DISCARD || !full())
+    {
+        return true;
+    }
+    return waitNotFull(deadline);
+}
+
+template<typename T>
+bool MpmcQueue<T>::waitNotFull(const Clock::time_point deadline)
+{
+    // A discard policy frees room itself once the ring is at capacity.
+    auto closed_or_not_full_pred = [&]() -> bool
+    {
+        if (!m_open_push.load(std::memory_order_acquire) || !full())
+        {
+            return true;
+        }
+        return m_settings.discard != Discard::NO_DISCARD && atCapacity();
+    };
+
+    m_push_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Wait::Status result{m_wait.waitUntil(deadline, closed_or_not_full_pred)};
+    m_push_waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (result != Wait::Status::SUCCESS || !m_open_push.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool MpmcQueue<T>::waitToPop(const Clock::time_point deadline)
+{
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    if (!empty())
+    {
+        return true;
+    }
+
+    auto closed_or_not_empty_pred = [&]() -> bool
+    {
+        if (!m_open_pop.load(std::memory_order_acquire) || !empty())
+        {
+            return true;
+        }
+        return false;
+    };
+
+    m_pop_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Wait::Status result{m_wait.waitUntil(deadline, closed_or_not_empty_pred)};
+    m_pop_waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (result != Wait::Status::SUCCESS || !m_open_pop.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool MpmcQueue<T>::waitPushOpenUntil(const Clock::time_point deadline)
+{
+    Wait::Status result{
+        m_wait.waitUntil(deadline, [this]() -> bool
+                         { return m_open_push.load(std::memory_order_acquire); })};
+    if (result != Wait::Status::SUCCESS)
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool MpmcQueue<T>::waitPopOpenUntil(const Clock::time_point deadline)
+{
+    Wait::Status result{
+        m_wait.waitUntil(deadline, [this]() -> bool
+                         { return m_open_pop.load(std::memory_order_acquire); })};
+    if (result != Wait::Status::SUCCESS)
+    {
+        return false;
+    }
+    return true;
+}
+
+} // namespace threadsafe
+} // namespace trlc
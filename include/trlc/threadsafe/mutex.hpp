@@ -0,0 +1,73 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+
+#include <cstddef>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief A mutex whose owner inherits the priority of the threads blocked on it.
+ *
+ * With a plain `std::mutex`, a high-priority thread waiting for a lock held by a low-priority one also waits
+ * for every medium-priority thread preempting the owner. On Linux this mutex uses `PTHREAD_PRIO_INHERIT`:
+ * the owner runs at the priority of its highest-priority waiter until it unlocks, which bounds the inversion
+ * to the critical section. Uncontended locking stays in user space. Windows has no inheritance for
+ * user-mode locks, there it is a plain slim reader/writer lock.
+ *
+ * It meets the Lockable requirements, so that it can be the `Lock` of `Queue` and `Variable`.
+ */
+class PriorityInheritanceMutex
+{
+public:
+    /**
+     * @brief Constructor, falling back to a plain mutex where the system does not support inheritance.
+     *
+     * Throws `std::system_error` if not even a plain mutex can be created.
+     */
+    PriorityInheritanceMutex();
+
+    /**
+     * @brief Destructor. The mutex must not be locked.
+     */
+    ~PriorityInheritanceMutex();
+
+    // Make this class uncopyable
+    UNCOPYABLE(PriorityInheritanceMutex);
+
+    /**
+     * @brief Lock the mutex, blocking until it is available.
+     *
+     * Like `std::mutex::lock`, throws `std::system_error` with the error of the native lock if it fails.
+     */
+    void lock();
+
+    /**
+     * @brief Lock the mutex if it is available.
+     * @return `true` if the mutex was locked, `false` if another thread owns it.
+     */
+    bool try_lock();
+
+    /**
+     * @brief Unlock the mutex, owned by the calling thread.
+     */
+    void unlock();
+
+    /**
+     * @brief Returns whether the owner inherits the priority of the waiters.
+     * @return `true` with priority inheritance, `false` on a plain mutex.
+     */
+    bool inheritsPriority() const;
+
+    static constexpr std::size_t NATIVE_SIZE{64}; ///< Bytes reserved for the native mutex.
+
+private:
+    alignas(8) unsigned char m_native[NATIVE_SIZE]{}; ///< The native mutex.
+    bool m_inherits{false};                           ///< Whether the native mutex inherits priorities.
+};
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+inline constexpr int32_t NO_NUMA_NODE{-1}; ///< Placement left to the operating system.
+
+using CpuSet = std::vector<uint32_t>; ///< Logical CPU indices.
+
+/**
+ * @brief Restricts a thread to a set of logical CPUs.
+ *
+ * On Windows all CPUs must belong to the same processor group.
+ *
+ * @param cpus The logical CPUs the thread may run on.
+ * @param native_handle The native handle of the thread.
+ * @return An empty error code if the affinity was applied, otherwise the error, `std::errc::invalid_argument`
+ *         for an empty set or a CPU the set cannot hold.
+ */
+std::error_code setNativeThreadAffinity(const CpuSet& cpus, const std::thread::native_handle_type native_handle);
+
+/**
+ * @brief Binds the calling thread to the CPUs of a NUMA node and prefers the node for its allocations.
+ *
+ * The memory preference is a thread memory policy on Linux; Windows has no equivalent, so only the CPU
+ * binding applies there and storage should be placed with `numaAllocate`.
+ *
+ * @param node The NUMA node.
+ * @return An empty error code if the CPU binding and the memory preference were applied, otherwise the
+ *         error of the first that failed. The CPU binding stays applied when only the memory preference fails.
+ */
+std::error_code bindCurrentThreadToNumaNode(const int32_t node);
+
+/**
+ * @brief Returns the number of NUMA nodes, 1 on systems without NUMA.
+ * @return The number of NUMA nodes.
+ */
+uint32_t numaNodeCount();
+
+/**
+ * @brief Returns the NUMA node of the CPU the calling thread is running on.
+ * @return The NUMA node, or `NO_NUMA_NODE` if it cannot be determined.
+ */
+int32_t currentNumaNode();
+
+/**
+ * @brief Returns the logical CPUs of a NUMA node.
+ * @param node The NUMA node.
+ * @return The logical CPUs, empty if the node does not exist.
+ */
+CpuSet numaNodeCpus(const int32_t node);
+
+/**
+ * @brief Allocates page-aligned memory placed on a NUMA node.
+ * @param bytes The number of bytes to allocate.
+ * @param node The NUMA node.
+ * @return The memory, or `nullptr` on failure.
+ */
+void* numaAllocate(const std::size_t bytes, const int32_t node);
+
+/**
+ * @brief Releases memory obtained from `numaAllocate`.
+ * @param ptr The memory to release.
+ * @param bytes The number of bytes passed to `numaAllocate`.
+ */
+void numaDeallocate(void* ptr, const std::size_t bytes);
+
+/**
+ * @brief Deleter destroying the elements of a `NumaArray` and releasing its storage.
+ */
+template<typename T>
+class NumaArrayDeleter
+{
+public:
+    NumaArrayDeleter() = default;
+
+    NumaArrayDeleter(const std::size_t count, const bool numa)
+        : m_count{count}
+        , m_numa{numa}
+    {
+    }
+
+    void operator()(T* ptr) const
+    {
+        for (std::size_t index = 0; index < m_count; ++index)
+        {
+            ptr[index].~T();
+        }
+        if (m_numa)
+        {
+            numaDeallocate(ptr, m_count * sizeof(T));
+        }
+        else
+        {
+            ::operator delete(ptr, std::align_val_t{alignof(T)});
+        }
+    }
+
+private:
+    std::size_t m_count{0}; ///< Number of constructed elements.
+    bool m_numa{false};     ///< Whether the storage comes from `numaAllocate`.
+};
+
+template<typename T>
+using NumaArray = std::unique_ptr<T[], NumaArrayDeleter<T>>;
+
+/**
+ * @brief Allocates an array of default-initialized elements, placed on a NUMA node if requested.
+ *
+ * Falls back to the regular heap when `node` is `NO_NUMA_NODE` or the placement fails.
+ *
+ * @tparam T Type of the elements.
+ * @param count The number of elements.
+ * @param node The NUMA node, or `NO_NUMA_NODE`.
+ * @return The array.
+ */
+template<typename T>
+NumaArray<T> makeNumaArray(const std::size_t count, const int32_t node)
+{
+    static_assert(alignof(T) <= 4096, "NUMA storage is only page aligned");
+    void* storage{node == NO_NUMA_NODE ? nullptr : numaAllocate(count * sizeof(T), node)};
+    const bool numa{storage != nullptr};
+    if (!numa)
+    {
+        storage = ::operator new(count * sizeof(T), std::align_val_t{alignof(T)});
+    }
+    T* elements{static_cast<T*>(storage)};
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        new (elements + index) T;
+    }
+    return NumaArray<T>{elements, NumaArrayDeleter<T>{count, numa}};
+}
+
+} // namespace threadsafe
+} // namespace trlc
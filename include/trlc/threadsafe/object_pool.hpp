@@ -0,0 +1,517 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+namespace detail
+{
+uint64_t nextObjectPoolId(); ///< Unique identifier of a new pool, never reused.
+} // namespace detail
+
+/**
+ * @brief Pool of objects of type T with per-thread caches of free objects.
+ *
+ * Each thread allocates from and frees into its own cache without locking. A cache that grows past two
+ * batches hands one batch back to a shared depot, and an empty cache takes a whole batch from the depot or
+ * carves a new chunk, so the pool lock is taken once per batch. This covers the producer/consumer pattern
+ * where objects are created on one thread and destroyed on another: the consumer's frees travel back to the
+ * producer in batches, and once the working set is allocated no call reaches the global allocator.
+ *
+ * Memory is only released when the pool is destroyed, after every object has been destroyed. A thread that
+ * exits, or that uses more than `MAX_THREAD_POOLS` pools of the same type, hands the free objects of its
+ * forgotten caches back to the depot, and the next thread to register reuses the empty cache.
+ *
+ * @tparam T Type of the pooled objects.
+ */
+template<typename T>
+class ObjectPool
+{
+public:
+    /**
+     * @brief Settings for the pool.
+     */
+    struct Settings
+    {
+        std::size_t chunk_size{256}; ///< Objects allocated at once when the pool runs dry.
+        std::size_t batch_size{64};  ///< Free objects moved at once between a thread cache and the depot.
+    };
+
+    /**
+     * @brief Deleter returning an object to its pool, for use with `std::unique_ptr`.
+     */
+    class Deleter
+    {
+    public:
+        Deleter() = default;
+
+        explicit Deleter(ObjectPool* pool)
+            : m_pool{pool}
+        {
+        }
+
+        void operator()(T* object) const
+        {
+            m_pool->destroy(object);
+        }
+
+    private:
+        ObjectPool* m_pool{nullptr}; ///< Owning pool.
+    };
+
+    using Pointer = std::unique_ptr<T, Deleter>;
+
+    /**
+     * @brief Constructor with default settings.
+     */
+    ObjectPool()
+        : ObjectPool(Settings{})
+    {
+    }
+
+    /**
+     * @brief Constructor that accepts pool settings.
+     * @param settings Settings to configure the pool.
+     */
+    explicit ObjectPool(const Settings& settings);
+
+    /**
+     * @brief Destructor that releases the memory. Every object must have been destroyed.
+     */
+    ~ObjectPool();
+
+    // Make this class uncopyable
+    UNCOPYABLE(ObjectPool);
+
+    /**
+     * @brief Construct an object in the pool.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return The object, to be returned with `destroy`.
+     */
+    template<typename... Args>
+    T* create(Args&&... args);
+
+    /**
+     * @brief Destroy an object and keep its memory for reuse. May be called from any thread.
+     * @param object The object created by this pool, or `nullptr`.
+     */
+    void destroy(T* object);
+
+    /**
+     * @brief Construct an object owned by a `std::unique_ptr` that returns it to the pool.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return The owning pointer.
+     */
+    template<typename... Args>
+    Pointer make(Args&&... args);
+
+    /**
+     * @brief Returns a callback destroying discarded elements, for `Queue<T*>::setDiscardedCallback`.
+     * @return The callback.
+     */
+    std::function<void(T* const&)> recycler();
+
+    /**
+     * @brief Returns the number of objects the pool has allocated memory for.
+     * @return The number of objects.
+     */
+    std::size_t capacity() const;
+
+private:
+    /**
+     * @brief Storage of one object, linked into a free list while unused.
+     */
+    union Block
+    {
+        Block* next;                                 ///< Next free block.
+        alignas(T) unsigned char storage[sizeof(T)]; ///< Object storage.
+    };
+
+    /**
+     * @brief Singly linked list of free blocks.
+     */
+    struct FreeList
+    {
+        Block* head{nullptr}; ///< First free block.
+        std::size_t count{0}; ///< Number of free blocks.
+
+        void push(Block* block)
+        {
+            block->next = head;
+            head = block;
+            ++count;
+        }
+
+        Block* pop()
+        {
+            Block* block{head};
+            head = block->next;
+            --count;
+            return block;
+        }
+    };
+
+    /**
+     * @brief Tells the thread caches outliving the pool that it is gone.
+     */
+    struct Anchor
+    {
+        std::mutex lock{};         ///< Held while a cache is handed back, and while the pool detaches.
+        ObjectPool* pool{nullptr}; ///< The pool, `nullptr` once destroyed.
+    };
+
+    /**
+     * @brief Cache of the calling thread in one pool.
+     */
+    struct CacheEntry
+    {
+        uint64_t pool_id{0};              ///< Identifier of the pool.
+        FreeList* cache{nullptr};         ///< Cache owned by the pool.
+        std::shared_ptr<Anchor> anchor{}; ///< Anchor of the pool.
+    };
+
+    /**
+     * @brief Caches of the calling thread, handed back to their pools when the thread exits.
+     */
+    struct ThreadCaches
+    {
+        std::vector<CacheEntry> entries{}; ///< At most `MAX_THREAD_POOLS` caches.
+
+        ~ThreadCaches()
+        {
+            for (CacheEntry& entry : entries)
+            {
+                forget(entry);
+            }
+        }
+    };
+
+    static constexpr std::size_t MAX_THREAD_POOLS{8}; ///< Caches remembered per thread and type.
+
+    const Settings m_settings;                         ///< Pool settings.
+    const uint64_t m_id;                               ///< Identifier matched by the thread caches.
+    const std::shared_ptr<Anchor> m_anchor;            ///< Shared with the thread caches.
+    mutable std::mutex m_lock{};                       ///< Guards the depot, chunks and caches.
+    std::vector<FreeList> m_depot{};                   ///< Batches of free blocks returned by threads.
+    std::vector<Block*> m_chunks{};                    ///< Allocated chunks.
+    std::vector<std::unique_ptr<FreeList>> m_caches{}; ///< Caches of the threads using the pool.
+    std::vector<FreeList*> m_orphans{};                ///< Empty caches forgotten by their threads.
+    std::atomic<std::size_t> m_capacity{0};            ///< Number of allocated blocks.
+
+    FreeList& localCache();                ///< Cache of the calling thread, registered on first use.
+    void refill(FreeList& cache);          ///< Move a batch or a new chunk into an empty cache.
+    void release(FreeList& cache);         ///< Move a batch from a full cache to the depot.
+    void orphan(FreeList& cache);          ///< Move the blocks of a forgotten cache to the depot.
+    static void forget(CacheEntry& entry); ///< Hand a cache back to its pool, if it still exists.
+};
+
+/**
+ * @brief Recycler of raw memory blocks grouped by power-of-two size classes.
+ *
+ * Deallocated blocks are kept in per-class free lists and handed out again for requests of the same
+ * class. Requests above `MAX_BLOCK_SIZE` or with extended alignment go to the global allocator.
+ */
+class BlockPool
+{
+public:
+    static constexpr std::size_t MAX_BLOCK_SIZE{64 * 1024}; ///< Largest recycled block.
+
+    BlockPool() = default;
+
+    /**
+     * @brief Destructor that releases the free blocks. Every block must have been deallocated.
+     */
+    ~BlockPool();
+
+    // Make this class uncopyable
+    UNCOPYABLE(BlockPool);
+
+    /**
+     * @brief Allocate a block.
+     * @param bytes The size of the block.
+     * @param alignment The alignment of the block.
+     * @return The block. Throws `std::bad_alloc` on failure, like `operator new`.
+     */
+    void* allocate(const std::size_t bytes, const std::size_t alignment);
+
+    /**
+     * @brief Keep a block for reuse.
+     * @param ptr The block returned by `allocate`.
+     * @param bytes The size passed to `allocate`.
+     * @param alignment The alignment passed to `allocate`.
+     */
+    void deallocate(void* ptr, const std::size_t bytes, const std::size_t alignment);
+
+private:
+    static constexpr std::size_t MIN_BLOCK_SIZE{16};
+    static constexpr std::size_t CLASSES{13}; ///< From `MIN_BLOCK_SIZE` to `MAX_BLOCK_SIZE`.
+
+    /**
+     * @brief Free block, linked through its own storage.
+     */
+    struct FreeBlock
+    {
+        FreeBlock* next; ///< Next free block of the same class.
+    };
+
+    std::mutex m_lock{};          ///< Guards the free lists.
+    FreeBlock* m_free[CLASSES]{}; ///< Free blocks of each size class.
+
+    static bool pooled(const std::size_t bytes, const std::size_t alignment); ///< Whether a request is recycled.
+    static std::size_t sizeClass(const std::size_t bytes);                    ///< Class of a request.
+};
+
+/**
+ * @brief Standard allocator backed by a shared `BlockPool`, e.g. for the chunks of `Queue`.
+ *
+ * Copies share the same pool, which lives as long as any of them.
+ *
+ * @tparam T Type of the allocated elements.
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    /**
+     * @brief Constructor that creates a new pool.
+     */
+    PoolAllocator()
+        : m_pool{std::make_shared<BlockPool>()}
+    {
+    }
+
+    /**
+     * @brief Constructor that shares an existing pool.
+     * @param pool The pool to allocate from.
+     */
+    explicit PoolAllocator(std::shared_ptr<BlockPool> pool)
+        : m_pool{std::move(pool)}
+    {
+    }
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other)
+        : m_pool{other.pool()}
+    {
+    }
+
+    T* allocate(const std::size_t count)
+    {
+        return static_cast<T*>(m_pool->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, const std::size_t count)
+    {
+        m_pool->deallocate(ptr, count * sizeof(T), alignof(T));
+    }
+
+    /**
+     * @brief Returns the shared pool.
+     * @return The pool.
+     */
+    const std::shared_ptr<BlockPool>& pool() const
+    {
+        return m_pool;
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>& other) const
+    {
+        return m_pool == other.pool();
+    }
+
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>& other) const
+    {
+        return m_pool != other.pool();
+    }
+
+private:
+    std::shared_ptr<BlockPool> m_pool; ///< Shared pool.
+};
+
+template<typename T>
+ObjectPool<T>::ObjectPool(const Settings& settings)
+    : m_settings{std::max<std::size_t>(settings.chunk_size, 1), std::max<std::size_t>(settings.batch_size, 1)}
+    , m_id{detail::nextObjectPoolId()}
+    , m_anchor{std::make_shared<Anchor>()}
+{
+    m_anchor->pool = this;
+}
+
+template<typename T>
+ObjectPool<T>::~ObjectPool()
+{
+    {
+        // Waits for a thread handing a cache back.
+        std::lock_guard<std::mutex> guard{m_anchor->lock};
+        m_anchor->pool = nullptr;
+    }
+    for (Block* chunk : m_chunks)
+    {
+        ::operator delete(chunk, std::align_val_t{alignof(Block)});
+    }
+}
+
+template<typename T>
+template<typename... Args>
+T* ObjectPool<T>::create(Args&&... args)
+{
+    FreeList& cache{localCache()};
+    if (cache.head == nullptr)
+    {
+        refill(cache);
+    }
+    Block* block{cache.pop()};
+    return new (block->storage) T(std::forward<Args>(args)...);
+}
+
+template<typename T>
+void ObjectPool<T>::destroy(T* object)
+{
+    if (object == nullptr)
+    {
+        return;
+    }
+    object->~T();
+    FreeList& cache{localCache()};
+    cache.push(reinterpret_cast<Block*>(object));
+    if (cache.count >= 2 * m_settings.batch_size)
+    {
+        release(cache);
+    }
+}
+
+template<typename T>
+template<typename... Args>
+typename ObjectPool<T>::Pointer ObjectPool<T>::make(Args&&... args)
+{
+    return Pointer{create(std::forward<Args>(args)...), Deleter{this}};
+}
+
+template<typename T>
+std::function<void(T* const&)> ObjectPool<T>::recycler()
+{
+    return [this](T* const& object)
+    { destroy(object); };
+}
+
+template<typename T>
+std::size_t ObjectPool<T>::capacity() const
+{
+    return m_capacity.load(std::memory_order_relaxed);
+}
+
+template<typename T>
+typename ObjectPool<T>::FreeList& ObjectPool<T>::localCache()
+{
+    // Pools are matched by identifier rather than address, a destroyed pool is never matched again.
+    thread_local ThreadCaches caches{};
+    std::vector<CacheEntry>& entries{caches.entries};
+    for (const CacheEntry& entry : entries)
+    {
+        if (entry.pool_id == m_id)
+        {
+            return *entry.cache;
+        }
+    }
+
+    if (entries.size() == MAX_THREAD_POOLS)
+    {
+        forget(entries.front());
+        entries.erase(entries.begin());
+    }
+    FreeList* cache{nullptr};
+    {
+        std::lock_guard<std::mutex> guard{m_lock};
+        if (!m_orphans.empty())
+        {
+            cache = m_orphans.back();
+            m_orphans.pop_back();
+        }
+        else
+        {
+            m_caches.push_back(std::make_unique<FreeList>());
+            cache = m_caches.back().get();
+        }
+    }
+    entries.push_back(CacheEntry{m_id, cache, m_anchor});
+    return *cache;
+}
+
+template<typename T>
+void ObjectPool<T>::forget(CacheEntry& entry)
+{
+    std::lock_guard<std::mutex> guard{entry.anchor->lock};
+    if (entry.anchor->pool != nullptr)
+    {
+        entry.anchor->pool->orphan(*entry.cache);
+    }
+}
+
+template<typename T>
+void ObjectPool<T>::orphan(FreeList& cache)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+    if (cache.count > 0)
+    {
+        m_depot.push_back(cache);
+        cache = FreeList{};
+    }
+    m_orphans.push_back(&cache);
+}
+
+template<typename T>
+void ObjectPool<T>::refill(FreeList& cache)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+    if (!m_depot.empty())
+    {
+        cache = m_depot.back();
+        m_depot.pop_back();
+        return;
+    }
+    Block* chunk{static_cast<Block*>(::operator new(m_settings.chunk_size * sizeof(Block), std::align_val_t{alignof(Block)}))};
+    m_chunks.push_back(chunk);
+    for (std::size_t index = m_settings.chunk_size; index > 0; --index)
+    {
+        cache.push(chunk + index - 1);
+    }
+    const std::size_t capacity{m_capacity.fetch_add(m_settings.chunk_size, std::memory_order_relaxed) + m_settings.chunk_size};
+    // The depot can never hold more batches than there are blocks, grow it now rather than in release().
+    m_depot.reserve(capacity / m_settings.batch_size + 1);
+}
+
+template<typename T>
+void ObjectPool<T>::release(FreeList& cache)
+{
+    // Keep the block freed last, it is the most likely to still be in the cache of this CPU.
+    Block* hot{cache.pop()};
+    FreeList batch{};
+    while (batch.count < m_settings.batch_size)
+    {
+        batch.push(cache.pop());
+    }
+    cache.push(hot);
+    std::lock_guard<std::mutex> guard{m_lock};
+    m_depot.push_back(batch);
+}
+
+} // namespace threadsafe
+} // namespace trlc
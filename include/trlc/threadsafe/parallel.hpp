@@ -0,0 +1,380 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/thread_pool.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+inline constexpr std::size_t AUTO_GRAIN{0}; ///< Grain size chosen from the range length and the pool size.
+
+namespace detail
+{
+
+inline constexpr std::size_t CHUNKS_PER_THREAD{8}; ///< Chunks per thread of an automatic grain, to absorb imbalance.
+inline constexpr std::size_t MIN_SORT_GRAIN{2048}; ///< Smallest range a parallel sort hands out as a task.
+
+/**
+ * @brief A set of tasks run by a pool, whose owner waits for all of them while running queued tasks itself.
+ *
+ * Tasks may add tasks to the group they run in. The owner must call `wait` before the group goes away. The
+ * first exception thrown by a task is kept and rethrown by `wait` once every task has finished.
+ */
+class TaskGroup
+{
+public:
+    /**
+     * @brief Constructor for a group running its tasks on a pool.
+     * @param pool The pool running the tasks.
+     */
+    explicit TaskGroup(ThreadPool& pool);
+
+    /**
+     * @brief Destructor that waits for the remaining tasks, dropping their exception.
+     */
+    ~TaskGroup();
+
+    // Make this class uncopyable
+    UNCOPYABLE(TaskGroup);
+
+    /**
+     * @brief Queue a task on the pool, or run it right away if the pool is stopping.
+     *
+     * @tparam Func The type of the task, called without arguments.
+     * @param func The task to run.
+     */
+    template<typename Func>
+    void run(Func func);
+
+    /**
+     * @brief Run a task of the group on the calling thread, its exception kept like the one of a queued task.
+     *
+     * @tparam Func The type of the task, called without arguments.
+     * @param func The task to run.
+     */
+    template<typename Func>
+    void call(Func func);
+
+    /**
+     * @brief Block until every task of the group has finished, running queued tasks of the pool meanwhile.
+     *
+     * The first exception thrown by a task is rethrown once every task has finished.
+     */
+    void wait();
+
+private:
+    /**
+     * @brief Completion state, shared with the queued tasks so that the last one can notify after `wait` returned.
+     */
+    struct State
+    {
+        std::atomic<std::size_t> pending{0}; ///< Tasks queued and not yet finished.
+        Wait done{};                         ///< Wait channel for the owner.
+        std::mutex error_lock{};             ///< Mutex protecting the exception.
+        std::exception_ptr error{};          ///< First exception thrown by a task.
+
+        void fail(std::exception_ptr exception); ///< Keep the exception of a task if it is the first one.
+        void finish();                           ///< Count a finished task, notify the owner after the last one.
+    };
+
+    template<typename Func>
+    static void execute(State& state, Func& func); ///< Run a task, keep its exception and count it as finished.
+    void join();                                   ///< Block until every task of the group has finished.
+
+    static constexpr std::chrono::milliseconds HELP_INTERVAL{1}; ///< Longest block before looking for tasks again.
+
+    ThreadPool& m_pool;                                        ///< Pool running the tasks.
+    std::shared_ptr<State> m_state{std::make_shared<State>()}; ///< Completion state.
+};
+
+template<typename Func>
+void TaskGroup::run(Func func)
+{
+    m_state->pending.fetch_add(1, std::memory_order_relaxed);
+    if (!m_pool.post([state = m_state, func]() mutable
+                     { execute(*state, func); }))
+    {
+        execute(*m_state, func);
+    }
+}
+
+template<typename Func>
+void TaskGroup::call(Func func)
+{
+    m_state->pending.fetch_add(1, std::memory_order_relaxed);
+    execute(*m_state, func);
+}
+
+template<typename Func>
+void TaskGroup::execute(State& state, Func& func)
+{
+    try
+    {
+        func();
+    }
+    catch (...)
+    {
+        state.fail(std::current_exception());
+    }
+    state.finish();
+}
+
+/**
+ * @brief Returns the grain size to use for a range.
+ * @param pool The pool running the chunks.
+ * @param count The length of the range.
+ * @param grain The requested grain size, or `AUTO_GRAIN` for about `CHUNKS_PER_THREAD` chunks per thread.
+ * @return The grain size, at least 1.
+ */
+std::size_t grainSize(const ThreadPool& pool, const std::size_t count, const std::size_t grain);
+
+/**
+ * @brief Run `func(begin, end)` on `[begin, end)`, after queueing its upper halves for as long as it exceeds `grain`.
+ *
+ * The queued halves split themselves again wherever they run, so idle workers steal the largest pieces first.
+ */
+template<typename Func>
+void splitRange(TaskGroup& group, std::size_t begin, std::size_t end, const std::size_t grain, Func& func)
+{
+    while (end - begin > grain)
+    {
+        const std::size_t middle{begin + (end - begin) / 2};
+        group.run([&group, middle, end, grain, &func]()
+                  { splitRange(group, middle, end, grain, func); });
+        end = middle;
+    }
+    func(begin, end);
+}
+
+/**
+ * @brief Run `func(begin, end)` on chunks of `[0, count)` of at most `grain` elements, on the pool and the caller.
+ */
+template<typename Func>
+void parallelRanges(ThreadPool& pool, const std::size_t count, const std::size_t grain, Func func)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    const std::size_t chunk{grainSize(pool, count, grain)};
+    if (count <= chunk)
+    {
+        func(std::size_t{0}, count);
+        return;
+    }
+    TaskGroup group(pool);
+    group.call([&group, count, chunk, &func]()
+               { splitRange(group, 0, count, chunk, func); });
+    group.wait();
+}
+
+/**
+ * @brief Returns the median of the first, middle and last elements of a range of at least three elements.
+ */
+template<typename RandomIt, typename Compare>
+RandomIt medianOfThree(const RandomIt first, const RandomIt last, Compare& comp)
+{
+    RandomIt a{first};
+    RandomIt b{first + (last - first) / 2};
+    RandomIt c{last - 1};
+    if (comp(*b, *a))
+    {
+        std::swap(a, b);
+    }
+    if (comp(*c, *b))
+    {
+        b = comp(*c, *a) ? a : c;
+    }
+    return b;
+}
+
+/**
+ * @brief Quicksort queueing the upper part of each partition, down to `grain` elements or `depth` partitions.
+ *
+ * Each partition is three-way, so that runs of equal elements are done at once. Below the grain size, or once
+ * the depth budget is spent on unlucky pivots, the range is left to `std::sort`.
+ */
+template<typename RandomIt, typename Compare>
+void quickSort(TaskGroup& group, RandomIt first, RandomIt last, Compare& comp, const std::size_t grain, std::size_t depth)
+{
+    using std::swap;
+    while (static_cast<std::size_t>(last - first) > grain && depth > 0)
+    {
+        --depth;
+        swap(*first, *medianOfThree(first, last, comp));
+        // The pivot stays at `first` while the rest is partitioned, then moves between the two parts.
+        const RandomIt lower{std::partition(first + 1, last, [&first, &comp](const auto& elem)
+                                            { return comp(elem, *first); })};
+        const RandomIt pivot{lower - 1};
+        swap(*first, *pivot);
+        const RandomIt upper{std::partition(lower, last, [&pivot, &comp](const auto& elem)
+                                            { return !comp(*pivot, elem); })};
+        group.run([&group, upper, last, &comp, grain, depth]()
+                  { quickSort(group, upper, last, comp, grain, depth); });
+        last = pivot;
+    }
+    std::sort(first, last, comp);
+}
+
+} // namespace detail
+
+/**
+ * @brief Call `func(i)` for every index of `[first, last)`, on the workers of a pool and the calling thread.
+ *
+ * The range is split in halves down to the grain size. The upper halves are queued on the pool, where idle
+ * workers steal them, the caller runs the lowest chunk and then runs queued tasks until every chunk is done,
+ * so that it never sits idle and a call from inside a task of the same pool cannot deadlock. `func` is called
+ * concurrently, the first exception it throws is rethrown once every chunk is done.
+ *
+ * @tparam Index An integral index type.
+ * @tparam Func The type of the function, called with an `Index`.
+ * @param pool The pool running the chunks.
+ * @param first The first index.
+ * @param last One past the last index.
+ * @param func The function to call for each index.
+ * @param grain The largest number of indices run as a single task, or `AUTO_GRAIN`.
+ */
+template<typename Index, typename Func>
+void parallelFor(ThreadPool& pool, const Index first, const Index last, Func func, const std::size_t grain = AUTO_GRAIN)
+{
+    static_assert(std::is_integral_v<Index>, "parallelFor iterates over an integral index range");
+    if (!(first < last))
+    {
+        return;
+    }
+    const std::size_t count{static_cast<std::size_t>(last - first)};
+    detail::parallelRanges(pool, count, grain, [first, &func](const std::size_t begin, const std::size_t end)
+                           {
+        for (std::size_t offset = begin; offset < end; ++offset)
+        {
+            func(static_cast<Index>(first + static_cast<Index>(offset)));
+        } });
+}
+
+/**
+ * @brief Reduce a range with an associative operation, on the workers of a pool and the calling thread.
+ *
+ * The range is cut into chunks of the grain size, each chunk is reduced from its first element, and the partial
+ * results are folded into `init` in order, so `reduce` needs not be commutative. With a fixed grain size, the
+ * grouping, and so the rounding of a floating point reduction, does not depend on the scheduling.
+ *
+ * @tparam RandomIt A random-access iterator.
+ * @tparam T The type of the result, constructible from an element.
+ * @tparam Reduce The type of the operation, called as `reduce(T, element)` and `reduce(T, T)`.
+ * @param pool The pool running the chunks.
+ * @param first The beginning of the range.
+ * @param last The end of the range.
+ * @param init The initial value, folded in once.
+ * @param reduce The associative operation.
+ * @param grain The largest number of elements reduced as a single task, or `AUTO_GRAIN`.
+ * @return The reduction of `init` and every element.
+ */
+template<typename RandomIt, typename T, typename Reduce>
+T parallelReduce(ThreadPool& pool, const RandomIt first, const RandomIt last, T init, Reduce reduce, const std::size_t grain = AUTO_GRAIN)
+{
+    const std::size_t count{static_cast<std::size_t>(std::distance(first, last))};
+    if (count == 0)
+    {
+        return init;
+    }
+    const std::size_t chunk{detail::grainSize(pool, count, grain)};
+    std::vector<std::optional<T>> partials((count + chunk - 1) / chunk);
+    detail::parallelRanges(pool, partials.size(), 1, [first, count, chunk, &partials, &reduce](const std::size_t begin, const std::size_t end)
+                           {
+        for (std::size_t index = begin; index < end; ++index)
+        {
+            RandomIt it{first + static_cast<std::ptrdiff_t>(index * chunk)};
+            const RandomIt chunk_end{first + static_cast<std::ptrdiff_t>(std::min(count, (index + 1) * chunk))};
+            T partial(*it);
+            for (++it; it != chunk_end; ++it)
+            {
+                partial = reduce(std::move(partial), *it);
+            }
+            partials[index].emplace(std::move(partial));
+        } });
+    for (std::optional<T>& partial : partials)
+    {
+        init = reduce(std::move(init), std::move(*partial));
+    }
+    return init;
+}
+
+/**
+ * @brief Apply an operation to every element of a range and store the results, on the workers of a pool and the calling thread.
+ *
+ * @tparam RandomIt A random-access input iterator.
+ * @tparam OutputIt A random-access output iterator.
+ * @tparam UnaryOp The type of the operation, called with an element.
+ * @param pool The pool running the chunks.
+ * @param first The beginning of the input range.
+ * @param last The end of the input range.
+ * @param out The beginning of the output range, which may be `first`.
+ * @param op The operation, called concurrently.
+ * @param grain The largest number of elements transformed as a single task, or `AUTO_GRAIN`.
+ * @return The end of the output range.
+ */
+template<typename RandomIt, typename OutputIt, typename UnaryOp>
+OutputIt parallelTransform(ThreadPool& pool, const RandomIt first, const RandomIt last, const OutputIt out, UnaryOp op, const std::size_t grain = AUTO_GRAIN)
+{
+    const std::size_t count{static_cast<std::size_t>(std::distance(first, last))};
+    detail::parallelRanges(pool, count, grain, [first, out, &op](const std::size_t begin, const std::size_t end)
+                           { std::transform(first + static_cast<std::ptrdiff_t>(begin), first + static_cast<std::ptrdiff_t>(end),
+                                            out + static_cast<std::ptrdiff_t>(begin), op); });
+    return out + static_cast<std::ptrdiff_t>(count);
+}
+
+/**
+ * @brief Sort a range, on the workers of a pool and the calling thread.
+ *
+ * A quicksort whose partitions are queued on the pool as they are made, ending in `std::sort` below the grain
+ * size. Like `std::sort`, it is not stable and its worst case stays `O(n log n)`.
+ *
+ * @tparam RandomIt A random-access iterator.
+ * @tparam Compare The type of the strict weak ordering.
+ * @param pool The pool running the partitions.
+ * @param first The beginning of the range.
+ * @param last The end of the range.
+ * @param comp The ordering, called concurrently.
+ * @param grain The largest number of elements sorted as a single task, or `AUTO_GRAIN`.
+ */
+template<typename RandomIt, typename Compare = std::less<>>
+void parallelSort(ThreadPool& pool, const RandomIt first, const RandomIt last, Compare comp = Compare{}, const std::size_t grain = AUTO_GRAIN)
+{
+    const std::size_t count{static_cast<std::size_t>(std::distance(first, last))};
+    const std::size_t chunk{grain == AUTO_GRAIN ? std::max(detail::grainSize(pool, count, grain), detail::MIN_SORT_GRAIN)
+                                                : std::max<std::size_t>(grain, 2)};
+    if (count <= chunk)
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+    std::size_t depth{0};
+    for (std::size_t length = count; length > 1; length /= 2)
+    {
+        depth += 2;
+    }
+    detail::TaskGroup group(pool);
+    group.call([&group, first, last, &comp, chunk, depth]()
+               { detail::quickSort(group, first, last, comp, chunk, depth); });
+    group.wait();
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,629 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/mpmc_queue.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/spsc_queue.hpp"
+#include "trlc/threadsafe/thread.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Settings for a pipeline, such as the queue capacity between stages and the workers' priority.
+ */
+struct PipelineSettings
+{
+    std::size_t capacity{64};                        ///< Batches buffered in front of each stage, rounded up to a power of two.
+    ThreadPriority priority{ThreadPriority::NORMAL}; ///< Priority of every worker.
+    std::string name{"pipeline"};                    ///< Prefix of the worker names.
+};
+
+/**
+ * @brief Metrics of one pipeline stage, to tell the bottleneck and rebalance the parallelism.
+ *
+ * A stage with a high utilization and a full input queue needs more workers, a stage with an empty input
+ * queue and a low utilization can give some away.
+ */
+struct PipelineStageStats
+{
+    std::string name{};           ///< Name of the stage.
+    std::size_t parallelism{0};   ///< Number of workers.
+    uint64_t items{0};            ///< Elements processed.
+    uint64_t batches{0};          ///< Batches processed.
+    double items_per_second{0.0}; ///< Average throughput since the start, until the stage finished.
+    double utilization{0.0};      ///< Share of the worker time spent in the stage function, from 0 to 1.
+    std::size_t queued{0};        ///< Batches waiting in the input queue, or blocked pushing into it.
+    std::size_t max_queued{0};    ///< Highest number of batches seen waiting in the input queue.
+    std::size_t capacity{0};      ///< Capacity of the input queue, in batches.
+    bool spsc{false};             ///< Whether the input queue is a `SpscQueue`, else a `MpmcQueue`.
+};
+
+namespace detail
+{
+
+/**
+ * @brief Queue of batches in front of a stage, with the end-of-stream bookkeeping of its producers.
+ *
+ * The pop side is closed once every producer is done and every batch was popped, so that idle consumers
+ * wake up and exit. A single producer and a single consumer share a `SpscQueue`, anything else a
+ * `MpmcQueue`.
+ */
+template<typename T>
+class PipelineEdge
+{
+public:
+    using Batch = std::vector<T>;
+    using Settings = typename Queue<Batch>::Settings;
+
+    PipelineEdge(const std::size_t capacity, const std::size_t producers, const bool single)
+        : m_producers{producers}
+    {
+        Settings settings;
+        settings.size = capacity;
+        settings.discard = Queue<Batch>::Discard::NO_DISCARD;
+        settings.control = Queue<Batch>::Control::FULL_CONTROL;
+        if (single)
+        {
+            m_spsc = std::make_unique<SpscQueue<Batch>>(settings);
+        }
+        else
+        {
+            m_mpmc = std::make_unique<MpmcQueue<Batch>>(settings);
+        }
+    }
+
+    // Make this class uncopyable
+    UNCOPYABLE(PipelineEdge);
+
+    void open()
+    {
+        m_spsc ? m_spsc->openPush() : m_mpmc->openPush();
+        m_spsc ? m_spsc->openPop() : m_mpmc->openPop();
+    }
+
+    void close()
+    {
+        m_spsc ? m_spsc->closePush() : m_mpmc->closePush();
+        m_spsc ? m_spsc->closePop() : m_mpmc->closePop();
+    }
+
+    bool push(Batch&& batch)
+    {
+        // Counted before the push, so that a consumer never sees the count drop to zero while it is queued.
+        const std::size_t queued{m_queued.fetch_add(1, std::memory_order_seq_cst) + 1};
+        std::size_t max_queued{m_max_queued.load(std::memory_order_relaxed)};
+        while (queued > max_queued && !m_max_queued.compare_exchange_weak(max_queued, queued, std::memory_order_relaxed))
+        {
+        }
+        if (!(m_spsc ? m_spsc->push(std::move(batch)) : m_mpmc->push(std::move(batch))))
+        {
+            m_queued.fetch_sub(1, std::memory_order_seq_cst);
+            return false;
+        }
+        return true;
+    }
+
+    bool pop(Batch& batch)
+    {
+        if (!(m_spsc ? m_spsc->pop(batch) : m_mpmc->pop(batch)))
+        {
+            return false;
+        }
+        if (m_queued.fetch_sub(1, std::memory_order_seq_cst) == 1 && m_producers.load(std::memory_order_seq_cst) == 0)
+        {
+            m_spsc ? m_spsc->closePop() : m_mpmc->closePop();
+        }
+        return true;
+    }
+
+    void producerDone()
+    {
+        if (m_producers.fetch_sub(1, std::memory_order_seq_cst) != 1)
+        {
+            return;
+        }
+        m_spsc ? m_spsc->closePush() : m_mpmc->closePush();
+        if (m_queued.load(std::memory_order_seq_cst) == 0)
+        {
+            m_spsc ? m_spsc->closePop() : m_mpmc->closePop();
+        }
+    }
+
+    std::size_t queued() const
+    {
+        return m_queued.load(std::memory_order_relaxed);
+    }
+
+    std::size_t maxQueued() const
+    {
+        return m_max_queued.load(std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() const
+    {
+        return m_spsc ? m_spsc->capacity() : m_mpmc->capacity();
+    }
+
+    bool spsc() const
+    {
+        return m_spsc != nullptr;
+    }
+
+private:
+    std::unique_ptr<SpscQueue<Batch>> m_spsc{}; ///< Queue of a one-to-one link.
+    std::unique_ptr<MpmcQueue<Batch>> m_mpmc{}; ///< Queue of any other link.
+    std::atomic<std::size_t> m_producers;       ///< Producers not done yet.
+    std::atomic<std::size_t> m_queued{0};       ///< Batches pushed and not yet popped.
+    std::atomic<std::size_t> m_max_queued{0};   ///< High-water mark of `m_queued`.
+};
+
+/**
+ * @brief Type-erased stage, owned by the graph of its pipeline.
+ */
+class PipelineStage
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~PipelineStage() = default;
+    virtual void open() = 0;                                                   ///< Open the input queue.
+    virtual void run() = 0;                                                    ///< Start the workers.
+    virtual void abort() = 0;                                                  ///< Close the input queue on both sides.
+    virtual void join() = 0;                                                   ///< Wait for the workers to exit.
+    virtual PipelineStageStats stats(const Clock::time_point start) const = 0; ///< Metrics since `start`.
+};
+
+/**
+ * @brief Stage running `F` on every element of its input batches, `R` is `void` for a sink.
+ */
+template<typename T, typename R, typename F>
+class PipelineStageImpl final : public PipelineStage
+{
+public:
+    using Output = std::conditional_t<std::is_void_v<R>, T, R>;
+
+    PipelineStageImpl(const PipelineSettings& settings, const std::string& name, const std::size_t parallelism,
+                      const std::size_t producers, const bool single_producer, F&& func)
+        : m_name{name}
+        , m_input{settings.capacity, producers, single_producer && parallelism == 1}
+        , m_running{parallelism}
+    {
+        for (std::size_t index = 0; index < parallelism; ++index)
+        {
+            auto worker{std::make_unique<Thread>(settings.name + "_" + name + "_" + std::to_string(index), settings.priority)};
+            // Each worker calls its own copy of the function, so that stateful functions need no lock.
+            worker->invoke([this, func]() mutable
+                           { work(func); });
+            m_workers.push_back(std::move(worker));
+        }
+    }
+
+    PipelineEdge<T>& input()
+    {
+        return m_input;
+    }
+
+    PipelineEdge<Output>** output()
+    {
+        return &m_output;
+    }
+
+    void open() override
+    {
+        m_input.open();
+    }
+
+    void run() override
+    {
+        for (auto& worker : m_workers)
+        {
+            worker->run(Thread::RunMode::ONCE);
+        }
+    }
+
+    void abort() override
+    {
+        m_input.close();
+    }
+
+    void join() override
+    {
+        for (auto& worker : m_workers)
+        {
+            worker->stop();
+        }
+    }
+
+    PipelineStageStats stats(const Clock::time_point start) const override
+    {
+        PipelineStageStats stats{};
+        stats.name = m_name;
+        stats.parallelism = m_workers.size();
+        stats.items = m_items.load(std::memory_order_relaxed);
+        stats.batches = m_batches.load(std::memory_order_relaxed);
+        stats.queued = m_input.queued();
+        stats.max_queued = m_input.maxQueued();
+        stats.capacity = m_input.capacity();
+        stats.spsc = m_input.spsc();
+        const Clock::time_point end{m_running.load(std::memory_order_acquire) == 0
+                                        ? Clock::time_point{Clock::duration{m_finished.load(std::memory_order_relaxed)}}
+                                        : Clock::now()};
+        const double elapsed_ns{static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())};
+        if (elapsed_ns > 0.0)
+        {
+            stats.items_per_second = static_cast<double>(stats.items) * 1e9 / elapsed_ns;
+            stats.utilization = std::min(1.0, static_cast<double>(m_busy_ns.load(std::memory_order_relaxed))
+                                                  / (elapsed_ns * static_cast<double>(stats.parallelism)));
+        }
+        return stats;
+    }
+
+private:
+    const std::string m_name;                         ///< Name of the stage.
+    PipelineEdge<T> m_input;                          ///< Queue in front of the stage.
+    PipelineEdge<Output>* m_output{nullptr};          ///< Queue of the next stage, unused by a sink.
+    std::vector<std::unique_ptr<Thread>> m_workers{}; ///< Workers of the stage.
+    std::atomic<uint64_t> m_items{0};                 ///< Elements processed.
+    std::atomic<uint64_t> m_batches{0};               ///< Batches processed.
+    std::atomic<uint64_t> m_busy_ns{0};               ///< Time spent in the function, all workers.
+    std::atomic<std::size_t> m_running;               ///< Workers not exited yet.
+    std::atomic<Clock::duration::rep> m_finished{0};  ///< Exit time of the last worker, since the clock epoch.
+
+    void work(F& func)
+    {
+        std::vector<T> batch{};
+        while (m_input.pop(batch))
+        {
+            const Clock::time_point start{Clock::now()};
+            if constexpr (std::is_void_v<R>)
+            {
+                for (T& elem : batch)
+                {
+                    func(std::move(elem));
+                }
+            }
+            else
+            {
+                std::vector<R> out{};
+                out.reserve(batch.size());
+                for (T& elem : batch)
+                {
+                    out.push_back(func(std::move(elem)));
+                }
+                // Blocks while the next stage is behind, a failure means the pipeline is being stopped.
+                m_output->push(std::move(out));
+            }
+            m_busy_ns.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()),
+                                std::memory_order_relaxed);
+            m_items.fetch_add(batch.size(), std::memory_order_relaxed);
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            batch.clear();
+        }
+        if constexpr (!std::is_void_v<R>)
+        {
+            m_output->producerDone();
+        }
+        m_finished.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        m_running.fetch_sub(1, std::memory_order_release);
+    }
+};
+
+/**
+ * @brief Stages of a pipeline, in declaration order, and their lifecycle.
+ */
+class PipelineGraph
+{
+public:
+    explicit PipelineGraph(const PipelineSettings& settings);
+
+    // Make this class uncopyable
+    UNCOPYABLE(PipelineGraph);
+
+    const PipelineSettings& settings() const;
+    bool declaring() const;                                          ///< Whether stages can still be added.
+    void add(std::unique_ptr<PipelineStage> stage, const bool sink); ///< Append a stage, a sink ends the graph.
+    bool start();                                                    ///< Open every queue, then start the workers.
+    void abort();                                                    ///< Close every queue.
+    void join();                                                     ///< Wait for every worker to exit.
+    std::vector<PipelineStageStats> stats() const;                   ///< Metrics of every stage.
+
+private:
+    const PipelineSettings m_settings;                      ///< Pipeline settings.
+    std::vector<std::unique_ptr<PipelineStage>> m_stages{}; ///< Stages in declaration order.
+    bool m_complete{false};                                 ///< Whether a sink ends the graph.
+    bool m_started{false};                                  ///< Whether the workers were started.
+    std::chrono::steady_clock::time_point m_start{};        ///< Start time of the workers.
+};
+
+} // namespace detail
+
+/**
+ * @brief Unconnected output of a pipeline stage, of element type `T`, to declare the next stage on.
+ *
+ * A link connects once: declaring a second stage on it, or declaring on a started pipeline, gives an
+ * invalid link, and a sink declared on it reports `false`.
+ */
+template<typename T>
+class PipelineLink
+{
+public:
+    /**
+     * @brief Declare the next stage, mapping every element to a new one.
+     * @tparam F Type of the function, callable with a `T&&`.
+     * @param name The name of the stage, in its worker names and stats.
+     * @param parallelism The number of workers, at least one.
+     * @param func The function, copied for each worker.
+     * @return The output of the new stage.
+     */
+    template<typename F>
+    PipelineLink<std::decay_t<std::invoke_result_t<F&, T&&>>> stage(const std::string& name, const std::size_t parallelism, F func);
+
+    /**
+     * @brief Declare the last stage, consuming every element.
+     * @tparam F Type of the function, callable with a `T&&`.
+     * @param name The name of the stage, in its worker names and stats.
+     * @param parallelism The number of workers, at least one.
+     * @param func The function, copied for each worker.
+     * @return `true` if the sink was declared, `false` if the link is invalid.
+     */
+    template<typename F>
+    bool sink(const std::string& name, const std::size_t parallelism, F func);
+
+    /**
+     * @brief Check whether stages can be declared on this link.
+     * @return `true` if the link is unconnected and its pipeline is not started.
+     */
+    bool valid() const
+    {
+        return m_graph != nullptr && *m_output == nullptr && m_graph->declaring();
+    }
+
+private:
+    template<typename In>
+    friend class Pipeline;
+    template<typename U>
+    friend class PipelineLink;
+
+    PipelineLink() = default;
+
+    PipelineLink(detail::PipelineGraph* graph, detail::PipelineEdge<T>** output, const std::size_t producers, const bool single)
+        : m_graph{graph}
+        , m_output{output}
+        , m_producers{producers}
+        , m_single{single}
+    {
+    }
+
+    detail::PipelineGraph* m_graph{nullptr};     ///< Graph of the pipeline, `nullptr` for an invalid link.
+    detail::PipelineEdge<T>** m_output{nullptr}; ///< Output queue of the upstream stage, to wire.
+    std::size_t m_producers{0};                  ///< Workers of the upstream stage.
+    bool m_single{false};                        ///< Whether a single thread pushes into this link.
+};
+
+/**
+ * @brief A chain of stages, each run by its own `Thread` workers, passing batches through bounded queues.
+ *
+ * Stages are declared in order with `stage` and ended by a `sink`, each with a parallelism degree. Two
+ * stages of one worker each are linked by a `SpscQueue`, any other link by a `MpmcQueue`. The queues never
+ * discard, so a slow stage blocks the stages in front of it instead of letting its queue grow.
+ *
+ * After `start`, batches of `In` are fed with `push`. `close` ends the input: every stage drains its queue,
+ * closes the push side of the next one and its workers exit, so `wait` returns once everything was
+ * processed. `stop`, also run by the destructor, closes every queue at once and drops what is queued.
+ *
+ * @tparam In Type of the elements fed into the first stage.
+ */
+template<typename In>
+class Pipeline
+{
+public:
+    using Settings = PipelineSettings;
+    using Batch = std::vector<In>;
+
+    /**
+     * @brief Constructor that accepts the pipeline settings.
+     * @param settings Settings to configure the pipeline.
+     */
+    explicit Pipeline(const Settings& settings);
+
+    /**
+     * @brief Destructor that stops the pipeline.
+     */
+    ~Pipeline();
+
+    // Make this class uncopyable
+    UNCOPYABLE(Pipeline);
+
+    /**
+     * @brief Declare the first stage, see `PipelineLink::stage`.
+     */
+    template<typename F>
+    PipelineLink<std::decay_t<std::invoke_result_t<F&, In&&>>> stage(const std::string& name, const std::size_t parallelism, F func)
+    {
+        return head().stage(name, parallelism, std::move(func));
+    }
+
+    /**
+     * @brief Declare a single stage consuming the input, see `PipelineLink::sink`.
+     */
+    template<typename F>
+    bool sink(const std::string& name, const std::size_t parallelism, F func)
+    {
+        return head().sink(name, parallelism, std::move(func));
+    }
+
+    /**
+     * @brief Start the workers of every stage.
+     * @return `true` if started, `false` if already started or closed, or not ended by a sink.
+     */
+    bool start();
+
+    /**
+     * @brief Feed a batch into the first stage, blocking while its queue is full.
+     * @param batch The elements, an empty batch is ignored.
+     * @return `true` if the batch was queued, `false` if the pipeline is not running or the batch is empty.
+     */
+    bool push(Batch batch);
+
+    /**
+     * @brief Feed a single element, as a batch of one.
+     * @param elem The element.
+     * @return `true` if the element was queued, `false` if the pipeline is not running.
+     */
+    bool push(In elem);
+
+    /**
+     * @brief End the input, so that the stages exit once they processed everything.
+     */
+    void close();
+
+    /**
+     * @brief Block until the workers of every stage exited, after `close` or `stop`.
+     */
+    void wait();
+
+    /**
+     * @brief Close every queue, dropping the queued batches, and wait for the workers.
+     */
+    void stop();
+
+    /**
+     * @brief Returns the metrics of every stage, in declaration order.
+     * @return The stage metrics.
+     */
+    std::vector<PipelineStageStats> stats() const;
+
+private:
+    detail::PipelineGraph m_graph;             ///< Stages of the pipeline.
+    detail::PipelineEdge<In>* m_head{nullptr}; ///< Input queue of the first stage.
+    std::atomic<bool> m_closed{false};         ///< Flag set by the first `close`.
+
+    PipelineLink<In> head(); ///< Link of the pipeline input.
+};
+
+template<typename T>
+template<typename F>
+PipelineLink<std::decay_t<std::invoke_result_t<F&, T&&>>> PipelineLink<T>::stage(const std::string& name, const std::size_t parallelism, F func)
+{
+    using R = std::decay_t<std::invoke_result_t<F&, T&&>>;
+    static_assert(!std::is_void_v<R>, "A stage returns the element passed to the next stage, use sink for the last one");
+    if (!valid())
+    {
+        return PipelineLink<R>{};
+    }
+    const std::size_t workers{std::max<std::size_t>(parallelism, 1)};
+    auto impl{std::make_unique<detail::PipelineStageImpl<T, R, F>>(m_graph->settings(), name, workers, m_producers, m_single,
+                                                                    std::move(func))};
+    *m_output = &impl->input();
+    detail::PipelineEdge<R>** output{impl->output()};
+    m_graph->add(std::move(impl), false);
+    return PipelineLink<R>{m_graph, output, workers, workers == 1};
+}
+
+template<typename T>
+template<typename F>
+bool PipelineLink<T>::sink(const std::string& name, const std::size_t parallelism, F func)
+{
+    if (!valid())
+    {
+        return false;
+    }
+    const std::size_t workers{std::max<std::size_t>(parallelism, 1)};
+    auto impl{std::make_unique<detail::PipelineStageImpl<T, void, F>>(m_graph->settings(), name, workers, m_producers, m_single,
+                                                                       std::move(func))};
+    *m_output = &impl->input();
+    m_graph->add(std::move(impl), true);
+    return true;
+}
+
+template<typename In>
+Pipeline<In>::Pipeline(const Settings& settings)
+    : m_graph{settings}
+{
+}
+
+template<typename In>
+Pipeline<In>::~Pipeline()
+{
+    stop();
+}
+
+template<typename In>
+bool Pipeline<In>::start()
+{
+    if (m_closed.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return m_graph.start();
+}
+
+template<typename In>
+bool Pipeline<In>::push(Batch batch)
+{
+    if (batch.empty() || m_head == nullptr)
+    {
+        return false;
+    }
+    return m_head->push(std::move(batch));
+}
+
+template<typename In>
+bool Pipeline<In>::push(In elem)
+{
+    Batch batch{};
+    batch.push_back(std::move(elem));
+    return push(std::move(batch));
+}
+
+template<typename In>
+void Pipeline<In>::close()
+{
+    if (m_head != nullptr && !m_closed.exchange(true, std::memory_order_acq_rel))
+    {
+        m_head->producerDone();
+    }
+}
+
+template<typename In>
+void Pipeline<In>::wait()
+{
+    m_graph.join();
+}
+
+template<typename In>
+void Pipeline<In>::stop()
+{
+    m_graph.abort();
+    m_graph.join();
+}
+
+template<typename In>
+std::vector<PipelineStageStats> Pipeline<In>::stats() const
+{
+    return m_graph.stats();
+}
+
+template<typename In>
+PipelineLink<In> Pipeline<In>::head()
+{
+    // Fed by any number of threads, so the first queue is never single-producer.
+    return PipelineLink<In>{&m_graph, &m_head, 1, false};
+}
+
+} // namespace threadsafe
+} // namespace trlc
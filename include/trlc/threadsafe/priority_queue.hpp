@@ -0,0 +1,603 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Thread-safe queue ordered by priority, with the settings and policies of `Queue`.
+ *
+ * Elements are kept in a fixed number of FIFO lanes, one per priority, and a bitmap of the non-empty lanes
+ * selects the most urgent lane in O(1). Elements of the same priority keep their push order.
+ *
+ * The `Settings` of `Queue` apply unchanged, with `DISCARD_OLDEST` discarding the oldest element of the lowest
+ * priority, which is the pushed element itself when its priority is below every queued element.
+ *
+ * @tparam T Type of elements stored in the queue.
+ * @tparam Lanes Number of priorities, `0` being the lowest and `Lanes - 1` the most urgent.
+ */
+template<typename T, uint32_t Lanes = 8>
+class PriorityQueue
+{
+    static_assert(Lanes > 0 && Lanes <= 64, "PriorityQueue supports 1 to 64 priorities");
+
+public:
+    using DiscardedCallback = typename Queue<T>::DiscardedCallback;
+    using Discard = typename Queue<T>::Discard;
+    using Control = typename Queue<T>::Control;
+    using Settings = typename Queue<T>::Settings;
+    static constexpr uint32_t WAIT_FOREVER = Queue<T>::WAIT_FOREVER;
+    static constexpr uint32_t HIGHEST_PRIORITY = Lanes - 1;
+
+    /**
+     * @brief Constructor that accepts queue settings.
+     * @param settings Settings to configure the queue behavior.
+     */
+    explicit PriorityQueue(const Settings& settings);
+
+    /**
+     * @brief Destructor that signal a exit waiting operation
+     */
+    ~PriorityQueue();
+
+    // Make this class uncopyable
+    UNCOPYABLE(PriorityQueue);
+
+    /**
+     * @brief Set the callback for discarded elements.
+     * @param discarded_callback Function to be called when an element is discarded.
+     */
+    void setDiscardedCallback(DiscardedCallback discarded_callback);
+
+    /**
+     * @brief Open the queue for push operations.
+     */
+    void openPush();
+
+    /**
+     * @brief Close the queue for push operations.
+     */
+    void closePush();
+
+    /**
+     * @brief Open the queue for pop operations.
+     */
+    void openPop();
+
+    /**
+     * @brief Close the queue for pop operations.
+     */
+    void closePop();
+
+    /**
+     * @brief Attempts to push an element with a priority, like `Queue::push`.
+     *
+     * @param elem The element to push into the queue.
+     * @param priority The priority of the element, clamped to `HIGHEST_PRIORITY`.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was pushed, `false` if it was discarded, the queue stayed full or
+     *         the queue was closed for push operations.
+     */
+    bool push(const T& elem, const uint32_t priority, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to move an element with a priority into the queue, like `Queue::push`.
+     *
+     * @param elem The element to move into the queue.
+     * @param priority The priority of the element, clamped to `HIGHEST_PRIORITY`.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was pushed, `false` otherwise.
+     */
+    bool push(T&& elem, const uint32_t priority, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Constructs an element with a priority in place, like `Queue::emplace`.
+     *
+     * @param priority The priority of the element, clamped to `HIGHEST_PRIORITY`.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool emplace(const uint32_t priority, Args&&... args);
+
+    /**
+     * @brief Attempts to pop the oldest element of the highest priority with an optional timeout.
+     *
+     * @param elem Reference where the popped element will be stored.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if an element was popped, `false` if the queue stayed empty until the timeout or
+     *         the queue was closed for pop operations.
+     */
+    bool pop(T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Pops the oldest element of the highest priority without blocking.
+     * @return The popped element, or `std::nullopt` if the queue was empty or closed for pop operations.
+     */
+    std::optional<T> tryPop();
+
+    /**
+     * @brief Waits until the queue is open for pushing or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for push operations within the timeout period, `false` otherwise.
+     */
+    bool waitPushOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Waits until the queue is open for popping or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for pop operations within the timeout period, `false` otherwise.
+     */
+    bool waitPopOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Check without blocking whether the queue holds elements and is open for pop operations.
+     * @return `true` if a pop would currently find an element, `false` otherwise.
+     */
+    bool readyToPop() const;
+
+    /**
+     * @brief Register a channel notified on every push, open and close, as used by `Selector`.
+     * @param wait The channel, to be removed with `removeObserver` before it is destroyed.
+     */
+    void addObserver(Wait& wait);
+
+    /**
+     * @brief Unregister a channel added with `addObserver`.
+     * @param wait The channel to remove.
+     */
+    void removeObserver(Wait& wait);
+
+private:
+    using Status = typename Queue<T>::Status;
+    using Deadline = Wait::Clock::time_point;
+
+    const Settings m_settings;                   ///< Queue settings.
+    std::deque<T> m_lanes[Lanes]{};              ///< Elements of each priority, oldest first.
+    uint64_t m_non_empty{0};                     ///< Bit `i` is set while lane `i` holds elements.
+    std::size_t m_count{0};                      ///< Number of elements in every lane.
+    std::atomic<Status> m_status{Status::EMPTY}; ///< Status of the queue.
+    std::mutex m_lock{};                         ///< Mutex to protect the lanes.
+    std::atomic<bool> m_open_push{false};        ///< Flag indicating whether push is open.
+    std::atomic<bool> m_open_pop{false};         ///< Flag indicating whether pop is open.
+    Wait m_not_empty{};                          ///< Wait channel for consumers blocked on an empty queue.
+    Wait m_not_full{};                           ///< Wait channel for producers blocked on a full queue.
+    Wait m_open{};                               ///< Wait channel for `waitPushOpen` and `waitPopOpen` callers.
+    DiscardedCallback m_discarded_callback{};    ///< Callback for discarded elements.
+    WaitObservers m_observers{};                 ///< External channels notified with the consumers.
+
+    void onDiscarded(const T& elem);                  ///< Handle discarded elements.
+    bool pushControllable() const;                    ///< Check if push is controllable.
+    bool popControllable() const;                     ///< Check if pop is controllable.
+    bool waitToPush(const Deadline deadline);         ///< Wait for push availability.
+    bool waitToPop(const Deadline deadline);          ///< Wait for pop availability.
+    void updateStatus();                              ///< Update the status of the queue.
+    void notifyPushed();                              ///< Wake up a consumer and the observers for a new element.
+    void notifyAll();                                 ///< Wake up every waiter after an open, close or exit.
+    T popFront(const uint32_t lane);                  ///< Move out the oldest element of a non-empty lane.
+    static uint32_t highestLane(const uint64_t mask); ///< Index of the highest set bit.
+    static uint32_t lowestLane(const uint64_t mask);  ///< Index of the lowest set bit.
+
+    static Deadline deadline(const uint32_t timeout_ms); ///< Convert a timeout to a deadline, `Wait::NO_DEADLINE` for `WAIT_FOREVER`.
+
+    /**
+     * @brief Internal push method constructing the element from `args`.
+     * @param priority The clamped priority of the element.
+     * @param push_deadline The time point to give up at.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool pushWithLock(const uint32_t priority, const Deadline push_deadline, Args&&... args);
+
+    /**
+     * @brief Hand an element that was never inserted to the discarded callback.
+     * @param args The element, or the arguments to construct it from.
+     */
+    template<typename... Args>
+    void discardNewest(Args&&... args);
+};
+
+template<typename T, uint32_t Lanes>
+PriorityQueue<T, Lanes>::PriorityQueue(const Settings& settings)
+    : m_settings{settings}
+    , m_not_empty{settings.wait_strategy}
+    , m_not_full{settings.wait_strategy}
+{
+    if (!pushControllable())
+    {
+        m_open_push.store(true, std::memory_order_release);
+    }
+    if (!popControllable())
+    {
+        m_open_pop.store(true, std::memory_order_release);
+    }
+}
+
+template<typename T, uint32_t Lanes>
+PriorityQueue<T, Lanes>::~PriorityQueue()
+{
+    m_open_pop.store(false, std::memory_order_release);
+    m_open_push.store(false, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::setDiscardedCallback(DiscardedCallback discarded_callback)
+{
+    m_discarded_callback = discarded_callback;
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::onDiscarded(const T& elem)
+{
+    if (m_discarded_callback)
+    {
+        m_discarded_callback(elem);
+    }
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::push(const T& elem, const uint32_t priority, const uint32_t timeout_ms)
+{
+    return pushWithLock(std::min(priority, HIGHEST_PRIORITY), deadline(timeout_ms), elem);
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::push(T&& elem, const uint32_t priority, const uint32_t timeout_ms)
+{
+    return pushWithLock(std::min(priority, HIGHEST_PRIORITY), deadline(timeout_ms), std::move(elem));
+}
+
+template<typename T, uint32_t Lanes>
+template<typename... Args>
+bool PriorityQueue<T, Lanes>::emplace(const uint32_t priority, Args&&... args)
+{
+    return pushWithLock(std::min(priority, HIGHEST_PRIORITY), Wait::NO_DEADLINE, std::forward<Args>(args)...);
+}
+
+template<typename T, uint32_t Lanes>
+template<typename... Args>
+bool PriorityQueue<T, Lanes>::pushWithLock(const uint32_t priority, const Deadline push_deadline, Args&&... args)
+{
+    if (!waitToPush(push_deadline))
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock{m_lock};
+    while (m_count >= m_settings.size)
+    {
+        const bool lower_than_queued{m_count == 0 || priority < lowestLane(m_non_empty)};
+        if (m_settings.discard == Discard::DISCARD_NEWEST ||
+            (m_settings.discard == Discard::DISCARD_OLDEST && lower_than_queued))
+        {
+            lock.unlock();
+            discardNewest(std::forward<Args>(args)...);
+            return false;
+        }
+        if (m_settings.discard == Discard::DISCARD_OLDEST)
+        {
+            T discarded_elem{popFront(lowestLane(m_non_empty))};
+            m_lanes[priority].emplace_back(std::forward<Args>(args)...);
+            m_non_empty |= uint64_t{1} << priority;
+            ++m_count;
+            updateStatus();
+            lock.unlock();
+            notifyPushed();
+            onDiscarded(discarded_elem);
+            return true;
+        }
+        // Another producer filled the queue after waitToPush() returned.
+        lock.unlock();
+        if (!waitToPush(push_deadline))
+        {
+            return false;
+        }
+        lock.lock();
+    }
+    m_lanes[priority].emplace_back(std::forward<Args>(args)...);
+    m_non_empty |= uint64_t{1} << priority;
+    ++m_count;
+    updateStatus();
+    lock.unlock();
+    notifyPushed();
+    return true;
+}
+
+template<typename T, uint32_t Lanes>
+template<typename... Args>
+void PriorityQueue<T, Lanes>::discardNewest(Args&&... args)
+{
+    if (!m_discarded_callback)
+    {
+        return;
+    }
+    if constexpr (sizeof...(Args) == 1 && std::conjunction_v<std::is_same<std::decay_t<Args>, T>...>)
+    {
+        onDiscarded(args...);
+    }
+    else
+    {
+        onDiscarded(T(std::forward<Args>(args)...));
+    }
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::pop(T& elem, const uint32_t timeout_ms)
+{
+    const Deadline pop_deadline{deadline(timeout_ms)};
+    while (waitToPop(pop_deadline))
+    {
+        {
+            std::unique_lock<std::mutex> lock{m_lock};
+            if (m_count > 0)
+            {
+                elem = popFront(highestLane(m_non_empty));
+                updateStatus();
+                lock.unlock();
+                m_not_full.notifyOne();
+                return true;
+            }
+        }
+        // Another consumer took the element after waitToPop() returned, retry until the same deadline.
+    }
+    return false;
+}
+
+template<typename T, uint32_t Lanes>
+std::optional<T> PriorityQueue<T, Lanes>::tryPop()
+{
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return std::nullopt;
+    }
+    std::unique_lock<std::mutex> lock{m_lock};
+    if (m_count == 0)
+    {
+        return std::nullopt;
+    }
+    std::optional<T> elem{popFront(highestLane(m_non_empty))};
+    updateStatus();
+    lock.unlock();
+    m_not_full.notifyOne();
+    return elem;
+}
+
+template<typename T, uint32_t Lanes>
+typename PriorityQueue<T, Lanes>::Deadline PriorityQueue<T, Lanes>::deadline(const uint32_t timeout_ms)
+{
+    if (timeout_ms == WAIT_FOREVER)
+    {
+        return Wait::NO_DEADLINE;
+    }
+    return Wait::deadlineAfter(std::chrono::milliseconds(timeout_ms));
+}
+
+template<typename T, uint32_t Lanes>
+T PriorityQueue<T, Lanes>::popFront(const uint32_t lane)
+{
+    T elem{std::move(m_lanes[lane].front())};
+    m_lanes[lane].pop_front();
+    if (m_lanes[lane].empty())
+    {
+        m_non_empty &= ~(uint64_t{1} << lane);
+    }
+    --m_count;
+    return elem;
+}
+
+template<typename T, uint32_t Lanes>
+uint32_t PriorityQueue<T, Lanes>::highestLane(const uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index{0};
+    _BitScanReverse64(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(63 - __builtin_clzll(mask));
+#endif
+}
+
+template<typename T, uint32_t Lanes>
+uint32_t PriorityQueue<T, Lanes>::lowestLane(const uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index{0};
+    _BitScanForward64(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(mask));
+#endif
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::pushControllable() const
+{
+    return m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::PUSH;
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::popControllable() const
+{
+    return m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::POP;
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::openPush()
+{
+    if (!pushControllable())
+    {
+        return;
+    }
+    m_open_push.store(true, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::closePush()
+{
+    if (!pushControllable())
+    {
+        return;
+    }
+    m_open_push.store(false, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::openPop()
+{
+    if (!popControllable())
+    {
+        return;
+    }
+    m_open_pop.store(true, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::closePop()
+{
+    if (!popControllable())
+    {
+        return;
+    }
+    m_open_pop.store(false, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::waitToPush(const Deadline deadline)
+{
+    if (!m_open_push.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    if (m_status.load(std::memory_order_acquire) == Status::FULL && m_settings.discard == Discard::NO_DISCARD)
+    {
+        Wait::Status result{m_not_full.waitUntil(deadline, [this]() -> bool
+                                                 { return !m_open_push.load(std::memory_order_acquire) ||
+                                                          m_status.load(std::memory_order_acquire) != Status::FULL; })};
+        if (result != Wait::Status::SUCCESS || !m_open_push.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::waitToPop(const Deadline deadline)
+{
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    if (m_status.load(std::memory_order_acquire) == Status::EMPTY)
+    {
+        Wait::Status result{m_not_empty.waitUntil(deadline, [this]() -> bool
+                                                  { return !m_open_pop.load(std::memory_order_acquire) ||
+                                                           m_status.load(std::memory_order_acquire) != Status::EMPTY; })};
+        if (result != Wait::Status::SUCCESS || !m_open_pop.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::updateStatus()
+{
+    if (m_count == 0)
+    {
+        m_status.store(Status::EMPTY, std::memory_order_release);
+    }
+    else if (m_count >= m_settings.size)
+    {
+        m_status.store(Status::FULL, std::memory_order_release);
+    }
+    else
+    {
+        m_status.store(Status::NORMAL, std::memory_order_release);
+    }
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::notifyPushed()
+{
+    m_not_empty.notifyOne();
+    m_observers.notify();
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::notifyAll()
+{
+    m_not_empty.notify();
+    m_not_full.notify();
+    m_open.notify();
+    m_observers.notify();
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::readyToPop() const
+{
+    return m_open_pop.load(std::memory_order_acquire) && m_status.load(std::memory_order_acquire) != Status::EMPTY;
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::addObserver(Wait& wait)
+{
+    m_observers.add(wait);
+}
+
+template<typename T, uint32_t Lanes>
+void PriorityQueue<T, Lanes>::removeObserver(Wait& wait)
+{
+    m_observers.remove(wait);
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::waitPushOpen(const uint32_t timeout_ms)
+{
+    Wait::Status result{
+        m_open.waitUntil(deadline(timeout_ms), [this]() -> bool
+                         { return m_open_push.load(std::memory_order_acquire); })};
+    return result == Wait::Status::SUCCESS;
+}
+
+template<typename T, uint32_t Lanes>
+bool PriorityQueue<T, Lanes>::waitPopOpen(const uint32_t timeout_ms)
+{
+    Wait::Status result{
+        m_open.waitUntil(deadline(timeout_ms), [this]() -> bool
+                         { return m_open_pop.load(std::memory_order_acquire); })};
+    return result == Wait::Status::SUCCESS;
+}
+
+} // namespace threadsafe
+} // namespace trlc
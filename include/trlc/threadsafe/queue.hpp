@@ -1,15 +1,23 @@
 #pragma once
 
 #include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/numa.hpp"
+#include "trlc/threadsafe/queue_stats.hpp"
+#include "trlc/threadsafe/trace.hpp"
 #include "trlc/threadsafe/wait.hpp"
 
 #include <atomic>
 #include <chrono>
 #include <deque>
 #include <functional>
+#include <iterator>
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace trlc
 {
@@ -22,8 +30,11 @@ namespace threadsafe
  * The Queue class allows thread-safe push and pop operations with optional control and discard policies.
  *
  * @tparam T Type of elements stored in the queue.
+ * @tparam Allocator Allocator of the element storage, e.g. `PoolAllocator<T>` to recycle its chunks.
+ * @tparam Stats Stats policy, `QueueStats` to record telemetry or `NoQueueStats` to compile it away.
+ * @tparam Lock Mutex guarding the elements, e.g. `PriorityInheritanceMutex` against priority inversion.
  */
-template<typename T>
+template<typename T, typename Allocator = std::allocator<T>, typename Stats = NoQueueStats, typename Lock = std::mutex>
 class Queue
 {
 public:
@@ -69,13 +80,16 @@ public:
         Discard discard{Discard::NO_DISCARD};                 ///< Discard policy.
         Control control{Control::NO_CONTROL};                 ///< Control policy.
         std::size_t size{std::numeric_limits<size_t>::max()}; ///< Maximum size of the queue.
+        Wait::Strategy wait_strategy{Wait::Strategy::BLOCK};  ///< Strategy of blocked push and pop operations.
+        int32_t numa_node{NO_NUMA_NODE};                      ///< Node of the ring storage of `SpscQueue` and `MpmcQueue`.
     };
 
     /**
      * @brief Constructor that accepts queue settings.
      * @param settings Settings to configure the queue behavior.
+     * @param allocator Allocator of the element storage.
      */
-    explicit Queue(const Settings& settings);
+    explicit Queue(const Settings& settings, const Allocator& allocator = Allocator());
 
     /**
      * @brief Destructor that signal a exit waiting operation
@@ -128,6 +142,74 @@ public:
      */
     bool push(const T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
 
+    /**
+     * @brief Attempts to move an element into the queue with an optional timeout.
+     *
+     * Behaves like `push(const T&, uint32_t)` but moves `elem` into the queue storage instead of copying it.
+     *
+     * @param elem The element to move into the queue.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    bool push(T&& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to push an element into the queue, waiting at most `timeout`.
+     *
+     * Behaves like `push(const T&, uint32_t)` with a timeout of any resolution, e.g. microseconds.
+     *
+     * @param elem The element to push into the queue.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool push(const T& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to move an element into the queue, waiting at most `timeout`.
+     * @param elem The element to move into the queue.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool push(T&& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to push an element into the queue, waiting at most until `deadline`.
+     *
+     * Behaves like `push(const T&, uint32_t)` with an absolute deadline, which callers retrying several
+     * operations can share without the total wait drifting.
+     *
+     * @param elem The element to push into the queue.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool push(const T& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Attempts to move an element into the queue, waiting at most until `deadline`.
+     * @param elem The element to move into the queue.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool push(T&& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Constructs an element in place at the back of the queue.
+     *
+     * Behaves like `push` with `WAIT_FOREVER`. The element is constructed directly in the queue storage;
+     * it is only constructed separately when `DISCARD_NEWEST` has to hand it to the discarded callback.
+     *
+     * @tparam Args Types of the arguments forwarded to the constructor of `T`.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool emplace(Args&&... args);
+
     /**
      * @brief Attempts to pop an element from the queue with an optional timeout.
      *
@@ -144,6 +226,116 @@ public:
      */
     bool pop(T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
 
+    /**
+     * @brief Attempts to pop an element from the queue, waiting at most `timeout`.
+     * @param elem Reference where the popped element will be stored.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool pop(T& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to pop an element from the queue, waiting at most until `deadline`.
+     * @param elem Reference where the popped element will be stored.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool pop(T& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Pops an element from the queue without blocking.
+     *
+     * The element is move-constructed out of the queue storage.
+     *
+     * @return The popped element, or `std::nullopt` if the queue was empty or closed for pop operations.
+     */
+    std::optional<T> tryPop();
+
+private:
+    struct PopOperation;
+    struct PushOperation;
+
+public:
+    /**
+     * @brief Pops an element from a coroutine, suspending it instead of blocking while the queue is empty.
+     *
+     * A suspended consumer holds no thread: it is resumed through `executor.post`, e.g. on a `ThreadPool`
+     * or with `InlineExecutor` on the pushing thread, once an element or a close makes the pop complete.
+     * The queue and the executor must outlive the suspended coroutine.
+     *
+     * @tparam Executor The executor type, with a `post(std::function<void()>)` member.
+     * @param elem Reference to store the popped element, alive until the coroutine resumed.
+     * @param executor The executor resuming the coroutine.
+     * @return An awaitable giving `true` if an element was popped, `false` if the queue was closed for pop.
+     */
+    template<typename Executor>
+    WaitAwaiter<Executor, PopOperation> co_pop(T& elem, Executor& executor);
+
+    /**
+     * @brief Pushes an element from a coroutine, suspending it instead of blocking while the queue is full.
+     *
+     * The discard policies apply as in `push`, so only `NO_DISCARD` ever suspends. The queue and the executor
+     * must outlive the suspended coroutine.
+     *
+     * @tparam Executor The executor type, with a `post(std::function<void()>)` member.
+     * @param elem The element to push, moved into the awaitable.
+     * @param executor The executor resuming the coroutine.
+     * @return An awaitable giving `true` if the element was pushed, `false` if it was discarded or the queue
+     *         was closed for push.
+     */
+    template<typename Executor>
+    WaitAwaiter<Executor, PushOperation> co_push(T elem, Executor& executor);
+
+    /**
+     * @brief Attempts to push a range of elements into the queue with an optional timeout.
+     *
+     * The elements are inserted in batches, each under a single lock acquisition with a single status
+     * update and wake-up, instead of once per element. Discard policies apply per element as in `push`:
+     * - If `DISCARD_OLDEST` is set, the oldest elements are removed to make room for the new ones.
+     * - If `DISCARD_NEWEST` is set, the elements that do not fit are discarded.
+     * - If `NO_DISCARD` is set, push the elements that fit, then block with `timeout_ms` until there is room
+     *   again and continue, until the whole range is pushed, the timeout expires or push is closed. The
+     *   elements pushed before a timeout or a close stay in the queue.
+     *
+     * @tparam InputIt Input iterator type. Use `std::move_iterator` to move the elements in.
+     * @param first Iterator to the first element to push.
+     * @param last Iterator past the last element to push.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return The number of elements pushed into the queue.
+     */
+    template<typename InputIt>
+    std::size_t pushBulk(InputIt first, InputIt last, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to pop up to `max_n` elements from the queue with an optional timeout.
+     *
+     * Blocks until at least one element is available, then moves out as many elements as are available,
+     * up to `max_n`, under a single lock acquisition with a single status update and wake-up.
+     *
+     * @tparam OutputIt Output iterator type receiving the popped elements.
+     * @param out Iterator where the popped elements are written.
+     * @param max_n The maximum number of elements to pop.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return The number of elements popped, `0` if the queue stayed empty until the timeout or the queue
+     *         was closed for pop operations.
+     */
+    template<typename OutputIt>
+    std::size_t popBulk(OutputIt out, const std::size_t max_n, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Moves every element currently in the queue to the back of a container without blocking.
+     *
+     * @tparam Container Container type supporting `push_back`.
+     * @param container The container receiving the elements.
+     * @return The number of elements moved, `0` if the queue was empty or closed for pop operations.
+     */
+    template<typename Container>
+    std::size_t drainTo(Container& container);
+
     /**
      * @brief Waits until the queue is open for pushing or until the specified timeout expires.
      *
@@ -158,6 +350,22 @@ public:
      */
     bool waitPushOpen(const uint32_t timeout_ms = WAIT_FOREVER);
 
+    /**
+     * @brief Waits until the queue is open for pushing, at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the queue is open for push operations, `false` if the timeout was reached.
+     */
+    template<class Rep, class Period>
+    bool waitPushOpen(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Waits until the queue is open for pushing, at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the queue is open for push operations, `false` if the deadline was reached.
+     */
+    template<class C, class Duration>
+    bool waitPushOpen(const std::chrono::time_point<C, Duration>& deadline);
+
     /**
      * @brief Waits until the queue is open for popping or until the specified timeout expires.
      *
@@ -172,30 +380,163 @@ public:
      */
     bool waitPopOpen(const uint32_t timeout_ms = WAIT_FOREVER);
 
+    /**
+     * @brief Waits until the queue is open for popping, at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the queue is open for pop operations, `false` if the timeout was reached.
+     */
+    template<class Rep, class Period>
+    bool waitPopOpen(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Waits until the queue is open for popping, at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the queue is open for pop operations, `false` if the deadline was reached.
+     */
+    template<class C, class Duration>
+    bool waitPopOpen(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Check without blocking whether the queue holds elements and is open for pop operations.
+     * @return `true` if a pop would currently find an element, `false` otherwise.
+     */
+    bool readyToPop() const;
+
+    /**
+     * @brief Register a channel notified on every push, open and close, as used by `Selector`.
+     * @param wait The channel, to be removed with `removeObserver` before it is destroyed.
+     */
+    void addObserver(Wait& wait);
+
+    /**
+     * @brief Unregister a channel added with `addObserver`.
+     * @param wait The channel to remove.
+     */
+    void removeObserver(Wait& wait);
+
+    /**
+     * @brief Returns the stats of the queue, e.g. to export `stats().snapshot()` to a metrics system.
+     * @return The stats policy instance.
+     */
+    Stats& stats();
+
 private:
-    const Settings m_settings;                   ///< Queue settings.
-    std::deque<T> m_queue{};                     ///< Underlying queue storage.
-    std::atomic<std::size_t> m_size{0};          ///< Current size of the queue.
-    std::atomic<Status> m_status{Status::EMPTY}; ///< Status of the queue.
-    std::mutex m_lock{};                         ///< Mutex to protect the queue operations.
-    std::atomic<bool> m_open_push{false};        ///< Flag indicating whether push is open.
-    std::atomic<bool> m_open_pop{false};         ///< Flag indicating whether pop is open.
-    Wait m_wait{};                               ///< Wait mechanism for blocking operations.
-    DiscardedCallback m_discarded_callback{};    ///< Callback for discarded elements.
+    /**
+     * @brief Operation of `co_pop`.
+     */
+    struct PopOperation
+    {
+        Queue* queue;       ///< The queue popped from.
+        T* elem;            ///< Where the element is stored.
+        bool popped{false}; ///< Result of the pop.
+
+        bool attempt();
+        bool ready() const;
+        void exit() {}
+        bool result() const
+        {
+            return popped;
+        }
+    };
+
+    /**
+     * @brief Operation of `co_push`.
+     */
+    struct PushOperation
+    {
+        Queue* queue;       ///< The queue pushed to.
+        T elem;             ///< The element, moved into the queue.
+        bool pushed{false}; ///< Result of the push.
+
+        bool attempt();
+        bool ready() const;
+        void exit() {}
+        bool result() const
+        {
+            return pushed;
+        }
+    };
+
+    using TimePoint = Wait::Clock::time_point;
+    using TimePointAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<TimePoint>;
+    struct NoTimestamps
+    {
+        explicit NoTimestamps(const TimePointAllocator&) {}
+    };
+    using Timestamps = std::conditional_t<Stats::ENABLED, std::deque<TimePoint, TimePointAllocator>, NoTimestamps>;
+
+    // Read-mostly state, loaded by every operation and written only on open, close or registration.
+    const Settings m_settings;                ///< Queue settings.
+    std::atomic<bool> m_open_push{false};     ///< Flag indicating whether push is open.
+    std::atomic<bool> m_open_pop{false};      ///< Flag indicating whether pop is open.
+    DiscardedCallback m_discarded_callback{}; ///< Callback for discarded elements.
+    WaitObservers m_observers{};              ///< External channels notified with the consumers.
+
+    // Storage, written by producers and consumers alike but only under the lock.
+    alignas(CACHE_LINE_SIZE) Lock m_lock{}; ///< Mutex to protect the queue operations.
+    std::deque<T, Allocator> m_queue;       ///< Underlying queue storage.
+    Timestamps m_pushed_at;                 ///< Push time of each element of `m_queue`, only with stats.
+
+    // Polled by both sides before they take the lock, written only when the queue becomes empty, normal or full.
+    alignas(CACHE_LINE_SIZE) std::atomic<Status> m_status{Status::EMPTY}; ///< Status of the queue.
+
+    Stats m_stats{};    ///< Telemetry of the queue, with its own producer and consumer lines.
+    Wait m_not_empty{}; ///< Wait channel for consumers blocked on an empty queue.
+    Wait m_not_full{};  ///< Wait channel for producers blocked on a full queue.
+    Wait m_open{};      ///< Wait channel for `waitPushOpen` and `waitPopOpen` callers.
 
     void onDiscarded(const T& elem);            ///< Handle discarded elements.
     bool pushControllable() const;              ///< Check if push is controllable.
     bool popControllable() const;               ///< Check if pop is controllable.
-    bool waitToPush(const uint32_t timeout_ms); ///< Wait for push availability.
-    bool waitToPop(const uint32_t timeout_ms);  ///< Wait for pop availability.
-    void pushWithLock(const T& elem);           ///< Internal push method.
-    const T& popWithLock();                     ///< Internal pop method.
     void updateStatus();                        ///< Update the status of the queue.
+    void notifyPushed(const std::size_t count); ///< Wake up consumers for `count` new elements.
+    void notifyPopped(const std::size_t count); ///< Wake up producers for `count` freed slots.
+    void notifyAll();                           ///< Wake up every waiter after an open, close or exit.
+
+    using Deadline = Wait::Clock::time_point;
+    static Deadline deadline(const uint32_t timeout_ms); ///< Convert a timeout to a deadline, `Wait::NO_DEADLINE` for `WAIT_FOREVER`.
+    bool waitToPush(const Deadline deadline);            ///< Wait for push availability.
+    bool waitToPop(const Deadline deadline);             ///< Wait for pop availability.
+    bool popUntil(T& elem, const Deadline deadline);     ///< Pop an element, waiting until the deadline.
+    bool waitPushOpenUntil(const Deadline deadline);     ///< Wait for the push to open until the deadline.
+    bool waitPopOpenUntil(const Deadline deadline);      ///< Wait for the pop to open until the deadline.
+    void stampPushed(const std::size_t count);           ///< Record `count` elements appended to `m_queue`.
+    void stampPopped(const std::size_t count);           ///< Record `count` elements popped from `m_queue`.
+    void stampDiscarded();                               ///< Record the oldest element of `m_queue` discarded.
+
+    /**
+     * @brief Internal push method constructing the element from `args`.
+     * @param push_deadline The time point to give up at.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool pushWithLock(const Deadline push_deadline, Args&&... args);
+
+    /**
+     * @brief Hand an element that was never inserted to the discarded callback.
+     * @param args The element, or the arguments to construct it from.
+     */
+    template<typename... Args>
+    void discardNewest(Args&&... args);
+
+    /**
+     * @brief Internal batch pop method.
+     * @param out Iterator where the popped elements are written.
+     * @param max_n The maximum number of elements to pop.
+     * @return The number of elements popped.
+     */
+    template<typename OutputIt>
+    std::size_t popBulkWithLock(OutputIt out, const std::size_t max_n);
 };
 
-template<typename T>
-Queue<T>::Queue(const Settings& settings)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+Queue<T, Allocator, Stats, Lock>::Queue(const Settings& settings, const Allocator& allocator)
     : m_settings{settings}
+    , m_queue{allocator}
+    , m_pushed_at{TimePointAllocator(allocator)}
+    , m_not_empty{settings.wait_strategy}
+    , m_not_full{settings.wait_strategy}
 {
     if (!pushControllable())
     {
@@ -207,22 +548,22 @@ Queue<T>::Queue(const Settings& settings)
     }
 }
 
-template<typename T>
-Queue<T>::~Queue()
+template<typename T, typename Allocator, typename Stats, typename Lock>
+Queue<T, Allocator, Stats, Lock>::~Queue()
 {
     m_open_pop.store(false, std::memory_order_release);
     m_open_push.store(false, std::memory_order_release);
-    m_wait.notify();
+    notifyAll();
 }
 
-template<typename T>
-void Queue<T>::setDiscardedCallback(DiscardedCallback discarded_callback)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::setDiscardedCallback(DiscardedCallback discarded_callback)
 {
     m_discarded_callback = discarded_callback;
 }
 
-template<typename T>
-void Queue<T>::onDiscarded(const T& elem)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::onDiscarded(const T& elem)
 {
     if (m_discarded_callback)
     {
@@ -230,49 +571,359 @@ void Queue<T>::onDiscarded(const T& elem)
     }
 }
 
-template<typename T>
-bool Queue<T>::push(const T& elem, const uint32_t timeout_ms)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::push(const T& elem, const uint32_t timeout_ms)
+{
+    return pushWithLock(deadline(timeout_ms), elem);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::push(T&& elem, const uint32_t timeout_ms)
+{
+    return pushWithLock(deadline(timeout_ms), std::move(elem));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class Rep, class Period>
+bool Queue<T, Allocator, Stats, Lock>::push(const T& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return pushWithLock(Wait::deadlineAfter(timeout), elem);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class Rep, class Period>
+bool Queue<T, Allocator, Stats, Lock>::push(T&& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return pushWithLock(Wait::deadlineAfter(timeout), std::move(elem));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class C, class Duration>
+bool Queue<T, Allocator, Stats, Lock>::push(const T& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return pushWithLock(Wait::toDeadline(deadline), elem);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class C, class Duration>
+bool Queue<T, Allocator, Stats, Lock>::push(T&& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return pushWithLock(Wait::toDeadline(deadline), std::move(elem));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename... Args>
+bool Queue<T, Allocator, Stats, Lock>::emplace(Args&&... args)
 {
-    if (!waitToPush(timeout_ms))
+    return pushWithLock(Wait::NO_DEADLINE, std::forward<Args>(args)...);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename... Args>
+bool Queue<T, Allocator, Stats, Lock>::pushWithLock(const Deadline push_deadline, Args&&... args)
+{
+    if (!waitToPush(push_deadline))
     {
         return false;
     }
 
-    if (m_status.load(std::memory_order_acquire) != Status::FULL)
+    std::unique_lock<Lock> lock{m_lock};
+    while (m_queue.size() >= m_settings.size)
     {
-        pushWithLock(elem);
-        return true;
+        if (m_settings.discard == Discard::DISCARD_NEWEST)
+        {
+            lock.unlock();
+            m_stats.recordDiscardNewest(1);
+            TRLC_THREADSAFE_TRACE(QUEUE_DISCARD, this, 0, 1);
+            discardNewest(std::forward<Args>(args)...);
+            return false;
+        }
+        if (m_settings.discard == Discard::DISCARD_OLDEST)
+        {
+            T discarded_elem{std::move(m_queue.front())};
+            m_queue.pop_front();
+            stampDiscarded();
+            m_queue.emplace_back(std::forward<Args>(args)...);
+            stampPushed(1);
+            updateStatus();
+            lock.unlock();
+            notifyPushed(1);
+            onDiscarded(discarded_elem);
+            return true;
+        }
+        // Another producer filled the queue after waitToPush() returned.
+        lock.unlock();
+        if (!waitToPush(push_deadline))
+        {
+            return false;
+        }
+        lock.lock();
     }
+    m_queue.emplace_back(std::forward<Args>(args)...);
+    stampPushed(1);
+    updateStatus();
+    lock.unlock();
+    notifyPushed(1);
+    return true;
+}
 
-    if (m_settings.discard == Discard::DISCARD_NEWEST)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename... Args>
+void Queue<T, Allocator, Stats, Lock>::discardNewest(Args&&... args)
+{
+    if (!m_discarded_callback)
     {
-        onDiscarded(elem);
-        return false;
+        return;
+    }
+    if constexpr (sizeof...(Args) == 1 && std::conjunction_v<std::is_same<std::decay_t<Args>, T>...>)
+    {
+        onDiscarded(args...);
     }
+    else
+    {
+        onDiscarded(T(std::forward<Args>(args)...));
+    }
+}
 
-    if (m_settings.discard == Discard::DISCARD_OLDEST)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::pop(T& elem, const uint32_t timeout_ms)
+{
+    return popUntil(elem, deadline(timeout_ms));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class Rep, class Period>
+bool Queue<T, Allocator, Stats, Lock>::pop(T& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return popUntil(elem, Wait::deadlineAfter(timeout));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class C, class Duration>
+bool Queue<T, Allocator, Stats, Lock>::pop(T& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return popUntil(elem, Wait::toDeadline(deadline));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::popUntil(T& elem, const Deadline pop_deadline)
+{
+    while (waitToPop(pop_deadline))
     {
-        auto discarded_elem = std::move(popWithLock());
-        onDiscarded(discarded_elem);
-        pushWithLock(elem);
-        return true;
+        {
+            std::unique_lock<Lock> lock{m_lock};
+            if (!m_queue.empty())
+            {
+                elem = std::move(m_queue.front());
+                m_queue.pop_front();
+                stampPopped(1);
+                updateStatus();
+                lock.unlock();
+                notifyPopped(1);
+                return true;
+            }
+        }
+        // Another consumer took the element after waitToPop() returned, retry until the same deadline.
     }
     return false;
 }
 
-template<typename T>
-bool Queue<T>::pop(T& elem, const uint32_t timeout_ms)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+std::optional<T> Queue<T, Allocator, Stats, Lock>::tryPop()
+{
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return std::nullopt;
+    }
+    std::unique_lock<Lock> lock{m_lock};
+    if (m_queue.empty())
+    {
+        return std::nullopt;
+    }
+    std::optional<T> elem{std::move(m_queue.front())};
+    m_queue.pop_front();
+    stampPopped(1);
+    updateStatus();
+    lock.unlock();
+    notifyPopped(1);
+    return elem;
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename Executor>
+WaitAwaiter<Executor, typename Queue<T, Allocator, Stats, Lock>::PopOperation> Queue<T, Allocator, Stats, Lock>::co_pop(T& elem, Executor& executor)
+{
+    return {m_not_empty, executor, PopOperation{this, &elem}};
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename Executor>
+WaitAwaiter<Executor, typename Queue<T, Allocator, Stats, Lock>::PushOperation> Queue<T, Allocator, Stats, Lock>::co_push(T elem, Executor& executor)
 {
-    if (!waitToPop(timeout_ms))
+    return {m_not_full, executor, PushOperation{this, std::move(elem)}};
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::PopOperation::attempt()
+{
+    std::optional<T> value{queue->tryPop()};
+    if (value)
+    {
+        *elem = std::move(*value);
+        popped = true;
+        return true;
+    }
+    return !queue->m_open_pop.load(std::memory_order_acquire);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::PopOperation::ready() const
+{
+    return !queue->m_open_pop.load(std::memory_order_acquire) || queue->m_status.load(std::memory_order_acquire) != Status::EMPTY;
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::PushOperation::attempt()
+{
+    const bool may_block{queue->m_settings.discard == Discard::NO_DISCARD};
+    if (may_block && queue->m_open_push.load(std::memory_order_acquire) && queue->m_status.load(std::memory_order_acquire) == Status::FULL)
     {
         return false;
     }
-    elem = popWithLock();
-    return true;
+    // A past deadline makes the push give up instead of blocking if the queue filled up in the meantime.
+    pushed = queue->pushWithLock(Deadline{}, std::move(elem));
+    return pushed || !may_block || !queue->m_open_push.load(std::memory_order_acquire);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::PushOperation::ready() const
+{
+    return !queue->m_open_push.load(std::memory_order_acquire) || queue->m_status.load(std::memory_order_acquire) != Status::FULL;
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+typename Queue<T, Allocator, Stats, Lock>::Deadline Queue<T, Allocator, Stats, Lock>::deadline(const uint32_t timeout_ms)
+{
+    if (timeout_ms == WAIT_FOREVER)
+    {
+        return Wait::NO_DEADLINE;
+    }
+    return Wait::deadlineAfter(std::chrono::milliseconds(timeout_ms));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename InputIt>
+std::size_t Queue<T, Allocator, Stats, Lock>::pushBulk(InputIt first, InputIt last, const uint32_t timeout_ms)
+{
+    const Deadline push_deadline{deadline(timeout_ms)};
+    std::size_t pushed{0};
+    std::vector<T> discarded_elems{};
+
+    while (first != last)
+    {
+        if (!waitToPush(push_deadline))
+        {
+            break;
+        }
+        const std::size_t pushed_before{pushed};
+        {
+            std::lock_guard<Lock> lock{m_lock};
+            for (; first != last; ++first)
+            {
+                if (m_queue.size() < m_settings.size)
+                {
+                    m_queue.push_back(*first);
+                    stampPushed(1);
+                    ++pushed;
+                    continue;
+                }
+                if (m_settings.discard == Discard::DISCARD_OLDEST)
+                {
+                    discarded_elems.push_back(std::move(m_queue.front()));
+                    m_queue.pop_front();
+                    stampDiscarded();
+                    m_queue.push_back(*first);
+                    stampPushed(1);
+                    ++pushed;
+                    continue;
+                }
+                if (m_settings.discard == Discard::DISCARD_NEWEST)
+                {
+                    const std::size_t discarded_before{discarded_elems.size()};
+                    for (; first != last; ++first)
+                    {
+                        discarded_elems.push_back(*first);
+                    }
+                    m_stats.recordDiscardNewest(discarded_elems.size() - discarded_before);
+                    TRLC_THREADSAFE_TRACE(QUEUE_DISCARD, this, 0, discarded_elems.size() - discarded_before);
+                }
+                break;
+            }
+            updateStatus();
+        }
+        notifyPushed(pushed - pushed_before);
+        for (const T& elem : discarded_elems)
+        {
+            onDiscarded(elem);
+        }
+        discarded_elems.clear();
+
+        if (Wait::Clock::now() >= push_deadline)
+        {
+            break;
+        }
+    }
+    return pushed;
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename OutputIt>
+std::size_t Queue<T, Allocator, Stats, Lock>::popBulk(OutputIt out, const std::size_t max_n, const uint32_t timeout_ms)
+{
+    if (max_n == 0 || !waitToPop(deadline(timeout_ms)))
+    {
+        return 0;
+    }
+    return popBulkWithLock(out, max_n);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename Container>
+std::size_t Queue<T, Allocator, Stats, Lock>::drainTo(Container& container)
+{
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return 0;
+    }
+    return popBulkWithLock(std::back_inserter(container), std::numeric_limits<std::size_t>::max());
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<typename OutputIt>
+std::size_t Queue<T, Allocator, Stats, Lock>::popBulkWithLock(OutputIt out, const std::size_t max_n)
+{
+    std::size_t popped{0};
+    {
+        std::lock_guard<Lock> lock{m_lock};
+        while (popped < max_n && !m_queue.empty())
+        {
+            *out = std::move(m_queue.front());
+            ++out;
+            m_queue.pop_front();
+            ++popped;
+        }
+        if (popped > 0)
+        {
+            stampPopped(popped);
+            updateStatus();
+        }
+    }
+    notifyPopped(popped);
+    return popped;
 }
 
-template<typename T>
-bool Queue<T>::pushControllable() const
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::pushControllable() const
 {
     if (m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::PUSH)
     {
@@ -281,8 +932,8 @@ bool Queue<T>::pushControllable() const
     return false;
 }
 
-template<typename T>
-bool Queue<T>::popControllable() const
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::popControllable() const
 {
     if (m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::POP)
     {
@@ -291,52 +942,52 @@ bool Queue<T>::popControllable() const
     return false;
 }
 
-template<typename T>
-void Queue<T>::openPush()
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::openPush()
 {
     if (!pushControllable())
     {
         return;
     }
     m_open_push.store(true, std::memory_order_release);
-    m_wait.notify();
+    notifyAll();
 }
 
-template<typename T>
-void Queue<T>::closePush()
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::closePush()
 {
     if (!pushControllable())
     {
         return;
     }
     m_open_push.store(false, std::memory_order_release);
-    m_wait.notify();
+    notifyAll();
 }
 
-template<typename T>
-void Queue<T>::openPop()
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::openPop()
 {
     if (!popControllable())
     {
         return;
     }
     m_open_pop.store(true, std::memory_order_release);
-    m_wait.notify();
+    notifyAll();
 }
 
-template<typename T>
-void Queue<T>::closePop()
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::closePop()
 {
     if (!popControllable())
     {
         return;
     }
     m_open_pop.store(false, std::memory_order_release);
-    m_wait.notify();
+    notifyAll();
 }
 
-template<typename T>
-bool Queue<T>::waitToPush(const uint32_t timeout_ms)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::waitToPush(const Deadline deadline)
 {
     if (!m_open_push.load(std::memory_order_acquire))
     {
@@ -354,7 +1005,12 @@ bool Queue<T>::waitToPush(const uint32_t timeout_ms)
 
     if (m_status.load(std::memory_order_acquire) == Status::FULL && m_settings.discard == Discard::NO_DISCARD)
     {
-        Wait::Status result{m_wait.waitFor(std::chrono::milliseconds(timeout_ms), closed_or_not_full_pred)};
+        const TimePoint start{Stats::ENABLED ? Wait::Clock::now() : TimePoint{}};
+        Wait::Status result{m_not_full.waitUntil(deadline, closed_or_not_full_pred)};
+        if constexpr (Stats::ENABLED)
+        {
+            m_stats.recordPushBlocked(Wait::Clock::now() - start);
+        }
         if (result != Wait::Status::SUCCESS || !m_open_push.load(std::memory_order_acquire))
         {
             return false;
@@ -362,8 +1018,8 @@ bool Queue<T>::waitToPush(const uint32_t timeout_ms)
     }
     return true;
 }
-template<typename T>
-bool Queue<T>::waitToPop(const uint32_t timeout_ms)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::waitToPop(const Deadline deadline)
 {
     if (!m_open_pop.load(std::memory_order_acquire))
     {
@@ -381,7 +1037,12 @@ bool Queue<T>::waitToPop(const uint32_t timeout_ms)
 
     if (m_status.load(std::memory_order_acquire) == Status::EMPTY)
     {
-        Wait::Status result{m_wait.waitFor(std::chrono::milliseconds(timeout_ms), closed_or_not_empty_pred)};
+        const TimePoint start{Stats::ENABLED ? Wait::Clock::now() : TimePoint{}};
+        Wait::Status result{m_not_empty.waitUntil(deadline, closed_or_not_empty_pred)};
+        if constexpr (Stats::ENABLED)
+        {
+            m_stats.recordPopBlocked(Wait::Clock::now() - start);
+        }
         if (result != Wait::Status::SUCCESS || !m_open_pop.load(std::memory_order_acquire))
         {
             return false;
@@ -390,50 +1051,160 @@ bool Queue<T>::waitToPop(const uint32_t timeout_ms)
     return true;
 }
 
-template<typename T>
-void Queue<T>::pushWithLock(const T& elem)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::updateStatus()
 {
-    std::lock_guard<std::mutex> lock{m_lock};
-    m_queue.push_back(elem);
-    updateStatus();
+    constexpr std::size_t NO_ELEMENT{0};
+    const std::size_t size{m_queue.size()};
+    Status status{Status::NORMAL};
+    if (size <= NO_ELEMENT)
+    {
+        status = Status::EMPTY;
+    }
+    else if (size >= m_settings.size)
+    {
+        status = Status::FULL;
+    }
+    // Called under the lock, so the status only changes here. Skipping the store of an unchanged status
+    // keeps the line polled by the other side shared instead of invalidating it on every operation.
+    if (m_status.load(std::memory_order_relaxed) != status)
+    {
+        m_status.store(status, std::memory_order_release);
+    }
 }
 
-template<typename T>
-const T& Queue<T>::popWithLock()
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::notifyPushed(const std::size_t count)
 {
-    std::lock_guard<std::mutex> lock{m_lock};
-    const T& elem{m_queue.front()};
-    m_queue.pop_front();
-    updateStatus();
-    return std::move(elem);
+    // Every new element wakes one consumer, not only the empty to non-empty transition: with several
+    // blocked consumers a transition-only signal would leave the others asleep next to available
+    // elements. Wait skips the notification entirely while nobody is blocked, which keeps the common
+    // uncontended case free of syscalls.
+    if (count == 1)
+    {
+        m_not_empty.notifyOne();
+    }
+    else if (count > 1)
+    {
+        m_not_empty.notify();
+    }
+    if (count > 0)
+    {
+        m_observers.notify();
+    }
 }
 
-template<typename T>
-void Queue<T>::updateStatus()
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::notifyPopped(const std::size_t count)
 {
-    constexpr std::size_t NO_ELEMENT{0};
-    m_size.store(m_queue.size(), std::memory_order_release);
-    if (m_size.load(std::memory_order_acquire) <= NO_ELEMENT)
+    // Producers only block while the queue is full, so they only exist once a slot frees up.
+    if (count == 1)
     {
-        m_status.store(Status::EMPTY, std::memory_order_release);
+        m_not_full.notifyOne();
     }
-    else if (m_size.load(std::memory_order_acquire) >= m_settings.size)
+    else if (count > 1)
     {
-        m_status.store(Status::FULL, std::memory_order_release);
+        m_not_full.notify();
     }
-    else
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::notifyAll()
+{
+    m_not_empty.notify();
+    m_not_full.notify();
+    m_open.notify();
+    m_observers.notify();
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::readyToPop() const
+{
+    return m_open_pop.load(std::memory_order_acquire) && m_status.load(std::memory_order_acquire) != Status::EMPTY;
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::addObserver(Wait& wait)
+{
+    m_observers.add(wait);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::removeObserver(Wait& wait)
+{
+    m_observers.remove(wait);
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+Stats& Queue<T, Allocator, Stats, Lock>::stats()
+{
+    return m_stats;
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::stampPushed(const std::size_t count)
+{
+    TRLC_THREADSAFE_TRACE(QUEUE_PUSH, this, m_queue.size(), count);
+    if constexpr (Stats::ENABLED)
+    {
+        m_pushed_at.insert(m_pushed_at.end(), count, Wait::Clock::now());
+        m_stats.recordPush(count, m_queue.size());
+    }
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::stampPopped(const std::size_t count)
+{
+    TRLC_THREADSAFE_TRACE(QUEUE_POP, this, m_queue.size(), count);
+    if constexpr (Stats::ENABLED)
+    {
+        const TimePoint now{Wait::Clock::now()};
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            m_stats.recordLatency(now - m_pushed_at.front());
+            m_pushed_at.pop_front();
+        }
+        m_stats.recordPop(count);
+    }
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+void Queue<T, Allocator, Stats, Lock>::stampDiscarded()
+{
+    TRLC_THREADSAFE_TRACE(QUEUE_DISCARD, this, 1, 1);
+    if constexpr (Stats::ENABLED)
     {
-        m_status.store(Status::NORMAL, std::memory_order_release);
+        m_pushed_at.pop_front();
+        m_stats.recordDiscardOldest(1);
     }
-    m_wait.notify();
 }
 
-template<typename T>
-bool Queue<T>::waitPushOpen(const uint32_t timeout_ms)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::waitPushOpen(const uint32_t timeout_ms)
+{
+    return waitPushOpenUntil(deadline(timeout_ms));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class Rep, class Period>
+bool Queue<T, Allocator, Stats, Lock>::waitPushOpen(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return waitPushOpenUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class C, class Duration>
+bool Queue<T, Allocator, Stats, Lock>::waitPushOpen(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return waitPushOpenUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::waitPushOpenUntil(const Deadline deadline)
 {
     Wait::Status result{
-        m_wait.waitFor(std::chrono::milliseconds(timeout_ms), [this]() -> bool
-                       { return m_open_push.load(std::memory_order_acquire); })};
+        m_open.waitUntil(deadline, [this]() -> bool
+                         { return m_open_push.load(std::memory_order_acquire); })};
     if (result != Wait::Status::SUCCESS)
     {
         return false;
@@ -441,12 +1212,32 @@ bool Queue<T>::waitPushOpen(const uint32_t timeout_ms)
     return true;
 }
 
-template<typename T>
-bool Queue<T>::waitPopOpen(const uint32_t timeout_ms)
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::waitPopOpen(const uint32_t timeout_ms)
+{
+    return waitPopOpenUntil(deadline(timeout_ms));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class Rep, class Period>
+bool Queue<T, Allocator, Stats, Lock>::waitPopOpen(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return waitPopOpenUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+template<class C, class Duration>
+bool Queue<T, Allocator, Stats, Lock>::waitPopOpen(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return waitPopOpenUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T, typename Allocator, typename Stats, typename Lock>
+bool Queue<T, Allocator, Stats, Lock>::waitPopOpenUntil(const Deadline deadline)
 {
     Wait::Status result{
-        m_wait.waitFor(std::chrono::milliseconds(timeout_ms), [this]() -> bool
-                       { return m_open_pop.load(std::memory_order_acquire); })};
+        m_open.waitUntil(deadline, [this]() -> bool
+                         { return m_open_pop.load(std::memory_order_acquire); })};
     if (result != Wait::Status::SUCCESS)
     {
         return false;
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Point-in-time copy of the counters of a queue, for export to a metrics system.
+ *
+ * The counters are read one after another without stopping the queue, so they are individually exact but
+ * not a consistent cut: e.g. `popped` may briefly exceed `pushed` by the elements of a concurrent push.
+ */
+struct QueueStatsSnapshot
+{
+    uint64_t pushed{0};                            ///< Elements inserted, including those that made an oldest element discarded.
+    uint64_t popped{0};                            ///< Elements removed by pop operations.
+    uint64_t discarded_oldest{0};                  ///< Queued elements dropped by `DISCARD_OLDEST`.
+    uint64_t discarded_newest{0};                  ///< Pushed elements dropped by `DISCARD_NEWEST`.
+    uint64_t high_water_mark{0};                   ///< Largest number of queued elements seen.
+    uint64_t blocked_pushes{0};                    ///< Push operations that blocked on a full queue.
+    uint64_t blocked_pops{0};                      ///< Pop operations that blocked on an empty queue.
+    std::chrono::nanoseconds push_blocked_time{0}; ///< Total time producers spent blocked.
+    std::chrono::nanoseconds pop_blocked_time{0};  ///< Total time consumers spent blocked.
+    DurationHistogramSnapshot latency{};           ///< Histogram of enqueue-to-dequeue times.
+};
+
+/**
+ * @brief Stats policy of `Queue` that records nothing and compiles away.
+ */
+struct NoQueueStats
+{
+    using Snapshot = QueueStatsSnapshot;
+    static constexpr bool ENABLED{false};
+
+    void recordPush(const std::size_t, const std::size_t) {}
+    void recordPop(const std::size_t) {}
+    void recordDiscardOldest(const std::size_t) {}
+    void recordDiscardNewest(const std::size_t) {}
+    void recordPushBlocked(const std::chrono::nanoseconds) {}
+    void recordPopBlocked(const std::chrono::nanoseconds) {}
+    void recordLatency(const std::chrono::nanoseconds) {}
+    Snapshot snapshot() const
+    {
+        return Snapshot{};
+    }
+    void reset() {}
+};
+
+/**
+ * @brief Stats policy of `Queue` counting operations, blocked time and enqueue-to-dequeue latency.
+ *
+ * Every counter is a relaxed atomic, and the producer and consumer counters live on separate cache lines,
+ * so recording costs a few uncontended increments per operation. With this policy the queue also stores a
+ * timestamp per element to measure its latency.
+ */
+class QueueStats
+{
+public:
+    using Snapshot = QueueStatsSnapshot;
+    static constexpr bool ENABLED{true};
+
+    /**
+     * @brief Default constructor.
+     */
+    QueueStats() = default;
+
+    // Make this class uncopyable
+    UNCOPYABLE(QueueStats);
+
+    /**
+     * @brief Record inserted elements.
+     * @param count The number of elements inserted.
+     * @param size The number of queued elements after the insertion.
+     */
+    void recordPush(const std::size_t count, const std::size_t size);
+
+    /**
+     * @brief Record popped elements.
+     * @param count The number of elements popped.
+     */
+    void recordPop(const std::size_t count);
+
+    /**
+     * @brief Record queued elements dropped to make room.
+     * @param count The number of elements dropped.
+     */
+    void recordDiscardOldest(const std::size_t count);
+
+    /**
+     * @brief Record pushed elements dropped because the queue was full.
+     * @param count The number of elements dropped.
+     */
+    void recordDiscardNewest(const std::size_t count);
+
+    /**
+     * @brief Record a push that blocked on a full queue.
+     * @param duration The time spent blocked.
+     */
+    void recordPushBlocked(const std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Record a pop that blocked on an empty queue.
+     * @param duration The time spent blocked.
+     */
+    void recordPopBlocked(const std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Record the time an element spent in the queue.
+     * @param latency The time from its push to its pop.
+     */
+    void recordLatency(const std::chrono::nanoseconds latency);
+
+    /**
+     * @brief Copy the counters.
+     * @return The current counters.
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Reset every counter to zero, e.g. after exporting a snapshot to compute rates.
+     */
+    void reset();
+
+private:
+    using Counter = std::atomic<uint64_t>;
+
+    // Producer side.
+    alignas(CACHE_LINE_SIZE) Counter m_pushed{0}; ///< Elements inserted.
+    Counter m_discarded_oldest{0};                ///< Queued elements dropped by `DISCARD_OLDEST`.
+    Counter m_discarded_newest{0};                ///< Pushed elements dropped by `DISCARD_NEWEST`.
+    Counter m_high_water_mark{0};                 ///< Largest number of queued elements.
+    Counter m_blocked_pushes{0};                  ///< Pushes that blocked.
+    Counter m_push_blocked_ns{0};                 ///< Time producers spent blocked.
+
+    // Consumer side.
+    alignas(CACHE_LINE_SIZE) Counter m_popped{0}; ///< Elements popped.
+    Counter m_blocked_pops{0};                    ///< Pops that blocked.
+    Counter m_pop_blocked_ns{0};                  ///< Time consumers spent blocked.
+    DurationHistogram m_latency{};                ///< Histogram of latencies.
+};
+
+inline void QueueStats::recordPush(const std::size_t count, const std::size_t size)
+{
+    m_pushed.fetch_add(count, std::memory_order_relaxed);
+    uint64_t high{m_high_water_mark.load(std::memory_order_relaxed)};
+    while (size > high && !m_high_water_mark.compare_exchange_weak(high, size, std::memory_order_relaxed))
+    {
+    }
+}
+
+inline void QueueStats::recordPop(const std::size_t count)
+{
+    m_popped.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline void QueueStats::recordDiscardOldest(const std::size_t count)
+{
+    m_discarded_oldest.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline void QueueStats::recordDiscardNewest(const std::size_t count)
+{
+    m_discarded_newest.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline void QueueStats::recordPushBlocked(const std::chrono::nanoseconds duration)
+{
+    m_blocked_pushes.fetch_add(1, std::memory_order_relaxed);
+    m_push_blocked_ns.fetch_add(static_cast<uint64_t>(duration.count()), std::memory_order_relaxed);
+}
+
+inline void QueueStats::recordPopBlocked(const std::chrono::nanoseconds duration)
+{
+    m_blocked_pops.fetch_add(1, std::memory_order_relaxed);
+    m_pop_blocked_ns.fetch_add(static_cast<uint64_t>(duration.count()), std::memory_order_relaxed);
+}
+
+inline void QueueStats::recordLatency(const std::chrono::nanoseconds latency)
+{
+    m_latency.record(latency);
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/thread.hpp"
+#include "trlc/threadsafe/thread_pool.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Runs delayed and periodic tasks from a single `Thread`, using a hierarchical timing wheel.
+ *
+ * Deadlines are rounded up to ticks of `Settings::tick` and kept in four wheels of 256 slots each, covering
+ * 2^8, 2^16, 2^24 and 2^32 ticks. Scheduling and cancelling are O(1) whatever the number of timers, and a
+ * timer moves down at most three times before it expires. The timer thread sleeps until an absolute
+ * deadline, so periodic tasks do not drift.
+ *
+ * Tasks run on the timer thread, or are posted to `Settings::pool` when one is given; tasks run on the
+ * timer thread must be short, since they delay every later timer. The pool must outlive the scheduler.
+ */
+class Scheduler
+{
+private:
+    struct Entry;
+
+public:
+    using Task = std::function<void()>;
+    using Clock = Wait::Clock;
+
+    /**
+     * @brief Enum to represent how the runs of a periodic task are spaced.
+     */
+    enum class Period : uint8_t
+    {
+        FIXED_RATE = 0, ///< Runs at every multiple of the period after the first deadline, skipping the ones missed.
+        FIXED_DELAY = 1 ///< Runs one period after the end of the previous run.
+    };
+
+    /**
+     * @brief Settings for the scheduler, such as the tick, the timer thread and the pool running the tasks.
+     */
+    struct Settings
+    {
+        std::chrono::nanoseconds tick{std::chrono::milliseconds{1}}; ///< Resolution of the deadlines, at least 1 ns.
+        ThreadPriority priority{ThreadPriority::NORMAL};             ///< Priority of the timer thread.
+        std::string name{"scheduler"};                               ///< Name of the timer thread.
+        ThreadPool* pool{nullptr};                                   ///< Pool running the tasks, `nullptr` for the timer thread.
+    };
+
+    /**
+     * @brief Handle of a scheduled task, used to cancel it.
+     *
+     * Tokens are copyable and remain safe to use after the task ran or the scheduler was destroyed.
+     */
+    class Token
+    {
+    public:
+        Token() = default;
+
+        /**
+         * @brief Cancel the task, so that it does not run again.
+         *
+         * A run already started completes. The task and its captures are released right away, or at the
+         * end of the run in progress.
+         *
+         * @return `true` if a future run was cancelled, `false` if the task already ran or was cancelled.
+         */
+        bool cancel();
+
+        /**
+         * @brief Check whether the task is still scheduled.
+         * @return `true` until a one-shot task starts or the task is cancelled.
+         */
+        bool active() const;
+
+    private:
+        friend class Scheduler;
+
+        explicit Token(std::weak_ptr<Entry> entry)
+            : m_entry{std::move(entry)}
+        {
+        }
+
+        std::weak_ptr<Entry> m_entry{}; ///< Entry of the task, expired once the scheduler dropped it.
+    };
+
+    /**
+     * @brief Constructor that starts the timer thread.
+     * @param settings Settings to configure the scheduler.
+     */
+    explicit Scheduler(const Settings& settings);
+
+    /**
+     * @brief Destructor that stops the timer thread, dropping the pending tasks, and waits for the tasks
+     * running in the pool.
+     */
+    ~Scheduler();
+
+    // Make this class uncopyable
+    UNCOPYABLE(Scheduler);
+
+    /**
+     * @brief Run a task once after a delay.
+     * @param delay The delay, of any resolution.
+     * @param task The task to run.
+     * @return The token of the task, inactive if the task is empty.
+     */
+    template<class Repr, class Ratio>
+    Token scheduleAfter(const std::chrono::duration<Repr, Ratio>& delay, Task task)
+    {
+        return schedule(Wait::deadlineAfter(delay), Clock::duration::zero(), Period::FIXED_RATE, std::move(task));
+    }
+
+    /**
+     * @brief Run a task once at a deadline.
+     * @param deadline The deadline, of any clock; deadlines in the past run on the next tick.
+     * @param task The task to run.
+     * @return The token of the task, inactive if the task is empty.
+     */
+    template<class C, class Duration>
+    Token scheduleAt(const std::chrono::time_point<C, Duration>& deadline, Task task)
+    {
+        return schedule(Wait::toDeadline(deadline), Clock::duration::zero(), Period::FIXED_RATE, std::move(task));
+    }
+
+    /**
+     * @brief Run a task periodically, the first time one period from now, until it is cancelled.
+     * @param period The period, of any resolution, at least one tick.
+     * @param task The task to run.
+     * @param mode How the runs are spaced.
+     * @return The token of the task, inactive if the task is empty.
+     */
+    template<class Repr, class Ratio>
+    Token scheduleEvery(const std::chrono::duration<Repr, Ratio>& period, Task task, const Period mode = Period::FIXED_RATE)
+    {
+        const Clock::duration every{std::max(std::chrono::ceil<Clock::duration>(period), m_tick)};
+        return schedule(Clock::now() + every, every, mode, std::move(task));
+    }
+
+    /**
+     * @brief Returns the number of scheduled tasks, periodic ones included, that were not cancelled.
+     * @return The number of active timers.
+     */
+    std::size_t size() const;
+
+private:
+    using EntryPtr = std::shared_ptr<Entry>;
+    using Slot = std::vector<EntryPtr>;
+
+    static constexpr std::size_t LEVELS{4}; ///< Number of wheels.
+    static constexpr uint32_t SLOT_BITS{8}; ///< Bits of the tick indexing the slots of one wheel.
+    static constexpr std::size_t SLOTS{1U << SLOT_BITS};
+    static constexpr uint64_t SLOT_MASK{SLOTS - 1};
+    static constexpr uint64_t NO_TICK{~uint64_t{0}};
+
+    /**
+     * @brief Scheduled task, shared by the wheel and the tokens.
+     */
+    struct Entry
+    {
+        enum State : uint8_t
+        {
+            PENDING = 0,  ///< Waiting for its deadline.
+            RUNNING = 1,  ///< Periodic task running, re-armed afterwards.
+            DONE = 2,     ///< One-shot task started.
+            CANCELLED = 3 ///< Cancelled by its token.
+        };
+
+        Task task;                                       ///< Function to run.
+        Clock::time_point deadline;                      ///< Deadline of the next run.
+        Clock::duration period;                          ///< Period of the runs, zero for a one-shot task.
+        Period mode;                                     ///< Spacing of the periodic runs.
+        uint64_t expiry{0};                              ///< Tick of the next run, guarded by the wheel lock.
+        std::atomic<uint8_t> state{PENDING};             ///< Lifecycle of the entry.
+        std::shared_ptr<std::atomic<std::size_t>> count; ///< Active timer count, shared with the scheduler.
+    };
+
+    /**
+     * @brief Tasks posted to the pool, kept alive by them until they signal the destructor.
+     */
+    struct PoolTasks
+    {
+        std::atomic<std::size_t> running{0}; ///< Tasks posted and not yet finished.
+        Wait done{};                         ///< Wait channel of the destructor.
+    };
+
+    const Settings m_settings;                               ///< Scheduler settings.
+    const Clock::duration m_tick;                            ///< Length of a tick.
+    const Clock::time_point m_origin;                        ///< Start of tick zero.
+    std::mutex m_lock;                                       ///< Guards the wheels and the current tick.
+    std::array<std::array<Slot, SLOTS>, LEVELS> m_wheel;     ///< Slots of every wheel.
+    uint64_t m_current{0};                                   ///< Next tick to expire.
+    std::size_t m_stored{0};                                 ///< Entries in the wheels, cancelled ones included.
+    std::atomic<uint64_t> m_sleep_until{NO_TICK};            ///< Tick the timer thread sleeps until, `NO_TICK` for ever.
+    std::atomic<bool> m_rearm{false};                        ///< Flag waking the timer thread for an earlier timer.
+    std::atomic<bool> m_stopping{false};                     ///< Flag telling the timer thread to exit.
+    const std::shared_ptr<std::atomic<std::size_t>> m_count; ///< Tasks scheduled and not yet cancelled or run once.
+    const std::shared_ptr<PoolTasks> m_pool_tasks;           ///< Tasks running in the pool, shared with them.
+    Wait m_wakeup{};                                         ///< Wait channel of the timer thread.
+    std::vector<EntryPtr> m_expired{};                       ///< Entries expired by the last step, reused.
+    Thread m_thread;                                         ///< Timer thread.
+
+    /**
+     * @brief Create the entry of a task and arm it.
+     */
+    Token schedule(const Clock::time_point deadline, const Clock::duration period, const Period mode, Task task);
+    void arm(const EntryPtr& entry);                             ///< Insert an entry, waking the timer thread if it sleeps past it.
+    void step();                                                 ///< Expire the elapsed ticks, run their tasks and sleep.
+    void advanceLocked();                                        ///< Cascade and expire the slots of the current tick.
+    void insertLocked(const EntryPtr& entry);                    ///< Place an entry in the wheel covering its expiry.
+    uint64_t nextTickLocked() const;                             ///< Earliest tick that may have work.
+    void dispatch(const EntryPtr& entry);                        ///< Run or post the task of an expired entry.
+    void execute(const EntryPtr& entry);                         ///< Run the task and re-arm a periodic entry.
+    void rearm(const EntryPtr& entry);                           ///< Put a periodic entry back for its next run.
+    uint64_t tickAtOrAfter(const Clock::time_point time) const;  ///< First tick starting at or after a time.
+    uint64_t tickAtOrBefore(const Clock::time_point time) const; ///< Tick containing a time.
+    Clock::time_point timeOf(const uint64_t tick) const;         ///< Start of a tick.
+};
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,842 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/object_pool.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Lock-free unbounded multi-producer/multi-consumer queue made of linked segments.
+ *
+ * The SegmentedQueue class offers the same API and `Settings` semantics as `Queue`, for the unbounded
+ * channels where `MpmcQueue` would need a capacity up front. Elements live in a linked list of segments of
+ * `SEGMENT_SIZE` slots. Producers claim a slot by advancing the tail index and consumers by advancing the
+ * head index, so both sides only contend on their own index; the pointer to the next segment is only
+ * written by the producer of the last slot of a segment. A segment is returned to an `ObjectPool` by
+ * the last consumer leaving it, so a steady flow of elements reuses the same few segments instead of
+ * reaching the allocator.
+ *
+ * A bounded `Settings::size` is honored against an approximate length, which concurrent producers may
+ * overshoot by one element each.
+ *
+ * @tparam T Type of elements stored in the queue.
+ */
+template<typename T>
+class SegmentedQueue
+{
+public:
+    using DiscardedCallback = typename Queue<T>::DiscardedCallback;
+    using Discard = typename Queue<T>::Discard;
+    using Control = typename Queue<T>::Control;
+    using Settings = typename Queue<T>::Settings;
+    static constexpr uint32_t WAIT_FOREVER = Queue<T>::WAIT_FOREVER;
+    static constexpr std::size_t SEGMENT_SIZE{31}; ///< Elements per segment.
+
+    /**
+     * @brief Constructor that accepts queue settings.
+     * @param settings Settings to configure the queue behavior.
+     */
+    explicit SegmentedQueue(const Settings& settings);
+
+    /**
+     * @brief Destructor that signal a exit waiting operation and destroys the remaining elements.
+     */
+    ~SegmentedQueue();
+
+    // Make this class uncopyable
+    UNCOPYABLE(SegmentedQueue);
+
+    /**
+     * @brief Set the callback for discarded elements.
+     * @param discarded_callback Function to be called when an element is discarded.
+     */
+    void setDiscardedCallback(DiscardedCallback discarded_callback);
+
+    /**
+     * @brief Open the queue for push operations.
+     */
+    void openPush();
+
+    /**
+     * @brief Close the queue for push operations.
+     */
+    void closePush();
+
+    /**
+     * @brief Open the queue for pop operations.
+     */
+    void openPop();
+
+    /**
+     * @brief Close the queue for pop operations.
+     */
+    void closePop();
+
+    /**
+     * @brief Attempts to push an element into the queue with an optional timeout.
+     *
+     * Discard policies behave as in `Queue::push`. An unbounded queue never waits for room.
+     *
+     * @param elem The element to push into the queue.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` if the queue was full and no discard
+     *         was allowed, or if the queue was closed for push operations.
+     */
+    bool push(const T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to move an element into the queue with an optional timeout.
+     * @param elem The element to move into the queue.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    bool push(T&& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Constructs an element in place in a segment, waiting forever for room if needed.
+     *
+     * The arguments are only consumed once a slot has been claimed.
+     *
+     * @tparam Args Types of the arguments forwarded to the constructor of `T`.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool emplace(Args&&... args);
+
+    /**
+     * @brief Attempts to pop an element from the queue with an optional timeout.
+     *
+     * @param elem Reference where the popped element will be stored.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` if the queue was
+     *         empty and the timeout was reached or the queue was closed for pop operations.
+     */
+    bool pop(T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Pops an element from the queue without blocking.
+     *
+     * The element is move-constructed out of its segment.
+     *
+     * @return The popped element, or `std::nullopt` if the queue was empty or closed for pop operations.
+     */
+    std::optional<T> tryPop();
+
+    /**
+     * @brief Waits until the queue is open for pushing or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for push operations within the timeout period, `false` otherwise.
+     */
+    bool waitPushOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Waits until the queue is open for popping or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for pop operations within the timeout period, `false` otherwise.
+     */
+    bool waitPopOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Returns the maximum number of elements the queue holds.
+     * @return `Settings::size`, the maximum of `std::size_t` when unbounded.
+     */
+    std::size_t capacity() const;
+
+    /**
+     * @brief Returns the number of elements in the queue, exact only while no operation is in progress.
+     * @return The number of elements.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Returns the number of segments allocated so far, in use or waiting for reuse.
+     * @return The number of segments.
+     */
+    std::size_t allocatedSegments() const;
+
+private:
+    using Clock = Wait::Clock;
+
+    /**
+     * @brief Bits telling how far the element of a slot went.
+     */
+    enum SlotState : uint8_t
+    {
+        WRITTEN = 1, ///< The producer constructed the element.
+        READ = 2,    ///< The consumer destroyed the element.
+        DESTROY = 4  ///< The consumer of a later slot left the release of the segment to this slot.
+    };
+
+    /**
+     * @brief One element of a segment with its state.
+     */
+    struct Slot
+    {
+        std::atomic<uint8_t> state{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    /**
+     * @brief Fixed-size array of slots, linked to the segment filled after it.
+     */
+    struct Segment
+    {
+        std::atomic<Segment*> next{nullptr}; ///< Next segment, set once the last slot is claimed.
+        Slot slots[SEGMENT_SIZE];            ///< Element storage.
+    };
+
+    // An index counts positions in its bits from `SHIFT` up, `LAP` positions per segment: the last one of
+    // each lap has no slot and marks a segment being installed. The lowest bit of the head index is set once
+    // the head segment is known to have a successor, so consumers stop checking the tail for it.
+    static constexpr std::size_t LAP{SEGMENT_SIZE + 1};
+    static constexpr std::size_t SHIFT{1};
+    static constexpr std::size_t HAS_NEXT{1};
+    static constexpr std::size_t STEP{std::size_t{1} << SHIFT};
+
+    // Rarely changing state shared by both sides.
+    const Settings m_settings;                ///< Queue settings.
+    const std::size_t m_capacity;             ///< Maximum number of elements.
+    ObjectPool<Segment> m_segments;           ///< Storage of the segments, recycled once drained.
+    std::atomic<bool> m_open_push{false};     ///< Flag indicating whether push is open.
+    std::atomic<bool> m_open_pop{false};      ///< Flag indicating whether pop is open.
+    DiscardedCallback m_discarded_callback{}; ///< Callback for discarded elements.
+    Wait m_wait{};                            ///< Wait mechanism for blocking operations.
+
+    // Consumer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_head{0}; ///< Next position to dequeue.
+    std::atomic<Segment*> m_head_segment{nullptr};               ///< Segment of the head position.
+    std::atomic<uint32_t> m_pop_waiters{0};                      ///< Number of threads blocked in pop.
+
+    // Producer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail{0}; ///< Next position to enqueue.
+    std::atomic<Segment*> m_tail_segment{nullptr};               ///< Segment of the tail position.
+    std::atomic<uint32_t> m_push_waiters{0};                     ///< Number of threads blocked in push.
+
+    void onDiscarded(const T& elem);                         ///< Handle discarded elements.
+    bool pushControllable() const;                           ///< Check if push is controllable.
+    bool popControllable() const;                            ///< Check if pop is controllable.
+    bool waitToPush(const Clock::time_point deadline);       ///< Wait for push availability.
+    bool waitToPop(const Clock::time_point deadline);        ///< Wait for pop availability.
+    bool bounded() const;                                    ///< Check whether `Settings::size` limits the queue.
+    bool full() const;                                       ///< Check whether a bounded queue looks full.
+    bool empty() const;                                      ///< Check whether the queue looks empty.
+    T* slotValue(Slot& slot) const;                          ///< Element storage of a slot.
+    void release(Segment* segment, const std::size_t start); ///< Recycle a segment once the slots from `start` are read.
+    void notifyPush();                                       ///< Wake blocked producers if there are any.
+    void notifyPop();                                        ///< Wake blocked consumers if there are any.
+    static Clock::time_point deadline(const uint32_t ms);    ///< Convert a timeout to a deadline, `Wait::NO_DEADLINE` for `WAIT_FOREVER`.
+
+    /**
+     * @brief Internal push method constructing the element from `args`.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool enqueue(const uint32_t timeout_ms, Args&&... args);
+
+    /**
+     * @brief Non-blocking push.
+     * @param args Arguments forwarded to the constructor of `T` once a slot is claimed.
+     * @return `true` if the element was pushed, `false` if a bounded queue was full.
+     */
+    template<typename... Args>
+    bool tryEnqueue(Args&&... args);
+
+    /**
+     * @brief Non-blocking pop.
+     * @param consume Callable receiving the claimed element to move it out; it is destroyed afterwards.
+     * @return `true` if an element was claimed, `false` if the queue was empty.
+     */
+    template<typename F>
+    bool dequeue(F&& consume);
+
+    /**
+     * @brief Hand an element that was never inserted to the discarded callback.
+     * @param args The element, or the arguments to construct it from.
+     */
+    template<typename... Args>
+    void discardNewest(Args&&... args);
+};
+
+template<typename T>
+SegmentedQueue<T>::SegmentedQueue(const Settings& settings)
+    : m_settings{settings}
+    , m_capacity{settings.size == 0 ? 1 : settings.size}
+    , m_segments{typename ObjectPool<Segment>::Settings{16, 4}}
+    , m_wait{settings.wait_strategy}
+{
+    Segment* first{m_segments.create()};
+    m_head_segment.store(first, std::memory_order_relaxed);
+    m_tail_segment.store(first, std::memory_order_relaxed);
+    if (!pushControllable())
+    {
+        m_open_push.store(true, std::memory_order_release);
+    }
+    if (!popControllable())
+    {
+        m_open_pop.store(true, std::memory_order_release);
+    }
+}
+
+template<typename T>
+SegmentedQueue<T>::~SegmentedQueue()
+{
+    m_open_pop.store(false, std::memory_order_release);
+    m_open_push.store(false, std::memory_order_release);
+    m_wait.notify();
+
+    std::size_t head{m_head.load(std::memory_order_acquire) & ~HAS_NEXT};
+    const std::size_t tail{m_tail.load(std::memory_order_acquire)};
+    Segment* segment{m_head_segment.load(std::memory_order_acquire)};
+    for (; head != tail; head += STEP)
+    {
+        const std::size_t offset{(head >> SHIFT) % LAP};
+        if (offset < SEGMENT_SIZE)
+        {
+            slotValue(segment->slots[offset])->~T();
+        }
+        else
+        {
+            Segment* next{segment->next.load(std::memory_order_acquire)};
+            m_segments.destroy(segment);
+            segment = next;
+        }
+    }
+    m_segments.destroy(segment);
+}
+
+template<typename T>
+void SegmentedQueue<T>::setDiscardedCallback(DiscardedCallback discarded_callback)
+{
+    m_discarded_callback = discarded_callback;
+}
+
+template<typename T>
+void SegmentedQueue<T>::onDiscarded(const T& elem)
+{
+    if (m_discarded_callback)
+    {
+        m_discarded_callback(elem);
+    }
+}
+
+template<typename T>
+std::size_t SegmentedQueue<T>::capacity() const
+{
+    return m_capacity;
+}
+
+template<typename T>
+std::size_t SegmentedQueue<T>::size() const
+{
+    while (true)
+    {
+        std::size_t tail{m_tail.load(std::memory_order_seq_cst)};
+        std::size_t head{m_head.load(std::memory_order_seq_cst) & ~HAS_NEXT};
+        if (m_tail.load(std::memory_order_seq_cst) != tail)
+        {
+            continue;
+        }
+        // Positions on the end of a lap stand for the first one of the next lap.
+        if ((tail >> SHIFT) % LAP == LAP - 1)
+        {
+            tail += STEP;
+        }
+        if ((head >> SHIFT) % LAP == LAP - 1)
+        {
+            head += STEP;
+        }
+        // Rotate both positions so that the head falls into the first lap, then leave out the lap ends.
+        const std::size_t lap{(head >> SHIFT) / LAP};
+        tail = (tail - ((lap * LAP) << SHIFT)) >> SHIFT;
+        head = (head - ((lap * LAP) << SHIFT)) >> SHIFT;
+        return tail - head - tail / LAP;
+    }
+}
+
+template<typename T>
+std::size_t SegmentedQueue<T>::allocatedSegments() const
+{
+    return m_segments.capacity();
+}
+
+template<typename T>
+bool SegmentedQueue<T>::push(const T& elem, const uint32_t timeout_ms)
+{
+    return enqueue(timeout_ms, elem);
+}
+
+template<typename T>
+bool SegmentedQueue<T>::push(T&& elem, const uint32_t timeout_ms)
+{
+    return enqueue(timeout_ms, std::move(elem));
+}
+
+template<typename T>
+template<typename... Args>
+bool SegmentedQueue<T>::emplace(Args&&... args)
+{
+    return enqueue(WAIT_FOREVER, std::forward<Args>(args)...);
+}
+
+template<typename T>
+template<typename... Args>
+bool SegmentedQueue<T>::enqueue(const uint32_t timeout_ms, Args&&... args)
+{
+    const Clock::time_point push_deadline{deadline(timeout_ms)};
+    while (true)
+    {
+        if (!waitToPush(push_deadline))
+        {
+            return false;
+        }
+        if (tryEnqueue(std::forward<Args>(args)...))
+        {
+            notifyPop();
+            return true;
+        }
+        if (m_settings.discard == Discard::DISCARD_NEWEST)
+        {
+            discardNewest(std::forward<Args>(args)...);
+            return false;
+        }
+        if (m_settings.discard == Discard::DISCARD_OLDEST)
+        {
+            std::optional<T> discarded_elem{};
+            if (dequeue([&discarded_elem](T& oldest)
+                        { discarded_elem.emplace(std::move(oldest)); }))
+            {
+                onDiscarded(*discarded_elem);
+            }
+        }
+    }
+}
+
+template<typename T>
+template<typename... Args>
+void SegmentedQueue<T>::discardNewest(Args&&... args)
+{
+    if (!m_discarded_callback)
+    {
+        return;
+    }
+    if constexpr (sizeof...(Args) == 1 && std::conjunction_v<std::is_same<std::decay_t<Args>, T>...>)
+    {
+        onDiscarded(args...);
+    }
+    else
+    {
+        onDiscarded(T(std::forward<Args>(args)...));
+    }
+}
+
+template<typename T>
+bool SegmentedQueue<T>::pop(T& elem, const uint32_t timeout_ms)
+{
+    const Clock::time_point pop_deadline{deadline(timeout_ms)};
+    while (true)
+    {
+        if (!waitToPop(pop_deadline))
+        {
+            return false;
+        }
+        if (dequeue([&elem](T& value)
+                    { elem = std::move(value); }))
+        {
+            notifyPush();
+            return true;
+        }
+    }
+}
+
+template<typename T>
+std::optional<T> SegmentedQueue<T>::tryPop()
+{
+    std::optional<T> elem{};
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return elem;
+    }
+    if (dequeue([&elem](T& value)
+                { elem.emplace(std::move(value)); }))
+    {
+        notifyPush();
+    }
+    return elem;
+}
+
+template<typename T>
+template<typename... Args>
+bool SegmentedQueue<T>::tryEnqueue(Args&&... args)
+{
+    if (full())
+    {
+        return false;
+    }
+    std::size_t tail{m_tail.load(std::memory_order_acquire)};
+    Segment* segment{m_tail_segment.load(std::memory_order_acquire)};
+    Segment* next{nullptr};
+    while (true)
+    {
+        const std::size_t offset{(tail >> SHIFT) % LAP};
+        if (offset == SEGMENT_SIZE)
+        {
+            // The producer of the last slot is installing the next segment.
+            std::this_thread::yield();
+            tail = m_tail.load(std::memory_order_acquire);
+            segment = m_tail_segment.load(std::memory_order_acquire);
+            continue;
+        }
+        if (offset + 1 == SEGMENT_SIZE && next == nullptr)
+        {
+            // Allocated before claiming the last slot, so that the other producers wait as little as possible.
+            next = m_segments.create();
+        }
+        if (m_tail.compare_exchange_weak(tail, tail + STEP, std::memory_order_seq_cst, std::memory_order_acquire))
+        {
+            if (offset + 1 == SEGMENT_SIZE)
+            {
+                m_tail_segment.store(next, std::memory_order_release);
+                m_tail.fetch_add(STEP, std::memory_order_release);
+                segment->next.store(next, std::memory_order_release);
+            }
+            else if (next != nullptr)
+            {
+                m_segments.destroy(next);
+            }
+            Slot& slot{segment->slots[offset]};
+            new (slotValue(slot)) T(std::forward<Args>(args)...);
+            slot.state.fetch_or(WRITTEN, std::memory_order_release);
+            return true;
+        }
+        segment = m_tail_segment.load(std::memory_order_acquire);
+    }
+}
+
+template<typename T>
+template<typename F>
+bool SegmentedQueue<T>::dequeue(F&& consume)
+{
+    std::size_t head{m_head.load(std::memory_order_acquire)};
+    Segment* segment{m_head_segment.load(std::memory_order_acquire)};
+    while (true)
+    {
+        const std::size_t offset{(head >> SHIFT) % LAP};
+        if (offset == SEGMENT_SIZE)
+        {
+            // The consumer of the last slot is moving the head to the next segment.
+            std::this_thread::yield();
+            head = m_head.load(std::memory_order_acquire);
+            segment = m_head_segment.load(std::memory_order_acquire);
+            continue;
+        }
+        std::size_t new_head{head + STEP};
+        if ((new_head & HAS_NEXT) == 0)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+            if ((head >> SHIFT) == (tail >> SHIFT))
+            {
+                return false;
+            }
+            if ((head >> SHIFT) / LAP != (tail >> SHIFT) / LAP)
+            {
+                new_head |= HAS_NEXT;
+            }
+        }
+        if (m_head.compare_exchange_weak(head, new_head, std::memory_order_seq_cst, std::memory_order_acquire))
+        {
+            if (offset + 1 == SEGMENT_SIZE)
+            {
+                Segment* next{segment->next.load(std::memory_order_acquire)};
+                while (next == nullptr)
+                {
+                    std::this_thread::yield();
+                    next = segment->next.load(std::memory_order_acquire);
+                }
+                std::size_t next_head{(new_head & ~HAS_NEXT) + STEP};
+                if (next->next.load(std::memory_order_relaxed) != nullptr)
+                {
+                    next_head |= HAS_NEXT;
+                }
+                m_head_segment.store(next, std::memory_order_release);
+                m_head.store(next_head, std::memory_order_release);
+            }
+
+            Slot& slot{segment->slots[offset]};
+            while ((slot.state.load(std::memory_order_acquire) & WRITTEN) == 0)
+            {
+                // The producer claimed the slot but has not constructed its element yet.
+                std::this_thread::yield();
+            }
+            T* value{slotValue(slot)};
+            consume(*value);
+            value->~T();
+
+            if (offset + 1 == SEGMENT_SIZE)
+            {
+                release(segment, 0);
+            }
+            else if ((slot.state.fetch_or(READ, std::memory_order_acq_rel) & DESTROY) != 0)
+            {
+                release(segment, offset + 1);
+            }
+            return true;
+        }
+        segment = m_head_segment.load(std::memory_order_acquire);
+    }
+}
+
+template<typename T>
+void SegmentedQueue<T>::release(Segment* segment, const std::size_t start)
+{
+    // The last slot is read last, by the consumer that starts the release.
+    for (std::size_t index = start; index + 1 < SEGMENT_SIZE; ++index)
+    {
+        Slot& slot{segment->slots[index]};
+        if ((slot.state.load(std::memory_order_acquire) & READ) == 0
+            && (slot.state.fetch_or(DESTROY, std::memory_order_acq_rel) & READ) == 0)
+        {
+            // Still being read, its consumer carries on from there.
+            return;
+        }
+    }
+    m_segments.destroy(segment);
+}
+
+template<typename T>
+bool SegmentedQueue<T>::bounded() const
+{
+    return m_capacity != std::numeric_limits<std::size_t>::max();
+}
+
+template<typename T>
+bool SegmentedQueue<T>::full() const
+{
+    return bounded() && size() >= m_capacity;
+}
+
+template<typename T>
+bool SegmentedQueue<T>::empty() const
+{
+    const std::size_t head{m_head.load(std::memory_order_acquire)};
+    const std::size_t tail{m_tail.load(std::memory_order_acquire)};
+    return (head >> SHIFT) == (tail >> SHIFT);
+}
+
+template<typename T>
+T* SegmentedQueue<T>::slotValue(Slot& slot) const
+{
+    return std::launder(reinterpret_cast<T*>(slot.storage));
+}
+
+template<typename T>
+void SegmentedQueue<T>::notifyPush()
+{
+    if (!bounded())
+    {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_push_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        m_wait.notify();
+    }
+}
+
+template<typename T>
+void SegmentedQueue<T>::notifyPop()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_pop_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        m_wait.notify();
+    }
+}
+
+template<typename T>
+typename SegmentedQueue<T>::Clock::time_point SegmentedQueue<T>::deadline(const uint32_t ms)
+{
+    if (ms == WAIT_FOREVER)
+    {
+        return Wait::NO_DEADLINE;
+    }
+    return Wait::deadlineAfter(std::chrono::milliseconds(ms));
+}
+
+template<typename T>
+bool SegmentedQueue<T>::pushControllable() const
+{
+    if (m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::PUSH)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+bool SegmentedQueue<T>::popControllable() const
+{
+    if (m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::POP)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+void SegmentedQueue<T>::openPush()
+{
+    if (!pushControllable())
+    {
+        return;
+    }
+    m_open_push.store(true, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void SegmentedQueue<T>::closePush()
+{
+    if (!pushControllable())
+    {
+        return;
+    }
+    m_open_push.store(false, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void SegmentedQueue<T>::openPop()
+{
+    if (!popControllable())
+    {
+        return;
+    }
+    m_open_pop.store(true, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void SegmentedQueue<T>::closePop()
+{
+    if (!popControllable())
+    {
+        return;
+    }
+    m_open_pop.store(false, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+bool SegmentedQueue<T>::waitToPush(const Clock::time_point deadline)
+{
+    if (!m_open_push.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    if (m_settings.discard != Discard::NO_DISCARD || !full())
+    {
+        return true;
+    }
+
+    auto closed_or_not_full_pred = [&]() -> bool
+    {
+        if (!m_open_push.load(std::memory_order_acquire) || !full())
+        {
+            return true;
+        }
+        return false;
+    };
+
+    m_push_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Wait::Status result{m_wait.waitUntil(deadline, closed_or_not_full_pred)};
+    m_push_waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (result != Wait::Status::SUCCESS || !m_open_push.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool SegmentedQueue<T>::waitToPop(const Clock::time_point deadline)
+{
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    if (!empty())
+    {
+        return true;
+    }
+
+    auto closed_or_not_empty_pred = [&]() -> bool
+    {
+        if (!m_open_pop.load(std::memory_order_acquire) || !empty())
+        {
+            return true;
+        }
+        return false;
+    };
+
+    m_pop_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Wait::Status result{m_wait.waitUntil(deadline, closed_or_not_empty_pred)};
+    m_pop_waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (result != Wait::Status::SUCCESS || !m_open_pop.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool SegmentedQueue<T>::waitPushOpen(const uint32_t timeout_ms)
+{
+    Wait::Status result{
+        m_wait.waitUntil(deadline(timeout_ms), [this]() -> bool
+                         { return m_open_push.load(std::memory_order_acquire); })};
+    if (result != Wait::Status::SUCCESS)
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool SegmentedQueue<T>::waitPopOpen(const uint32_t timeout_ms)
+{
+    Wait::Status result{
+        m_wait.waitUntil(deadline(timeout_ms), [this]() -> bool
+                         { return m_open_pop.load(std::memory_order_acquire); })};
+    if (result != Wait::Status::SUCCESS)
+    {
+        return false;
+    }
+    return true;
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Blocks a single thread until any of several queues has elements, like `epoll` for queues.
+ *
+ * Queues of any element type are registered with `add`, which hooks the selector's own `Wait` into the
+ * queue's observers, so every push, open and close wakes the selector. `wait` then blocks once for all of
+ * them and reports which are ready to pop. Supported queues provide `readyToPop`, `addObserver` and
+ * `removeObserver`, such as `Queue` and `PriorityQueue`.
+ *
+ * A registered queue must outlive its registration: remove it, or destroy the selector, first.
+ */
+class Selector
+{
+public:
+    static constexpr uint32_t WAIT_FOREVER = std::numeric_limits<uint32_t>::max();
+    static constexpr std::size_t NONE{static_cast<std::size_t>(-1)};
+
+    /**
+     * @brief Constructor selecting the strategy used before blocking.
+     * @param strategy The wait strategy of the selector.
+     */
+    explicit Selector(const Wait::Strategy strategy = Wait::Strategy::BLOCK);
+
+    /**
+     * @brief Destructor that unregisters from every queue.
+     */
+    ~Selector();
+
+    // Make this class uncopyable
+    UNCOPYABLE(Selector);
+
+    /**
+     * @brief Register a queue.
+     * @tparam Q Type of the queue.
+     * @param queue The queue to watch.
+     * @return The index identifying the queue in the results of `wait` and `waitAny`.
+     */
+    template<typename Q>
+    std::size_t add(Q& queue)
+    {
+        queue.addObserver(m_wait);
+        return addSource(Source{[&queue]() -> bool
+                                { return queue.readyToPop(); },
+                                [&queue](Wait& wait)
+                                { queue.removeObserver(wait); }});
+    }
+
+    /**
+     * @brief Unregister a queue.
+     * @param index The index returned by `add`.
+     * @return `true` if the queue was removed, `false` if the index is not registered.
+     */
+    bool remove(const std::size_t index);
+
+    /**
+     * @brief Block until at least one registered queue is ready to pop or the timeout expires.
+     *
+     * @param ready Receives the indices of the ready queues, in ascending order.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return The number of ready queues, `0` on timeout.
+     */
+    std::size_t wait(std::vector<std::size_t>& ready, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Block until one registered queue is ready to pop or the timeout expires.
+     *
+     * Successive calls start looking from the queue after the last one returned, so a busy queue
+     * cannot starve the others.
+     *
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return The index of a ready queue, or `NONE` on timeout.
+     */
+    std::size_t waitAny(const uint32_t timeout_ms = WAIT_FOREVER);
+
+private:
+    /**
+     * @brief Type-erased registered queue.
+     */
+    struct Source
+    {
+        std::function<bool()> ready{};       ///< Whether the queue is ready to pop.
+        std::function<void(Wait&)> detach{}; ///< Remove the selector from the queue observers.
+    };
+
+    Wait m_wait;                     ///< Channel notified by every registered queue.
+    std::mutex m_lock{};             ///< Guards `m_sources`.
+    std::vector<Source> m_sources{}; ///< Registered queues, empty entries once removed.
+    std::size_t m_next{0};           ///< First index examined by the next `waitAny`.
+
+    std::size_t addSource(Source source); ///< Store a source and return its index.
+};
+
+} // namespace threadsafe
+} // namespace trlc
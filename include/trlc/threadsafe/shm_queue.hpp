@@ -0,0 +1,858 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Named region of memory shared between processes, `shm_open` on POSIX and a file mapping on Windows.
+ *
+ * The region outlives the processes mapping it on POSIX, until `remove` is called. Windows releases it
+ * with its last handle.
+ */
+class SharedMemory
+{
+public:
+    SharedMemory() = default;
+
+    /**
+     * @brief Destructor that unmaps the region, which stays available to the other processes.
+     */
+    ~SharedMemory();
+
+    // Make this class uncopyable
+    UNCOPYABLE(SharedMemory);
+
+    /**
+     * @brief Map a region, creating it with the given size if it does not exist yet.
+     * @param name The name of the region, without a leading slash.
+     * @param bytes The size of the region when it is created; an existing region is mapped whole.
+     * @return `true` if the region was mapped, `false` otherwise.
+     */
+    bool open(const std::string& name, const std::size_t bytes);
+
+    /**
+     * @brief Unmap the region.
+     */
+    void close();
+
+    /**
+     * @brief Returns the mapped memory.
+     * @return The start of the region, `nullptr` if it is not mapped.
+     */
+    void* data() const;
+
+    /**
+     * @brief Returns the size of the mapping.
+     * @return The number of bytes mapped.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Check whether the last `open` created the region.
+     * @return `true` if the region was created, `false` if it already existed.
+     */
+    bool created() const;
+
+    /**
+     * @brief Remove a region by name. Processes that mapped it keep their mapping.
+     * @param name The name of the region.
+     * @return `true` if the region was removed, `false` if it did not exist.
+     */
+    static bool remove(const std::string& name);
+
+private:
+    void* m_data{nullptr}; ///< Start of the mapping.
+    std::size_t m_size{0}; ///< Size of the mapping.
+    bool m_created{false}; ///< Whether the region was created by `open`.
+#ifdef _WIN32
+    void* m_handle{nullptr}; ///< Handle of the file mapping.
+#endif
+};
+
+namespace detail
+{
+
+/**
+ * @brief Block until a 32-bit word shared between processes no longer holds a value, or a deadline.
+ *
+ * A futex on Linux. `WaitOnAddress` does not cross process boundaries, so Windows sleeps for a
+ * millisecond instead. May return early; callers check their condition again.
+ *
+ * @param word The word, in shared memory.
+ * @param expected The value the word had when the caller last checked its condition.
+ * @param deadline The deadline, `Wait::NO_DEADLINE` to wait forever.
+ */
+void sharedWait(std::atomic<uint32_t>& word, const uint32_t expected, const Wait::Clock::time_point deadline);
+
+/**
+ * @brief Wake every process blocked in `sharedWait` on a word.
+ * @param word The word, in shared memory.
+ */
+void sharedWake(std::atomic<uint32_t>& word);
+
+/**
+ * @brief Header at the start of the region of a `ShmQueue`, followed by the slots.
+ */
+struct ShmQueueHeader
+{
+    static constexpr uint64_t READY{0x74726c6373686d71}; ///< Magic value set once the header is initialized.
+    static constexpr uint32_t VERSION{1};                ///< Layout version.
+
+    // Written once by the creator.
+    std::atomic<uint64_t> magic{0};     ///< `READY` once the creator initialized the region.
+    uint32_t version{0};                ///< Layout version of the creator.
+    uint32_t slot_size{0};              ///< Size of a slot, which tells both sides agree on `T`.
+    uint64_t capacity{0};               ///< Maximum number of elements.
+    uint64_t mask{0};                   ///< Mask mapping a position to a slot.
+    uint32_t discard{0};                ///< Discard policy of the creator.
+    uint32_t control{0};                ///< Control policy of the creator.
+    std::atomic<uint32_t> open_push{0}; ///< Non-zero while push is open.
+    std::atomic<uint32_t> open_pop{0};  ///< Non-zero while pop is open.
+
+    // Consumer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{0}; ///< Next position to dequeue.
+    std::atomic<uint32_t> pop_waiters{0};                   ///< Threads of any process blocked in pop.
+    std::atomic<uint32_t> pop_event{0};                     ///< Word consumers block on, bumped to wake them.
+
+    // Producer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail{0}; ///< Next position to enqueue.
+    std::atomic<uint32_t> push_waiters{0};                  ///< Threads of any process blocked in push.
+    std::atomic<uint32_t> push_event{0};                    ///< Word producers block on, bumped to wake them.
+};
+
+/**
+ * @brief Slots start on the cache line following the header.
+ */
+inline constexpr std::size_t SHM_QUEUE_SLOTS_OFFSET{(sizeof(ShmQueueHeader) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE};
+
+/**
+ * @brief Layout and initial state of a `ShmQueue` region, used by the process that creates it.
+ */
+struct ShmQueueLayout
+{
+    uint32_t slot_size{0}; ///< Size of a slot, starting with its 64-bit sequence number.
+    uint64_t capacity{0};  ///< Maximum number of elements.
+    uint32_t discard{0};   ///< Discard policy.
+    uint32_t control{0};   ///< Control policy.
+    bool open_push{false}; ///< Whether push starts open.
+    bool open_pop{false};  ///< Whether pop starts open.
+};
+
+/**
+ * @brief Map the region of a `ShmQueue`, creating and initializing it if it does not exist yet.
+ *
+ * The creator sets the sequence number of each slot to its index. An existing region is only accepted
+ * once its creator has published it, and if its slots have the same size.
+ *
+ * @param memory The mapping to open.
+ * @param name The name of the region.
+ * @param layout The layout of the region when it is created.
+ * @return The header, or `nullptr` if the region could not be mapped or has another layout.
+ */
+ShmQueueHeader* attachShmQueue(SharedMemory& memory, const std::string& name, const ShmQueueLayout& layout);
+
+} // namespace detail
+
+/**
+ * @brief Lock-free bounded multi-producer/multi-consumer queue shared between processes.
+ *
+ * The ShmQueue class keeps the ring of `MpmcQueue`, its indices, open flags and policies in a named
+ * `SharedMemory` region, so that processes exchange trivially copyable elements without serializing them.
+ * The first process to open a name creates the region with its `Settings`; the others attach to it and
+ * follow the capacity, discard and control policies stored there, only `wait_strategy` stays local. The
+ * queue lives on in the region when a process detaches or exits, so a restarted consumer resumes at the
+ * oldest element it had not popped.
+ *
+ * Blocked operations sleep on futex words in the region, woken across processes. A process that dies
+ * in the middle of an operation leaves its slot claimed forever; `remove` the region to start afresh.
+ *
+ * @tparam T Type of elements stored in the queue, trivially copyable.
+ */
+template<typename T>
+class ShmQueue
+{
+    static_assert(std::is_trivially_copyable_v<T>, "ShmQueue elements are copied between processes byte by byte");
+    static_assert(std::is_default_constructible_v<T>, "ShmQueue elements are popped into a default-constructed T");
+    static_assert(alignof(T) <= CACHE_LINE_SIZE, "ShmQueue slots are aligned to at most a cache line");
+
+public:
+    using DiscardedCallback = typename Queue<T>::DiscardedCallback;
+    using Discard = typename Queue<T>::Discard;
+    using Control = typename Queue<T>::Control;
+    using Settings = typename Queue<T>::Settings;
+    static constexpr uint32_t WAIT_FOREVER = Queue<T>::WAIT_FOREVER;
+    static constexpr std::size_t DEFAULT_CAPACITY{1024}; ///< Capacity used when `Settings::size` is unbounded.
+
+    /**
+     * @brief Constructor that creates the named queue or attaches to it.
+     *
+     * The ring is sized to the next power of two of `settings.size`, `DEFAULT_CAPACITY` when unbounded.
+     * Check `valid` afterwards.
+     *
+     * @param name The name of the shared memory region.
+     * @param settings Settings of the queue when it is created.
+     */
+    ShmQueue(const std::string& name, const Settings& settings);
+
+    /**
+     * @brief Destructor that detaches from the region. The queue and its elements remain for the other processes.
+     */
+    ~ShmQueue();
+
+    // Make this class uncopyable
+    UNCOPYABLE(ShmQueue);
+
+    /**
+     * @brief Remove the region of a queue, so that the next process to open the name creates it again.
+     * @param name The name of the shared memory region.
+     * @return `true` if the region was removed, `false` if it did not exist.
+     */
+    static bool remove(const std::string& name);
+
+    /**
+     * @brief Check whether the region was mapped and holds a queue of `T`.
+     * @return `true` if the queue is usable, `false` otherwise.
+     */
+    bool valid() const;
+
+    /**
+     * @brief Check whether this process created the queue.
+     * @return `true` if the region was created by this instance, `false` if it attached to it.
+     */
+    bool created() const;
+
+    /**
+     * @brief Set the callback for the elements this process discards.
+     * @param discarded_callback Function to be called when an element is discarded.
+     */
+    void setDiscardedCallback(DiscardedCallback discarded_callback);
+
+    /**
+     * @brief Open the queue for push operations, in every process.
+     */
+    void openPush();
+
+    /**
+     * @brief Close the queue for push operations, in every process.
+     */
+    void closePush();
+
+    /**
+     * @brief Open the queue for pop operations, in every process.
+     */
+    void openPop();
+
+    /**
+     * @brief Close the queue for pop operations, in every process.
+     */
+    void closePop();
+
+    /**
+     * @brief Attempts to push an element into the queue with an optional timeout.
+     *
+     * Discard policies behave as in `Queue::push`.
+     *
+     * @param elem The element to push into the queue.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` if the queue was full and no discard
+     *         was allowed, if the queue was closed for push operations or if it is not valid.
+     */
+    bool push(const T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to pop an element from the queue with an optional timeout.
+     *
+     * @param elem Reference where the popped element will be stored.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` if the queue was
+     *         empty and the timeout was reached, if the queue was closed for pop operations or if it is
+     *         not valid.
+     */
+    bool pop(T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Pops an element from the queue without blocking.
+     * @return The popped element, or `std::nullopt` if the queue was empty, closed for pop operations or
+     *         not valid.
+     */
+    std::optional<T> tryPop();
+
+    /**
+     * @brief Waits until the queue is open for pushing or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for push operations within the timeout period, `false` otherwise.
+     */
+    bool waitPushOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Waits until the queue is open for popping or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for pop operations within the timeout period, `false` otherwise.
+     */
+    bool waitPopOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Returns the maximum number of elements the queue holds.
+     * @return The capacity of the queue, 0 if it is not valid.
+     */
+    std::size_t capacity() const;
+
+    /**
+     * @brief Returns the number of elements in the queue, exact only while no operation is in progress.
+     * @return The number of elements.
+     */
+    std::size_t size() const;
+
+private:
+    using Clock = Wait::Clock;
+    using Header = detail::ShmQueueHeader;
+
+    /**
+     * @brief One element of the ring with its sequence number, as in `MpmcQueue`.
+     */
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "ShmQueue needs address-free atomics");
+    static_assert(offsetof(Slot, sequence) == 0, "The creator initializes the sequence at the start of each slot");
+
+    const Wait::Strategy m_wait_strategy;     ///< Strategy of the blocked operations of this process.
+    SharedMemory m_memory{};                  ///< Mapping of the region.
+    Header* m_header{nullptr};                ///< Header of the region, `nullptr` if not valid.
+    Slot* m_slots{nullptr};                   ///< Ring storage.
+    DiscardedCallback m_discarded_callback{}; ///< Callback for discarded elements.
+
+    void onDiscarded(const T& elem);                      ///< Handle discarded elements.
+    bool pushControllable() const;                        ///< Check if push is controllable.
+    bool popControllable() const;                         ///< Check if pop is controllable.
+    bool pushOpen() const;                                ///< Check if push is open.
+    bool popOpen() const;                                 ///< Check if pop is open.
+    bool waitToPush(const Clock::time_point deadline);    ///< Wait for push availability.
+    bool waitToPop(const Clock::time_point deadline);     ///< Wait for pop availability.
+    bool waitNotFull(const Clock::time_point deadline);   ///< Block until the tail slot is free or push closes.
+    bool atCapacity() const;                              ///< Check whether `capacity` positions are claimed and not dequeued.
+    bool full() const;                                    ///< Check whether the ring looks full, also on a slot still in use.
+    bool empty() const;                                   ///< Check whether the ring looks empty.
+    bool tryEnqueue(const T& elem);                       ///< Non-blocking push, `false` if the ring was full.
+    bool dequeue(T& elem);                                ///< Non-blocking pop, `false` if the ring was empty.
+    void notifyAll();                                     ///< Wake the blocked threads of both sides.
+    static Clock::time_point deadline(const uint32_t ms); ///< Convert a timeout to a deadline, `Wait::NO_DEADLINE` for `WAIT_FOREVER`.
+
+    /**
+     * @brief Wake the blocked threads of one side, in any process, if there are any.
+     * @param waiters The waiter count of the side.
+     * @param event The word the side blocks on.
+     */
+    void notify(std::atomic<uint32_t>& waiters, std::atomic<uint32_t>& event);
+
+    /**
+     * @brief Block on the event of one side until a predicate holds.
+     * @param waiters The waiter count of the side.
+     * @param event The word the side blocks on.
+     * @param deadline The deadline.
+     * @param pred The condition to wait for.
+     * @return `true` if the predicate held before the deadline, `false` otherwise.
+     */
+    template<typename Pr>
+    bool block(std::atomic<uint32_t>& waiters, std::atomic<uint32_t>& event, const Clock::time_point deadline, Pr pred);
+};
+
+template<typename T>
+ShmQueue<T>::ShmQueue(const std::string& name, const Settings& settings)
+    : m_wait_strategy{settings.wait_strategy}
+{
+    detail::ShmQueueLayout layout{};
+    layout.slot_size = static_cast<uint32_t>(sizeof(Slot));
+    layout.capacity = settings.size == std::numeric_limits<std::size_t>::max() ? DEFAULT_CAPACITY : (settings.size == 0 ? 1 : settings.size);
+    layout.discard = static_cast<uint32_t>(settings.discard);
+    layout.control = static_cast<uint32_t>(settings.control);
+    layout.open_push = settings.control != Control::FULL_CONTROL && settings.control != Control::PUSH;
+    layout.open_pop = settings.control != Control::FULL_CONTROL && settings.control != Control::POP;
+    m_header = detail::attachShmQueue(m_memory, name, layout);
+    if (m_header != nullptr)
+    {
+        m_slots = std::launder(reinterpret_cast<Slot*>(static_cast<unsigned char*>(m_memory.data()) + detail::SHM_QUEUE_SLOTS_OFFSET));
+    }
+}
+
+template<typename T>
+ShmQueue<T>::~ShmQueue()
+{
+    m_memory.close();
+}
+
+template<typename T>
+bool ShmQueue<T>::remove(const std::string& name)
+{
+    return SharedMemory::remove(name);
+}
+
+template<typename T>
+bool ShmQueue<T>::valid() const
+{
+    return m_header != nullptr;
+}
+
+template<typename T>
+bool ShmQueue<T>::created() const
+{
+    return valid() && m_memory.created();
+}
+
+template<typename T>
+void ShmQueue<T>::setDiscardedCallback(DiscardedCallback discarded_callback)
+{
+    m_discarded_callback = discarded_callback;
+}
+
+template<typename T>
+void ShmQueue<T>::onDiscarded(const T& elem)
+{
+    if (m_discarded_callback)
+    {
+        m_discarded_callback(elem);
+    }
+}
+
+template<typename T>
+std::size_t ShmQueue<T>::capacity() const
+{
+    if (!valid())
+    {
+        return 0;
+    }
+    return static_cast<std::size_t>(m_header->capacity);
+}
+
+template<typename T>
+std::size_t ShmQueue<T>::size() const
+{
+    if (!valid())
+    {
+        return 0;
+    }
+    const uint64_t head{m_header->head.load(std::memory_order_acquire)};
+    const uint64_t tail{m_header->tail.load(std::memory_order_acquire)};
+    return tail > head ? static_cast<std::size_t>(tail - head) : 0;
+}
+
+template<typename T>
+bool ShmQueue<T>::push(const T& elem, const uint32_t timeout_ms)
+{
+    if (!valid())
+    {
+        return false;
+    }
+    const Discard discard{static_cast<Discard>(m_header->discard)};
+    const Clock::time_point push_deadline{deadline(timeout_ms)};
+    while (true)
+    {
+        if (!waitToPush(push_deadline))
+        {
+            return false;
+        }
+        if (tryEnqueue(elem))
+        {
+            notify(m_header->pop_waiters, m_header->pop_event);
+            return true;
+        }
+        if (!atCapacity())
+        {
+            // A consumer still copies out the element of the previous lap, discarding would not free its slot.
+            if (!waitNotFull(push_deadline))
+            {
+                return false;
+            }
+            continue;
+        }
+        if (discard == Discard::DISCARD_NEWEST)
+        {
+            onDiscarded(elem);
+            return false;
+        }
+        if (discard == Discard::DISCARD_OLDEST)
+        {
+            T oldest;
+            if (dequeue(oldest))
+            {
+                onDiscarded(oldest);
+            }
+        }
+    }
+}
+
+template<typename T>
+bool ShmQueue<T>::pop(T& elem, const uint32_t timeout_ms)
+{
+    if (!valid())
+    {
+        return false;
+    }
+    const Clock::time_point pop_deadline{deadline(timeout_ms)};
+    while (true)
+    {
+        if (!waitToPop(pop_deadline))
+        {
+            return false;
+        }
+        if (dequeue(elem))
+        {
+            notify(m_header->push_waiters, m_header->push_event);
+            return true;
+        }
+    }
+}
+
+template<typename T>
+std::optional<T> ShmQueue<T>::tryPop()
+{
+    std::optional<T> elem{};
+    if (!valid() || !popOpen())
+    {
+        return elem;
+    }
+    T value;
+    if (dequeue(value))
+    {
+        elem.emplace(value);
+        notify(m_header->push_waiters, m_header->push_event);
+    }
+    return elem;
+}
+
+template<typename T>
+bool ShmQueue<T>::tryEnqueue(const T& elem)
+{
+    uint64_t pos{m_header->tail.load(std::memory_order_relaxed)};
+    while (true)
+    {
+        const uint64_t head{m_header->head.load(std::memory_order_acquire)};
+        if (head <= pos && pos - head >= m_header->capacity)
+        {
+            return false;
+        }
+        Slot& slot{m_slots[pos & m_header->mask]};
+        const uint64_t sequence{slot.sequence.load(std::memory_order_acquire)};
+        const int64_t diff{static_cast<int64_t>(sequence - pos)};
+        if (diff == 0)
+        {
+            if (m_header->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                std::memcpy(slot.storage, &elem, sizeof(T));
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds the element of the previous lap.
+            return false;
+        }
+        else
+        {
+            pos = m_header->tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+bool ShmQueue<T>::dequeue(T& elem)
+{
+    uint64_t pos{m_header->head.load(std::memory_order_relaxed)};
+    while (true)
+    {
+        Slot& slot{m_slots[pos & m_header->mask]};
+        const uint64_t sequence{slot.sequence.load(std::memory_order_acquire)};
+        const int64_t diff{static_cast<int64_t>(sequence - (pos + 1))};
+        if (diff == 0)
+        {
+            if (m_header->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                std::memcpy(&elem, slot.storage, sizeof(T));
+                slot.sequence.store(pos + m_header->mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The producer of this position has not published its element yet.
+            return false;
+        }
+        else
+        {
+            pos = m_header->head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+bool ShmQueue<T>::atCapacity() const
+{
+    const uint64_t pos{m_header->tail.load(std::memory_order_acquire)};
+    const uint64_t head{m_header->head.load(std::memory_order_acquire)};
+    return head <= pos && pos - head >= m_header->capacity;
+}
+
+template<typename T>
+bool ShmQueue<T>::full() const
+{
+    if (atCapacity())
+    {
+        return true;
+    }
+    const uint64_t pos{m_header->tail.load(std::memory_order_acquire)};
+    const uint64_t sequence{m_slots[pos & m_header->mask].sequence.load(std::memory_order_acquire)};
+    return static_cast<int64_t>(sequence - pos) < 0;
+}
+
+template<typename T>
+bool ShmQueue<T>::empty() const
+{
+    const uint64_t pos{m_header->head.load(std::memory_order_acquire)};
+    const uint64_t sequence{m_slots[pos & m_header->mask].sequence.load(std::memory_order_acquire)};
+    return static_cast<int64_t>(sequence - (pos + 1)) < 0;
+}
+
+template<typename T>
+void ShmQueue<T>::notify(std::atomic<uint32_t>& waiters, std::atomic<uint32_t>& event)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0)
+    {
+        event.fetch_add(1, std::memory_order_release);
+        detail::sharedWake(event);
+    }
+}
+
+template<typename T>
+void ShmQueue<T>::notifyAll()
+{
+    m_header->push_event.fetch_add(1, std::memory_order_seq_cst);
+    m_header->pop_event.fetch_add(1, std::memory_order_seq_cst);
+    detail::sharedWake(m_header->push_event);
+    detail::sharedWake(m_header->pop_event);
+}
+
+template<typename T>
+template<typename Pr>
+bool ShmQueue<T>::block(std::atomic<uint32_t>& waiters, std::atomic<uint32_t>& event, const Clock::time_point deadline, Pr pred)
+{
+    if (m_wait_strategy != Wait::Strategy::BLOCK)
+    {
+        // Polling shared memory is the cheapest hand-over between processes, until the spin budget is spent.
+        const Clock::time_point spin_end{Clock::now() + Wait::MAX_SPIN_DURATION};
+        while (Clock::now() < std::min(spin_end, deadline))
+        {
+            if (pred())
+            {
+                return true;
+            }
+            cpuRelax();
+        }
+    }
+
+    // A notifier bumps the event after changing the state, so a bump between the check and the sleep
+    // makes the sleep return right away.
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+    bool success{false};
+    while (true)
+    {
+        const uint32_t seen{event.load(std::memory_order_seq_cst)};
+        if (pred())
+        {
+            success = true;
+            break;
+        }
+        if (Clock::now() >= deadline)
+        {
+            break;
+        }
+        detail::sharedWait(event, seen, deadline);
+    }
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+    return success;
+}
+
+template<typename T>
+typename ShmQueue<T>::Clock::time_point ShmQueue<T>::deadline(const uint32_t ms)
+{
+    if (ms == WAIT_FOREVER)
+    {
+        return Wait::NO_DEADLINE;
+    }
+    return Wait::deadlineAfter(std::chrono::milliseconds(ms));
+}
+
+template<typename T>
+bool ShmQueue<T>::pushControllable() const
+{
+    const Control control{static_cast<Control>(m_header->control)};
+    if (control == Control::FULL_CONTROL || control == Control::PUSH)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+bool ShmQueue<T>::popControllable() const
+{
+    const Control control{static_cast<Control>(m_header->control)};
+    if (control == Control::FULL_CONTROL || control == Control::POP)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+bool ShmQueue<T>::pushOpen() const
+{
+    return m_header->open_push.load(std::memory_order_acquire) != 0;
+}
+
+template<typename T>
+bool ShmQueue<T>::popOpen() const
+{
+    return m_header->open_pop.load(std::memory_order_acquire) != 0;
+}
+
+template<typename T>
+void ShmQueue<T>::openPush()
+{
+    if (!valid() || !pushControllable())
+    {
+        return;
+    }
+    m_header->open_push.store(1, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T>
+void ShmQueue<T>::closePush()
+{
+    if (!valid() || !pushControllable())
+    {
+        return;
+    }
+    m_header->open_push.store(0, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T>
+void ShmQueue<T>::openPop()
+{
+    if (!valid() || !popControllable())
+    {
+        return;
+    }
+    m_header->open_pop.store(1, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T>
+void ShmQueue<T>::closePop()
+{
+    if (!valid() || !popControllable())
+    {
+        return;
+    }
+    m_header->open_pop.store(0, std::memory_order_release);
+    notifyAll();
+}
+
+template<typename T>
+bool ShmQueue<T>::waitToPush(const Clock::time_point deadline)
+{
+    if (!pushOpen())
+    {
+        return false;
+    }
+    if (static_cast<Discard>(m_header->discard) != Discard::NO_DISCARD || !full())
+    {
+        return true;
+    }
+    return waitNotFull(deadline);
+}
+
+template<typename T>
+bool ShmQueue<T>::waitNotFull(const Clock::time_point deadline)
+{
+    // A discard policy frees room itself once the ring is at capacity.
+    const bool discards{static_cast<Discard>(m_header->discard) != Discard::NO_DISCARD};
+    auto closed_or_not_full_pred = [this, discards]() -> bool
+    { return !pushOpen() || !full() || (discards && atCapacity()); };
+    if (!block(m_header->push_waiters, m_header->push_event, deadline, closed_or_not_full_pred))
+    {
+        return false;
+    }
+    return pushOpen();
+}
+
+template<typename T>
+bool ShmQueue<T>::waitToPop(const Clock::time_point deadline)
+{
+    if (!popOpen())
+    {
+        return false;
+    }
+    if (!empty())
+    {
+        return true;
+    }
+    auto closed_or_not_empty_pred = [this]() -> bool
+    { return !popOpen() || !empty(); };
+    if (!block(m_header->pop_waiters, m_header->pop_event, deadline, closed_or_not_empty_pred))
+    {
+        return false;
+    }
+    return popOpen();
+}
+
+template<typename T>
+bool ShmQueue<T>::waitPushOpen(const uint32_t timeout_ms)
+{
+    if (!valid())
+    {
+        return false;
+    }
+    return block(m_header->push_waiters, m_header->push_event, deadline(timeout_ms), [this]() -> bool
+                 { return pushOpen(); });
+}
+
+template<typename T>
+bool ShmQueue<T>::waitPopOpen(const uint32_t timeout_ms)
+{
+    if (!valid())
+    {
+        return false;
+    }
+    return block(m_header->pop_waiters, m_header->pop_event, deadline(timeout_ms), [this]() -> bool
+                 { return popOpen(); });
+}
+
+} // namespace threadsafe
+} // namespace trlc
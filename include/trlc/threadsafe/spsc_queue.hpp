@@ -0,0 +1,1173 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/numa.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Lock-free bounded single-producer/single-consumer queue.
+ *
+ * The SpscQueue class offers the same API and `Settings` semantics as `Queue`, but it is backed by a
+ * fixed-capacity power-of-two ring allocated once at construction. Exactly one thread may push and exactly
+ * one thread may pop at a time. The producer and consumer indices live on separate cache lines and the
+ * blocking `Wait` is only signaled when the other side is actually waiting.
+ *
+ * @tparam T Type of elements stored in the queue.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    using DiscardedCallback = typename Queue<T>::DiscardedCallback;
+    using Discard = typename Queue<T>::Discard;
+    using Control = typename Queue<T>::Control;
+    using Settings = typename Queue<T>::Settings;
+    static constexpr uint32_t WAIT_FOREVER = Queue<T>::WAIT_FOREVER;
+    static constexpr std::size_t DEFAULT_CAPACITY{1024}; ///< Capacity used when `Settings::size` is unbounded.
+
+    /**
+     * @brief Slot of the ring held between `reserve` and `commit`, or between `peek` and `release`.
+     *
+     * Gives access to the element in place in the ring. Empty when nothing could be reserved or peeked.
+     * It is move-only so that a slot is committed or released once, and it must not outlive its queue.
+     */
+    class Reservation
+    {
+    public:
+        Reservation() = default;
+
+        /**
+         * @brief Destructor that drops a slot neither committed nor released.
+         *
+         * A reserved element is destroyed without being published, a peeked element is released. Like
+         * `commit` and `release`, it must run on the thread that reserved or peeked the slot.
+         */
+        ~Reservation()
+        {
+            if (m_elem != nullptr)
+            {
+                m_queue->drop(*this);
+            }
+        }
+
+        Reservation(Reservation&& other) noexcept
+            : m_queue{other.m_queue}
+            , m_elem{std::exchange(other.m_elem, nullptr)}
+            , m_index{other.m_index}
+            , m_peeked{other.m_peeked}
+        {
+        }
+
+        Reservation& operator=(Reservation&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (m_elem != nullptr)
+                {
+                    m_queue->drop(*this);
+                }
+                m_queue = other.m_queue;
+                m_elem = std::exchange(other.m_elem, nullptr);
+                m_index = other.m_index;
+                m_peeked = other.m_peeked;
+            }
+            return *this;
+        }
+
+        Reservation(const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+
+        explicit operator bool() const
+        {
+            return m_elem != nullptr;
+        }
+
+        T& operator*() const
+        {
+            return *m_elem;
+        }
+
+        T* operator->() const
+        {
+            return m_elem;
+        }
+
+    private:
+        friend class SpscQueue;
+
+        Reservation(SpscQueue* queue, T* elem, const std::size_t index, const bool peeked)
+            : m_queue{queue}
+            , m_elem{elem}
+            , m_index{index}
+            , m_peeked{peeked}
+        {
+        }
+
+        SpscQueue* m_queue{nullptr}; ///< Queue owning the slot.
+        T* m_elem{nullptr};          ///< Element in the ring.
+        std::size_t m_index{0};      ///< Index of the slot.
+        bool m_peeked{false};        ///< Whether the slot was peeked rather than reserved.
+    };
+
+    /**
+     * @brief Constructor that accepts queue settings.
+     *
+     * The ring is sized to the next power of two of `settings.size`. An unbounded size falls back to
+     * `DEFAULT_CAPACITY` because the ring cannot grow after construction.
+     *
+     * @param settings Settings to configure the queue behavior.
+     */
+    explicit SpscQueue(const Settings& settings);
+
+    /**
+     * @brief Destructor that signal a exit waiting operation and destroys the remaining elements.
+     */
+    ~SpscQueue();
+
+    // Make this class uncopyable
+    UNCOPYABLE(SpscQueue);
+
+    /**
+     * @brief Set the callback for discarded elements.
+     * @param discarded_callback Function to be called when an element is discarded.
+     */
+    void setDiscardedCallback(DiscardedCallback discarded_callback);
+
+    /**
+     * @brief Open the queue for push operations.
+     */
+    void openPush();
+
+    /**
+     * @brief Close the queue for push operations.
+     */
+    void closePush();
+
+    /**
+     * @brief Open the queue for pop operations.
+     */
+    void openPop();
+
+    /**
+     * @brief Close the queue for pop operations.
+     */
+    void closePop();
+
+    /**
+     * @brief Attempts to push an element into the queue with an optional timeout.
+     *
+     * Must only be called from the producer thread. Discard policies behave as in `Queue::push`.
+     *
+     * @param elem The element to push into the queue.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` if the queue was full and no discard
+     *         was allowed, or if the queue was closed for push operations.
+     */
+    bool push(const T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to move an element into the queue with an optional timeout.
+     *
+     * Must only be called from the producer thread.
+     *
+     * @param elem The element to move into the queue.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    bool push(T&& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to push an element into the queue, waiting at most `timeout`.
+     * @param elem The element to push into the queue.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool push(const T& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to move an element into the queue, waiting at most `timeout`.
+     * @param elem The element to move into the queue.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool push(T&& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to push an element into the queue, waiting at most until `deadline`.
+     * @param elem The element to push into the queue.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool push(const T& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Attempts to move an element into the queue, waiting at most until `deadline`.
+     * @param elem The element to move into the queue.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool push(T&& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Constructs an element in place in the ring, waiting forever for room if needed.
+     *
+     * Must only be called from the producer thread.
+     *
+     * @tparam Args Types of the arguments forwarded to the constructor of `T`.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was successfully pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool emplace(Args&&... args);
+
+    /**
+     * @brief Reserves the next slot of the ring so that the element is written in place, with an optional timeout.
+     *
+     * Must only be called from the producer thread, with one reservation at a time. The element is
+     * default-initialized, so the storage of a trivial type is handed over as is and no payload is copied.
+     * Control and discard policies behave as in `push`, except that `DISCARD_NEWEST` has no element to hand
+     * to the discarded callback. The consumer does not see the element until `commit`.
+     *
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return The reserved slot, empty if the queue was full and no discard was allowed, or if the queue was
+     *         closed for push operations.
+     */
+    Reservation reserve(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Reserves a slot of the ring, waiting at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return The reserved slot, empty if none could be reserved.
+     */
+    template<class Rep, class Period>
+    Reservation reserve(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Reserves a slot of the ring, waiting at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return The reserved slot, empty if none could be reserved.
+     */
+    template<class C, class Duration>
+    Reservation reserve(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Publishes a reserved slot to the consumer.
+     *
+     * A reservation can be committed even once the queue is closed for push operations. One dropped without
+     * a commit is destroyed unpublished.
+     *
+     * @param reservation The slot returned by `reserve`, empty on return.
+     * @return `true` if the element was published, `false` if the reservation was empty.
+     */
+    bool commit(Reservation& reservation);
+
+    /**
+     * @brief Attempts to pop an element from the queue with an optional timeout.
+     *
+     * Must only be called from the consumer thread.
+     *
+     * @param elem Reference where the popped element will be stored.
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` if the queue was
+     *         empty and the timeout was reached or the queue was closed for pop operations.
+     */
+    bool pop(T& elem, const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Attempts to pop an element from the queue, waiting at most `timeout`.
+     * @param elem Reference where the popped element will be stored.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` otherwise.
+     */
+    template<class Rep, class Period>
+    bool pop(T& elem, const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Attempts to pop an element from the queue, waiting at most until `deadline`.
+     * @param elem Reference where the popped element will be stored.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if an element was successfully popped from the queue, `false` otherwise.
+     */
+    template<class C, class Duration>
+    bool pop(T& elem, const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Pops an element from the queue without blocking.
+     *
+     * Must only be called from the consumer thread. The element is move-constructed out of the ring.
+     *
+     * @return The popped element, or `std::nullopt` if the queue was empty or closed for pop operations.
+     */
+    std::optional<T> tryPop();
+
+    /**
+     * @brief Gives access in place to the oldest element with an optional timeout.
+     *
+     * Must only be called from the consumer thread, with one peeked element at a time and no pop until it
+     * is released.
+     *
+     * @param timeout_ms The maximum time to wait in milliseconds. Defaults to `WAIT_FOREVER`
+     *                   to wait indefinitely.
+     * @return The slot of the oldest element, empty if the queue was empty and the timeout was reached or
+     *         the queue was closed for pop operations.
+     */
+    Reservation peek(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Gives access in place to the oldest element, waiting at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return The slot of the oldest element, empty if none could be peeked.
+     */
+    template<class Rep, class Period>
+    Reservation peek(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Gives access in place to the oldest element, waiting at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return The slot of the oldest element, empty if none could be peeked.
+     */
+    template<class C, class Duration>
+    Reservation peek(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Destroys a peeked element and hands its slot back to the producer.
+     *
+     * A peeked element dropped without a release is released by its destructor.
+     *
+     * @param reservation The slot returned by `peek`, empty on return.
+     * @return `true` if the slot was released, `false` if the reservation was empty.
+     */
+    bool release(Reservation& reservation);
+
+    /**
+     * @brief Waits until the queue is open for pushing or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for push operations within the timeout period, `false` otherwise.
+     */
+    bool waitPushOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Waits until the queue is open for pushing, at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the queue is open for push operations, `false` if the timeout was reached.
+     */
+    template<class Rep, class Period>
+    bool waitPushOpen(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Waits until the queue is open for pushing, at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the queue is open for push operations, `false` if the deadline was reached.
+     */
+    template<class C, class Duration>
+    bool waitPushOpen(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Waits until the queue is open for popping or until the specified timeout expires.
+     * @param timeout_ms The maximum time to wait in milliseconds.
+     * @return `true` if the queue is open for pop operations within the timeout period, `false` otherwise.
+     */
+    bool waitPopOpen(const uint32_t timeout_ms = WAIT_FOREVER);
+
+    /**
+     * @brief Waits until the queue is open for popping, at most `timeout`.
+     * @param timeout The maximum time to wait, `duration::max()` to wait indefinitely.
+     * @return `true` if the queue is open for pop operations, `false` if the timeout was reached.
+     */
+    template<class Rep, class Period>
+    bool waitPopOpen(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Waits until the queue is open for popping, at most until `deadline`.
+     * @param deadline The time point to give up at, `time_point::max()` to wait indefinitely.
+     * @return `true` if the queue is open for pop operations, `false` if the deadline was reached.
+     */
+    template<class C, class Duration>
+    bool waitPopOpen(const std::chrono::time_point<C, Duration>& deadline);
+
+    /**
+     * @brief Returns the maximum number of elements the queue holds.
+     * @return The capacity of the queue.
+     */
+    std::size_t capacity() const;
+
+private:
+    static constexpr std::size_t NOT_READING{std::numeric_limits<std::size_t>::max()};
+
+    /**
+     * @brief Raw storage for one element of the ring.
+     */
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // Rarely changing state shared by both sides.
+    const Settings m_settings;                ///< Queue settings.
+    const std::size_t m_capacity;             ///< Maximum number of elements.
+    const std::size_t m_mask;                 ///< Mask mapping an index to a slot.
+    NumaArray<Slot> m_slots;                  ///< Ring storage.
+    std::atomic<bool> m_open_push{false};     ///< Flag indicating whether push is open.
+    std::atomic<bool> m_open_pop{false};      ///< Flag indicating whether pop is open.
+    DiscardedCallback m_discarded_callback{}; ///< Callback for discarded elements.
+    Wait m_wait{};                            ///< Wait mechanism for blocking operations.
+
+    // Consumer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_head{0}; ///< Index of the oldest element.
+    std::size_t m_cached_tail{0};                                ///< Consumer's copy of `m_tail`.
+    std::atomic<std::size_t> m_reading{NOT_READING};             ///< Index being moved out by the consumer.
+    std::atomic<uint32_t> m_pop_waiters{0};                      ///< Number of threads blocked in pop.
+
+    // Producer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail{0}; ///< Index of the next free slot.
+    std::size_t m_cached_head{0};                                ///< Producer's copy of `m_head`.
+    std::atomic<uint32_t> m_push_waiters{0};                     ///< Number of threads blocked in push.
+
+    void onDiscarded(const T& elem);        ///< Handle discarded elements.
+    bool pushControllable() const;          ///< Check if push is controllable.
+    bool popControllable() const;           ///< Check if pop is controllable.
+    bool full();                            ///< Check, from the producer, whether the ring is full.
+    bool empty();                           ///< Check, from the consumer, whether the ring is empty.
+    bool discardOldest();                   ///< Remove the oldest element from the producer side.
+    Reservation claimHead();                ///< Claim the oldest element, empty if the ring is empty.
+    void drop(Reservation& reservation);    ///< Drop a reservation neither committed nor released.
+    T* slot(const std::size_t index) const; ///< Element storage for an index.
+    void notifyPush();                      ///< Wake a blocked producer if there is one.
+    void notifyPop();                       ///< Wake a blocked consumer if there is one.
+
+    using Deadline = Wait::Clock::time_point;
+    static Deadline deadline(const uint32_t timeout_ms);               ///< Convert a timeout to a deadline, `Wait::NO_DEADLINE` for `WAIT_FOREVER`.
+    bool waitToPush(const Deadline deadline);                          ///< Wait for push availability.
+    bool waitReader(const std::size_t index, const Deadline deadline); ///< Wait until the consumer stops reading the slot of an index.
+    bool waitToPop(const Deadline deadline);                           ///< Wait for pop availability.
+
+    /**
+     * @brief Internal push method constructing the element from `args`.
+     * @param push_deadline The time point to give up at, `Wait::NO_DEADLINE` to wait indefinitely.
+     * @param args Arguments forwarded to the constructor of `T`.
+     * @return `true` if the element was pushed, `false` otherwise.
+     */
+    template<typename... Args>
+    bool enqueue(const Deadline push_deadline, Args&&... args);
+
+    Reservation reserveUntil(const Deadline push_deadline); ///< Reserve a slot, waiting at most until a deadline.
+    bool popUntil(T& elem, const Deadline pop_deadline);    ///< Pop an element, waiting at most until a deadline.
+    Reservation peekUntil(const Deadline pop_deadline);     ///< Peek the oldest element, waiting at most until a deadline.
+    bool waitPushOpenUntil(const Deadline deadline);        ///< Wait for push to open, at most until a deadline.
+    bool waitPopOpenUntil(const Deadline deadline);         ///< Wait for pop to open, at most until a deadline.
+
+    /**
+     * @brief Non-blocking pop.
+     * @param consume Callable receiving the oldest element to move it out; it is destroyed afterwards.
+     * @return `true` if an element was popped, `false` if the ring was empty.
+     */
+    template<typename F>
+    bool dequeue(F&& consume);
+
+    /**
+     * @brief Hand an element that was never inserted to the discarded callback.
+     * @param args The element, or the arguments to construct it from.
+     */
+    template<typename... Args>
+    void discardNewest(Args&&... args);
+};
+
+template<typename T>
+SpscQueue<T>::SpscQueue(const Settings& settings)
+    : m_settings{settings}
+    , m_capacity{settings.size == std::numeric_limits<std::size_t>::max() ? DEFAULT_CAPACITY : (settings.size == 0 ? 1 : settings.size)}
+    , m_mask{nextPowerOfTwo(m_capacity) - 1}
+    , m_slots{makeNumaArray<Slot>(m_mask + 1, settings.numa_node)}
+    , m_wait{settings.wait_strategy}
+{
+    if (!pushControllable())
+    {
+        m_open_push.store(true, std::memory_order_release);
+    }
+    if (!popControllable())
+    {
+        m_open_pop.store(true, std::memory_order_release);
+    }
+}
+
+template<typename T>
+SpscQueue<T>::~SpscQueue()
+{
+    m_open_pop.store(false, std::memory_order_release);
+    m_open_push.store(false, std::memory_order_release);
+    m_wait.notify();
+
+    const std::size_t tail{m_tail.load(std::memory_order_acquire)};
+    for (std::size_t index = m_head.load(std::memory_order_acquire); index != tail; ++index)
+    {
+        slot(index)->~T();
+    }
+}
+
+template<typename T>
+void SpscQueue<T>::setDiscardedCallback(DiscardedCallback discarded_callback)
+{
+    m_discarded_callback = discarded_callback;
+}
+
+template<typename T>
+void SpscQueue<T>::onDiscarded(const T& elem)
+{
+    if (m_discarded_callback)
+    {
+        m_discarded_callback(elem);
+    }
+}
+
+template<typename T>
+std::size_t SpscQueue<T>::capacity() const
+{
+    return m_capacity;
+}
+
+template<typename T>
+bool SpscQueue<T>::push(const T& elem, const uint32_t timeout_ms)
+{
+    return enqueue(deadline(timeout_ms), elem);
+}
+
+template<typename T>
+bool SpscQueue<T>::push(T&& elem, const uint32_t timeout_ms)
+{
+    return enqueue(deadline(timeout_ms), std::move(elem));
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool SpscQueue<T>::push(const T& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return enqueue(Wait::deadlineAfter(timeout), elem);
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool SpscQueue<T>::push(T&& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return enqueue(Wait::deadlineAfter(timeout), std::move(elem));
+}
+
+template<typename T>
+template<class C, class Duration>
+bool SpscQueue<T>::push(const T& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return enqueue(Wait::toDeadline(deadline), elem);
+}
+
+template<typename T>
+template<class C, class Duration>
+bool SpscQueue<T>::push(T&& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return enqueue(Wait::toDeadline(deadline), std::move(elem));
+}
+
+template<typename T>
+typename SpscQueue<T>::Reservation SpscQueue<T>::reserve(const uint32_t timeout_ms)
+{
+    return reserveUntil(deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+typename SpscQueue<T>::Reservation SpscQueue<T>::reserve(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return reserveUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+typename SpscQueue<T>::Reservation SpscQueue<T>::reserve(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return reserveUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T>
+bool SpscQueue<T>::pop(T& elem, const uint32_t timeout_ms)
+{
+    return popUntil(elem, deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool SpscQueue<T>::pop(T& elem, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return popUntil(elem, Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+bool SpscQueue<T>::pop(T& elem, const std::chrono::time_point<C, Duration>& deadline)
+{
+    return popUntil(elem, Wait::toDeadline(deadline));
+}
+
+template<typename T>
+typename SpscQueue<T>::Reservation SpscQueue<T>::peek(const uint32_t timeout_ms)
+{
+    return peekUntil(deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+typename SpscQueue<T>::Reservation SpscQueue<T>::peek(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return peekUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+typename SpscQueue<T>::Reservation SpscQueue<T>::peek(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return peekUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T>
+bool SpscQueue<T>::waitPushOpen(const uint32_t timeout_ms)
+{
+    return waitPushOpenUntil(deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool SpscQueue<T>::waitPushOpen(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return waitPushOpenUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+bool SpscQueue<T>::waitPushOpen(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return waitPushOpenUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T>
+bool SpscQueue<T>::waitPopOpen(const uint32_t timeout_ms)
+{
+    return waitPopOpenUntil(deadline(timeout_ms));
+}
+
+template<typename T>
+template<class Rep, class Period>
+bool SpscQueue<T>::waitPopOpen(const std::chrono::duration<Rep, Period>& timeout)
+{
+    return waitPopOpenUntil(Wait::deadlineAfter(timeout));
+}
+
+template<typename T>
+template<class C, class Duration>
+bool SpscQueue<T>::waitPopOpen(const std::chrono::time_point<C, Duration>& deadline)
+{
+    return waitPopOpenUntil(Wait::toDeadline(deadline));
+}
+
+template<typename T>
+template<typename... Args>
+bool SpscQueue<T>::emplace(Args&&... args)
+{
+    return enqueue(Wait::NO_DEADLINE, std::forward<Args>(args)...);
+}
+
+template<typename T>
+template<typename... Args>
+bool SpscQueue<T>::enqueue(const Deadline push_deadline, Args&&... args)
+{
+    if (!waitToPush(push_deadline))
+    {
+        return false;
+    }
+
+    while (full())
+    {
+        if (m_settings.discard == Discard::DISCARD_NEWEST)
+        {
+            discardNewest(std::forward<Args>(args)...);
+            return false;
+        }
+        if (m_settings.discard != Discard::DISCARD_OLDEST)
+        {
+            return false;
+        }
+        discardOldest();
+    }
+
+    const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+    if (!waitReader(tail, push_deadline))
+    {
+        return false;
+    }
+    new (slot(tail)) T(std::forward<Args>(args)...);
+    m_tail.store(tail + 1, std::memory_order_release);
+    notifyPop();
+    return true;
+}
+
+template<typename T>
+typename SpscQueue<T>::Reservation SpscQueue<T>::reserveUntil(const Deadline push_deadline)
+{
+    if (!waitToPush(push_deadline))
+    {
+        return Reservation{};
+    }
+
+    while (full())
+    {
+        if (m_settings.discard != Discard::DISCARD_OLDEST)
+        {
+            return Reservation{};
+        }
+        discardOldest();
+    }
+
+    const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+    if (!waitReader(tail, push_deadline))
+    {
+        return Reservation{};
+    }
+    return Reservation{this, new (slot(tail)) T, tail, false};
+}
+
+template<typename T>
+bool SpscQueue<T>::commit(Reservation& reservation)
+{
+    if (!reservation)
+    {
+        return false;
+    }
+    m_tail.store(reservation.m_index + 1, std::memory_order_release);
+    reservation.m_elem = nullptr;
+    notifyPop();
+    return true;
+}
+
+template<typename T>
+bool SpscQueue<T>::waitReader(const std::size_t index, const Deadline deadline)
+{
+    if (m_settings.discard != Discard::DISCARD_OLDEST)
+    {
+        return true;
+    }
+    // The consumer may still be reading the element that previously used this slot, until it releases it.
+    auto done_or_closed_pred = [&]() -> bool
+    {
+        const std::size_t reading{m_reading.load(std::memory_order_seq_cst)};
+        return reading == NOT_READING || (reading & m_mask) != (index & m_mask) ||
+               !m_open_push.load(std::memory_order_acquire);
+    };
+    if (done_or_closed_pred())
+    {
+        return m_open_push.load(std::memory_order_acquire);
+    }
+
+    m_push_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Wait::Status result{m_wait.waitUntil(deadline, done_or_closed_pred)};
+    m_push_waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (result != Wait::Status::SUCCESS || !m_open_push.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+template<typename... Args>
+void SpscQueue<T>::discardNewest(Args&&... args)
+{
+    if (!m_discarded_callback)
+    {
+        return;
+    }
+    if constexpr (sizeof...(Args) == 1 && std::conjunction_v<std::is_same<std::decay_t<Args>, T>...>)
+    {
+        onDiscarded(args...);
+    }
+    else
+    {
+        onDiscarded(T(std::forward<Args>(args)...));
+    }
+}
+
+template<typename T>
+bool SpscQueue<T>::popUntil(T& elem, const Deadline pop_deadline)
+{
+    while (true)
+    {
+        if (!waitToPop(pop_deadline))
+        {
+            return false;
+        }
+        if (dequeue([&elem](T& value)
+                    { elem = std::move(value); }))
+        {
+            return true;
+        }
+    }
+}
+
+template<typename T>
+std::optional<T> SpscQueue<T>::tryPop()
+{
+    std::optional<T> elem{};
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return elem;
+    }
+    dequeue([&elem](T& value)
+            { elem.emplace(std::move(value)); });
+    return elem;
+}
+
+template<typename T>
+typename SpscQueue<T>::Reservation SpscQueue<T>::peekUntil(const Deadline peek_deadline)
+{
+    while (true)
+    {
+        if (!waitToPop(peek_deadline))
+        {
+            return Reservation{};
+        }
+        Reservation reservation{claimHead()};
+        if (reservation)
+        {
+            return reservation;
+        }
+    }
+}
+
+template<typename T>
+bool SpscQueue<T>::release(Reservation& reservation)
+{
+    if (!reservation)
+    {
+        return false;
+    }
+    reservation->~T();
+    if (m_settings.discard != Discard::DISCARD_OLDEST)
+    {
+        m_head.store(reservation.m_index + 1, std::memory_order_release);
+    }
+    else
+    {
+        m_reading.store(NOT_READING, std::memory_order_release);
+    }
+    reservation.m_elem = nullptr;
+    notifyPush();
+    return true;
+}
+
+template<typename T>
+void SpscQueue<T>::drop(Reservation& reservation)
+{
+    if (reservation.m_peeked)
+    {
+        release(reservation);
+        return;
+    }
+    // The tail has not moved, the slot is free again for the next reservation.
+    reservation->~T();
+    reservation.m_elem = nullptr;
+}
+
+template<typename T>
+template<typename F>
+bool SpscQueue<T>::dequeue(F&& consume)
+{
+    Reservation reservation{claimHead()};
+    if (!reservation)
+    {
+        return false;
+    }
+    consume(*reservation);
+    release(reservation);
+    return true;
+}
+
+template<typename T>
+typename SpscQueue<T>::Reservation SpscQueue<T>::claimHead()
+{
+    while (!empty())
+    {
+        std::size_t head{m_head.load(std::memory_order_acquire)};
+        if (m_settings.discard != Discard::DISCARD_OLDEST)
+        {
+            // The head moves on release, the producer alone cannot take the slot back.
+            return Reservation{this, slot(head), head, true};
+        }
+
+        // The producer may discard the oldest element concurrently, so the head is claimed with a CAS.
+        // The claimed index is published first so the producer does not reuse the slot while it is read.
+        m_reading.store(head, std::memory_order_seq_cst);
+        if (!m_head.compare_exchange_strong(head, head + 1, std::memory_order_seq_cst))
+        {
+            m_reading.store(NOT_READING, std::memory_order_release);
+            continue;
+        }
+        return Reservation{this, slot(head), head, true};
+    }
+    return Reservation{};
+}
+
+template<typename T>
+bool SpscQueue<T>::discardOldest()
+{
+    std::size_t head{m_head.load(std::memory_order_seq_cst)};
+    if (head == m_tail.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    if (!m_head.compare_exchange_strong(head, head + 1, std::memory_order_seq_cst))
+    {
+        return false;
+    }
+    T* ptr{slot(head)};
+    T discarded_elem{std::move(*ptr)};
+    ptr->~T();
+    onDiscarded(discarded_elem);
+    return true;
+}
+
+template<typename T>
+bool SpscQueue<T>::full()
+{
+    const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+    if (tail - m_cached_head < m_capacity)
+    {
+        return false;
+    }
+    m_cached_head = m_head.load(std::memory_order_seq_cst);
+    return tail - m_cached_head >= m_capacity;
+}
+
+template<typename T>
+bool SpscQueue<T>::empty()
+{
+    const std::size_t head{m_head.load(std::memory_order_acquire)};
+    if (head < m_cached_tail)
+    {
+        return false;
+    }
+    m_cached_tail = m_tail.load(std::memory_order_acquire);
+    return head >= m_cached_tail;
+}
+
+template<typename T>
+T* SpscQueue<T>::slot(const std::size_t index) const
+{
+    return std::launder(reinterpret_cast<T*>(m_slots[index & m_mask].storage));
+}
+
+template<typename T>
+void SpscQueue<T>::notifyPush()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_push_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        m_wait.notify();
+    }
+}
+
+template<typename T>
+void SpscQueue<T>::notifyPop()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_pop_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        m_wait.notify();
+    }
+}
+
+template<typename T>
+bool SpscQueue<T>::pushControllable() const
+{
+    if (m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::PUSH)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+bool SpscQueue<T>::popControllable() const
+{
+    if (m_settings.control == Control::FULL_CONTROL || m_settings.control == Control::POP)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+void SpscQueue<T>::openPush()
+{
+    if (!pushControllable())
+    {
+        return;
+    }
+    m_open_push.store(true, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void SpscQueue<T>::closePush()
+{
+    if (!pushControllable())
+    {
+        return;
+    }
+    m_open_push.store(false, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void SpscQueue<T>::openPop()
+{
+    if (!popControllable())
+    {
+        return;
+    }
+    m_open_pop.store(true, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+void SpscQueue<T>::closePop()
+{
+    if (!popControllable())
+    {
+        return;
+    }
+    m_open_pop.store(false, std::memory_order_release);
+    m_wait.notify();
+}
+
+template<typename T>
+typename SpscQueue<T>::Deadline SpscQueue<T>::deadline(const uint32_t timeout_ms)
+{
+    if (timeout_ms == WAIT_FOREVER)
+    {
+        return Wait::NO_DEADLINE;
+    }
+    return Wait::deadlineAfter(std::chrono::milliseconds(timeout_ms));
+}
+
+template<typename T>
+bool SpscQueue<T>::waitToPush(const Deadline deadline)
+{
+    if (!m_open_push.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    if (m_settings.discard != Discard::NO_DISCARD || !full())
+    {
+        return true;
+    }
+
+    auto closed_or_not_full_pred = [&]() -> bool
+    {
+        if (!m_open_push.load(std::memory_order_acquire) || !full())
+        {
+            return true;
+        }
+        return false;
+    };
+
+    m_push_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Wait::Status result{m_wait.waitUntil(deadline, closed_or_not_full_pred)};
+    m_push_waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (result != Wait::Status::SUCCESS || !m_open_push.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool SpscQueue<T>::waitToPop(const Deadline deadline)
+{
+    if (!m_open_pop.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    if (!empty())
+    {
+        return true;
+    }
+
+    auto closed_or_not_empty_pred = [&]() -> bool
+    {
+        if (!m_open_pop.load(std::memory_order_acquire) || !empty())
+        {
+            return true;
+        }
+        return false;
+    };
+
+    m_pop_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Wait::Status result{m_wait.waitUntil(deadline, closed_or_not_empty_pred)};
+    m_pop_waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (result != Wait::Status::SUCCESS || !m_open_pop.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool SpscQueue<T>::waitPushOpenUntil(const Deadline deadline)
+{
+    Wait::Status result{
+        m_wait.waitUntil(deadline, [this]() -> bool
+                         { return m_open_push.load(std::memory_order_acquire); })};
+    if (result != Wait::Status::SUCCESS)
+    {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool SpscQueue<T>::waitPopOpenUntil(const Deadline deadline)
+{
+    Wait::Status result{
+        m_wait.waitUntil(deadline, [this]() -> bool
+                         { return m_open_pop.load(std::memory_order_acquire); })};
+    if (result != Wait::Status::SUCCESS)
+    {
+        return false;
+    }
+    return true;
+}
+
+} // namespace threadsafe
+} // namespace trlc
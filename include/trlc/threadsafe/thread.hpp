@@ -1,15 +1,23 @@
 #pragma once
 
 #include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/future.hpp"
+#include "trlc/threadsafe/numa.hpp"
+#include "trlc/threadsafe/thread_stats.hpp"
+#include "trlc/threadsafe/trace.hpp"
 
 #include <any>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
+#include <system_error>
 #include <thread>
+#include <tuple>
 #include <type_traits>
 
 namespace trlc
@@ -40,10 +48,65 @@ const NativeThreadPrioritys& defaultNativeThreadPrioritys();
 
 /**
  * @brief Sets the native thread priority for a given thread.
+ *
+ * On Linux `NORMAL` puts the thread under `SCHED_OTHER`, the other priorities under `SCHED_FIFO`, see
+ * `setCurrentThreadScheduling` for the other policies.
+ *
  * @param priority The desired thread priority.
  * @param native_handle The native handle of the thread to set priority.
+ * @return An empty error code on success, otherwise the error, such as a missing `CAP_SYS_NICE` on Linux.
  */
-void setNaitiveThreadPriority(ThreadPriority priority, const std::thread::native_handle_type native_handle);
+std::error_code setNaitiveThreadPriority(ThreadPriority priority, const std::thread::native_handle_type native_handle);
+
+/**
+ * @brief Scheduling policies of a thread.
+ *
+ * Windows has no real-time policies for threads: there `FIFO` and `RR` map to `THREAD_PRIORITY_TIME_CRITICAL`,
+ * `OTHER` maps the nice value onto the thread priorities and `DEADLINE` is not supported.
+ */
+enum class SchedulingPolicy : uint8_t
+{
+    OTHER = 0,   ///< Time sharing (`SCHED_OTHER`), weighted by the nice value.
+    FIFO = 1,    ///< Real-time, first in first out among equal priorities (`SCHED_FIFO`).
+    RR = 2,      ///< Real-time, round robin among equal priorities (`SCHED_RR`).
+    DEADLINE = 3 ///< Earliest deadline first with a CPU budget per period (`SCHED_DEADLINE`).
+};
+
+/**
+ * @brief A scheduling policy and its parameters.
+ *
+ * On Linux the real-time policies require `CAP_SYS_NICE` or an `RLIMIT_RTPRIO` allowance. The kernel admits
+ * a `DEADLINE` thread only if the budgets of all of them fit in the CPUs, and only while its affinity
+ * spans all CPUs of its root domain.
+ */
+struct ThreadScheduling
+{
+    SchedulingPolicy policy{SchedulingPolicy::OTHER}; ///< The policy.
+    int32_t nice{0};                                  ///< Nice value of `OTHER`, from -20 (most CPU) to 19.
+    int32_t priority{0};                              ///< Static priority of `FIFO` and `RR`, from 1 to 99.
+    std::chrono::nanoseconds runtime{0};              ///< CPU time of `DEADLINE` in each period.
+    std::chrono::nanoseconds deadline{0};             ///< Time of `DEADLINE` to get the runtime, 0 for the period.
+    std::chrono::nanoseconds period{0};               ///< Period of `DEADLINE`.
+};
+
+/**
+ * @brief Applies a scheduling policy to the calling thread.
+ * @param scheduling The policy and its parameters.
+ * @return An empty error code on success, otherwise the error, the thread then keeps its scheduling.
+ */
+std::error_code setCurrentThreadScheduling(const ThreadScheduling& scheduling);
+
+/**
+ * @brief Returns the scheduling policy of the calling thread.
+ * @return The policy and its parameters, `OTHER` for the time sharing variants such as `SCHED_BATCH`.
+ */
+ThreadScheduling currentThreadScheduling();
+
+/**
+ * @brief Returns the native handle of the calling thread.
+ * @return The native handle of the calling thread.
+ */
+std::thread::native_handle_type currentNativeThreadHandle();
 
 /**
  * @brief A thread class that supports custom functions, thread priorities, and callbacks.
@@ -123,6 +186,61 @@ public:
         return true;
     }
 
+    /**
+     * @brief Runs a function once on this thread and returns a future for its typed result.
+     *
+     * Unlike `invoke` with a result callback, the result is not type-erased into `ResultType`; it is moved
+     * straight into the returned future. The function runs instead of the one set with `invoke`, which is
+     * kept for a later `run`, and the result callback is not called.
+     *
+     * @tparam Func The type of the function.
+     * @tparam Args The types of the arguments.
+     * @param func The function to run.
+     * @param args The arguments to pass to the function.
+     * @return A future for the result of `func`, or for the exception it throws or the one raised when the
+     *         thread cannot be started, invalid if the thread was started and not stopped since.
+     */
+    template<typename Func, typename... Args>
+    auto submit(Func func, Args&&... args) -> Future<std::invoke_result_t<Func, std::decay_t<Args>...>>
+    {
+        using R = std::invoke_result_t<Func, std::decay_t<Args>...>;
+        if (m_thread_ptr != nullptr)
+        {
+            return Future<R>{};
+        }
+        auto promise{std::make_shared<Promise<R>>()};
+        Future<R> future{promise->getFuture()};
+        m_task = [promise, func, tuple_args = std::make_tuple(std::forward<Args>(args)...)]() mutable
+        {
+            try
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    std::apply(func, std::move(tuple_args));
+                    promise->setValue();
+                }
+                else
+                {
+                    promise->setValue(std::apply(func, std::move(tuple_args)));
+                }
+            }
+            catch (...)
+            {
+                promise->setException(std::current_exception());
+            }
+        };
+        try
+        {
+            start(RunMode::ONCE);
+        }
+        catch (...)
+        {
+            m_task = nullptr;
+            promise->setException(std::current_exception());
+        }
+        return future;
+    }
+
     // Setters for member variables
     /**
      * @brief Sets the predicate to control the loop condition of the thread.
@@ -133,6 +251,99 @@ public:
         m_pred = pred;
     }
 
+    /**
+     * @brief Sets the logical CPUs the thread may run on, applied when the thread starts.
+     *
+     * It is applied before the scheduling policy, and whether it could be applied is reported by
+     * `affinityError`.
+     *
+     * @param cpus The logical CPUs, empty to leave the affinity to the operating system.
+     */
+    void setAffinity(const CpuSet& cpus)
+    {
+        m_affinity = cpus;
+    }
+
+    /**
+     * @brief Sets the scheduling policy of the thread, applied when the thread starts instead of the priority.
+     *
+     * Whether it could be applied is reported by `schedulingError`.
+     *
+     * @param scheduling The policy and its parameters.
+     */
+    void setScheduling(const ThreadScheduling& scheduling)
+    {
+        m_scheduling = scheduling;
+    }
+
+    /**
+     * @brief Returns why the priority or scheduling policy could not be applied at the latest start.
+     *
+     * Set before the start callback runs, so that it can be checked there, or from any thread after `stop`.
+     *
+     * @return An empty error code if it was applied or the thread did not start yet, otherwise the error.
+     */
+    std::error_code schedulingError() const
+    {
+        return std::error_code{m_scheduling_error.load(std::memory_order_acquire), std::system_category()};
+    }
+
+    /**
+     * @brief Returns whether the NUMA node or the affinity could not be applied at the latest start.
+     *
+     * Set before the start callback runs, so that it can be checked there, or from any thread after `stop`.
+     *
+     * @return An empty error code if they were applied or the thread did not start yet, otherwise the error
+     *         of the first that failed, see `bindCurrentThreadToNumaNode` and `setNativeThreadAffinity`.
+     */
+    std::error_code affinityError() const
+    {
+        return std::error_code{m_affinity_error.load(std::memory_order_acquire), std::system_category()};
+    }
+
+    /**
+     * @brief Sets the NUMA node the thread is bound to, applied when the thread starts.
+     *
+     * The thread runs on the CPUs of the node and prefers the node for its allocations. An affinity set
+     * with `setAffinity` further restricts the CPUs.
+     *
+     * @param node The NUMA node, or `NO_NUMA_NODE` to leave the placement to the operating system.
+     */
+    void setNumaNode(const int32_t node)
+    {
+        m_numa_node = node;
+    }
+
+    /**
+     * @brief Enables the runtime stats of the thread, applied when the thread starts.
+     *
+     * Each call of the function is then timed and counted, see `stats`.
+     *
+     * @param enable `true` to record stats, `false` (default) to leave the loop uninstrumented.
+     */
+    void enableStats(const bool enable)
+    {
+        m_stats_enabled = enable;
+    }
+
+    /**
+     * @brief Returns the runtime stats of the thread, from any thread and without stopping it.
+     * @return The iteration counts, call durations, wall and CPU time and context switches of every run
+     *         since the stats were enabled or reset.
+     */
+    ThreadStatsSnapshot stats() const
+    {
+        return m_stats.snapshot();
+    }
+
+    /**
+     * @brief Resets the runtime stats of the thread, e.g. after exporting them to compute rates.
+     */
+    void resetStats()
+    {
+        m_stats.reset();
+    }
+
     /**
      * @brief Sets the start callback function to be executed when the thread starts.
      * @param start_callback The callback function.
@@ -175,13 +386,8 @@ public:
         {
             return false;
         }
-        m_loop.store(false, std::memory_order_release);
-        if (mode == RunMode::LOOP)
-        {
-            m_loop.store(true, std::memory_order_release);
-        }
-        m_thread_ptr = std::make_unique<std::thread>([this]()
-                                                     { loop(); });
+        m_task = nullptr;
+        start(mode);
         return true;
     }
     /**
@@ -200,6 +406,7 @@ public:
             m_thread_ptr->join();
         }
         m_thread_ptr.reset();
+        m_task = nullptr;
         return true;
     }
 
@@ -215,28 +422,89 @@ public:
 private:
     const std::string m_name;
     Callable m_callable{nullptr};
+    std::function<void()> m_task{};
     std::atomic<bool> m_loop{true};
     ThreadPriority m_priority;
+    std::optional<ThreadScheduling> m_scheduling{};
+    std::atomic<int> m_scheduling_error{0};
+    std::atomic<int> m_affinity_error{0};
+    CpuSet m_affinity{};
+    int32_t m_numa_node{NO_NUMA_NODE};
     Pred m_pred{};
     Callback m_start_callback{};
     ResultCallback m_result_callback{};
     Callback m_exit_callback{};
     std::unique_ptr<std::thread> m_thread_ptr{};
+    bool m_stats_enabled{false};
+    ThreadStats m_stats{};
+
+    /**
+     * @brief Starts the native thread running `loop`.
+     * @param mode Whether the thread should run once or in a loop.
+     */
+    void start(const RunMode mode)
+    {
+        m_loop.store(false, std::memory_order_release);
+        m_scheduling_error.store(0, std::memory_order_release);
+        m_affinity_error.store(0, std::memory_order_release);
+        if (mode == RunMode::LOOP)
+        {
+            m_loop.store(true, std::memory_order_release);
+        }
+        m_thread_ptr = std::make_unique<std::thread>([this]()
+                                                     { loop(); });
+    }
 
     /**
      * @brief The main loop function that runs the thread.
      */
     void loop()
     {
-        setNaitiveThreadPriority(m_priority, m_thread_ptr->native_handle());
+        // m_thread_ptr may not be assigned yet when the new thread gets here.
+        // The affinity goes first, since SCHED_DEADLINE is admitted against the CPUs the thread may run on.
+        std::error_code affinity_error{};
+        if (m_numa_node != NO_NUMA_NODE)
+        {
+            affinity_error = bindCurrentThreadToNumaNode(m_numa_node);
+        }
+        if (!m_affinity.empty())
+        {
+            const std::error_code error{setNativeThreadAffinity(m_affinity, currentNativeThreadHandle())};
+            affinity_error = affinity_error ? affinity_error : error;
+        }
+        m_affinity_error.store(affinity_error.value(), std::memory_order_release);
+        const std::error_code scheduling_error{m_scheduling ? setCurrentThreadScheduling(*m_scheduling)
+                                                            : setNaitiveThreadPriority(m_priority, currentNativeThreadHandle())};
+        m_scheduling_error.store(scheduling_error.value(), std::memory_order_release);
+        const bool stats_enabled{m_stats_enabled};
+        if (stats_enabled)
+        {
+            m_stats.start();
+        }
+        TRLC_THREADSAFE_TRACE_THREAD_NAME(m_name);
         startCallback();
+        TRLC_THREADSAFE_TRACE(THREAD_START, this, 0, 0);
 
         do
         {
-            call();
+            if (stats_enabled)
+            {
+                const std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+                call();
+                m_stats.recordCall(std::chrono::steady_clock::now() - start);
+            }
+            else
+            {
+                call();
+            }
         } while (isContinue());
 
+        TRLC_THREADSAFE_TRACE(THREAD_EXIT, this, 0, 0);
         exitCallback();
+        if (stats_enabled)
+        {
+            m_stats.finish();
+        }
     }
 
     /**
@@ -244,14 +512,22 @@ private:
      */
     void call()
     {
-        if (m_callable)
+        if (m_task)
         {
+            TRLC_THREADSAFE_TRACE(THREAD_CALL_BEGIN, this, 0, 0);
+            m_task();
+            TRLC_THREADSAFE_TRACE(THREAD_CALL_END, this, 0, 0);
+        }
+        else if (m_callable)
+        {
+            TRLC_THREADSAFE_TRACE(THREAD_CALL_BEGIN, this, 0, 0);
             ResultType result{};
             result = std::move(m_callable());
             if (m_result_callback)
             {
                 m_result_callback(result);
             };
+            TRLC_THREADSAFE_TRACE(THREAD_CALL_END, this, 0, 0);
         }
     }
 
@@ -289,6 +565,10 @@ private:
         }
         if (m_pred && !m_pred())
         {
+            if (m_stats_enabled)
+            {
+                m_stats.recordPredicateStop();
+            }
             return false;
         }
         return true;
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/future.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/thread.hpp"
+#include "trlc/threadsafe/wait.hpp"
+#include "trlc/threadsafe/work_stealing_deque.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief A pool of reusable `Thread` workers with per-worker work-stealing deques.
+ *
+ * Tasks posted from a worker go to that worker's own Chase–Lev deque, tasks posted from any other thread go
+ * to a shared injection queue. An idle worker first pops its own deque, then the injection queue, then
+ * steals from the other workers, and only blocks when no task is queued anywhere.
+ */
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+    using Callback = Thread::Callback;
+
+    /**
+     * @brief Settings for the pool, such as the number of workers, their priority and names.
+     */
+    struct Settings
+    {
+        std::size_t size{std::thread::hardware_concurrency()}; ///< Number of workers, at least one.
+        ThreadPriority priority{ThreadPriority::NORMAL};       ///< Priority of every worker.
+        std::string name{"pool"};                              ///< Prefix of the worker names.
+        Callback start_callback{};                             ///< Called by each worker when it starts.
+        Callback exit_callback{};                              ///< Called by each worker when it exits.
+    };
+
+    /**
+     * @brief Constructor that starts the workers.
+     * @param settings Settings to configure the pool.
+     */
+    explicit ThreadPool(const Settings& settings);
+
+    /**
+     * @brief Destructor that runs the remaining tasks and stops the workers.
+     */
+    ~ThreadPool();
+
+    // Make this class uncopyable
+    UNCOPYABLE(ThreadPool);
+
+    /**
+     * @brief Queue a task for execution by one of the workers.
+     *
+     * An exception thrown by the task is dropped, its worker goes on with the next task.
+     *
+     * @param task The task to run.
+     * @return `true` if the task was queued, `false` if it is empty or the pool is stopping.
+     */
+    bool post(Task task);
+
+    /**
+     * @brief Queue a function for execution and return a future for its typed result.
+     *
+     * @tparam Func The type of the function.
+     * @tparam Args The types of the arguments.
+     * @param func The function to run.
+     * @param args The arguments to pass to the function.
+     * @return A future for the result of `func`, or for the exception it throws, abandoned if the pool is
+     *         stopping.
+     */
+    template<typename Func, typename... Args>
+    auto submit(Func func, Args&&... args) -> Future<std::invoke_result_t<Func, std::decay_t<Args>...>>
+    {
+        using R = std::invoke_result_t<Func, std::decay_t<Args>...>;
+        auto promise{std::make_shared<Promise<R>>()};
+        Future<R> future{promise->getFuture()};
+        post([promise, func, tuple_args = std::make_tuple(std::forward<Args>(args)...)]() mutable
+             {
+            try
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    std::apply(func, std::move(tuple_args));
+                    promise->setValue();
+                }
+                else
+                {
+                    promise->setValue(std::apply(func, std::move(tuple_args)));
+                }
+            }
+            catch (...)
+            {
+                promise->setException(std::current_exception());
+            } });
+        return future;
+    }
+
+    /**
+     * @brief Block until every queued task, including tasks posted by running tasks, has finished.
+     *
+     * Must not be called from a worker of this pool.
+     */
+    void waitIdle();
+
+    /**
+     * @brief Run one queued task on the calling thread, if there is one.
+     *
+     * Lets a thread that waits for tasks of this pool help run them instead of blocking. A worker first
+     * pops its own deque, any other thread starts with the injection queue, then both steal from the workers.
+     *
+     * @return `true` if a task was run, `false` if no task was found.
+     */
+    bool tryRunOne();
+
+    /**
+     * @brief Run the remaining tasks and stop the workers. Called by the destructor.
+     *
+     * Called from a worker of this pool, it only stops accepting tasks: the remaining tasks still run and
+     * the workers stop on the next call from another thread, so the pool must not be destroyed by its workers.
+     */
+    void stop();
+
+    /**
+     * @brief Returns the number of workers.
+     * @return The number of workers.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Returns the index of the calling worker in this pool.
+     * @return The worker index, or `NOT_A_WORKER` if the caller is not one of its workers.
+     */
+    std::size_t workerIndex() const;
+
+    static constexpr std::size_t NOT_A_WORKER{static_cast<std::size_t>(-1)};
+
+private:
+    using TaskQueue = Queue<Task*>;
+    using TaskDeque = WorkStealingDeque<Task*>;
+
+    const Settings m_settings;                        ///< Pool settings.
+    std::vector<std::unique_ptr<TaskDeque>> m_deques; ///< Local deque of each worker.
+    std::vector<std::unique_ptr<Thread>> m_workers;   ///< Worker threads.
+    TaskQueue m_injection;                            ///< Tasks posted from outside the pool.
+    std::atomic<bool> m_accepting{true};              ///< Flag indicating whether post is allowed.
+    std::atomic<bool> m_stopping{false};              ///< Flag telling idle workers to exit.
+    std::atomic<std::size_t> m_queued{0};             ///< Tasks posted and not yet taken by a worker.
+    std::atomic<std::size_t> m_pending{0};            ///< Tasks posted and not yet finished.
+    Wait m_idle{};                                    ///< Wait channel for workers without work.
+    Wait m_done{};                                    ///< Wait channel for `waitIdle` callers.
+
+    void step(const std::size_t index);             ///< Run one task or block until there is work.
+    bool runOne(const std::size_t index);           ///< Find and run one task for a worker or `NOT_A_WORKER`.
+    Task* findTask(const std::size_t index);        ///< Pop, dequeue or steal a task.
+    void runTask(Task* task);                       ///< Run and release a task.
+    static TaskQueue::Settings injectionSettings(); ///< Settings of the injection queue.
+};
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+#include "trlc/threadsafe/histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Copy of the counters of a thread, summed over all its runs.
+ */
+struct ThreadStatsSnapshot
+{
+    bool running{false};                       ///< Whether the thread is currently running.
+    uint64_t iterations{0};                    ///< Calls of the thread function.
+    uint64_t predicate_stops{0};               ///< Runs ended by the loop predicate.
+    std::chrono::nanoseconds wall_time{0};     ///< Time spent running.
+    std::chrono::nanoseconds busy_time{0};     ///< Time spent inside the thread function.
+    std::chrono::nanoseconds cpu_time{0};      ///< CPU time consumed by the thread, user and kernel.
+    uint64_t voluntary_switches{0};            ///< Context switches where the thread blocked, Linux only.
+    uint64_t involuntary_switches{0};          ///< Context switches where the thread was preempted, Linux only.
+    DurationHistogramSnapshot call_duration{}; ///< Histogram of the durations of the calls.
+
+    /**
+     * @brief Returns the number of calls per second of wall time.
+     * @return The iteration rate, zero before the first run.
+     */
+    double iterationRate() const;
+
+    /**
+     * @brief Returns the fraction of the wall time spent inside the thread function.
+     * @return The busy ratio, close to one for a saturated thread.
+     */
+    double busyRatio() const;
+
+    /**
+     * @brief Returns the fraction of the wall time the thread spent on a CPU.
+     * @return The CPU utilization, low for a thread that mostly blocks.
+     */
+    double cpuUtilization() const;
+};
+
+/**
+ * @brief Runtime counters of a `Thread`, written by the worker and readable from any thread.
+ *
+ * The worker only touches relaxed atomics on its own cache line per call. CPU time and context switches
+ * are queried from the operating system when a snapshot is taken, through `pthread_getcpuclockid` and
+ * `/proc/self/task` on Linux and `GetThreadTimes` on Windows, so they cost nothing while the worker runs.
+ */
+class ThreadStats
+{
+public:
+    using Snapshot = ThreadStatsSnapshot;
+
+    /**
+     * @brief Default constructor.
+     */
+    ThreadStats() = default;
+
+    // Make this class uncopyable
+    UNCOPYABLE(ThreadStats);
+
+    /**
+     * @brief Mark the start of a run, called by the worker thread itself.
+     */
+    void start();
+
+    /**
+     * @brief Record one call of the thread function, called by the worker thread.
+     * @param duration The duration of the call.
+     */
+    void recordCall(const std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Record that the loop predicate ended the run, called by the worker thread.
+     */
+    void recordPredicateStop();
+
+    /**
+     * @brief Mark the end of a run, called by the worker thread itself.
+     */
+    void finish();
+
+    /**
+     * @brief Copy the counters without stopping the worker.
+     * @return The current counters.
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Reset every counter to zero, including those of the current run.
+     */
+    void reset();
+
+private:
+    /**
+     * @brief Resource usage of a thread.
+     */
+    struct Usage
+    {
+        std::chrono::nanoseconds cpu_time{0}; ///< CPU time, user and kernel.
+        uint64_t voluntary_switches{0};       ///< Context switches where the thread blocked.
+        uint64_t involuntary_switches{0};     ///< Context switches where the thread was preempted.
+    };
+
+    using Counter = std::atomic<uint64_t>;
+
+    // Worker side, written per call.
+    alignas(CACHE_LINE_SIZE) Counter m_iterations{0}; ///< Calls of the thread function.
+    Counter m_busy_ns{0};                             ///< Time spent inside the thread function.
+    DurationHistogram m_call_duration{};              ///< Histogram of the call durations.
+
+    // Run bookkeeping, written at the start and the end of each run.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_sequence{0}; ///< Odd while a run starts or finishes.
+    std::atomic<bool> m_running{false};                           ///< Whether a run is in progress.
+    std::atomic<int64_t> m_start_ns{0};                           ///< Steady clock time of the run start.
+    std::atomic<int64_t> m_native_id{0};                          ///< OS thread id of the current run.
+    std::atomic<int64_t> m_cpu_clock{0};                          ///< CPU time clock of the current run, Linux only.
+    std::atomic<int64_t> m_base_cpu_ns{0};                        ///< CPU time of the current run not counted.
+    Counter m_base_voluntary{0};                                  ///< Voluntary switches of the current run not counted.
+    Counter m_base_involuntary{0};                                ///< Involuntary switches of the current run not counted.
+    Counter m_predicate_stops{0};                                 ///< Runs ended by the predicate.
+    Counter m_finished_wall_ns{0};                                ///< Wall time of the finished runs.
+    Counter m_finished_cpu_ns{0};                                 ///< CPU time of the finished runs.
+    Counter m_finished_voluntary{0};                              ///< Voluntary switches of the finished runs.
+    Counter m_finished_involuntary{0};                            ///< Involuntary switches of the finished runs.
+
+    uint32_t beginWrite();                  ///< Make the sequence odd, waiting for another writer.
+    void endWrite(const uint32_t sequence); ///< Make the sequence even again.
+    void setBaseline(const Usage& usage);   ///< Set the usage not counted in the current run.
+    static int64_t steadyNow();             ///< Steady clock time in nanoseconds.
+    static Usage currentUsage();            ///< Usage of the calling thread.
+    bool runningUsage(Usage& usage) const;  ///< Usage of the running worker, `false` if unavailable.
+};
+
+inline void ThreadStats::recordCall(const std::chrono::nanoseconds duration)
+{
+    m_iterations.fetch_add(1, std::memory_order_relaxed);
+    m_busy_ns.fetch_add(static_cast<uint64_t>(duration.count() > 0 ? duration.count() : 0), std::memory_order_relaxed);
+    m_call_duration.record(duration);
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Kinds of trace records written by the tracepoints of the library.
+ */
+enum class TraceEvent : uint16_t
+{
+    QUEUE_PUSH = 0,        ///< Elements pushed into a queue, `value` is the size after the push.
+    QUEUE_POP = 1,         ///< Elements popped from a queue, `value` is the size after the pop.
+    QUEUE_DISCARD = 2,     ///< Elements discarded by a queue policy, `value` is 1 for the oldest and 0 for the newest.
+    WAIT_BEGIN = 3,        ///< A thread starts waiting on a `Wait`.
+    WAIT_END = 4,          ///< A thread stops waiting on a `Wait`, `value` is the `Wait::Status`.
+    WAIT_NOTIFY = 5,       ///< A `Wait` with waiters is notified, `value` is 1 for all waiters and 0 for one.
+    THREAD_START = 6,      ///< A `Thread` starts running.
+    THREAD_EXIT = 7,       ///< A `Thread` stops running.
+    THREAD_CALL_BEGIN = 8, ///< A `Thread` calls its function.
+    THREAD_CALL_END = 9,   ///< The function of a `Thread` returned.
+    USER = 256             ///< First code free for application events.
+};
+
+/**
+ * @brief A fixed-size binary trace record.
+ */
+struct TraceRecord
+{
+    uint64_t ticks{0};  ///< Time stamp counter, or steady clock nanoseconds where there is none.
+    uint64_t object{0}; ///< Address of the queue, wait or thread the event is about.
+    uint64_t value{0};  ///< Event-specific value, see `TraceEvent`.
+    uint32_t thread{0}; ///< Sequential id of the recording thread, from 1.
+    uint16_t event{0};  ///< The `TraceEvent`.
+    uint16_t count{0};  ///< Number of elements of a queue event, saturated.
+};
+
+static_assert(sizeof(TraceRecord) == 32, "Trace records are 32 bytes in the trace file");
+
+/**
+ * @brief Header at the start of a trace file.
+ *
+ * The file is a ring: the header, `THREAD_NAMES` thread name entries, then `capacity` records, of which the
+ * last `written` ones, up to `capacity`, are valid. Record `n` is stored at index `n % capacity`. The time
+ * stamps are converted to nanoseconds through the two calibration points.
+ */
+struct TraceFileHeader
+{
+    static constexpr uint32_t MAGIC{0x43525454};  ///< "TTRC", set once the file is initialized.
+    static constexpr uint32_t VERSION{1};         ///< Layout version.
+    static constexpr uint32_t THREAD_NAMES{256};  ///< Entries of the thread name table.
+    static constexpr std::size_t NAME_LENGTH{28}; ///< Bytes of a thread name, including the terminating null.
+
+    uint32_t magic{0};        ///< `MAGIC`.
+    uint32_t version{0};      ///< `VERSION`.
+    uint32_t record_size{0};  ///< `sizeof(TraceRecord)`.
+    uint32_t names{0};        ///< `THREAD_NAMES`.
+    uint64_t capacity{0};     ///< Records the ring holds.
+    uint64_t written{0};      ///< Records written since the start, the ring keeps the last `capacity` ones.
+    uint64_t dropped{0};      ///< Records lost because the buffer of their thread was full.
+    uint64_t start_ticks{0};  ///< Time stamp counter at the start.
+    uint64_t start_ns{0};     ///< Steady clock nanoseconds at the start.
+    uint64_t latest_ticks{0}; ///< Time stamp counter at the latest flush.
+    uint64_t latest_ns{0};    ///< Steady clock nanoseconds at the latest flush.
+};
+
+/**
+ * @brief An entry of the thread name table, at index `thread - 1` of a trace file.
+ */
+struct TraceThreadName
+{
+    uint32_t thread{0};                        ///< Id of the thread, 0 for an unused entry.
+    char name[TraceFileHeader::NAME_LENGTH]{}; ///< Name of the thread, null-terminated.
+};
+
+static_assert(sizeof(TraceThreadName) == 32, "Thread name entries are 32 bytes in the trace file");
+
+/**
+ * @brief Settings of a tracing session.
+ */
+struct TraceSettings
+{
+    std::string path{"trlc_threadsafe.trace"}; ///< Path of the memory-mapped trace file, overwritten.
+    std::size_t file_records{1u << 20};        ///< Records kept by the file, the oldest are overwritten.
+    std::size_t thread_records{1u << 14};      ///< Records buffered per thread, rounded up to a power of two.
+    uint32_t flush_interval_ms{10};            ///< Period at which the flusher drains the thread buffers.
+};
+
+/**
+ * @brief Low-overhead event tracing of queues, waits and threads into a ring-buffer trace file.
+ *
+ * The tracepoints of `Queue`, `Wait` and `Thread` compile to nothing unless the library is built with
+ * `TRLC_THREADSAFE_TRACING` (CMake option `TRLC_ENABLE_TRACING`), and only test a flag while no session
+ * runs. During a session each thread appends records to its own lock-free buffer, dropping them when
+ * the buffer is full rather than blocking, and a flusher thread moves them into the memory-mapped file,
+ * so that the records flushed before a crash stay in the file. `exportChromeTrace` turns a trace file into
+ * a JSON trace viewable in Perfetto or `chrome://tracing`.
+ */
+class Tracer
+{
+public:
+    Tracer() = delete;
+
+    /**
+     * @brief Create the trace file and start recording.
+     * @param settings Settings of the session.
+     * @return `true` if the session started, `false` if one is running or the file could not be created.
+     */
+    static bool start(const TraceSettings& settings);
+
+    /**
+     * @brief Stop recording, flush the buffered records and close the trace file.
+     */
+    static void stop();
+
+    /**
+     * @brief Returns whether a session is running.
+     * @return `true` while recording.
+     */
+    static bool running();
+
+    /**
+     * @brief Append a record to the buffer of the calling thread, if a session is running.
+     *
+     * Called by the tracepoints, also usable for application events from `TraceEvent::USER` on.
+     *
+     * @param event The kind of event.
+     * @param object The object the event is about.
+     * @param value The event-specific value.
+     * @param count The number of elements, saturated to 65535.
+     */
+    static void record(const TraceEvent event, const void* object, const uint64_t value = 0, const std::size_t count = 1);
+
+    /**
+     * @brief Name the calling thread in the trace file, such as after the `Thread` running it.
+     * @param name The name, truncated to `TraceFileHeader::NAME_LENGTH - 1` bytes.
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * @brief Returns the number of records dropped in the current or last session.
+     * @return The number of records lost because a thread buffer was full.
+     */
+    static uint64_t dropped();
+
+    /**
+     * @brief Convert a trace file to the Chrome trace event JSON format, which Perfetto also reads.
+     *
+     * Waits and function calls become duration slices of their thread, the other events instants.
+     *
+     * @param trace_path Path of the trace file.
+     * @param json_path Path of the JSON file to write.
+     * @return `true` on success, `false` if the trace file is invalid or a file could not be accessed.
+     */
+    static bool exportChromeTrace(const std::string& trace_path, const std::string& json_path);
+};
+
+namespace detail
+{
+extern std::atomic<bool> g_tracing; ///< Whether a session is running, tested by every tracepoint.
+} // namespace detail
+
+} // namespace threadsafe
+} // namespace trlc
+
+#ifdef TRLC_THREADSAFE_TRACING
+/**
+ * @brief Record a `TraceEvent` if a tracing session is running. Compiled out without `TRLC_THREADSAFE_TRACING`.
+ */
+#define TRLC_THREADSAFE_TRACE(event, object, value, count)                                                          \
+    do                                                                                                              \
+    {                                                                                                               \
+        if (::trlc::threadsafe::detail::g_tracing.load(std::memory_order_relaxed))                                  \
+        {                                                                                                           \
+            ::trlc::threadsafe::Tracer::record(::trlc::threadsafe::TraceEvent::event, (object), (value), (count)); \
+        }                                                                                                           \
+    } while (false)
+
+/**
+ * @brief Name the calling thread in the trace files. Compiled out without `TRLC_THREADSAFE_TRACING`.
+ */
+#define TRLC_THREADSAFE_TRACE_THREAD_NAME(name) ::trlc::threadsafe::Tracer::setThreadName(name)
+#else
+#define TRLC_THREADSAFE_TRACE(event, object, value, count) \
+    do                                                     \
+    {                                                      \
+    } while (false)
+#define TRLC_THREADSAFE_TRACE_THREAD_NAME(name) \
+    do                                          \
+    {                                           \
+    } while (false)
+#endif
@@ -2,7 +2,14 @@
 
 #include "trlc/threadsafe/common.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
 
 namespace trlc
 {
@@ -13,12 +20,62 @@ namespace threadsafe
     template<typename... Args>                                                                                    \
     std::enable_if_t<has_##name##_operator_for_t_class<T, Args...> && std::is_constructible<T, Args&&...>::value, \
                      bool>                                                                                        \
-    operator op(Args&&... args)                                                                                   \
+    operator op(Args&&... args) const                                                                             \
     {                                                                                                             \
-        std::lock_guard<std::mutex> guard{m_lock};                                                                \
-        return (m_value op T(static_cast<Args&&>(args)...));                                                      \
+        return read([&](const T& value) -> bool                                                                   \
+                    { return (value op T(static_cast<Args&&>(args)...)); });                                      \
     }
 
+CREATE_HAS_MEMBER_FUNCTION_TRAIT(has_lock_shared, lock_shared);
+
+/**
+ * @brief Lock policy tag selecting the sequence lock specialization of `Variable`.
+ *
+ * Readers copy the value optimistically and retry when a writer was active, so they never write to shared
+ * memory. Only available for trivially copyable types.
+ */
+struct SeqLock
+{
+};
+
+/**
+ * @brief Lock policy tag selecting the read-copy-update specialization of `Variable`.
+ *
+ * Readers take immutable `std::shared_ptr<const T>` snapshots without locking, writers copy, modify and
+ * publish a new value. Suited for large values that are read far more often than written.
+ */
+struct Rcu
+{
+};
+
+/**
+ * @brief Lock policy tag selecting the `std::atomic` specialization of `Variable`.
+ *
+ * Default policy for trivially copyable types whose `std::atomic` is always lock-free, such as `int`,
+ * `bool` and `double`.
+ */
+struct Atomic
+{
+};
+
+/**
+ * @brief Evaluates `std::atomic<T>::is_always_lock_free` only once `T` is known to fit in `std::atomic`.
+ */
+template<typename T>
+struct is_always_lock_free_atomic : std::bool_constant<std::atomic<T>::is_always_lock_free>
+{
+};
+
+/**
+ * @brief Default lock policy of `Variable`: `Atomic` for lock-free capable types, `std::mutex` otherwise.
+ */
+template<typename T>
+using DefaultVariableLock = std::conditional_t<std::conjunction_v<std::is_trivially_copyable<T>,
+                                                                  std::is_default_constructible<T>,
+                                                                  is_always_lock_free_atomic<T>>,
+                                               Atomic,
+                                               std::mutex>;
+
 /**
  * @brief A thread-safe wrapper for a variable of type T.
  *
@@ -26,9 +83,16 @@ namespace threadsafe
  * to guard its access. It provides thread-safe assignment, comparison, and
  * access to the encapsulated variable.
  *
+ * When `Lock` provides `lock_shared`, such as `std::shared_mutex`, read-only
+ * operations (`get`, conversion, comparisons and const `invoke`) take a shared
+ * lock and run concurrently. Use `SeqLock` for a lock-free read path.
+ *
+ * Types for which `std::atomic<T>` is always lock-free default to the `Atomic` specialization instead.
+ *
  * @tparam T The type of the variable to be protected.
+ * @tparam Lock The mutex type guarding the variable.
  */
-template<typename T>
+template<typename T, typename Lock = DefaultVariableLock<T>>
 class Variable
 {
 public:
@@ -70,7 +134,7 @@ public:
     template<typename... Args>
     std::enable_if_t<std::is_constructible<T, Args&&...>::value, void> operator=(Args&&... args)
     {
-        std::lock_guard<std::mutex> guard{m_lock};
+        WriteGuard guard{m_lock};
         m_value = T(static_cast<Args&&>(args)...);
     }
 
@@ -91,9 +155,9 @@ public:
      *
      * @return A copy of the current value.
      */
-    T get()
+    T get() const
     {
-        std::lock_guard<std::mutex> guard{m_lock};
+        ReadGuard guard{m_lock};
         return m_value;
     }
 
@@ -106,7 +170,7 @@ public:
      */
     operator T() const
     {
-        std::lock_guard<std::mutex> guard{m_lock};
+        ReadGuard guard{m_lock};
         return m_value;
     }
 
@@ -127,7 +191,28 @@ public:
              typename std::enable_if<!std::is_member_function_pointer<F>::value>::type* = nullptr>
     decltype(auto) invoke(F&& func, Args&&... args)
     {
-        std::lock_guard<std::mutex> guard(m_lock);
+        WriteGuard guard(m_lock);
+        return std::forward<F>(func)(m_value, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a non-member function or callable with the stored value, for read-only access.
+     *
+     * The callable receives the stored value as a const reference, under a shared lock when `Lock`
+     * supports it.
+     *
+     * @tparam F The type of the callable (function, lambda, etc.)
+     * @tparam Args The types of the arguments to the callable.
+     * @param func The callable (function, lambda, etc.) to invoke.
+     * @param args The arguments to pass to the callable.
+     * @return The result of invoking the callable with the stored value and the provided arguments.
+     */
+    template<typename F,
+             typename... Args,
+             typename std::enable_if<!std::is_member_function_pointer<F>::value>::type* = nullptr>
+    decltype(auto) invoke(F&& func, Args&&... args) const
+    {
+        ReadGuard guard(m_lock);
         return std::forward<F>(func)(m_value, std::forward<Args>(args)...);
     }
 
@@ -147,7 +232,7 @@ public:
     template<typename R, typename C, typename... Args>
     decltype(auto) invoke(R (C::*func)(Args...), Args&&... args)
     {
-        std::lock_guard<std::mutex> guard(m_lock);
+        WriteGuard guard(m_lock);
         return (m_value.*func)(std::forward<Args>(args)...);
     }
 
@@ -168,13 +253,714 @@ public:
     template<typename R, typename C, typename... Args>
     decltype(auto) invoke(R (C::*func)(Args...) const, Args&&... args) const
     {
-        std::lock_guard<std::mutex> guard(m_lock);
+        ReadGuard guard(m_lock);
         return (m_value.*func)(std::forward<Args>(args)...);
     }
 
 private:
-    T m_value{};                 ///< The encapsulated value of type T.
-    mutable std::mutex m_lock{}; ///< A mutex to guard access to m_value.
+    using ReadGuard = std::conditional_t<has_lock_shared<Lock, void()>::value, std::shared_lock<Lock>, std::lock_guard<Lock>>;
+    using WriteGuard = std::lock_guard<Lock>;
+
+    T m_value{};           ///< The encapsulated value of type T.
+    mutable Lock m_lock{}; ///< A mutex to guard access to m_value.
+
+    /**
+     * @brief Calls `func` with the stored value under a read lock.
+     */
+    template<typename F>
+    decltype(auto) read(F&& func) const
+    {
+        ReadGuard guard{m_lock};
+        return std::forward<F>(func)(m_value);
+    }
+};
+
+/**
+ * @brief `std::atomic` specialization of `Variable` for lock-free capable types.
+ *
+ * Reads are single atomic loads and assignments single atomic stores, all sequentially consistent like the
+ * mutex they replace. Modifying operations run as compare-exchange loops on a copy, so a callable passed to
+ * `invoke` or `update` may be called more than once under contention and should have no other side effects.
+ *
+ * @tparam T The type of the variable to be protected.
+ */
+template<typename T>
+class Variable<T, Atomic>
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Atomic requires a trivially copyable type");
+
+public:
+    using Type = T;
+
+    /**
+     * @brief Default constructor, holding a value-initialized `T`.
+     */
+    Variable()
+        : m_value{T{}}
+    {
+    }
+
+    /**
+     * @brief Perfect-forwarding constructor to construct T in place.
+     * @param args Arguments to forward to T's constructor.
+     */
+    template<typename... Args>
+    Variable(Args&&... args)
+        : m_value{T(std::forward<Args>(args)...)}
+    {
+    }
+
+    // Make this class uncopyable
+    UNCOPYABLE(Variable);
+
+    /**
+     * @brief Lock-free assignment operator.
+     * @param args The new value to assign.
+     */
+    template<typename... Args>
+    std::enable_if_t<std::is_constructible<T, Args&&...>::value, void> operator=(Args&&... args)
+    {
+        m_value.store(T(static_cast<Args&&>(args)...), std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Lock-free comparison operator.
+     */
+    COMPARISON_OPERATOR_IMPL(==, equal);
+    COMPARISON_OPERATOR_IMPL(!=, not_equal);
+    COMPARISON_OPERATOR_IMPL(<, less);
+    COMPARISON_OPERATOR_IMPL(<=, less_or_equal);
+    COMPARISON_OPERATOR_IMPL(>, greater);
+    COMPARISON_OPERATOR_IMPL(>=, greater_or_equal);
+
+    /**
+     * @brief Lock-free getter for the value.
+     * @return A copy of the current value.
+     */
+    T get() const
+    {
+        return m_value.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Lock-free type conversion operator.
+     * @return A copy of the current value.
+     */
+    operator T() const
+    {
+        return m_value.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Atomically adds `delta` to the value.
+     * @param delta The value to add.
+     * @return The value before the addition.
+     */
+    template<typename U = T>
+    std::enable_if_t<std::is_arithmetic<U>::value && !std::is_same<U, bool>::value, T> fetchAdd(const T delta)
+    {
+        if constexpr (std::is_integral_v<T>)
+        {
+            return m_value.fetch_add(delta, std::memory_order_seq_cst);
+        }
+        else
+        {
+            // Floating-point fetch_add is only available since C++20.
+            T expected{m_value.load(std::memory_order_relaxed)};
+            while (!m_value.compare_exchange_weak(expected, expected + delta, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+            {
+            }
+            return expected;
+        }
+    }
+
+    /**
+     * @brief Atomically replaces the value with `desired` if it equals `expected`.
+     * @param expected The expected value, updated to the current value on failure.
+     * @param desired The value to store.
+     * @return `true` if the value was replaced, `false` otherwise.
+     */
+    bool compareExchange(T& expected, const T desired)
+    {
+        return m_value.compare_exchange_strong(expected, desired, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Lets `func` modify a copy of the value and stores it if the value did not change meanwhile.
+     *
+     * Retries with the current value otherwise, so `func` may be called more than once.
+     *
+     * @param func The callable receiving a `T&`.
+     * @param args The arguments to pass to the callable.
+     * @return The result of the last call of the callable, by value.
+     */
+    template<typename F, typename... Args>
+    auto update(F&& func, Args&&... args)
+    {
+        T expected{m_value.load(std::memory_order_seq_cst)};
+        while (true)
+        {
+            T desired{expected};
+            if constexpr (std::is_void_v<std::invoke_result_t<F&, T&, Args&...>>)
+            {
+                func(desired, args...);
+                if (exchange(expected, desired))
+                {
+                    return;
+                }
+            }
+            else
+            {
+                auto result{func(desired, args...)};
+                if (exchange(expected, desired))
+                {
+                    return result;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Invokes a callable on a copy of the value and stores the modified copy, like `update`.
+     */
+    template<typename F,
+             typename... Args,
+             typename std::enable_if<!std::is_member_function_pointer<F>::value>::type* = nullptr>
+    auto invoke(F&& func, Args&&... args)
+    {
+        return update(std::forward<F>(func), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a callable with a copy of the value.
+     *
+     * @param func The callable receiving a `const T&`.
+     * @param args The arguments to pass to the callable.
+     * @return The result of invoking the callable, by value.
+     */
+    template<typename F,
+             typename... Args,
+             typename std::enable_if<!std::is_member_function_pointer<F>::value>::type* = nullptr>
+    auto invoke(F&& func, Args&&... args) const
+    {
+        const T value{m_value.load(std::memory_order_seq_cst)};
+        return std::forward<F>(func)(value, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a non-const member function on a copy of the value and stores the modified copy.
+     *
+     * @param func The member function pointer to invoke.
+     * @param args The arguments to pass to the member function.
+     * @return The result of the last call of the member function, by value.
+     */
+    template<typename R, typename C, typename... Args>
+    std::decay_t<R> invoke(R (C::*func)(Args...), Args&&... args)
+    {
+        return update([func](T& value, auto&... forwarded) -> std::decay_t<R>
+                      { return (value.*func)(forwarded...); },
+                      args...);
+    }
+
+    /**
+     * @brief Invokes a const member function on a copy of the value.
+     *
+     * @param func The const member function pointer to invoke.
+     * @param args The arguments to pass to the member function.
+     * @return The result of invoking the member function, by value.
+     */
+    template<typename R, typename C, typename... Args>
+    std::decay_t<R> invoke(R (C::*func)(Args...) const, Args&&... args) const
+    {
+        const T value{m_value.load(std::memory_order_seq_cst)};
+        return (value.*func)(std::forward<Args>(args)...);
+    }
+
+private:
+    std::atomic<T> m_value; ///< The encapsulated value of type T.
+
+    template<typename F>
+    auto read(F&& func) const
+    {
+        const T value{m_value.load(std::memory_order_seq_cst)};
+        return std::forward<F>(func)(value);
+    }
+
+    /**
+     * @brief Stores `desired` if the value still equals `expected`, which is refreshed otherwise.
+     *
+     * Nothing is stored when the callable left the value unchanged, read-only calls stay a single load.
+     */
+    bool exchange(T& expected, const T& desired)
+    {
+        if (std::memcmp(&expected, &desired, sizeof(T)) == 0)
+        {
+            return true;
+        }
+        return m_value.compare_exchange_weak(expected, desired, std::memory_order_seq_cst,
+                                             std::memory_order_seq_cst);
+    }
+};
+
+/**
+ * @brief Sequence lock specialization of `Variable` for trivially copyable types.
+ *
+ * The value is stored as atomic words next to a sequence counter. A writer makes the counter odd, stores
+ * the words and makes it even again; a reader copies the words and retries if the counter was odd or changed
+ * meanwhile. Readers therefore never write to shared cache lines and scale with the number of cores, while
+ * writers are serialized by a mutex. Read-only operations work on a consistent copy of the value.
+ *
+ * @tparam T The type of the variable to be protected.
+ */
+template<typename T>
+class Variable<T, SeqLock>
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock requires a trivially copyable type");
+    static_assert(std::is_default_constructible_v<T>, "SeqLock requires a default constructible type");
+
+public:
+    using Type = T;
+
+    /**
+     * @brief Default constructor.
+     */
+    Variable()
+    {
+        store(T{});
+    }
+
+    /**
+     * @brief Perfect-forwarding constructor to construct T in place.
+     * @param args Arguments to forward to T's constructor.
+     */
+    template<typename... Args>
+    Variable(Args&&... args)
+    {
+        store(T{std::forward<Args>(args)...});
+    }
+
+    // Make this class uncopyable
+    UNCOPYABLE(Variable);
+
+    /**
+     * @brief Thread-safe assignment operator.
+     * @param args The new value to assign.
+     */
+    template<typename... Args>
+    std::enable_if_t<std::is_constructible<T, Args&&...>::value, void> operator=(Args&&... args)
+    {
+        std::lock_guard<std::mutex> guard{m_write_lock};
+        store(T(static_cast<Args&&>(args)...));
+    }
+
+    /**
+     * @brief Thread-safe comparison operator.
+     */
+    COMPARISON_OPERATOR_IMPL(==, equal);
+    COMPARISON_OPERATOR_IMPL(!=, not_equal);
+    COMPARISON_OPERATOR_IMPL(<, less);
+    COMPARISON_OPERATOR_IMPL(<=, less_or_equal);
+    COMPARISON_OPERATOR_IMPL(>, greater);
+    COMPARISON_OPERATOR_IMPL(>=, greater_or_equal);
+
+    /**
+     * @brief Lock-free getter for the value.
+     * @return A consistent copy of the current value.
+     */
+    T get() const
+    {
+        return load();
+    }
+
+    /**
+     * @brief Lock-free type conversion operator.
+     * @return A consistent copy of the current value.
+     */
+    operator T() const
+    {
+        return load();
+    }
+
+    /**
+     * @brief Copies the stored value, lets `func` modify the copy and writes it back.
+     *
+     * Writers are serialized, readers keep seeing the previous value until the callable returns.
+     *
+     * @param func The callable receiving a `T&`.
+     * @param args The arguments to pass to the callable.
+     * @return The result of invoking the callable.
+     */
+    template<typename F, typename... Args>
+    auto update(F&& func, Args&&... args)
+    {
+        std::lock_guard<std::mutex> guard{m_write_lock};
+        T value{load()};
+        if constexpr (std::is_void_v<std::invoke_result_t<F, T&, Args...>>)
+        {
+            std::forward<F>(func)(value, std::forward<Args>(args)...);
+            store(value);
+        }
+        else
+        {
+            auto result{std::forward<F>(func)(value, std::forward<Args>(args)...)};
+            store(value);
+            return result;
+        }
+    }
+
+    /**
+     * @brief Invokes a callable with the stored value and writes the modified value back, like `update`.
+     */
+    template<typename F,
+             typename... Args,
+             typename std::enable_if<!std::is_member_function_pointer<F>::value>::type* = nullptr>
+    auto invoke(F&& func, Args&&... args)
+    {
+        return update(std::forward<F>(func), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a callable with a consistent copy of the stored value, without locking.
+     *
+     * @param func The callable receiving a `const T&`.
+     * @param args The arguments to pass to the callable.
+     * @return The result of invoking the callable, by value.
+     */
+    template<typename F,
+             typename... Args,
+             typename std::enable_if<!std::is_member_function_pointer<F>::value>::type* = nullptr>
+    auto invoke(F&& func, Args&&... args) const
+    {
+        const T value{load()};
+        return std::forward<F>(func)(value, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a non-const member function on a copy of the value and stores the modified copy, like `update`.
+     *
+     * @param func The member function pointer to invoke.
+     * @param args The arguments to pass to the member function.
+     * @return The result of invoking the member function, by value.
+     */
+    template<typename R, typename C, typename... Args>
+    std::decay_t<R> invoke(R (C::*func)(Args...), Args&&... args)
+    {
+        return update([func](T& value, Args&&... forwarded) -> std::decay_t<R>
+                      { return (value.*func)(std::forward<Args>(forwarded)...); },
+                      std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a const member function on a consistent copy of the stored value, without locking.
+     *
+     * @param func The const member function pointer to invoke.
+     * @param args The arguments to pass to the member function.
+     * @return The result of invoking the member function, by value.
+     */
+    template<typename R, typename C, typename... Args>
+    std::decay_t<R> invoke(R (C::*func)(Args...) const, Args&&... args) const
+    {
+        const T value{load()};
+        return (value.*func)(std::forward<Args>(args)...);
+    }
+
+private:
+    static constexpr std::size_t WORDS{(sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t)};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_sequence{0}; ///< Odd while a write is in progress.
+    std::atomic<uint64_t> m_words[WORDS]{};                       ///< The value, copied word by word.
+    std::mutex m_write_lock{};                                    ///< Serializes writers.
+
+    template<typename F>
+    auto read(F&& func) const
+    {
+        const T value{load()};
+        return std::forward<F>(func)(value);
+    }
+
+    T load() const
+    {
+        uint64_t buffer[WORDS];
+        while (true)
+        {
+            const uint64_t sequence{m_sequence.load(std::memory_order_acquire)};
+            if ((sequence & 1) != 0)
+            {
+                cpuRelax();
+                continue;
+            }
+            for (std::size_t index = 0; index < WORDS; ++index)
+            {
+                buffer[index] = m_words[index].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    void store(const T& value)
+    {
+        uint64_t buffer[WORDS]{};
+        std::memcpy(buffer, &value, sizeof(T));
+        const uint64_t sequence{m_sequence.load(std::memory_order_relaxed)};
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t index = 0; index < WORDS; ++index)
+        {
+            m_words[index].store(buffer[index], std::memory_order_relaxed);
+        }
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+};
+
+/**
+ * @brief Read-copy-update specialization of `Variable`.
+ *
+ * The value lives in an immutable `std::shared_ptr<const T>`. Readers copy the pointer of the published slot
+ * out of two slots while holding a per-thread striped reader count, so reading never copies `T`, never takes
+ * a lock and never waits for a writer. Writers are serialized by a mutex: they build a new value, wait until
+ * no reader is still copying the other slot, store the value there and flip the published slot. The replaced
+ * value is released when the slot is reused by the next write and its last snapshot is dropped.
+ *
+ * @tparam T The type of the variable to be protected.
+ */
+template<typename T>
+class Variable<T, Rcu>
+{
+public:
+    using Type = T;
+    using Snapshot = std::shared_ptr<const T>;
+
+    /**
+     * @brief Default constructor, holding a value-initialized `T`.
+     */
+    Variable()
+        : Variable(T{})
+    {
+    }
+
+    /**
+     * @brief Perfect-forwarding constructor to construct T in place.
+     * @param args Arguments to forward to T's constructor.
+     */
+    template<typename... Args>
+    Variable(Args&&... args)
+    {
+        m_slots[0] = std::make_shared<const T>(std::forward<Args>(args)...);
+    }
+
+    // Make this class uncopyable
+    UNCOPYABLE(Variable);
+
+    /**
+     * @brief Publishes a new value constructed from `args`.
+     * @param args The new value to assign.
+     */
+    template<typename... Args>
+    std::enable_if_t<std::is_constructible<T, Args&&...>::value, void> operator=(Args&&... args)
+    {
+        Snapshot value{std::make_shared<const T>(std::forward<Args>(args)...)};
+        std::lock_guard<std::mutex> guard{m_write_lock};
+        publish(std::move(value));
+    }
+
+    /**
+     * @brief Thread-safe comparison operator, evaluated on a snapshot.
+     */
+    COMPARISON_OPERATOR_IMPL(==, equal);
+    COMPARISON_OPERATOR_IMPL(!=, not_equal);
+    COMPARISON_OPERATOR_IMPL(<, less);
+    COMPARISON_OPERATOR_IMPL(<=, less_or_equal);
+    COMPARISON_OPERATOR_IMPL(>, greater);
+    COMPARISON_OPERATOR_IMPL(>=, greater_or_equal);
+
+    /**
+     * @brief Returns an immutable snapshot of the current value without locking.
+     *
+     * The snapshot stays valid and unchanged while it is held, independently of later updates.
+     *
+     * @return The snapshot.
+     */
+    Snapshot snapshot() const
+    {
+        std::atomic<uint32_t>* readers{nullptr};
+        uint32_t index{m_index.load(std::memory_order_seq_cst)};
+        while (true)
+        {
+            readers = &m_readers[index][stripe()].count;
+            readers->fetch_add(1, std::memory_order_seq_cst);
+            const uint32_t current{m_index.load(std::memory_order_seq_cst)};
+            if (current == index)
+            {
+                break;
+            }
+            // A writer flipped the slot meanwhile, register on the new one.
+            readers->fetch_sub(1, std::memory_order_release);
+            index = current;
+        }
+        Snapshot value{m_slots[index]};
+        readers->fetch_sub(1, std::memory_order_release);
+        return value;
+    }
+
+    /**
+     * @brief Thread-safe getter for the value.
+     * @return A copy of the current value.
+     */
+    T get() const
+    {
+        return *snapshot();
+    }
+
+    /**
+     * @brief Thread-safe type conversion operator.
+     * @return A copy of the current value.
+     */
+    operator T() const
+    {
+        return *snapshot();
+    }
+
+    /**
+     * @brief Copies the current value, lets `func` modify the copy and publishes it.
+     *
+     * Readers keep seeing the previous value until the copy is published.
+     *
+     * @param func The callable receiving a `T&`.
+     * @param args The arguments to pass to the callable.
+     * @return The result of invoking the callable, by value.
+     */
+    template<typename F, typename... Args>
+    auto update(F&& func, Args&&... args)
+    {
+        std::lock_guard<std::mutex> guard{m_write_lock};
+        auto value{std::make_shared<T>(*m_slots[m_index.load(std::memory_order_relaxed)])};
+        if constexpr (std::is_void_v<std::invoke_result_t<F, T&, Args...>>)
+        {
+            std::forward<F>(func)(*value, std::forward<Args>(args)...);
+            publish(std::move(value));
+        }
+        else
+        {
+            auto result{std::forward<F>(func)(*value, std::forward<Args>(args)...)};
+            publish(std::move(value));
+            return result;
+        }
+    }
+
+    /**
+     * @brief Invokes a callable on a copy of the value and publishes the modified copy, like `update`.
+     */
+    template<typename F,
+             typename... Args,
+             typename std::enable_if<!std::is_member_function_pointer<F>::value>::type* = nullptr>
+    auto invoke(F&& func, Args&&... args)
+    {
+        return update(std::forward<F>(func), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a callable with a snapshot of the value, without locking.
+     *
+     * @param func The callable receiving a `const T&`.
+     * @param args The arguments to pass to the callable.
+     * @return The result of invoking the callable, by value since the snapshot is released on return.
+     */
+    template<typename F,
+             typename... Args,
+             typename std::enable_if<!std::is_member_function_pointer<F>::value>::type* = nullptr>
+    auto invoke(F&& func, Args&&... args) const
+    {
+        const Snapshot value{snapshot()};
+        return std::forward<F>(func)(*value, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a non-const member function on a copy of the value and publishes the modified copy, like `update`.
+     *
+     * @param func The member function pointer to invoke.
+     * @param args The arguments to pass to the member function.
+     * @return The result of invoking the member function, by value.
+     */
+    template<typename R, typename C, typename... Args>
+    std::decay_t<R> invoke(R (C::*func)(Args...), Args&&... args)
+    {
+        return update([func](T& value, Args&&... forwarded) -> std::decay_t<R>
+                      { return (value.*func)(std::forward<Args>(forwarded)...); },
+                      std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Invokes a const member function on a snapshot of the value, without locking.
+     *
+     * @param func The const member function pointer to invoke.
+     * @param args The arguments to pass to the member function.
+     * @return The result of invoking the member function, by value.
+     */
+    template<typename R, typename C, typename... Args>
+    std::decay_t<R> invoke(R (C::*func)(Args...) const, Args&&... args) const
+    {
+        const Snapshot value{snapshot()};
+        return ((*value).*func)(std::forward<Args>(args)...);
+    }
+
+private:
+    static constexpr std::size_t STRIPES{16}; ///< Reader count stripes per slot.
+
+    /**
+     * @brief Reader count on its own cache line.
+     */
+    struct alignas(CACHE_LINE_SIZE) ReaderCount
+    {
+        std::atomic<uint32_t> count{0};
+    };
+
+    Snapshot m_slots[2]{};                                     ///< Published and previous value.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_index{0}; ///< Index of the published slot.
+    mutable ReaderCount m_readers[2][STRIPES]{};               ///< Readers copying each slot.
+    std::mutex m_write_lock{};                                 ///< Serializes writers.
+
+    /**
+     * @brief Returns the reader count stripe of the calling thread.
+     */
+    static std::size_t stripe()
+    {
+        static std::atomic<std::size_t> next{0};
+        thread_local const std::size_t index{next.fetch_add(1, std::memory_order_relaxed) % STRIPES};
+        return index;
+    }
+
+    template<typename F>
+    auto read(F&& func) const
+    {
+        const Snapshot value{snapshot()};
+        return std::forward<F>(func)(*value);
+    }
+
+    /**
+     * @brief Stores `value` in the unpublished slot and publishes it. Requires `m_write_lock`.
+     */
+    void publish(Snapshot value)
+    {
+        const uint32_t next{m_index.load(std::memory_order_relaxed) ^ 1U};
+        for (std::size_t index = 0; index < STRIPES; ++index)
+        {
+            // Readers only hold the count while copying the pointer, so this wait is short.
+            while (m_readers[next][index].count.load(std::memory_order_seq_cst) != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        m_slots[next] = std::move(value);
+        m_index.store(next, std::memory_order_seq_cst);
+    }
 };
 
 } // namespace threadsafe
@@ -1,21 +1,36 @@
 #pragma once
 
 #include "common.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace trlc
 {
 namespace threadsafe
 {
 
+template<typename Executor, typename Operation>
+class WaitAwaiter;
+
+template<typename Pr>
+struct WaitPredicateOperation;
+
 /**
  * @brief A thread-safe class for handling conditional waits.
  *
  * This class provides mechanisms for waiting on a condition variable with support
- * for notifications, timeouts, and predicate-based conditions.
+ * for notifications, timeouts, and predicate-based conditions. Depending on the `Strategy`,
+ * a waiting thread first polls its predicate for a short time before it blocks, which avoids
+ * the sleep and wake-up round trip when the condition is met within microseconds.
  */
 class Wait
 {
@@ -31,10 +46,28 @@ public:
     };
 
     /**
-     * @brief Default constructor for the Wait class.
+     * @brief Enumeration of the strategies used before a waiting thread blocks.
+     */
+    enum class Strategy : uint32_t
+    {
+        BLOCK = 0,   ///< Block on the condition variable right away.
+        SPIN = 1,    ///< Poll the predicate for up to `MAX_SPIN_DURATION`, then block.
+        ADAPTIVE = 2 ///< Poll the predicate for about twice the recent average wait, then block.
+    };
+
+    static constexpr std::chrono::nanoseconds MAX_SPIN_DURATION{50000}; ///< Upper bound of a spin phase.
+
+    /**
+     * @brief Default constructor for the Wait class, using `Strategy::BLOCK`.
      */
     Wait() = default;
 
+    /**
+     * @brief Constructor selecting the strategy used before blocking.
+     * @param strategy The wait strategy.
+     */
+    explicit Wait(const Strategy strategy);
+
     /**
      * @brief Default destructor for the Wait class.
      */
@@ -49,6 +82,24 @@ public:
      */
     void notify();
 
+    /**
+     * @brief Notify one waiting thread.
+     *
+     * Wakes up a single thread blocked on the condition variable. Use this when only one waiter can make
+     * progress from the event, such as a single element becoming available.
+     */
+    void notifyOne();
+
+    /**
+     * @brief Check whether any thread is currently blocked, or about to block, in one of the wait functions.
+     *
+     * Notifications are skipped while this returns false, so a notifier may also use it to avoid work that
+     * only matters to waiters.
+     *
+     * @return True if at least one thread is waiting, false otherwise.
+     */
+    bool hasWaiters() const;
+
     /**
      * @brief Exit request to unblock waiting threads.
      *
@@ -77,14 +128,19 @@ public:
     template<typename Pr>
     Status wait(Pr pred)
     {
+        const Clock::time_point start{Clock::now()};
+        TRLC_THREADSAFE_TRACE(WAIT_BEGIN, this, 0, 0);
+        if (spin(spinLimit(), pred))
+        {
+            return recordWait(start, isExit() ? Status::EXIT : Status::SUCCESS);
+        }
+
         std::unique_lock<std::mutex> lock(m_lock);
+        addWaiter();
         m_condition.wait(lock, [this, &pred]() -> bool
                          { return isExit() || pred(); });
-        if (isExit())
-        {
-            return Status::EXIT;
-        }
-        return Status::SUCCESS;
+        removeWaiter();
+        return recordWait(start, isExit() ? Status::EXIT : Status::SUCCESS);
     }
 
     /**
@@ -103,18 +159,8 @@ public:
     Wait::Status waitFor(const std::chrono::duration<Repr, Period>& timeout)
     {
         enableInternalPred();
-        std::unique_lock<std::mutex> lock(m_lock);
-        bool status{m_condition.wait_for(lock, timeout, [this]() -> bool
-                                         { return isExit() || internalPred(); })};
-        if (!status)
-        {
-            return Status::TIMEOUT;
-        }
-        if (isExit())
-        {
-            return Status::EXIT;
-        }
-        return Status::SUCCESS;
+        return waitFor(timeout, [this]() -> bool
+                       { return internalPred(); });
     }
 
     /**
@@ -135,25 +181,187 @@ public:
     template<class Repr, class Period, typename Pr>
     Status waitFor(const std::chrono::duration<Repr, Period>& timeout, Pr pred)
     {
+        return waitUntil(deadlineAfter(timeout), pred);
+    }
+
+    /**
+     * @brief Block the calling thread until a deadline or until exit is requested.
+     *
+     * @tparam C The clock of the deadline, converted to the steady clock if needed.
+     * @tparam Duration The duration type of the deadline.
+     * @param deadline The time point to wait until, `time_point::max()` to wait indefinitely.
+     * @return The status of the wait operation, either `Status::SUCCESS`, `Status::TIMEOUT`, or
+     * `Status::EXIT`.
+     */
+    template<class C, class Duration>
+    Status waitUntil(const std::chrono::time_point<C, Duration>& deadline)
+    {
+        enableInternalPred();
+        return waitUntil(deadline, [this]() -> bool
+                         { return internalPred(); });
+    }
+
+    /**
+     * @brief Block the calling thread until a deadline or until the predicate returns true.
+     *
+     * A deadline of `time_point::max()` blocks without timeout, like `wait(pred)`. Retry loops should pass
+     * the same deadline on every attempt, so that the total wait does not drift.
+     *
+     * @tparam C The clock of the deadline, converted to the steady clock if needed.
+     * @tparam Duration The duration type of the deadline.
+     * @tparam Pr The predicate type.
+     * @param deadline The time point to wait until.
+     * @param pred A callable predicate that returns a boolean value indicating whether to stop
+     * waiting.
+     * @return The status of the wait operation, either `Status::SUCCESS`, `Status::TIMEOUT`, or
+     * `Status::EXIT`.
+     */
+    template<class C, class Duration, typename Pr>
+    Status waitUntil(const std::chrono::time_point<C, Duration>& deadline, Pr pred)
+    {
+        const Clock::time_point steady_deadline{toDeadline(deadline)};
+        if (steady_deadline == NO_DEADLINE)
+        {
+            return wait(pred);
+        }
+        const Clock::time_point start{Clock::now()};
+        TRLC_THREADSAFE_TRACE(WAIT_BEGIN, this, 0, 0);
+        const std::chrono::nanoseconds left{steady_deadline > start ? steady_deadline - start : Clock::duration::zero()};
+        if (spin(std::min(left, spinLimit()), pred))
+        {
+            return recordWait(start, isExit() ? Status::EXIT : Status::SUCCESS);
+        }
+
         std::unique_lock<std::mutex> lock(m_lock);
-        bool status{m_condition.wait_for(lock, timeout, [this, &pred]() -> bool
-                                         { return isExit() || pred(); })};
+        addWaiter();
+        bool status{m_condition.wait_until(lock, steady_deadline, [this, &pred]() -> bool
+                                           { return isExit() || pred(); })};
+        removeWaiter();
         if (!status)
         {
-            return Status::TIMEOUT;
+            return recordWait(start, Status::TIMEOUT);
         }
-        if (isExit())
+        return recordWait(start, isExit() ? Status::EXIT : Status::SUCCESS);
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Clock::time_point NO_DEADLINE{Clock::time_point::max()}; ///< Deadline of an infinite wait.
+
+    /**
+     * @brief Convert a relative timeout to a steady clock deadline.
+     *
+     * Timeouts too large to be represented, such as `duration::max()`, give `NO_DEADLINE`.
+     *
+     * @param timeout The timeout, of any resolution.
+     * @return The deadline, rounded up to the clock resolution.
+     */
+    template<class Repr, class Period>
+    static Clock::time_point deadlineAfter(const std::chrono::duration<Repr, Period>& timeout)
+    {
+        const Clock::time_point now{Clock::now()};
+        if (timeout <= std::chrono::duration<Repr, Period>::zero())
         {
-            return Status::EXIT;
+            return now;
         }
-        return Status::SUCCESS;
+        // Compared in floating point seconds, which cannot overflow for any duration type.
+        if (std::chrono::duration<double>(timeout).count() >= std::chrono::duration<double>(NO_DEADLINE - now).count())
+        {
+            return NO_DEADLINE;
+        }
+        return now + std::chrono::ceil<Clock::duration>(timeout);
     }
 
-private:
-    mutable std::mutex m_lock;                     ///< Mutex for thread-safe access
-    std::condition_variable m_condition;           ///< Condition variable for signaling
-    std::atomic<bool> m_exit{false};               ///< Atomic flag indicating an exit request
-    std::atomic<bool> m_internal_pred_flag{false}; ///< Internal predicate flag used for signaling
+    /**
+     * @brief Convert a deadline of any clock to a steady clock deadline.
+     *
+     * Deadlines of other clocks are converted through the time left until them, so later adjustments of
+     * those clocks are not followed.
+     *
+     * @param deadline The deadline, `time_point::max()` for no deadline.
+     * @return The steady clock deadline.
+     */
+    template<class C, class Duration>
+    static Clock::time_point toDeadline(const std::chrono::time_point<C, Duration>& deadline)
+    {
+        if (deadline == std::chrono::time_point<C, Duration>::max())
+        {
+            return NO_DEADLINE;
+        }
+        if constexpr (std::is_same_v<C, Clock>)
+        {
+            return std::chrono::ceil<Clock::duration>(deadline);
+        }
+        else
+        {
+            return deadlineAfter(deadline - C::now());
+        }
+    }
+
+    /**
+     * @brief A waiter parked on a `Wait` without a thread, called back by the next notification.
+     *
+     * Intrusive, so parking allocates nothing. The owner keeps it alive until its callback ran.
+     */
+    struct Parked
+    {
+        void (*notified)(void* context){nullptr}; ///< Called once by the notification, outside the lock.
+        void* context{nullptr};                   ///< Argument of `notified`.
+        Parked* next{nullptr};                    ///< Next parked waiter, owned by the `Wait`.
+    };
+
+    /**
+     * @brief Park a waiter until the next notification, unless the predicate already holds.
+     *
+     * The non-blocking counterpart of `wait(pred)`: `notifyOne` calls back the oldest parked waiter before it
+     * wakes a blocked thread, `notify` and `exit` call back all of them. The callback should re-check the
+     * predicate and park again if another waiter won the race.
+     *
+     * @tparam Pr The predicate type.
+     * @param parked The waiter, not parked already.
+     * @param pred The predicate, evaluated under the lock of this `Wait`.
+     * @return `true` if the waiter was parked, `false` if the predicate holds or exit was requested.
+     */
+    template<typename Pr>
+    bool park(Parked& parked, Pr pred)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        // Counted before the predicate is checked, like a blocking waiter, so a concurrent notification either
+        // sees this waiter or its condition change is seen by the predicate.
+        addWaiter();
+        if (isExit() || pred())
+        {
+            removeWaiter();
+            return false;
+        }
+        parked.next = nullptr;
+        if (m_parked_tail != nullptr)
+        {
+            m_parked_tail->next = &parked;
+        }
+        else
+        {
+            m_parked_head = &parked;
+        }
+        m_parked_tail = &parked;
+        return true;
+    }
+
+    /**
+     * @brief Suspend a coroutine until the predicate holds, without blocking its thread.
+     *
+     * The coroutine is resumed through `executor.post`, with a `std::function<void()>` argument, as soon as a
+     * notification makes the predicate hold. A `post` returning `false`, such as `ThreadPool::post` on a
+     * stopping pool, makes the notifying thread resume the coroutine itself.
+     *
+     * @tparam Pr The predicate type.
+     * @tparam Executor The executor type, e.g. `ThreadPool` or `InlineExecutor`.
+     * @param pred The predicate, evaluated under the lock of this `Wait` or on the executor.
+     * @param executor The executor resuming the coroutine, alive until it resumed.
+     * @return An awaitable giving `Status::SUCCESS`, or `Status::EXIT` if exit was requested.
+     */
+    template<typename Pr, typename Executor>
+    WaitAwaiter<Executor, WaitPredicateOperation<Pr>> co_wait(Pr pred, Executor& executor);
 
     /**
      * @brief Check if an exit request has been made.
@@ -162,6 +370,37 @@ private:
      */
     bool isExit() const;
 
+private:
+    // Read-mostly state, loaded by every wait.
+    alignas(CACHE_LINE_SIZE) const Strategy m_strategy{Strategy::BLOCK}; ///< Strategy used before blocking
+    std::atomic<bool> m_exit{false};                                     ///< Atomic flag indicating an exit request
+
+    // Loaded by every notification, written only when a thread blocks or the internal predicate flips.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_waiters{0}; ///< Number of threads inside a wait function
+    std::atomic<bool> m_internal_pred_flag{false};               ///< Internal predicate flag used for signaling
+
+    // Written by the waiters, touched by the notifying side only while someone blocks.
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_average_wait_ns{MAX_SPIN_DURATION.count() / 4}; ///< Moving average of recent waits
+    mutable std::mutex m_lock;                                                                      ///< Mutex for thread-safe access
+    std::condition_variable m_condition;                                                            ///< Condition variable for signaling
+    Parked* m_parked_head{nullptr};                                                                 ///< Oldest parked waiter, guarded by `m_lock`
+    Parked* m_parked_tail{nullptr};                                                                 ///< Newest parked waiter, guarded by `m_lock`
+
+    /**
+     * @brief Detach parked waiters, to be called back once the lock is released.
+     *
+     * @param all Whether to detach every parked waiter or only the oldest.
+     * @return The detached waiters, linked through `Parked::next`.
+     */
+    Parked* unparkLocked(const bool all);
+
+    /**
+     * @brief Call back detached parked waiters.
+     *
+     * @param parked The waiters returned by `unparkLocked`.
+     */
+    static void resumeParked(Parked* parked);
+
     /**
      * @brief Check if the system is currently waiting.
      *
@@ -187,6 +426,273 @@ private:
      * is no longer waiting.
      */
     void disableInternalPred();
+
+    /**
+     * @brief Register the calling thread as a waiter.
+     *
+     * Called with `m_lock` held, before the predicate is evaluated for the first time. Together with the
+     * fence in `hasWaiters()`, either the notifier sees the waiter or the waiter sees the notified state.
+     */
+    void addWaiter();
+
+    /**
+     * @brief Unregister the calling thread as a waiter.
+     */
+    void removeWaiter();
+
+    /**
+     * @brief Duration of the spin phase for the configured strategy.
+     *
+     * `ADAPTIVE` spins for twice the moving average of recent waits, and not at all once the average
+     * exceeds `MAX_SPIN_DURATION`, since such waits end up blocking anyway.
+     *
+     * @return The spin duration, zero to block right away.
+     */
+    std::chrono::nanoseconds spinLimit() const;
+
+    /**
+     * @brief Feed the duration of a completed wait into the moving average used by `ADAPTIVE`, and trace its end.
+     * @param start The time point at which the wait started.
+     * @param status The outcome of the wait.
+     * @return `status`.
+     */
+    Status recordWait(const Clock::time_point start, const Status status);
+
+    /**
+     * @brief Poll the predicate without blocking, relaxing the CPU and then yielding between polls.
+     *
+     * @tparam Pr The predicate type.
+     * @param limit The maximum time to spin.
+     * @param pred The predicate to poll.
+     * @return True if the predicate was met or exit was requested within `limit`, false otherwise.
+     */
+    template<typename Pr>
+    bool spin(const std::chrono::nanoseconds limit, Pr& pred)
+    {
+        constexpr uint32_t RELAX_ITERATIONS{64};     // Polls with a pause hint before yielding.
+        constexpr uint32_t CLOCK_CHECK_INTERVAL{16}; // Polls between two reads of the clock.
+        if (limit <= std::chrono::nanoseconds::zero())
+        {
+            return false;
+        }
+        const Clock::time_point start{Clock::now()};
+        for (uint32_t i = 0;; ++i)
+        {
+            if (isExit() || pred())
+            {
+                return true;
+            }
+            if (i % CLOCK_CHECK_INTERVAL == 0 && Clock::now() - start >= limit)
+            {
+                return false;
+            }
+            if (i < RELAX_ITERATIONS)
+            {
+                cpuRelax();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+/**
+ * @brief Executor resuming coroutines on the notifying thread, for work short enough to run there.
+ */
+struct InlineExecutor
+{
+    bool post(const std::function<void()>& task) const
+    {
+        task();
+        return true;
+    }
+};
+
+/**
+ * @brief Operation of `Wait::co_wait`, complete once the predicate holds.
+ */
+template<typename Pr>
+struct WaitPredicateOperation
+{
+    Pr pred;                                    ///< The awaited predicate.
+    Wait::Status status{Wait::Status::SUCCESS}; ///< Result of the wait.
+
+    bool attempt()
+    {
+        return pred();
+    }
+    bool ready()
+    {
+        return pred();
+    }
+    void exit()
+    {
+        status = Wait::Status::EXIT;
+    }
+    Wait::Status result() const
+    {
+        return status;
+    }
+};
+
+/**
+ * @brief Awaitable suspending a coroutine on a `Wait` until an operation completes, resumed on an executor.
+ *
+ * `Operation` provides `bool attempt()`, which tries the operation and returns `true` once it completed,
+ * successfully or not; `bool ready()`, evaluated under the lock of the `Wait` and `true` when an attempt may
+ * complete; `void exit()`, called instead when exit is requested; and `result()`, the value of `co_await`.
+ *
+ * Only `await_suspend` knows the coroutine handle type, as a template parameter, so this header stays valid
+ * C++17 and a C++17 build of the library serves C++20 callers.
+ *
+ * @tparam Executor The executor type, with a `post(std::function<void()>)` member.
+ * @tparam Operation The awaited operation.
+ */
+template<typename Executor, typename Operation>
+class WaitAwaiter
+{
+public:
+    /**
+     * @brief Constructor, called by the `co_` functions.
+     * @param wait The channel notified when the operation may complete.
+     * @param executor The executor resuming the coroutine.
+     * @param operation The awaited operation.
+     */
+    WaitAwaiter(Wait& wait, Executor& executor, Operation operation)
+        : m_wait{wait}
+        , m_executor{executor}
+        , m_operation{std::move(operation)}
+    {
+    }
+
+    // Make this class uncopyable, the parked waiter points to it
+    UNCOPYABLE(WaitAwaiter);
+
+    bool await_ready()
+    {
+        return m_operation.attempt();
+    }
+
+    template<typename Handle>
+    bool await_suspend(Handle handle)
+    {
+        m_address = handle.address();
+        m_resume = [](void* address) -> void
+        { Handle::from_address(address).resume(); };
+        m_parked.notified = &WaitAwaiter::onNotified;
+        m_parked.context = this;
+        return suspend();
+    }
+
+    auto await_resume()
+    {
+        return m_operation.result();
+    }
+
+private:
+    Wait& m_wait;                     ///< Channel the coroutine is parked on.
+    Executor& m_executor;             ///< Executor resuming the coroutine.
+    Operation m_operation;            ///< The awaited operation.
+    Wait::Parked m_parked{};          ///< Parking node of the coroutine.
+    void* m_address{nullptr};         ///< Address of the coroutine handle.
+    void (*m_resume)(void*){nullptr}; ///< Resumes the coroutine from its address.
+
+    /**
+     * @brief Attempt the operation and park until the next notification while it cannot complete.
+     * @return `true` if the coroutine is parked, `false` if the operation completed and it must resume.
+     */
+    bool suspend()
+    {
+        while (!m_operation.attempt())
+        {
+            if (m_wait.isExit())
+            {
+                m_operation.exit();
+                return false;
+            }
+            // Once parked, a notification may resume the coroutine on another thread: nothing may touch
+            // this awaiter after park() returned true.
+            if (m_wait.park(m_parked, [this]() -> bool
+                            { return m_operation.ready(); }))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Callback of the parked waiter: attempt again on the executor.
+     * @param context The awaiter.
+     */
+    static void onNotified(void* context)
+    {
+        WaitAwaiter* self{static_cast<WaitAwaiter*>(context)};
+        std::function<void()> task{[self]() -> void
+                                   {
+                                       if (!self->suspend())
+                                       {
+                                           self->m_resume(self->m_address);
+                                       }
+                                   }};
+        if constexpr (std::is_same_v<decltype(self->m_executor.post(task)), bool>)
+        {
+            if (!self->m_executor.post(task))
+            {
+                task();
+            }
+        }
+        else
+        {
+            self->m_executor.post(task);
+        }
+    }
+};
+
+template<typename Pr, typename Executor>
+WaitAwaiter<Executor, WaitPredicateOperation<Pr>> Wait::co_wait(Pr pred, Executor& executor)
+{
+    return {*this, executor, WaitPredicateOperation<Pr>{std::move(pred)}};
+}
+
+/**
+ * @brief A set of external `Wait` channels to notify on every state change of an object.
+ *
+ * Lets a thread block on the events of several objects at once, as `Selector` does for queues: each
+ * object notifies the registered channels next to its own waiters. Notifying an empty set costs a fence
+ * and a load.
+ */
+class WaitObservers
+{
+public:
+    WaitObservers() = default;
+
+    // Make this class uncopyable
+    UNCOPYABLE(WaitObservers);
+
+    /**
+     * @brief Register a channel. It must be removed before it is destroyed.
+     * @param wait The channel to notify.
+     */
+    void add(Wait& wait);
+
+    /**
+     * @brief Unregister a channel. Once this returns, the channel is no longer notified.
+     * @param wait The channel to remove.
+     */
+    void remove(Wait& wait);
+
+    /**
+     * @brief Notify every registered channel.
+     */
+    void notify();
+
+private:
+    std::atomic<std::size_t> m_count{0}; ///< Number of registered channels.
+    std::mutex m_lock{};                 ///< Guards `m_waits`.
+    std::vector<Wait*> m_waits{};        ///< Registered channels.
 };
 
 } // namespace threadsafe
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "trlc/threadsafe/common.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+/**
+ * @brief Lock-free Chase–Lev work-stealing deque.
+ *
+ * A single owner thread pushes and pops at the bottom, while any number of thief threads steal from the
+ * top. The ring grows when full; arrays replaced by a growth are kept until the deque is destroyed
+ * because a concurrent thief may still read from them. The memory orders follow Lê et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ *
+ * @tparam T Type of elements stored in the deque, typically a pointer to a task.
+ */
+template<typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque requires a trivially copyable element type");
+
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY{256};
+
+    /**
+     * @brief Constructor that accepts the initial capacity.
+     * @param capacity Initial number of slots, rounded up to a power of two.
+     */
+    explicit WorkStealingDeque(const std::size_t capacity = DEFAULT_CAPACITY);
+
+    // Make this class uncopyable
+    UNCOPYABLE(WorkStealingDeque);
+
+    /**
+     * @brief Push an element at the bottom. Must only be called by the owner thread.
+     * @param elem The element to push.
+     */
+    void push(const T elem);
+
+    /**
+     * @brief Pop the most recently pushed element. Must only be called by the owner thread.
+     * @return The element, or `std::nullopt` if the deque is empty.
+     */
+    std::optional<T> pop();
+
+    /**
+     * @brief Steal the oldest element. May be called by any thread.
+     * @return The element, or `std::nullopt` if the deque is empty or another thread won the race.
+     */
+    std::optional<T> steal();
+
+    /**
+     * @brief Approximate number of elements, exact only when called by the owner without thieves.
+     * @return The number of elements.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Check whether the deque looks empty.
+     * @return `true` if no element is visible, `false` otherwise.
+     */
+    bool empty() const;
+
+private:
+    /**
+     * @brief Circular array of atomic slots.
+     */
+    struct Array
+    {
+        const std::size_t capacity;                ///< Number of slots, a power of two.
+        const std::size_t mask;                    ///< Mask mapping an index to a slot.
+        std::unique_ptr<std::atomic<T>[]> slots{}; ///< Slot storage.
+
+        explicit Array(const std::size_t size)
+            : capacity{size}
+            , mask{size - 1}
+            , slots{std::make_unique<std::atomic<T>[]>(size)}
+        {
+        }
+
+        T get(const int64_t index) const
+        {
+            return slots[static_cast<std::size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(const int64_t index, const T elem)
+        {
+            slots[static_cast<std::size_t>(index) & mask].store(elem, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_top{0};    ///< Index thieves steal from.
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_bottom{0}; ///< Index the owner pushes to.
+    std::atomic<Array*> m_array{nullptr};                      ///< Current ring.
+    std::vector<std::unique_ptr<Array>> m_arrays{};            ///< Current and retired rings, owner only.
+
+    Array* grow(Array* array, const int64_t bottom, const int64_t top); ///< Double the ring size.
+};
+
+template<typename T>
+WorkStealingDeque<T>::WorkStealingDeque(const std::size_t capacity)
+{
+    m_arrays.push_back(std::make_unique<Array>(nextPowerOfTwo(capacity)));
+    m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+}
+
+template<typename T>
+void WorkStealingDeque<T>::push(const T elem)
+{
+    const int64_t bottom{m_bottom.load(std::memory_order_relaxed)};
+    const int64_t top{m_top.load(std::memory_order_acquire)};
+    Array* array{m_array.load(std::memory_order_relaxed)};
+    if (bottom - top > static_cast<int64_t>(array->capacity) - 1)
+    {
+        array = grow(array, bottom, top);
+    }
+    array->put(bottom, elem);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template<typename T>
+std::optional<T> WorkStealingDeque<T>::pop()
+{
+    const int64_t bottom{m_bottom.load(std::memory_order_relaxed) - 1};
+    Array* array{m_array.load(std::memory_order_relaxed)};
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top{m_top.load(std::memory_order_relaxed)};
+
+    if (top > bottom)
+    {
+        // Empty, restore the bottom.
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    const T elem{array->get(bottom)};
+    if (top == bottom)
+    {
+        // Last element, race against the thieves for it.
+        const bool won{m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)};
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        if (!won)
+        {
+            return std::nullopt;
+        }
+    }
+    return elem;
+}
+
+template<typename T>
+std::optional<T> WorkStealingDeque<T>::steal()
+{
+    int64_t top{m_top.load(std::memory_order_acquire)};
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom{m_bottom.load(std::memory_order_acquire)};
+    if (top >= bottom)
+    {
+        return std::nullopt;
+    }
+
+    Array* array{m_array.load(std::memory_order_acquire)};
+    const T elem{array->get(top)};
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return std::nullopt;
+    }
+    return elem;
+}
+
+template<typename T>
+std::size_t WorkStealingDeque<T>::size() const
+{
+    const int64_t bottom{m_bottom.load(std::memory_order_relaxed)};
+    const int64_t top{m_top.load(std::memory_order_relaxed)};
+    return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::empty() const
+{
+    return size() == 0;
+}
+
+template<typename T>
+typename WorkStealingDeque<T>::Array* WorkStealingDeque<T>::grow(Array* array, const int64_t bottom, const int64_t top)
+{
+    auto bigger{std::make_unique<Array>(array->capacity * 2)};
+    for (int64_t index = top; index < bottom; ++index)
+    {
+        bigger->put(index, array->get(index));
+    }
+    Array* result{bigger.get()};
+    m_arrays.push_back(std::move(bigger));
+    m_array.store(result, std::memory_order_release);
+    return result;
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,61 @@
+#include "trlc/threadsafe/histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+uint64_t DurationHistogramSnapshot::count() const
+{
+    uint64_t count{0};
+    for (const uint64_t bucket : buckets)
+    {
+        count += bucket;
+    }
+    return count;
+}
+
+std::chrono::nanoseconds DurationHistogramSnapshot::percentile(const double fraction) const
+{
+    const uint64_t total{count()};
+    if (total == 0)
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+    const double clamped{fraction < 0.0 ? 0.0 : (fraction > 1.0 ? 1.0 : fraction)};
+    const uint64_t rank{std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * static_cast<double>(total))))};
+    uint64_t seen{0};
+    for (std::size_t index = 0; index < BUCKETS; ++index)
+    {
+        seen += buckets[index];
+        if (seen >= rank)
+        {
+            return std::chrono::nanoseconds{(int64_t{2} << index) - 1};
+        }
+    }
+    return std::chrono::nanoseconds{(int64_t{2} << (BUCKETS - 1)) - 1};
+}
+
+DurationHistogram::Snapshot DurationHistogram::snapshot() const
+{
+    Snapshot snapshot{};
+    for (std::size_t index = 0; index < Snapshot::BUCKETS; ++index)
+    {
+        snapshot.buckets[index] = m_buckets[index].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void DurationHistogram::reset()
+{
+    for (std::atomic<uint64_t>& bucket : m_buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,106 @@
+#include "trlc/threadsafe/mutex.hpp"
+
+#include <new>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif __linux__
+#include <pthread.h>
+#endif
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+#ifdef _WIN32
+using NativeMutex = ::SRWLOCK;
+#elif __linux__
+using NativeMutex = ::pthread_mutex_t;
+#endif
+
+static_assert(sizeof(NativeMutex) <= PriorityInheritanceMutex::NATIVE_SIZE, "The native mutex fits in its storage");
+static_assert(alignof(NativeMutex) <= 8, "The storage is aligned for the native mutex");
+
+namespace
+{
+
+NativeMutex* native(unsigned char* storage)
+{
+    return reinterpret_cast<NativeMutex*>(storage);
+}
+
+} // namespace
+
+PriorityInheritanceMutex::PriorityInheritanceMutex()
+{
+#ifdef _WIN32
+    ::InitializeSRWLock(new (m_native) NativeMutex);
+#elif __linux__
+    ::pthread_mutexattr_t attr;
+    int error{::pthread_mutexattr_init(&attr)};
+    if (error == 0)
+    {
+        m_inherits = ::pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT) == 0;
+        error = ::pthread_mutex_init(new (m_native) NativeMutex, &attr);
+        ::pthread_mutexattr_destroy(&attr);
+    }
+    if (error != 0)
+    {
+        // PI futexes are missing from the kernel, or the attributes could not be created.
+        m_inherits = false;
+        error = ::pthread_mutex_init(new (m_native) NativeMutex, nullptr);
+    }
+    if (error != 0)
+    {
+        throw std::system_error(error, std::generic_category(), "PriorityInheritanceMutex");
+    }
+#endif
+}
+
+PriorityInheritanceMutex::~PriorityInheritanceMutex()
+{
+#ifdef __linux__
+    ::pthread_mutex_destroy(native(m_native));
+#endif
+}
+
+void PriorityInheritanceMutex::lock()
+{
+#ifdef _WIN32
+    ::AcquireSRWLockExclusive(native(m_native));
+#elif __linux__
+    const int error{::pthread_mutex_lock(native(m_native))};
+    if (error != 0)
+    {
+        throw std::system_error(error, std::generic_category(), "PriorityInheritanceMutex::lock");
+    }
+#endif
+}
+
+bool PriorityInheritanceMutex::try_lock()
+{
+#ifdef _WIN32
+    return ::TryAcquireSRWLockExclusive(native(m_native)) != 0;
+#elif __linux__
+    return ::pthread_mutex_trylock(native(m_native)) == 0;
+#endif
+}
+
+void PriorityInheritanceMutex::unlock()
+{
+#ifdef _WIN32
+    ::ReleaseSRWLockExclusive(native(m_native));
+#elif __linux__
+    ::pthread_mutex_unlock(native(m_native));
+#endif
+}
+
+bool PriorityInheritanceMutex::inheritsPriority() const
+{
+    return m_inherits;
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,293 @@
+#include "trlc/threadsafe/numa.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif __linux__
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+namespace
+{
+
+std::error_code systemError(const int error)
+{
+    return std::error_code{error, std::system_category()};
+}
+
+std::error_code invalidArgument()
+{
+#ifdef _WIN32
+    return systemError(ERROR_INVALID_PARAMETER);
+#else
+    return systemError(EINVAL);
+#endif
+}
+
+} // namespace
+
+#ifdef __linux__
+namespace
+{
+
+constexpr std::size_t BITS_PER_WORD{sizeof(unsigned long) * 8};
+
+/**
+ * @brief Parse a kernel CPU or node list such as "0-3,8,10-11".
+ */
+CpuSet parseList(const std::string& list)
+{
+    CpuSet result{};
+    const char* cursor{list.c_str()};
+    while (*cursor != '\0')
+    {
+        char* end{nullptr};
+        const unsigned long first{std::strtoul(cursor, &end, 10)};
+        if (end == cursor)
+        {
+            break; // Malformed list.
+        }
+        unsigned long last{first};
+        cursor = end;
+        if (*cursor == '-')
+        {
+            last = std::strtoul(cursor + 1, &end, 10);
+            cursor = end;
+        }
+        for (unsigned long value = first; value <= last; ++value)
+        {
+            result.push_back(static_cast<uint32_t>(value));
+        }
+        if (*cursor != ',')
+        {
+            break;
+        }
+        ++cursor;
+    }
+    return result;
+}
+
+std::string readLine(const std::string& path)
+{
+    std::ifstream file{path};
+    std::string line{};
+    std::getline(file, line);
+    return line;
+}
+
+/**
+ * @brief Build a node mask for the memory policy syscalls.
+ */
+std::vector<unsigned long> nodeMask(const int32_t node)
+{
+    std::vector<unsigned long> mask(static_cast<std::size_t>(node) / BITS_PER_WORD + 1, 0);
+    mask[static_cast<std::size_t>(node) / BITS_PER_WORD] |= 1UL << (static_cast<std::size_t>(node) % BITS_PER_WORD);
+    return mask;
+}
+
+} // namespace
+#endif
+
+std::error_code setNativeThreadAffinity(const CpuSet& cpus, const std::thread::native_handle_type native_handle)
+{
+    if (cpus.empty())
+    {
+        return invalidArgument();
+    }
+#ifdef _WIN32
+    constexpr uint32_t CPUS_PER_GROUP{64};
+    ::GROUP_AFFINITY affinity{};
+    affinity.Group = static_cast<WORD>(cpus.front() / CPUS_PER_GROUP);
+    for (const uint32_t cpu : cpus)
+    {
+        if (cpu / CPUS_PER_GROUP != affinity.Group)
+        {
+            return invalidArgument();
+        }
+        affinity.Mask |= KAFFINITY{1} << (cpu % CPUS_PER_GROUP);
+    }
+    if (::SetThreadGroupAffinity(native_handle, &affinity, nullptr) == 0)
+    {
+        return systemError(static_cast<int>(::GetLastError()));
+    }
+    return {};
+#elif __linux__
+    ::cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const uint32_t cpu : cpus)
+    {
+        if (cpu >= CPU_SETSIZE)
+        {
+            return invalidArgument();
+        }
+        CPU_SET(cpu, &set);
+    }
+    return systemError(::pthread_setaffinity_np(native_handle, sizeof(set), &set));
+#endif
+}
+
+std::error_code bindCurrentThreadToNumaNode(const int32_t node)
+{
+    if (node < 0)
+    {
+        return invalidArgument();
+    }
+#ifdef _WIN32
+    ::GROUP_AFFINITY affinity{};
+    if (::GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity) == 0)
+    {
+        return systemError(static_cast<int>(::GetLastError()));
+    }
+    if (affinity.Mask == 0)
+    {
+        return invalidArgument();
+    }
+    if (::SetThreadGroupAffinity(::GetCurrentThread(), &affinity, nullptr) == 0)
+    {
+        return systemError(static_cast<int>(::GetLastError()));
+    }
+    return {};
+#elif __linux__
+    const std::error_code error{setNativeThreadAffinity(numaNodeCpus(node), ::pthread_self())};
+    if (error)
+    {
+        return error;
+    }
+    // The binding stays applied, and is still useful, when the memory policy is not permitted.
+    std::vector<unsigned long> mask{nodeMask(node)};
+    if (::syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask.data(), mask.size() * BITS_PER_WORD + 1) != 0)
+    {
+        return systemError(errno);
+    }
+    return {};
+#endif
+}
+
+uint32_t numaNodeCount()
+{
+#ifdef _WIN32
+    ULONG highest{0};
+    if (::GetNumaHighestNodeNumber(&highest) == 0)
+    {
+        return 1;
+    }
+    return static_cast<uint32_t>(highest) + 1;
+#elif __linux__
+    const CpuSet nodes{parseList(readLine("/sys/devices/system/node/online"))};
+    if (nodes.empty())
+    {
+        return 1;
+    }
+    return nodes.back() + 1;
+#endif
+}
+
+int32_t currentNumaNode()
+{
+#ifdef _WIN32
+    ::PROCESSOR_NUMBER processor{};
+    ::GetCurrentProcessorNumberEx(&processor);
+    USHORT node{0};
+    if (::GetNumaProcessorNodeEx(&processor, &node) == 0)
+    {
+        return NO_NUMA_NODE;
+    }
+    return static_cast<int32_t>(node);
+#elif __linux__
+    unsigned int cpu{0};
+    unsigned int node{0};
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+    {
+        return NO_NUMA_NODE;
+    }
+    return static_cast<int32_t>(node);
+#endif
+}
+
+CpuSet numaNodeCpus(const int32_t node)
+{
+    if (node < 0)
+    {
+        return {};
+    }
+#ifdef _WIN32
+    constexpr uint32_t CPUS_PER_GROUP{64};
+    ::GROUP_AFFINITY affinity{};
+    if (::GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity) == 0)
+    {
+        return {};
+    }
+    CpuSet cpus{};
+    for (uint32_t bit = 0; bit < CPUS_PER_GROUP; ++bit)
+    {
+        if ((affinity.Mask >> bit) & 1)
+        {
+            cpus.push_back(affinity.Group * CPUS_PER_GROUP + bit);
+        }
+    }
+    return cpus;
+#elif __linux__
+    CpuSet cpus{parseList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"))};
+    if (cpus.empty() && node == 0 && numaNodeCount() == 1)
+    {
+        // Kernels without NUMA support have no node directory, every CPU belongs to node 0.
+        for (uint32_t cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+#endif
+}
+
+void* numaAllocate(const std::size_t bytes, const int32_t node)
+{
+    if (bytes == 0 || node < 0)
+    {
+        return nullptr;
+    }
+#ifdef _WIN32
+    return ::VirtualAllocExNuma(::GetCurrentProcess(), nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+                                static_cast<DWORD>(node));
+#elif __linux__
+    void* ptr{::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+    if (ptr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    // Pages are placed on first touch, the policy makes the kernel prefer the node for them.
+    std::vector<unsigned long> mask{nodeMask(node)};
+    ::syscall(SYS_mbind, ptr, bytes, MPOL_PREFERRED, mask.data(), mask.size() * BITS_PER_WORD + 1, 0);
+    return ptr;
+#endif
+}
+
+void numaDeallocate(void* ptr, const std::size_t bytes)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+#ifdef _WIN32
+    (void)bytes;
+    ::VirtualFree(ptr, 0, MEM_RELEASE);
+#elif __linux__
+    ::munmap(ptr, bytes);
+#endif
+}
+
+} // namespace threadsafe
+} // namespace trlc
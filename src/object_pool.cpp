@@ -0,0 +1,82 @@
+#include "trlc/threadsafe/object_pool.hpp"
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+namespace detail
+{
+uint64_t nextObjectPoolId()
+{
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace detail
+
+BlockPool::~BlockPool()
+{
+    for (std::size_t index = 0; index < CLASSES; ++index)
+    {
+        while (m_free[index] != nullptr)
+        {
+            FreeBlock* block{m_free[index]};
+            m_free[index] = block->next;
+            ::operator delete(block);
+        }
+    }
+}
+
+void* BlockPool::allocate(const std::size_t bytes, const std::size_t alignment)
+{
+    if (!pooled(bytes, alignment))
+    {
+        return ::operator new(bytes, std::align_val_t{alignment});
+    }
+    const std::size_t index{sizeClass(bytes)};
+    {
+        std::lock_guard<std::mutex> guard{m_lock};
+        if (FreeBlock* block{m_free[index]})
+        {
+            m_free[index] = block->next;
+            return block;
+        }
+    }
+    return ::operator new(MIN_BLOCK_SIZE << index);
+}
+
+void BlockPool::deallocate(void* ptr, const std::size_t bytes, const std::size_t alignment)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    if (!pooled(bytes, alignment))
+    {
+        ::operator delete(ptr, std::align_val_t{alignment});
+        return;
+    }
+    const std::size_t index{sizeClass(bytes)};
+    FreeBlock* block{static_cast<FreeBlock*>(ptr)};
+    std::lock_guard<std::mutex> guard{m_lock};
+    block->next = m_free[index];
+    m_free[index] = block;
+}
+
+bool BlockPool::pooled(const std::size_t bytes, const std::size_t alignment)
+{
+    return bytes <= MAX_BLOCK_SIZE && alignment <= alignof(std::max_align_t);
+}
+
+std::size_t BlockPool::sizeClass(const std::size_t bytes)
+{
+    std::size_t index{0};
+    while ((MIN_BLOCK_SIZE << index) < bytes)
+    {
+        ++index;
+    }
+    return index;
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,79 @@
+#include "trlc/threadsafe/parallel.hpp"
+
+namespace trlc
+{
+namespace threadsafe
+{
+namespace detail
+{
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : m_pool{pool}
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    join();
+}
+
+void TaskGroup::wait()
+{
+    join();
+    std::exception_ptr error{};
+    {
+        std::lock_guard<std::mutex> lock{m_state->error_lock};
+        std::swap(error, m_state->error);
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::join()
+{
+    State& state{*m_state};
+    while (state.pending.load(std::memory_order_acquire) > 0)
+    {
+        if (m_pool.tryRunOne())
+        {
+            continue;
+        }
+        // Every remaining task is running elsewhere, but those may still queue more.
+        state.done.waitFor(HELP_INTERVAL, [&state]() -> bool
+                           { return state.pending.load(std::memory_order_acquire) == 0; });
+    }
+}
+
+void TaskGroup::State::fail(std::exception_ptr exception)
+{
+    std::lock_guard<std::mutex> lock{error_lock};
+    if (!error)
+    {
+        error = std::move(exception);
+    }
+}
+
+void TaskGroup::State::finish()
+{
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        done.notify();
+    }
+}
+
+std::size_t grainSize(const ThreadPool& pool, const std::size_t count, const std::size_t grain)
+{
+    if (grain != AUTO_GRAIN)
+    {
+        return grain;
+    }
+    // The caller runs chunks too.
+    const std::size_t chunks{(pool.size() + 1) * CHUNKS_PER_THREAD};
+    return std::max<std::size_t>(count / chunks, 1);
+}
+
+} // namespace detail
+} // namespace threadsafe
+} // namespace trlc
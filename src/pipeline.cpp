@@ -0,0 +1,82 @@
+#include "trlc/threadsafe/pipeline.hpp"
+
+#include <utility>
+
+namespace trlc
+{
+namespace threadsafe
+{
+namespace detail
+{
+
+PipelineGraph::PipelineGraph(const PipelineSettings& settings)
+    : m_settings{settings}
+{
+}
+
+const PipelineSettings& PipelineGraph::settings() const
+{
+    return m_settings;
+}
+
+bool PipelineGraph::declaring() const
+{
+    return !m_complete && !m_started;
+}
+
+void PipelineGraph::add(std::unique_ptr<PipelineStage> stage, const bool sink)
+{
+    m_stages.push_back(std::move(stage));
+    m_complete = sink;
+}
+
+bool PipelineGraph::start()
+{
+    if (m_started || !m_complete)
+    {
+        return false;
+    }
+    m_started = true;
+    // Every queue is open before any worker pushes into it.
+    for (auto& stage : m_stages)
+    {
+        stage->open();
+    }
+    m_start = std::chrono::steady_clock::now();
+    for (auto& stage : m_stages)
+    {
+        stage->run();
+    }
+    return true;
+}
+
+void PipelineGraph::abort()
+{
+    for (auto& stage : m_stages)
+    {
+        stage->abort();
+    }
+}
+
+void PipelineGraph::join()
+{
+    for (auto& stage : m_stages)
+    {
+        stage->join();
+    }
+}
+
+std::vector<PipelineStageStats> PipelineGraph::stats() const
+{
+    std::vector<PipelineStageStats> stats{};
+    stats.reserve(m_stages.size());
+    for (const auto& stage : m_stages)
+    {
+        stats.push_back(stage->stats(m_start));
+    }
+    return stats;
+}
+
+} // namespace detail
+} // namespace threadsafe
+} // namespace trlc
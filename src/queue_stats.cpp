@@ -0,0 +1,39 @@
+#include "trlc/threadsafe/queue_stats.hpp"
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+QueueStats::Snapshot QueueStats::snapshot() const
+{
+    Snapshot snapshot{};
+    snapshot.pushed = m_pushed.load(std::memory_order_relaxed);
+    snapshot.popped = m_popped.load(std::memory_order_relaxed);
+    snapshot.discarded_oldest = m_discarded_oldest.load(std::memory_order_relaxed);
+    snapshot.discarded_newest = m_discarded_newest.load(std::memory_order_relaxed);
+    snapshot.high_water_mark = m_high_water_mark.load(std::memory_order_relaxed);
+    snapshot.blocked_pushes = m_blocked_pushes.load(std::memory_order_relaxed);
+    snapshot.blocked_pops = m_blocked_pops.load(std::memory_order_relaxed);
+    snapshot.push_blocked_time = std::chrono::nanoseconds{static_cast<int64_t>(m_push_blocked_ns.load(std::memory_order_relaxed))};
+    snapshot.pop_blocked_time = std::chrono::nanoseconds{static_cast<int64_t>(m_pop_blocked_ns.load(std::memory_order_relaxed))};
+    snapshot.latency = m_latency.snapshot();
+    return snapshot;
+}
+
+void QueueStats::reset()
+{
+    m_pushed.store(0, std::memory_order_relaxed);
+    m_popped.store(0, std::memory_order_relaxed);
+    m_discarded_oldest.store(0, std::memory_order_relaxed);
+    m_discarded_newest.store(0, std::memory_order_relaxed);
+    m_high_water_mark.store(0, std::memory_order_relaxed);
+    m_blocked_pushes.store(0, std::memory_order_relaxed);
+    m_blocked_pops.store(0, std::memory_order_relaxed);
+    m_push_blocked_ns.store(0, std::memory_order_relaxed);
+    m_pop_blocked_ns.store(0, std::memory_order_relaxed);
+    m_latency.reset();
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,330 @@
+#include "trlc/threadsafe/scheduler.hpp"
+
+#include <utility>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+bool Scheduler::Token::cancel()
+{
+    const EntryPtr entry{m_entry.lock()};
+    if (!entry)
+    {
+        return false;
+    }
+    uint8_t expected{Entry::PENDING};
+    if (entry->state.compare_exchange_strong(expected, Entry::CANCELLED, std::memory_order_acq_rel))
+    {
+        // Nobody touches the task of a cancelled entry, release its captures now rather than at its deadline.
+        entry->task = nullptr;
+        entry->count->fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    // A periodic task in progress, the run releases it once it sees the cancellation.
+    expected = Entry::RUNNING;
+    if (entry->state.compare_exchange_strong(expected, Entry::CANCELLED, std::memory_order_acq_rel))
+    {
+        entry->count->fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool Scheduler::Token::active() const
+{
+    const EntryPtr entry{m_entry.lock()};
+    if (!entry)
+    {
+        return false;
+    }
+    const uint8_t state{entry->state.load(std::memory_order_acquire)};
+    return state == Entry::PENDING || state == Entry::RUNNING;
+}
+
+Scheduler::Scheduler(const Settings& settings)
+    : m_settings{settings}
+    , m_tick{std::max(std::chrono::ceil<Clock::duration>(settings.tick), Clock::duration{1})}
+    , m_origin{Clock::now()}
+    , m_count{std::make_shared<std::atomic<std::size_t>>(0)}
+    , m_pool_tasks{std::make_shared<PoolTasks>()}
+    , m_thread{settings.name, settings.priority}
+{
+    m_thread.invoke([this]()
+                    { step(); });
+    m_thread.setPredicate([this]() -> bool
+                          { return !m_stopping.load(std::memory_order_acquire); });
+    m_thread.run(Thread::RunMode::LOOP);
+}
+
+Scheduler::~Scheduler()
+{
+    m_stopping.store(true, std::memory_order_release);
+    m_wakeup.notify();
+    m_thread.stop();
+    m_pool_tasks->done.wait([this]() -> bool
+                            { return m_pool_tasks->running.load(std::memory_order_acquire) == 0; });
+}
+
+std::size_t Scheduler::size() const
+{
+    return m_count->load(std::memory_order_relaxed);
+}
+
+Scheduler::Token Scheduler::schedule(const Clock::time_point deadline, const Clock::duration period, const Period mode, Task task)
+{
+    if (!task)
+    {
+        return Token{};
+    }
+    auto entry{std::make_shared<Entry>()};
+    entry->task = std::move(task);
+    entry->deadline = deadline;
+    entry->period = period;
+    entry->mode = mode;
+    entry->count = m_count;
+    m_count->fetch_add(1, std::memory_order_relaxed);
+    arm(entry);
+    return Token{entry};
+}
+
+void Scheduler::arm(const EntryPtr& entry)
+{
+    bool wake{false};
+    {
+        std::lock_guard<std::mutex> lock{m_lock};
+        entry->expiry = tickAtOrAfter(entry->deadline);
+        insertLocked(entry);
+        wake = entry->expiry < m_sleep_until.load(std::memory_order_relaxed);
+    }
+    if (wake)
+    {
+        m_rearm.store(true, std::memory_order_release);
+        m_wakeup.notifyOne();
+    }
+}
+
+void Scheduler::step()
+{
+    uint64_t next{NO_TICK};
+    {
+        std::lock_guard<std::mutex> lock{m_lock};
+        const uint64_t now{tickAtOrBefore(Clock::now())};
+        if (m_stored == 0 && m_current <= now)
+        {
+            // Nothing to cascade nor expire on the way, skip the idle ticks at once.
+            m_current = now + 1;
+        }
+        while (m_current <= now)
+        {
+            advanceLocked();
+        }
+        next = nextTickLocked();
+        // Published under the lock, so that a timer inserted from now on sees whether it must wake us.
+        m_sleep_until.store(next, std::memory_order_relaxed);
+    }
+
+    for (const EntryPtr& entry : m_expired)
+    {
+        dispatch(entry);
+    }
+    m_expired.clear();
+
+    auto woken{[this]() -> bool
+               { return m_rearm.exchange(false, std::memory_order_acq_rel) || m_stopping.load(std::memory_order_acquire); }};
+    if (next == NO_TICK)
+    {
+        m_wakeup.wait(woken);
+    }
+    else
+    {
+        m_wakeup.waitUntil(timeOf(next), woken);
+    }
+}
+
+void Scheduler::advanceLocked()
+{
+    const uint64_t tick{m_current};
+    // Each time the lower wheels wrap around, the next slot of the wheel above moves down.
+    for (std::size_t level = 1; level < LEVELS; ++level)
+    {
+        const uint32_t shift{static_cast<uint32_t>(level) * SLOT_BITS};
+        if ((tick & ((uint64_t{1} << shift) - 1)) != 0)
+        {
+            break;
+        }
+        Slot cascade{};
+        cascade.swap(m_wheel[level][(tick >> shift) & SLOT_MASK]);
+        m_stored -= cascade.size();
+        for (const EntryPtr& entry : cascade)
+        {
+            if (entry->state.load(std::memory_order_relaxed) != Entry::CANCELLED)
+            {
+                insertLocked(entry);
+            }
+        }
+    }
+
+    Slot expired{};
+    expired.swap(m_wheel[0][tick & SLOT_MASK]);
+    m_stored -= expired.size();
+    m_current = tick + 1;
+    for (EntryPtr& entry : expired)
+    {
+        if (entry->state.load(std::memory_order_relaxed) == Entry::CANCELLED)
+        {
+            continue;
+        }
+        if (entry->expiry > tick)
+        {
+            insertLocked(entry);
+            continue;
+        }
+        m_expired.push_back(std::move(entry));
+    }
+}
+
+void Scheduler::insertLocked(const EntryPtr& entry)
+{
+    // Late entries expire on the next processed tick, entries beyond the last wheel wait at its far end and
+    // are placed again by their real expiry when they cascade.
+    constexpr uint64_t SPAN{uint64_t{1} << (LEVELS * SLOT_BITS)};
+    uint64_t expiry{std::max(entry->expiry, m_current)};
+    if (expiry - m_current >= SPAN)
+    {
+        expiry = m_current + SPAN - 1;
+    }
+    const uint64_t delta{expiry - m_current};
+    std::size_t level{0};
+    while (level + 1 < LEVELS && delta >= (uint64_t{1} << ((level + 1) * SLOT_BITS)))
+    {
+        ++level;
+    }
+    m_wheel[level][(expiry >> (level * SLOT_BITS)) & SLOT_MASK].push_back(entry);
+    ++m_stored;
+}
+
+uint64_t Scheduler::nextTickLocked() const
+{
+    if (m_stored == 0)
+    {
+        return NO_TICK;
+    }
+    if ((m_current & SLOT_MASK) == 0)
+    {
+        // The current tick starts by a cascade.
+        return m_current;
+    }
+    // Up to the next cascade, only the first wheel can expire entries.
+    const uint64_t cascade{(m_current | SLOT_MASK) + 1};
+    for (uint64_t tick = m_current; tick < cascade; ++tick)
+    {
+        if (!m_wheel[0][tick & SLOT_MASK].empty())
+        {
+            return tick;
+        }
+    }
+    return cascade;
+}
+
+void Scheduler::dispatch(const EntryPtr& entry)
+{
+    const bool periodic{entry->period != Clock::duration::zero()};
+    uint8_t expected{Entry::PENDING};
+    if (!entry->state.compare_exchange_strong(expected, periodic ? Entry::RUNNING : Entry::DONE, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    if (!periodic)
+    {
+        entry->count->fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    if (m_settings.pool == nullptr)
+    {
+        execute(entry);
+        return;
+    }
+    const std::shared_ptr<PoolTasks> pool_tasks{m_pool_tasks};
+    pool_tasks->running.fetch_add(1, std::memory_order_relaxed);
+    const bool posted{m_settings.pool->post([this, entry, pool_tasks]()
+                                            {
+        execute(entry);
+        if (pool_tasks->running.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            pool_tasks->done.notify();
+        } })};
+    if (!posted)
+    {
+        // The pool is stopping, run the task here rather than lose it.
+        pool_tasks->running.fetch_sub(1, std::memory_order_relaxed);
+        execute(entry);
+    }
+}
+
+void Scheduler::execute(const EntryPtr& entry)
+{
+    entry->task();
+    if (entry->period == Clock::duration::zero())
+    {
+        entry->task = nullptr;
+        return;
+    }
+    rearm(entry);
+}
+
+void Scheduler::rearm(const EntryPtr& entry)
+{
+    const Clock::time_point now{Clock::now()};
+    if (entry->mode == Period::FIXED_DELAY)
+    {
+        entry->deadline = now + entry->period;
+    }
+    else
+    {
+        entry->deadline += entry->period;
+        if (entry->deadline <= now)
+        {
+            // Skip the runs missed by a late or long run, keeping the phase of the first deadline.
+            entry->deadline += entry->period * ((now - entry->deadline) / entry->period + 1);
+        }
+    }
+
+    uint8_t expected{Entry::RUNNING};
+    if (m_stopping.load(std::memory_order_acquire)
+        || !entry->state.compare_exchange_strong(expected, Entry::PENDING, std::memory_order_acq_rel))
+    {
+        // Cancelled while it ran, or the scheduler is going away.
+        entry->task = nullptr;
+        return;
+    }
+    arm(entry);
+}
+
+uint64_t Scheduler::tickAtOrAfter(const Clock::time_point time) const
+{
+    if (time <= m_origin)
+    {
+        return 0;
+    }
+    const Clock::duration elapsed{time - m_origin};
+    return static_cast<uint64_t>(elapsed / m_tick) + (elapsed % m_tick != Clock::duration::zero() ? 1 : 0);
+}
+
+uint64_t Scheduler::tickAtOrBefore(const Clock::time_point time) const
+{
+    if (time <= m_origin)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>((time - m_origin) / m_tick);
+}
+
+Scheduler::Clock::time_point Scheduler::timeOf(const uint64_t tick) const
+{
+    return m_origin + m_tick * static_cast<Clock::duration::rep>(tick);
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,123 @@
+#include "trlc/threadsafe/selector.hpp"
+
+#include <chrono>
+#include <utility>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+Selector::Selector(const Wait::Strategy strategy)
+    : m_wait{strategy}
+{
+}
+
+Selector::~Selector()
+{
+    std::vector<Source> sources{};
+    {
+        std::lock_guard<std::mutex> lock{m_lock};
+        sources.swap(m_sources);
+    }
+    for (Source& source : sources)
+    {
+        if (source.detach)
+        {
+            source.detach(m_wait);
+        }
+    }
+}
+
+std::size_t Selector::addSource(Source source)
+{
+    std::lock_guard<std::mutex> lock{m_lock};
+    for (std::size_t index = 0; index < m_sources.size(); ++index)
+    {
+        if (!m_sources[index].ready)
+        {
+            m_sources[index] = std::move(source);
+            return index;
+        }
+    }
+    m_sources.push_back(std::move(source));
+    return m_sources.size() - 1;
+}
+
+bool Selector::remove(const std::size_t index)
+{
+    Source source{};
+    {
+        std::lock_guard<std::mutex> lock{m_lock};
+        if (index >= m_sources.size() || !m_sources[index].ready)
+        {
+            return false;
+        }
+        source = std::move(m_sources[index]);
+        m_sources[index] = Source{};
+    }
+    // Detached outside the lock: a queue notifies its observers under its own lock, which then takes
+    // the lock of the selector's Wait, whose predicate takes this lock.
+    source.detach(m_wait);
+    return true;
+}
+
+std::size_t Selector::wait(std::vector<std::size_t>& ready, const uint32_t timeout_ms)
+{
+    ready.clear();
+    auto any_ready = [this, &ready]() -> bool
+    {
+        std::lock_guard<std::mutex> lock{m_lock};
+        ready.clear();
+        for (std::size_t index = 0; index < m_sources.size(); ++index)
+        {
+            if (m_sources[index].ready && m_sources[index].ready())
+            {
+                ready.push_back(index);
+            }
+        }
+        return !ready.empty();
+    };
+    if (timeout_ms == WAIT_FOREVER)
+    {
+        m_wait.wait(any_ready);
+    }
+    else
+    {
+        m_wait.waitFor(std::chrono::milliseconds(timeout_ms), any_ready);
+    }
+    return ready.size();
+}
+
+std::size_t Selector::waitAny(const uint32_t timeout_ms)
+{
+    std::size_t found{NONE};
+    auto one_ready = [this, &found]() -> bool
+    {
+        std::lock_guard<std::mutex> lock{m_lock};
+        const std::size_t count{m_sources.size()};
+        for (std::size_t offset = 0; offset < count; ++offset)
+        {
+            const std::size_t index{(m_next + offset) % count};
+            if (m_sources[index].ready && m_sources[index].ready())
+            {
+                found = index;
+                m_next = index + 1;
+                return true;
+            }
+        }
+        return false;
+    };
+    if (timeout_ms == WAIT_FOREVER)
+    {
+        m_wait.wait(one_ready);
+    }
+    else
+    {
+        m_wait.waitFor(std::chrono::milliseconds(timeout_ms), one_ready);
+    }
+    return found;
+}
+
+} // namespace threadsafe
+} // namespace trlc
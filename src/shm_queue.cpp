@@ -0,0 +1,266 @@
+#include "trlc/threadsafe/shm_queue.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif __linux__
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <thread>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+namespace
+{
+
+constexpr std::chrono::seconds ATTACH_TIMEOUT{1}; ///< Time given to a creator to size and initialize its region.
+
+#ifdef _WIN32
+std::string regionName(const std::string& name)
+{
+    return "Local\\" + name;
+}
+#elif __linux__
+std::string regionName(const std::string& name)
+{
+    return "/" + name;
+}
+#endif
+
+} // namespace
+
+SharedMemory::~SharedMemory()
+{
+    close();
+}
+
+bool SharedMemory::open(const std::string& name, const std::size_t bytes)
+{
+    close();
+#ifdef _WIN32
+    const uint64_t size{bytes};
+    ::HANDLE handle{::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                         static_cast<DWORD>(size & 0xFFFFFFFF), regionName(name).c_str())};
+    if (handle == nullptr)
+    {
+        return false;
+    }
+    const bool created{::GetLastError() != ERROR_ALREADY_EXISTS};
+    void* data{::MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0)};
+    if (data == nullptr)
+    {
+        ::CloseHandle(handle);
+        return false;
+    }
+    ::MEMORY_BASIC_INFORMATION info{};
+    ::VirtualQuery(data, &info, sizeof(info));
+    m_handle = handle;
+    m_data = data;
+    m_size = info.RegionSize;
+    m_created = created;
+    return true;
+#elif __linux__
+    const std::string path{regionName(name)};
+    bool created{true};
+    int fd{::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)};
+    if (fd < 0 && errno == EEXIST)
+    {
+        created = false;
+        fd = ::shm_open(path.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    std::size_t size{bytes};
+    if (created)
+    {
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            ::close(fd);
+            ::shm_unlink(path.c_str());
+            return false;
+        }
+    }
+    else
+    {
+        // The creator sizes the region right after creating it.
+        const auto give_up{std::chrono::steady_clock::now() + ATTACH_TIMEOUT};
+        struct ::stat status{};
+        while (::fstat(fd, &status) == 0 && status.st_size == 0 && std::chrono::steady_clock::now() < give_up)
+        {
+            std::this_thread::yield();
+        }
+        size = static_cast<std::size_t>(status.st_size);
+        if (size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+    }
+
+    void* data{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        if (created)
+        {
+            ::shm_unlink(path.c_str());
+        }
+        return false;
+    }
+    m_data = data;
+    m_size = size;
+    m_created = created;
+    return true;
+#endif
+}
+
+void SharedMemory::close()
+{
+    if (m_data == nullptr)
+    {
+        return;
+    }
+#ifdef _WIN32
+    ::UnmapViewOfFile(m_data);
+    ::CloseHandle(m_handle);
+    m_handle = nullptr;
+#elif __linux__
+    ::munmap(m_data, m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_created = false;
+}
+
+void* SharedMemory::data() const
+{
+    return m_data;
+}
+
+std::size_t SharedMemory::size() const
+{
+    return m_size;
+}
+
+bool SharedMemory::created() const
+{
+    return m_created;
+}
+
+bool SharedMemory::remove(const std::string& name)
+{
+#ifdef _WIN32
+    // The mapping goes away with its last handle.
+    (void)name;
+    return true;
+#elif __linux__
+    return ::shm_unlink(regionName(name).c_str()) == 0;
+#endif
+}
+
+namespace detail
+{
+
+void sharedWait(std::atomic<uint32_t>& word, const uint32_t expected, const Wait::Clock::time_point deadline)
+{
+#ifdef _WIN32
+    (void)word;
+    (void)expected;
+    (void)deadline;
+    ::Sleep(1);
+#elif __linux__
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "A futex is a plain 32-bit word");
+    // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline, the clock of `steady_clock`.
+    ::timespec absolute{};
+    ::timespec* timeout{nullptr};
+    if (deadline != Wait::NO_DEADLINE)
+    {
+        const auto since_epoch{std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch())};
+        absolute.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+        absolute.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+        timeout = &absolute;
+    }
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_BITSET, expected, timeout, nullptr, FUTEX_BITSET_MATCH_ANY);
+#endif
+}
+
+void sharedWake(std::atomic<uint32_t>& word)
+{
+#ifdef _WIN32
+    (void)word;
+#elif __linux__
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+ShmQueueHeader* attachShmQueue(SharedMemory& memory, const std::string& name, const ShmQueueLayout& layout)
+{
+    const uint64_t slots{nextPowerOfTwo(static_cast<std::size_t>(layout.capacity))};
+    if (!memory.open(name, SHM_QUEUE_SLOTS_OFFSET + slots * layout.slot_size))
+    {
+        return nullptr;
+    }
+    unsigned char* base{static_cast<unsigned char*>(memory.data())};
+
+    if (memory.created())
+    {
+        ShmQueueHeader* header{new (base) ShmQueueHeader{}};
+        header->version = ShmQueueHeader::VERSION;
+        header->slot_size = layout.slot_size;
+        header->capacity = layout.capacity;
+        header->mask = slots - 1;
+        header->discard = layout.discard;
+        header->control = layout.control;
+        header->open_push.store(layout.open_push ? 1 : 0, std::memory_order_relaxed);
+        header->open_pop.store(layout.open_pop ? 1 : 0, std::memory_order_relaxed);
+        for (uint64_t index = 0; index < slots; ++index)
+        {
+            new (base + SHM_QUEUE_SLOTS_OFFSET + index * layout.slot_size) std::atomic<uint64_t>{index};
+        }
+        header->magic.store(ShmQueueHeader::READY, std::memory_order_release);
+        return header;
+    }
+
+    if (memory.size() < SHM_QUEUE_SLOTS_OFFSET)
+    {
+        memory.close();
+        return nullptr;
+    }
+    ShmQueueHeader* header{std::launder(reinterpret_cast<ShmQueueHeader*>(base))};
+    const auto give_up{std::chrono::steady_clock::now() + ATTACH_TIMEOUT};
+    while (header->magic.load(std::memory_order_acquire) != ShmQueueHeader::READY)
+    {
+        if (std::chrono::steady_clock::now() >= give_up)
+        {
+            memory.close();
+            return nullptr;
+        }
+        std::this_thread::yield();
+    }
+    if (header->version != ShmQueueHeader::VERSION || header->slot_size != layout.slot_size
+        || memory.size() < SHM_QUEUE_SLOTS_OFFSET + (header->mask + 1) * layout.slot_size)
+    {
+        memory.close();
+        return nullptr;
+    }
+    return header;
+}
+
+} // namespace detail
+
+} // namespace threadsafe
+} // namespace trlc
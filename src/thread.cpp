@@ -3,8 +3,12 @@
 #ifdef _WIN32
 #include <windows.h>
 #elif __linux__
+#include <cerrno>
 #include <pthread.h>
 #include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 namespace trlc
@@ -12,6 +16,80 @@ namespace trlc
 namespace threadsafe
 {
 
+namespace
+{
+
+std::error_code systemError(const int error)
+{
+    return std::error_code{error, std::system_category()};
+}
+
+#ifdef _WIN32
+int32_t niceToNativePriority(const int32_t nice)
+{
+    if (nice <= -15)
+    {
+        return THREAD_PRIORITY_HIGHEST;
+    }
+    if (nice <= -5)
+    {
+        return THREAD_PRIORITY_ABOVE_NORMAL;
+    }
+    if (nice < 5)
+    {
+        return THREAD_PRIORITY_NORMAL;
+    }
+    return nice < 15 ? THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_LOWEST;
+}
+#elif __linux__
+constexpr uint32_t POLICY_DEADLINE{6}; ///< `SCHED_DEADLINE`, missing from older C library headers.
+
+/**
+ * @brief The `struct sched_attr` of the `sched_setattr` and `sched_getattr` syscalls, not wrapped by the C library.
+ */
+struct SchedAttr
+{
+    uint32_t size{sizeof(SchedAttr)};
+    uint32_t policy{0};
+    uint64_t flags{0};
+    int32_t nice{0};
+    uint32_t priority{0};
+    uint64_t runtime{0};
+    uint64_t deadline{0};
+    uint64_t period{0};
+};
+
+id_t currentThreadId()
+{
+    return static_cast<id_t>(::syscall(SYS_gettid));
+}
+
+std::error_code setCurrentThreadDeadline(const ThreadScheduling& scheduling)
+{
+#ifdef SYS_sched_setattr
+    if (scheduling.runtime.count() <= 0 || scheduling.deadline.count() < 0 || scheduling.period.count() <= 0)
+    {
+        return systemError(EINVAL);
+    }
+    SchedAttr attr{};
+    attr.policy = POLICY_DEADLINE;
+    attr.runtime = static_cast<uint64_t>(scheduling.runtime.count());
+    attr.deadline = static_cast<uint64_t>((scheduling.deadline.count() == 0 ? scheduling.period : scheduling.deadline).count());
+    attr.period = static_cast<uint64_t>(scheduling.period.count());
+    if (::syscall(SYS_sched_setattr, 0, &attr, 0) != 0)
+    {
+        return systemError(errno);
+    }
+    return {};
+#else
+    (void)scheduling;
+    return systemError(ENOSYS);
+#endif
+}
+#endif
+
+} // namespace
+
 constexpr int32_t MAX_NUM_OF_PRIORITY{6};
 
 const NativeThreadPrioritys& defaultNativeThreadPrioritys()
@@ -41,16 +119,140 @@ const NativeThreadPrioritys& defaultNativeThreadPrioritys()
 #endif
 };
 
-void setNaitiveThreadPriority(ThreadPriority priority, const std::thread::native_handle_type native_handle)
+std::error_code setNaitiveThreadPriority(ThreadPriority priority, const std::thread::native_handle_type native_handle)
 {
     const NativeThreadPrioritys& default_prioritys{defaultNativeThreadPrioritys()};
 #ifdef _WIN32
-    ::SetThreadPriority(native_handle, default_prioritys.at(priority));
+    if (!::SetThreadPriority(native_handle, default_prioritys.at(priority)))
+    {
+        return systemError(static_cast<int>(::GetLastError()));
+    }
+    return {};
 #elif __linux__
-
-    ::sched_param sch_params;
+    ::sched_param sch_params{};
+    if (priority == ThreadPriority::NORMAL)
+    {
+        // Time sharing like any other thread, which needs no privilege and keeps the inherited nice value.
+        return systemError(::pthread_setschedparam(native_handle, SCHED_OTHER, &sch_params));
+    }
     sch_params.sched_priority = default_prioritys.at(priority);
-    ::pthread_setschedparam(native_handle, SCHED_FIFO, &sch_params);
+    return systemError(::pthread_setschedparam(native_handle, SCHED_FIFO, &sch_params));
+#endif
+}
+
+std::error_code setCurrentThreadScheduling(const ThreadScheduling& scheduling)
+{
+#ifdef _WIN32
+    int32_t native_priority{THREAD_PRIORITY_TIME_CRITICAL};
+    switch (scheduling.policy)
+    {
+    case SchedulingPolicy::OTHER:
+        native_priority = niceToNativePriority(scheduling.nice);
+        break;
+    case SchedulingPolicy::FIFO:
+    case SchedulingPolicy::RR:
+        break;
+    default:
+        return systemError(ERROR_NOT_SUPPORTED);
+    }
+    if (!::SetThreadPriority(::GetCurrentThread(), native_priority))
+    {
+        return systemError(static_cast<int>(::GetLastError()));
+    }
+    return {};
+#elif __linux__
+    ::sched_param sch_params{};
+    switch (scheduling.policy)
+    {
+    case SchedulingPolicy::OTHER:
+    {
+        const int error{::pthread_setschedparam(::pthread_self(), SCHED_OTHER, &sch_params)};
+        if (error != 0)
+        {
+            return systemError(error);
+        }
+        // The nice value belongs to the thread, not to the process, on Linux.
+        if (::setpriority(PRIO_PROCESS, currentThreadId(), scheduling.nice) != 0)
+        {
+            return systemError(errno);
+        }
+        return {};
+    }
+    case SchedulingPolicy::FIFO:
+    case SchedulingPolicy::RR:
+        sch_params.sched_priority = scheduling.priority;
+        return systemError(::pthread_setschedparam(::pthread_self(),
+                                                   scheduling.policy == SchedulingPolicy::FIFO ? SCHED_FIFO : SCHED_RR,
+                                                   &sch_params));
+    case SchedulingPolicy::DEADLINE:
+        return setCurrentThreadDeadline(scheduling);
+    }
+    return systemError(EINVAL);
+#endif
+}
+
+ThreadScheduling currentThreadScheduling()
+{
+    ThreadScheduling scheduling{};
+#ifdef _WIN32
+    const int native_priority{::GetThreadPriority(::GetCurrentThread())};
+    if (native_priority == THREAD_PRIORITY_TIME_CRITICAL)
+    {
+        scheduling.policy = SchedulingPolicy::FIFO;
+    }
+    else
+    {
+        scheduling.nice = native_priority >= THREAD_PRIORITY_HIGHEST  ? -15
+                          : native_priority <= THREAD_PRIORITY_LOWEST ? 15
+                                                                      : -5 * native_priority;
+    }
+#elif __linux__
+#ifdef SYS_sched_getattr
+    SchedAttr attr{};
+    if (::syscall(SYS_sched_getattr, 0, &attr, sizeof(attr), 0) == 0)
+    {
+        switch (attr.policy)
+        {
+        case SCHED_FIFO:
+        case SCHED_RR:
+            scheduling.policy = attr.policy == SCHED_FIFO ? SchedulingPolicy::FIFO : SchedulingPolicy::RR;
+            scheduling.priority = static_cast<int32_t>(attr.priority);
+            break;
+        case POLICY_DEADLINE:
+            scheduling.policy = SchedulingPolicy::DEADLINE;
+            scheduling.runtime = std::chrono::nanoseconds{attr.runtime};
+            scheduling.deadline = std::chrono::nanoseconds{attr.deadline};
+            scheduling.period = std::chrono::nanoseconds{attr.period};
+            break;
+        default:
+            scheduling.nice = attr.nice;
+            break;
+        }
+        return scheduling;
+    }
+#endif
+    int policy{SCHED_OTHER};
+    ::sched_param sch_params{};
+    ::pthread_getschedparam(::pthread_self(), &policy, &sch_params);
+    if (policy == SCHED_FIFO || policy == SCHED_RR)
+    {
+        scheduling.policy = policy == SCHED_FIFO ? SchedulingPolicy::FIFO : SchedulingPolicy::RR;
+        scheduling.priority = sch_params.sched_priority;
+    }
+    else
+    {
+        scheduling.nice = ::getpriority(PRIO_PROCESS, currentThreadId());
+    }
+#endif
+    return scheduling;
+}
+
+std::thread::native_handle_type currentNativeThreadHandle()
+{
+#ifdef _WIN32
+    return ::GetCurrentThread();
+#elif __linux__
+    return ::pthread_self();
 #endif
 }
 
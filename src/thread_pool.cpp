@@ -0,0 +1,221 @@
+#include "trlc/threadsafe/thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+namespace
+{
+thread_local const ThreadPool* t_pool{nullptr};                    ///< Pool owning the calling worker.
+thread_local std::size_t t_worker_index{ThreadPool::NOT_A_WORKER}; ///< Index of the calling worker.
+} // namespace
+
+ThreadPool::ThreadPool(const Settings& settings)
+    : m_settings{settings}
+    , m_injection{injectionSettings()}
+{
+    const std::size_t count{std::max<std::size_t>(m_settings.size, 1)};
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        m_deques.push_back(std::make_unique<TaskDeque>());
+    }
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        auto worker{std::make_unique<Thread>(m_settings.name + "_" + std::to_string(index), m_settings.priority)};
+        worker->invoke([this, index]()
+                       { step(index); });
+        worker->setPredicate([this]() -> bool
+                             { return !m_stopping.load(std::memory_order_acquire); });
+        worker->setStartCallback([this, index]()
+                                 {
+            t_pool = this;
+            t_worker_index = index;
+            if (m_settings.start_callback)
+            {
+                m_settings.start_callback();
+            } });
+        worker->setExitCallback([this]()
+                                {
+            if (m_settings.exit_callback)
+            {
+                m_settings.exit_callback();
+            }
+            t_pool = nullptr;
+            t_worker_index = NOT_A_WORKER; });
+        worker->run(Thread::RunMode::LOOP);
+        m_workers.push_back(std::move(worker));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+    // Only reachable when a task was posted while stopping, the workers are gone at this point.
+    while (std::optional<Task*> task{m_injection.tryPop()})
+    {
+        delete *task;
+    }
+    for (auto& deque : m_deques)
+    {
+        while (std::optional<Task*> task{deque->pop()})
+        {
+            delete *task;
+        }
+    }
+}
+
+bool ThreadPool::post(Task task)
+{
+    if (!task)
+    {
+        return false;
+    }
+    // Counted before checking the flag, so that stop() either sees this task or the post sees the stop.
+    m_pending.fetch_add(1, std::memory_order_seq_cst);
+    if (!m_accepting.load(std::memory_order_seq_cst))
+    {
+        if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            m_done.notify();
+        }
+        return false;
+    }
+
+    Task* queued_task{new Task(std::move(task))};
+    m_queued.fetch_add(1, std::memory_order_seq_cst);
+    const std::size_t index{workerIndex()};
+    if (index != NOT_A_WORKER)
+    {
+        m_deques[index]->push(queued_task);
+    }
+    else
+    {
+        m_injection.push(queued_task);
+    }
+    m_idle.notifyOne();
+    return true;
+}
+
+void ThreadPool::waitIdle()
+{
+    m_done.wait([this]() -> bool
+                { return m_pending.load(std::memory_order_acquire) == 0; });
+}
+
+bool ThreadPool::tryRunOne()
+{
+    return runOne(workerIndex());
+}
+
+void ThreadPool::stop()
+{
+    m_accepting.store(false, std::memory_order_seq_cst);
+    if (workerIndex() != NOT_A_WORKER)
+    {
+        // The calling task is itself pending and its worker cannot join itself, the remaining tasks run
+        // and the workers stop on the next stop() from another thread.
+        return;
+    }
+    waitIdle();
+    m_stopping.store(true, std::memory_order_release);
+    m_idle.notify();
+    for (auto& worker : m_workers)
+    {
+        worker->stop();
+    }
+}
+
+std::size_t ThreadPool::size() const
+{
+    return m_workers.size();
+}
+
+std::size_t ThreadPool::workerIndex() const
+{
+    if (t_pool != this)
+    {
+        return NOT_A_WORKER;
+    }
+    return t_worker_index;
+}
+
+void ThreadPool::step(const std::size_t index)
+{
+    if (runOne(index))
+    {
+        return;
+    }
+    m_idle.wait([this]() -> bool
+                { return m_stopping.load(std::memory_order_acquire) || m_queued.load(std::memory_order_acquire) > 0; });
+}
+
+bool ThreadPool::runOne(const std::size_t index)
+{
+    Task* task{findTask(index)};
+    if (task == nullptr)
+    {
+        return false;
+    }
+    m_queued.fetch_sub(1, std::memory_order_acq_rel);
+    runTask(task);
+    return true;
+}
+
+ThreadPool::Task* ThreadPool::findTask(const std::size_t index)
+{
+    const bool worker{index != NOT_A_WORKER};
+    if (worker)
+    {
+        if (std::optional<Task*> task{m_deques[index]->pop()})
+        {
+            return *task;
+        }
+    }
+    if (std::optional<Task*> task{m_injection.tryPop()})
+    {
+        return *task;
+    }
+    // A worker skips its own deque, any other thread steals from every worker.
+    const std::size_t count{m_deques.size()};
+    const std::size_t first{worker ? index + 1 : 0};
+    const std::size_t victims{worker ? count - 1 : count};
+    for (std::size_t offset = 0; offset < victims; ++offset)
+    {
+        if (std::optional<Task*> task{m_deques[(first + offset) % count]->steal()})
+        {
+            return *task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::runTask(Task* task)
+{
+    try
+    {
+        (*task)();
+    }
+    catch (...)
+    {
+        // A throwing task must not terminate its worker. submit() already hands the exception to the future.
+    }
+    delete task;
+    if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        m_done.notify();
+    }
+}
+
+ThreadPool::TaskQueue::Settings ThreadPool::injectionSettings()
+{
+    TaskQueue::Settings settings;
+    settings.control = TaskQueue::Control::NO_CONTROL;
+    return settings;
+}
+
+} // namespace threadsafe
+} // namespace trlc
@@ -0,0 +1,259 @@
+#include "trlc/threadsafe/thread_stats.hpp"
+
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif __linux__
+#include <fstream>
+#include <pthread.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+namespace
+{
+
+double perSecond(const double value, const std::chrono::nanoseconds wall_time)
+{
+    if (wall_time.count() <= 0)
+    {
+        return 0.0;
+    }
+    return value / std::chrono::duration<double>(wall_time).count();
+}
+
+#ifdef _WIN32
+std::chrono::nanoseconds cpuTime(const HANDLE handle)
+{
+    FILETIME creation{};
+    FILETIME exited{};
+    FILETIME kernel{};
+    FILETIME user{};
+    if (!::GetThreadTimes(handle, &creation, &exited, &kernel, &user))
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+    const uint64_t kernel_100ns{(static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime};
+    const uint64_t user_100ns{(static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime};
+    return std::chrono::nanoseconds{static_cast<int64_t>((kernel_100ns + user_100ns) * 100)};
+}
+#elif __linux__
+std::chrono::nanoseconds cpuTime(const clockid_t clock)
+{
+    ::timespec time{};
+    if (::clock_gettime(clock, &time) != 0)
+    {
+        return std::chrono::nanoseconds{-1};
+    }
+    return std::chrono::seconds{time.tv_sec} + std::chrono::nanoseconds{time.tv_nsec};
+}
+#endif
+
+} // namespace
+
+double ThreadStatsSnapshot::iterationRate() const
+{
+    return perSecond(static_cast<double>(iterations), wall_time);
+}
+
+double ThreadStatsSnapshot::busyRatio() const
+{
+    return perSecond(std::chrono::duration<double>(busy_time).count(), wall_time);
+}
+
+double ThreadStatsSnapshot::cpuUtilization() const
+{
+    return perSecond(std::chrono::duration<double>(cpu_time).count(), wall_time);
+}
+
+void ThreadStats::start()
+{
+    const uint32_t sequence{beginWrite()};
+#ifdef _WIN32
+    m_native_id.store(static_cast<int64_t>(::GetCurrentThreadId()));
+#elif __linux__
+    m_native_id.store(static_cast<int64_t>(::syscall(SYS_gettid)));
+    clockid_t clock{CLOCK_THREAD_CPUTIME_ID};
+    ::pthread_getcpuclockid(::pthread_self(), &clock);
+    m_cpu_clock.store(static_cast<int64_t>(clock));
+#endif
+    setBaseline(currentUsage());
+    m_start_ns.store(steadyNow());
+    m_running.store(true);
+    endWrite(sequence);
+}
+
+void ThreadStats::recordPredicateStop()
+{
+    m_predicate_stops.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ThreadStats::finish()
+{
+    const Usage usage{currentUsage()};
+    const int64_t end_ns{steadyNow()};
+    const uint32_t sequence{beginWrite()};
+    m_finished_wall_ns.fetch_add(static_cast<uint64_t>(end_ns - m_start_ns.load()));
+    m_finished_cpu_ns.fetch_add(static_cast<uint64_t>((usage.cpu_time - std::chrono::nanoseconds{m_base_cpu_ns.load()}).count()));
+    m_finished_voluntary.fetch_add(usage.voluntary_switches - m_base_voluntary.load());
+    m_finished_involuntary.fetch_add(usage.involuntary_switches - m_base_involuntary.load());
+    m_running.store(false);
+    endWrite(sequence);
+}
+
+ThreadStats::Snapshot ThreadStats::snapshot() const
+{
+    Snapshot snapshot{};
+    while (true)
+    {
+        const uint32_t sequence{m_sequence.load()};
+        if ((sequence & 1) != 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        snapshot.running = m_running.load();
+        snapshot.wall_time = std::chrono::nanoseconds{static_cast<int64_t>(m_finished_wall_ns.load())};
+        snapshot.cpu_time = std::chrono::nanoseconds{static_cast<int64_t>(m_finished_cpu_ns.load())};
+        snapshot.voluntary_switches = m_finished_voluntary.load();
+        snapshot.involuntary_switches = m_finished_involuntary.load();
+        if (snapshot.running)
+        {
+            snapshot.wall_time += std::chrono::nanoseconds{steadyNow() - m_start_ns.load()};
+            Usage usage{};
+            if (runningUsage(usage))
+            {
+                snapshot.cpu_time += usage.cpu_time - std::chrono::nanoseconds{m_base_cpu_ns.load()};
+                snapshot.voluntary_switches += usage.voluntary_switches - m_base_voluntary.load();
+                snapshot.involuntary_switches += usage.involuntary_switches - m_base_involuntary.load();
+            }
+        }
+        if (m_sequence.load() == sequence)
+        {
+            break;
+        }
+    }
+    snapshot.iterations = m_iterations.load(std::memory_order_relaxed);
+    snapshot.busy_time = std::chrono::nanoseconds{static_cast<int64_t>(m_busy_ns.load(std::memory_order_relaxed))};
+    snapshot.predicate_stops = m_predicate_stops.load(std::memory_order_relaxed);
+    snapshot.call_duration = m_call_duration.snapshot();
+    return snapshot;
+}
+
+void ThreadStats::reset()
+{
+    const uint32_t sequence{beginWrite()};
+    m_iterations.store(0, std::memory_order_relaxed);
+    m_busy_ns.store(0, std::memory_order_relaxed);
+    m_call_duration.reset();
+    m_predicate_stops.store(0, std::memory_order_relaxed);
+    m_finished_wall_ns.store(0);
+    m_finished_cpu_ns.store(0);
+    m_finished_voluntary.store(0);
+    m_finished_involuntary.store(0);
+    if (m_running.load())
+    {
+        // The OS counters of the running worker keep growing, count from their current values instead.
+        Usage usage{};
+        if (runningUsage(usage))
+        {
+            setBaseline(usage);
+        }
+        m_start_ns.store(steadyNow());
+    }
+    endWrite(sequence);
+}
+
+uint32_t ThreadStats::beginWrite()
+{
+    uint32_t sequence{m_sequence.load()};
+    while ((sequence & 1) != 0 || !m_sequence.compare_exchange_weak(sequence, sequence + 1))
+    {
+        std::this_thread::yield();
+        sequence = m_sequence.load();
+    }
+    return sequence + 1;
+}
+
+void ThreadStats::endWrite(const uint32_t sequence)
+{
+    m_sequence.store(sequence + 1);
+}
+
+void ThreadStats::setBaseline(const Usage& usage)
+{
+    m_base_cpu_ns.store(usage.cpu_time.count());
+    m_base_voluntary.store(usage.voluntary_switches);
+    m_base_involuntary.store(usage.involuntary_switches);
+}
+
+int64_t ThreadStats::steadyNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ThreadStats::Usage ThreadStats::currentUsage()
+{
+    Usage usage{};
+#ifdef _WIN32
+    usage.cpu_time = cpuTime(::GetCurrentThread());
+#elif __linux__
+    usage.cpu_time = cpuTime(CLOCK_THREAD_CPUTIME_ID);
+    ::rusage resources{};
+    if (::getrusage(RUSAGE_THREAD, &resources) == 0)
+    {
+        usage.voluntary_switches = static_cast<uint64_t>(resources.ru_nvcsw);
+        usage.involuntary_switches = static_cast<uint64_t>(resources.ru_nivcsw);
+    }
+#endif
+    return usage;
+}
+
+bool ThreadStats::runningUsage(Usage& usage) const
+{
+#ifdef _WIN32
+    const HANDLE handle{::OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(m_native_id.load()))};
+    if (handle == nullptr)
+    {
+        return false;
+    }
+    usage.cpu_time = cpuTime(handle);
+    ::CloseHandle(handle);
+    return true;
+#elif __linux__
+    usage.cpu_time = cpuTime(static_cast<clockid_t>(m_cpu_clock.load()));
+    if (usage.cpu_time.count() < 0)
+    {
+        return false;
+    }
+    std::ifstream status{"/proc/self/task/" + std::to_string(m_native_id.load()) + "/status"};
+    std::string key{};
+    while (status >> key)
+    {
+        if (key == "voluntary_ctxt_switches:")
+        {
+            status >> usage.voluntary_switches;
+        }
+        else if (key == "nonvoluntary_ctxt_switches:")
+        {
+            status >> usage.involuntary_switches;
+        }
+    }
+    return true;
+#else
+    (void)usage;
+    return false;
+#endif
+}
+
+} // namespace threadsafe
+} // namespace trlc
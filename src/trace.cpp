@@ -0,0 +1,625 @@
+#include "trlc/threadsafe/trace.hpp"
+
+#include "trlc/threadsafe/thread.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace trlc
+{
+namespace threadsafe
+{
+
+namespace detail
+{
+std::atomic<bool> g_tracing{false};
+} // namespace detail
+
+namespace
+{
+
+uint64_t steadyNanoseconds()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t readTicks()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return steadyNanoseconds();
+#endif
+}
+
+/**
+ * @brief Lock-free ring of the records of one thread, written by that thread and drained by the flusher.
+ */
+struct ThreadBuffer
+{
+    ThreadBuffer(const uint32_t id, const std::size_t capacity)
+        : thread{id}
+        , records(nextPowerOfTwo(capacity))
+        , mask{records.size() - 1}
+    {
+    }
+
+    /**
+     * @brief Append a record, from the owning thread only.
+     * @return `false` if the ring is full.
+     */
+    bool push(const TraceRecord& record)
+    {
+        const uint64_t position{tail.load(std::memory_order_relaxed)};
+        if (position - cached_head >= records.size())
+        {
+            cached_head = head.load(std::memory_order_acquire);
+            if (position - cached_head >= records.size())
+            {
+                return false;
+            }
+        }
+        records[position & mask] = record;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pass every buffered record to `func` and release them, from the flusher only.
+     */
+    template<typename Func>
+    void drain(Func func)
+    {
+        uint64_t position{head.load(std::memory_order_relaxed)};
+        const uint64_t end{tail.load(std::memory_order_acquire)};
+        for (; position != end; ++position)
+        {
+            func(records[position & mask]);
+        }
+        head.store(position, std::memory_order_release);
+    }
+
+    /**
+     * @brief Discard the buffered records, while no flusher runs.
+     */
+    void clear()
+    {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    const uint32_t thread;                                  ///< Id of the thread.
+    std::vector<TraceRecord> records;                       ///< Ring storage.
+    const std::size_t mask;                                 ///< Mask turning a position into an index.
+    std::string name{};                                     ///< Name of the thread, guarded by the session lock.
+    std::atomic<bool> retired{false};                       ///< Set once the thread exited.
+    std::atomic<uint64_t> dropped{0};                       ///< Records lost since the last flush.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{0}; ///< Next position to drain.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail{0}; ///< Next position to write.
+    uint64_t cached_head{0};                                ///< Last head seen by the writer.
+};
+
+/**
+ * @brief Per-thread handle on the buffer of the thread, retiring it when the thread exits.
+ */
+struct LocalBuffer
+{
+    ~LocalBuffer()
+    {
+        if (buffer)
+        {
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    }
+
+    std::shared_ptr<ThreadBuffer> buffer{}; ///< Buffer of the thread, registered on its first record.
+    std::string name{};                     ///< Name given before the buffer existed.
+    bool untraced{false};                   ///< Set on the flusher, whose own waits are not traced.
+};
+
+thread_local LocalBuffer t_local{}; ///< Buffer of the calling thread.
+
+/**
+ * @brief A file mapped into memory, so that its content survives a crash of the process.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // Make this class uncopyable
+    UNCOPYABLE(MappedFile);
+
+    bool open(const std::string& path, const std::size_t bytes)
+    {
+        close();
+#ifdef _WIN32
+        const uint64_t size{bytes};
+        ::HANDLE file{::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr)};
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        ::HANDLE mapping{::CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                              static_cast<DWORD>(size & 0xFFFFFFFF), nullptr)};
+        void* data{mapping != nullptr ? ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0) : nullptr};
+        if (data == nullptr)
+        {
+            if (mapping != nullptr)
+            {
+                ::CloseHandle(mapping);
+            }
+            ::CloseHandle(file);
+            return false;
+        }
+        m_file = file;
+        m_mapping = mapping;
+#elif __linux__
+        const int fd{::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+        if (fd < 0)
+        {
+            return false;
+        }
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* data{::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+#endif
+        m_data = data;
+        m_size = bytes;
+        return true;
+    }
+
+    void close()
+    {
+        if (m_data == nullptr)
+        {
+            return;
+        }
+#ifdef _WIN32
+        ::UnmapViewOfFile(m_data);
+        ::CloseHandle(m_mapping);
+        ::CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = nullptr;
+#elif __linux__
+        ::munmap(m_data, m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    void* data() const
+    {
+        return m_data;
+    }
+
+private:
+    void* m_data{nullptr}; ///< Start of the mapping.
+    std::size_t m_size{0}; ///< Size of the mapping in bytes.
+#ifdef _WIN32
+    void* m_file{nullptr};    ///< File handle.
+    void* m_mapping{nullptr}; ///< File mapping handle.
+#endif
+};
+
+/**
+ * @brief State of the tracing sessions: the registered thread buffers, the trace file and the flusher.
+ */
+class Session
+{
+public:
+    Session() = default;
+
+    ~Session()
+    {
+        stop();
+    }
+
+    // Make this class uncopyable
+    UNCOPYABLE(Session);
+
+    bool start(const TraceSettings& settings)
+    {
+        std::lock_guard<std::mutex> control(m_control);
+        if (detail::g_tracing.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            const std::size_t capacity{std::max<std::size_t>(settings.file_records, 1)};
+            const std::size_t names_offset{sizeof(TraceFileHeader)};
+            const std::size_t records_offset{names_offset + TraceFileHeader::THREAD_NAMES * sizeof(TraceThreadName)};
+            if (!m_file.open(settings.path, records_offset + capacity * sizeof(TraceRecord)))
+            {
+                return false;
+            }
+            unsigned char* base{static_cast<unsigned char*>(m_file.data())};
+            m_header = new (base) TraceFileHeader{};
+            m_names = reinterpret_cast<TraceThreadName*>(base + names_offset);
+            for (uint32_t index = 0; index < TraceFileHeader::THREAD_NAMES; ++index)
+            {
+                new (m_names + index) TraceThreadName{};
+            }
+            m_records = reinterpret_cast<TraceRecord*>(base + records_offset);
+            m_header->version = TraceFileHeader::VERSION;
+            m_header->record_size = sizeof(TraceRecord);
+            m_header->names = TraceFileHeader::THREAD_NAMES;
+            m_header->capacity = capacity;
+            m_header->start_ticks = readTicks();
+            m_header->start_ns = steadyNanoseconds();
+            m_header->latest_ticks = m_header->start_ticks;
+            m_header->latest_ns = m_header->start_ns;
+            m_header->magic = TraceFileHeader::MAGIC;
+            m_settings = settings;
+            // Records left by threads after the previous session stopped belong to no file.
+            for (const auto& buffer : m_buffers)
+            {
+                buffer->clear();
+                buffer->dropped.store(0, std::memory_order_relaxed);
+                writeName(*buffer);
+            }
+            detail::g_tracing.store(true, std::memory_order_release);
+        }
+
+        m_flusher = std::make_unique<Thread>("trace flusher");
+        m_flusher->invoke([this]()
+                          {
+            flush();
+            m_wake.waitFor(std::chrono::milliseconds(m_settings.flush_interval_ms)); });
+        m_flusher->setPredicate([]() -> bool
+                                { return detail::g_tracing.load(std::memory_order_acquire); });
+        m_flusher->setStartCallback([]()
+                                    { t_local.untraced = true; });
+        m_flusher->run(Thread::RunMode::LOOP);
+        return true;
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> control(m_control);
+        if (!detail::g_tracing.exchange(false, std::memory_order_acq_rel))
+        {
+            return;
+        }
+        m_wake.notify();
+        m_flusher->stop();
+        m_flusher.reset();
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        flushLocked();
+        m_dropped = m_header->dropped;
+        m_header = nullptr;
+        m_names = nullptr;
+        m_records = nullptr;
+        m_file.close();
+    }
+
+    ThreadBuffer* registerThread(LocalBuffer& local)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_header == nullptr)
+        {
+            return nullptr;
+        }
+        local.buffer = std::make_shared<ThreadBuffer>(m_next_thread++, std::max<std::size_t>(m_settings.thread_records, 2));
+        local.buffer->name = local.name.empty() ? "thread " + std::to_string(local.buffer->thread) : local.name;
+        m_buffers.push_back(local.buffer);
+        writeName(*local.buffer);
+        return local.buffer.get();
+    }
+
+    void setName(ThreadBuffer& buffer, const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        buffer.name = name;
+        writeName(buffer);
+    }
+
+    uint64_t dropped()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_header != nullptr ? m_header->dropped : m_dropped;
+    }
+
+private:
+    std::mutex m_control{};                                 ///< Serializes start and stop.
+    std::mutex m_lock{};                                    ///< Guards the buffer list, the names and the file.
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers{}; ///< Buffers of the threads that recorded.
+    uint32_t m_next_thread{1};                              ///< Id of the next thread to record.
+    TraceSettings m_settings{};                             ///< Settings of the current session.
+    MappedFile m_file{};                                    ///< The trace file.
+    TraceFileHeader* m_header{nullptr};                     ///< Header of the mapped file, null between sessions.
+    TraceThreadName* m_names{nullptr};                      ///< Thread name table of the mapped file.
+    TraceRecord* m_records{nullptr};                        ///< Record ring of the mapped file.
+    uint64_t m_dropped{0};                                  ///< Records dropped by the last session.
+    std::unique_ptr<Thread> m_flusher{};                    ///< Thread draining the buffers into the file.
+    Wait m_wake{};                                          ///< Paces the flusher, notified by stop.
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_header != nullptr)
+        {
+            flushLocked();
+        }
+    }
+
+    void flushLocked()
+    {
+        for (auto it = m_buffers.begin(); it != m_buffers.end();)
+        {
+            ThreadBuffer& buffer{**it};
+            // Loaded first, so that the records of an exited thread are all drained before its buffer goes.
+            const bool retired{buffer.retired.load(std::memory_order_acquire)};
+            buffer.drain([this](const TraceRecord& record)
+                         {
+                m_records[m_header->written % m_header->capacity] = record;
+                ++m_header->written; });
+            m_header->dropped += buffer.dropped.exchange(0, std::memory_order_relaxed);
+            it = retired ? m_buffers.erase(it) : it + 1;
+        }
+        m_header->latest_ticks = readTicks();
+        m_header->latest_ns = steadyNanoseconds();
+    }
+
+    void writeName(const ThreadBuffer& buffer)
+    {
+        if (m_names == nullptr || buffer.thread > TraceFileHeader::THREAD_NAMES)
+        {
+            return;
+        }
+        TraceThreadName& entry{m_names[buffer.thread - 1]};
+        entry.thread = buffer.thread;
+        std::memset(entry.name, 0, sizeof(entry.name));
+        std::memcpy(entry.name, buffer.name.data(), std::min(buffer.name.size(), sizeof(entry.name) - 1));
+    }
+};
+
+Session& session()
+{
+    static Session instance;
+    return instance;
+}
+
+/**
+ * @brief Write one Chrome trace event, `args` being the body of its argument object.
+ */
+void writeEvent(std::ofstream& out, bool& first, const char* name, const char* category, const char phase, const double ts,
+                const uint32_t thread, const char* args)
+{
+    char line[384];
+    std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",%s\"ts\":%.3f,\"pid\":1,\"tid\":%" PRIu32 ",\"args\":{%s}}",
+                  first ? "" : ",\n", name, category, phase, phase == 'i' ? "\"s\":\"t\"," : "", ts, thread, args);
+    out << line;
+    first = false;
+}
+
+} // namespace
+
+bool Tracer::start(const TraceSettings& settings)
+{
+    return session().start(settings);
+}
+
+void Tracer::stop()
+{
+    session().stop();
+}
+
+bool Tracer::running()
+{
+    return detail::g_tracing.load(std::memory_order_acquire);
+}
+
+void Tracer::record(const TraceEvent event, const void* object, const uint64_t value, const std::size_t count)
+{
+    if (!detail::g_tracing.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    LocalBuffer& local{t_local};
+    if (local.untraced)
+    {
+        return;
+    }
+    ThreadBuffer* buffer{local.buffer.get()};
+    if (buffer == nullptr && (buffer = session().registerThread(local)) == nullptr)
+    {
+        return;
+    }
+    const TraceRecord record{readTicks(), static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object)), value, buffer->thread,
+                             static_cast<uint16_t>(event), static_cast<uint16_t>(std::min<std::size_t>(count, UINT16_MAX))};
+    if (!buffer->push(record))
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Tracer::setThreadName(const std::string& name)
+{
+    LocalBuffer& local{t_local};
+    local.name = name;
+    if (local.buffer)
+    {
+        session().setName(*local.buffer, name);
+    }
+}
+
+uint64_t Tracer::dropped()
+{
+    return session().dropped();
+}
+
+bool Tracer::exportChromeTrace(const std::string& trace_path, const std::string& json_path)
+{
+    std::ifstream in(trace_path, std::ios::binary);
+    TraceFileHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != TraceFileHeader::MAGIC
+        || header.version != TraceFileHeader::VERSION || header.record_size != sizeof(TraceRecord)
+        || header.names != TraceFileHeader::THREAD_NAMES || header.capacity == 0)
+    {
+        return false;
+    }
+    std::vector<TraceThreadName> names(header.names);
+    std::vector<TraceRecord> ring(header.capacity);
+    if (!in.read(reinterpret_cast<char*>(names.data()), static_cast<std::streamsize>(names.size() * sizeof(TraceThreadName)))
+        || !in.read(reinterpret_cast<char*>(ring.data()), static_cast<std::streamsize>(ring.size() * sizeof(TraceRecord))))
+    {
+        return false;
+    }
+
+    // Oldest first, then by time, since the flusher interleaves the threads one buffer at a time.
+    const uint64_t count{std::min(header.written, header.capacity)};
+    std::vector<TraceRecord> records;
+    records.reserve(count);
+    for (uint64_t index = header.written - count; index < header.written; ++index)
+    {
+        records.push_back(ring[index % header.capacity]);
+    }
+    std::stable_sort(records.begin(), records.end(), [](const TraceRecord& lhs, const TraceRecord& rhs)
+                     { return lhs.ticks < rhs.ticks; });
+    const double ns_per_tick{header.latest_ticks > header.start_ticks
+                                 ? static_cast<double>(header.latest_ns - header.start_ns) / static_cast<double>(header.latest_ticks - header.start_ticks)
+                                 : 1.0};
+
+    std::ofstream out(json_path);
+    if (!out)
+    {
+        return false;
+    }
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first{true};
+    char args[256];
+    for (const TraceThreadName& entry : names)
+    {
+        if (entry.thread == 0)
+        {
+            continue;
+        }
+        char name[TraceFileHeader::NAME_LENGTH]{};
+        std::memcpy(name, entry.name, sizeof(name) - 1);
+        std::string escaped;
+        for (const char* c = name; *c != '\0'; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += static_cast<unsigned char>(*c) < 0x20 ? ' ' : *c;
+        }
+        std::snprintf(args, sizeof(args), "\"name\":\"%s\"", escaped.c_str());
+        writeEvent(out, first, "thread_name", "__metadata", 'M', 0.0, entry.thread, args);
+    }
+
+    // Slices cut by the ring are skipped: an end only closes a begin of the same thread.
+    std::vector<std::size_t> depth;
+    for (const TraceRecord& record : records)
+    {
+        const double ts{(static_cast<double>(static_cast<int64_t>(record.ticks - header.start_ticks)) * ns_per_tick) / 1000.0};
+        if (record.thread >= depth.size())
+        {
+            depth.resize(record.thread + 1, 0);
+        }
+        switch (static_cast<TraceEvent>(record.event))
+        {
+        case TraceEvent::QUEUE_PUSH:
+        case TraceEvent::QUEUE_POP:
+            std::snprintf(args, sizeof(args), "\"queue\":\"0x%" PRIx64 "\",\"size\":%" PRIu64 ",\"count\":%u", record.object, record.value,
+                          static_cast<unsigned>(record.count));
+            writeEvent(out, first, record.event == static_cast<uint16_t>(TraceEvent::QUEUE_PUSH) ? "push" : "pop", "queue", 'i', ts,
+                       record.thread, args);
+            break;
+        case TraceEvent::QUEUE_DISCARD:
+            std::snprintf(args, sizeof(args), "\"queue\":\"0x%" PRIx64 "\",\"oldest\":%" PRIu64 ",\"count\":%u", record.object, record.value,
+                          static_cast<unsigned>(record.count));
+            writeEvent(out, first, "discard", "queue", 'i', ts, record.thread, args);
+            break;
+        case TraceEvent::WAIT_BEGIN:
+            std::snprintf(args, sizeof(args), "\"wait\":\"0x%" PRIx64 "\"", record.object);
+            writeEvent(out, first, "wait", "wait", 'B', ts, record.thread, args);
+            ++depth[record.thread];
+            break;
+        case TraceEvent::WAIT_END:
+        case TraceEvent::THREAD_CALL_END:
+            if (depth[record.thread] == 0)
+            {
+                break;
+            }
+            --depth[record.thread];
+            std::snprintf(args, sizeof(args), "\"status\":%" PRIu64, record.value);
+            writeEvent(out, first, record.event == static_cast<uint16_t>(TraceEvent::WAIT_END) ? "wait" : "call",
+                       record.event == static_cast<uint16_t>(TraceEvent::WAIT_END) ? "wait" : "thread", 'E', ts, record.thread, args);
+            break;
+        case TraceEvent::WAIT_NOTIFY:
+            std::snprintf(args, sizeof(args), "\"wait\":\"0x%" PRIx64 "\",\"all\":%" PRIu64, record.object, record.value);
+            writeEvent(out, first, "notify", "wait", 'i', ts, record.thread, args);
+            break;
+        case TraceEvent::THREAD_START:
+        case TraceEvent::THREAD_EXIT:
+            std::snprintf(args, sizeof(args), "\"thread\":\"0x%" PRIx64 "\"", record.object);
+            writeEvent(out, first, record.event == static_cast<uint16_t>(TraceEvent::THREAD_START) ? "start" : "exit", "thread", 'i', ts,
+                       record.thread, args);
+            break;
+        case TraceEvent::THREAD_CALL_BEGIN:
+            std::snprintf(args, sizeof(args), "\"thread\":\"0x%" PRIx64 "\"", record.object);
+            writeEvent(out, first, "call", "thread", 'B', ts, record.thread, args);
+            ++depth[record.thread];
+            break;
+        default:
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "event %u", static_cast<unsigned>(record.event));
+            std::snprintf(args, sizeof(args), "\"object\":\"0x%" PRIx64 "\",\"value\":%" PRIu64 ",\"count\":%u", record.object, record.value,
+                          static_cast<unsigned>(record.count));
+            writeEvent(out, first, name, "user", 'i', ts, record.thread, args);
+            break;
+        }
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace threadsafe
+} // namespace trlc
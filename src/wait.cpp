@@ -1,10 +1,17 @@
 #include "trlc/threadsafe/wait.hpp"
 
+#include <algorithm>
+
 namespace trlc
 {
 namespace threadsafe
 {
 
+Wait::Wait(const Strategy strategy)
+    : m_strategy{strategy}
+{
+}
+
 Wait::~Wait()
 {
     exit();
@@ -13,7 +20,58 @@ Wait::~Wait()
 void Wait::notify()
 {
     disableInternalPred();
+    if (!hasWaiters())
+    {
+        return;
+    }
+    TRLC_THREADSAFE_TRACE(WAIT_NOTIFY, this, 1, 0);
+    Parked* parked{nullptr};
+    {
+        // Serialize with waiters that have evaluated their predicate but are not blocked yet,
+        // otherwise the notification could be lost.
+        std::lock_guard<std::mutex> lock(m_lock);
+        parked = unparkLocked(true);
+    }
     m_condition.notify_all();
+    resumeParked(parked);
+}
+
+void Wait::notifyOne()
+{
+    disableInternalPred();
+    if (!hasWaiters())
+    {
+        return;
+    }
+    TRLC_THREADSAFE_TRACE(WAIT_NOTIFY, this, 0, 0);
+    Parked* parked{nullptr};
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        parked = unparkLocked(false);
+    }
+    if (parked != nullptr)
+    {
+        resumeParked(parked);
+        return;
+    }
+    m_condition.notify_one();
+}
+
+bool Wait::hasWaiters() const
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return m_waiters.load(std::memory_order_seq_cst) > 0;
+}
+
+void Wait::addWaiter()
+{
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void Wait::removeWaiter()
+{
+    m_waiters.fetch_sub(1, std::memory_order_release);
 }
 
 bool Wait::isExit() const
@@ -45,21 +103,131 @@ void Wait::disableInternalPred()
 void Wait::exit()
 {
     m_exit.store(true, std::memory_order_release);
+    Parked* parked{nullptr};
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        parked = unparkLocked(true);
+    }
     m_condition.notify_all();
+    resumeParked(parked);
+}
+
+Wait::Parked* Wait::unparkLocked(const bool all)
+{
+    Parked* parked{m_parked_head};
+    if (parked == nullptr)
+    {
+        return nullptr;
+    }
+    if (all)
+    {
+        m_parked_head = nullptr;
+        m_parked_tail = nullptr;
+    }
+    else
+    {
+        m_parked_head = parked->next;
+        if (m_parked_head == nullptr)
+        {
+            m_parked_tail = nullptr;
+        }
+        parked->next = nullptr;
+    }
+    for (Parked* it = parked; it != nullptr; it = it->next)
+    {
+        removeWaiter();
+    }
+    return parked;
+}
+
+void Wait::resumeParked(Parked* parked)
+{
+    while (parked != nullptr)
+    {
+        // The callback may park the same waiter again, which rewrites its link.
+        Parked* next{parked->next};
+        parked->notified(parked->context);
+        parked = next;
+    }
 }
 
 Wait::Status Wait::wait()
 {
     enableInternalPred();
-    std::unique_lock<std::mutex> lock(m_lock);
-    m_condition.wait(lock, [this]() -> bool
-                     { return isExit() || internalPred(); });
-    if (isExit())
+    return wait([this]() -> bool
+                { return internalPred(); });
+}
+
+std::chrono::nanoseconds Wait::spinLimit() const
+{
+    switch (m_strategy)
+    {
+    case Strategy::SPIN:
+        return MAX_SPIN_DURATION;
+    case Strategy::ADAPTIVE:
+    {
+        const std::chrono::nanoseconds average{m_average_wait_ns.load(std::memory_order_relaxed)};
+        if (average > MAX_SPIN_DURATION)
+        {
+            return std::chrono::nanoseconds::zero();
+        }
+        return std::min(average * 2, MAX_SPIN_DURATION);
+    }
+    case Strategy::BLOCK:
+    default:
+        return std::chrono::nanoseconds::zero();
+    }
+}
+
+Wait::Status Wait::recordWait(const Clock::time_point start, const Status status)
+{
+    constexpr int64_t WEIGHT_SHIFT{3};                // Each sample weighs 1/8 of the average.
+    constexpr int64_t MAX_SAMPLE_NS{1'000'000'000};   // Clamp outliers such as long timeouts.
+    TRLC_THREADSAFE_TRACE(WAIT_END, this, static_cast<uint64_t>(status), 0);
+    if (m_strategy != Strategy::ADAPTIVE)
+    {
+        return status;
+    }
+    const int64_t sample{std::min<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(), MAX_SAMPLE_NS)};
+    // Concurrent waiters may overwrite each other's update, which only costs a sample.
+    const int64_t average{m_average_wait_ns.load(std::memory_order_relaxed)};
+    m_average_wait_ns.store(average + ((sample - average) >> WEIGHT_SHIFT), std::memory_order_relaxed);
+    return status;
+}
+
+void WaitObservers::add(Wait& wait)
+{
+    std::lock_guard<std::mutex> lock{m_lock};
+    m_waits.push_back(&wait);
+    m_count.store(m_waits.size(), std::memory_order_seq_cst);
+}
+
+void WaitObservers::remove(Wait& wait)
+{
+    std::lock_guard<std::mutex> lock{m_lock};
+    const auto it{std::find(m_waits.begin(), m_waits.end(), &wait)};
+    if (it != m_waits.end())
+    {
+        m_waits.erase(it);
+    }
+    m_count.store(m_waits.size(), std::memory_order_seq_cst);
+}
+
+void WaitObservers::notify()
+{
+    // Pairs with the registration, like Wait::hasWaiters() with the waiter count.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_count.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{m_lock};
+    for (Wait* wait : m_waits)
     {
-        return Status::EXIT;
+        wait->notify();
     }
-    return Status::SUCCESS;
 }
 
 } // namespace threadsafe
-} // namespace trlc
\ No newline at end of file
+} // namespace trlc
@@ -0,0 +1,260 @@
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/thread_pool.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <gtest/gtest.h>
+
+using Queue = trlc::threadsafe::Queue<int>;
+using trlc::threadsafe::InlineExecutor;
+using trlc::threadsafe::ThreadPool;
+using trlc::threadsafe::Wait;
+
+/**
+ * @brief Fire-and-forget coroutine, its frame is destroyed when it returns.
+ */
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object()
+        {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+};
+
+/**
+ * @brief Outcome of a coroutine, written when it completes.
+ */
+struct Outcome
+{
+    std::atomic<bool> done{false};
+    bool result{false};
+    int value{0};
+};
+
+template<typename Executor>
+Task popOne(Queue& queue, Executor& executor, Outcome& outcome)
+{
+    outcome.result = co_await queue.co_pop(outcome.value, executor);
+    outcome.done.store(true);
+}
+
+template<typename Executor>
+Task pushOne(Queue& queue, Executor& executor, const int value, Outcome& outcome)
+{
+    outcome.result = co_await queue.co_push(value, executor);
+    outcome.done.store(true);
+}
+
+/**
+ * @brief Test that co_pop suspends on an empty queue and resumes with the next pushed element.
+ */
+TEST(CoroutineTest, CoPopResumesOnPush)
+{
+    Queue queue{Queue::Settings{}};
+    InlineExecutor executor;
+    Outcome outcome;
+
+    popOne(queue, executor, outcome);
+    ASSERT_FALSE(outcome.done.load());
+
+    ASSERT_TRUE(queue.push(42));
+    ASSERT_TRUE(outcome.done.load());
+    EXPECT_TRUE(outcome.result);
+    EXPECT_EQ(outcome.value, 42);
+}
+
+/**
+ * @brief Test that co_pop completes without suspending when an element is queued.
+ */
+TEST(CoroutineTest, CoPopReady)
+{
+    Queue queue{Queue::Settings{}};
+    InlineExecutor executor;
+    Outcome outcome;
+
+    ASSERT_TRUE(queue.push(7));
+    popOne(queue, executor, outcome);
+    ASSERT_TRUE(outcome.done.load());
+    EXPECT_TRUE(outcome.result);
+    EXPECT_EQ(outcome.value, 7);
+}
+
+/**
+ * @brief Test that closing the pop side resumes a suspended co_pop with false.
+ */
+TEST(CoroutineTest, CoPopClosed)
+{
+    Queue::Settings settings;
+    settings.control = Queue::Control::FULL_CONTROL;
+    Queue queue{settings};
+    queue.openPush();
+    queue.openPop();
+    InlineExecutor executor;
+    Outcome outcome;
+
+    popOne(queue, executor, outcome);
+    ASSERT_FALSE(outcome.done.load());
+
+    queue.closePop();
+    ASSERT_TRUE(outcome.done.load());
+    EXPECT_FALSE(outcome.result);
+}
+
+/**
+ * @brief Test that co_push suspends on a full queue and resumes once a slot frees up.
+ */
+TEST(CoroutineTest, CoPushWaitsForSlot)
+{
+    Queue::Settings settings;
+    settings.size = 1;
+    Queue queue{settings};
+    InlineExecutor executor;
+    Outcome outcome;
+
+    ASSERT_TRUE(queue.push(1));
+    pushOne(queue, executor, 2, outcome);
+    ASSERT_FALSE(outcome.done.load());
+
+    int value{0};
+    ASSERT_TRUE(queue.pop(value, 0));
+    EXPECT_EQ(value, 1);
+    ASSERT_TRUE(outcome.done.load());
+    EXPECT_TRUE(outcome.result);
+    ASSERT_TRUE(queue.pop(value, 0));
+    EXPECT_EQ(value, 2);
+}
+
+/**
+ * @brief Test that co_push applies DISCARD_NEWEST instead of suspending.
+ */
+TEST(CoroutineTest, CoPushDiscardNewest)
+{
+    Queue::Settings settings;
+    settings.size = 1;
+    settings.discard = Queue::Discard::DISCARD_NEWEST;
+    Queue queue{settings};
+    InlineExecutor executor;
+    Outcome outcome;
+
+    ASSERT_TRUE(queue.push(1));
+    pushOne(queue, executor, 2, outcome);
+    ASSERT_TRUE(outcome.done.load());
+    EXPECT_FALSE(outcome.result);
+}
+
+/**
+ * @brief Test many suspended consumers resumed on a small thread pool.
+ */
+TEST(CoroutineTest, ManyConsumersOnThreadPool)
+{
+    constexpr int COUNT{2000};
+    ThreadPool::Settings pool_settings;
+    pool_settings.size = 2;
+    ThreadPool pool{pool_settings};
+    Queue queue{Queue::Settings{}};
+    std::atomic<int> completed{0};
+    std::atomic<long> sum{0};
+    Wait all_done;
+
+    auto consumer = [&]() -> Task
+    {
+        int value{0};
+        if (co_await queue.co_pop(value, pool))
+        {
+            sum.fetch_add(value);
+        }
+        completed.fetch_add(1);
+        all_done.notify();
+    };
+    for (int i = 0; i < COUNT; ++i)
+    {
+        consumer();
+    }
+    EXPECT_EQ(completed.load(), 0);
+
+    for (int i = 1; i <= COUNT; ++i)
+    {
+        ASSERT_TRUE(queue.push(i));
+    }
+    ASSERT_EQ(all_done.waitFor(std::chrono::seconds{10}, [&]() -> bool
+                               { return completed.load() == COUNT; }),
+              Wait::Status::SUCCESS);
+    EXPECT_EQ(sum.load(), static_cast<long>(COUNT) * (COUNT + 1) / 2);
+    pool.waitIdle();
+}
+
+/**
+ * @brief Test that co_wait re-parks on notifications until the predicate holds.
+ */
+TEST(CoroutineTest, CoWaitPredicate)
+{
+    Wait wait;
+    InlineExecutor executor;
+    std::atomic<bool> flag{false};
+    std::atomic<bool> done{false};
+    Wait::Status status{Wait::Status::TIMEOUT};
+
+    auto waiter = [&]() -> Task
+    {
+        status = co_await wait.co_wait([&]() -> bool
+                                       { return flag.load(); },
+                                       executor);
+        done.store(true);
+    };
+    waiter();
+    ASSERT_FALSE(done.load());
+    ASSERT_TRUE(wait.hasWaiters());
+
+    wait.notify();
+    ASSERT_FALSE(done.load());
+
+    flag.store(true);
+    wait.notifyOne();
+    ASSERT_TRUE(done.load());
+    EXPECT_EQ(status, Wait::Status::SUCCESS);
+    EXPECT_FALSE(wait.hasWaiters());
+}
+
+/**
+ * @brief Test that exit resumes a suspended co_wait with EXIT.
+ */
+TEST(CoroutineTest, CoWaitExit)
+{
+    Wait wait;
+    InlineExecutor executor;
+    std::atomic<bool> done{false};
+    Wait::Status status{Wait::Status::SUCCESS};
+
+    auto waiter = [&]() -> Task
+    {
+        status = co_await wait.co_wait([]() -> bool
+                                       { return false; },
+                                       executor);
+        done.store(true);
+    };
+    waiter();
+    ASSERT_FALSE(done.load());
+
+    wait.exit();
+    ASSERT_TRUE(done.load());
+    EXPECT_EQ(status, Wait::Status::EXIT);
+}
@@ -0,0 +1,171 @@
+#include "trlc/threadsafe/future.hpp"
+
+#include <exception>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using trlc::threadsafe::Future;
+using trlc::threadsafe::Promise;
+
+/**
+ * @brief Test for setting a value and getting it from another thread.
+ */
+TEST(FutureTest, SetAndGet)
+{
+    Promise<int> promise;
+    Future<int> future{promise.getFuture()};
+    ASSERT_TRUE(future.valid());
+    ASSERT_FALSE(future.ready());
+    ASSERT_FALSE(promise.getFuture().valid()); // Only one future per promise.
+    ASSERT_FALSE(future.waitFor(10));
+
+    std::thread setter([&promise]()
+                       { ASSERT_TRUE(promise.setValue(42)); });
+    ASSERT_EQ(future.get(), 42);
+    setter.join();
+    ASSERT_FALSE(promise.setValue(43));  // Already set.
+    ASSERT_FALSE(future.get().has_value()); // Already taken.
+}
+
+/**
+ * @brief Test that an abandoned promise completes its future without a value.
+ */
+TEST(FutureTest, AbandonedPromise)
+{
+    Future<std::unique_ptr<int>> future;
+    Future<void> void_future;
+    {
+        Promise<std::unique_ptr<int>> promise;
+        Promise<void> void_promise;
+        future = promise.getFuture();
+        void_future = void_promise.getFuture();
+    }
+    ASSERT_TRUE(future.ready());
+    ASSERT_FALSE(future.get().has_value());
+    ASSERT_FALSE(void_future.get());
+}
+
+/**
+ * @brief Test for chaining continuations, registered before and after the value is set.
+ */
+TEST(FutureTest, Then)
+{
+    Promise<int> promise;
+    Future<std::string> chained{promise.getFuture()
+                                    .then([](int value)
+                                          { return value * 2; })
+                                    .then([](int value)
+                                          { return std::to_string(value); })};
+    ASSERT_TRUE(promise.setValue(21));
+    ASSERT_EQ(chained.get(), "42");
+
+    Promise<void> ready_promise;
+    ASSERT_TRUE(ready_promise.setValue());
+    int called{0};
+    Future<void> after{ready_promise.getFuture().then([&called]()
+                                                     { ++called; })};
+    ASSERT_EQ(called, 1); // Runs immediately when the value is already there.
+    ASSERT_TRUE(after.get());
+
+    Future<int> abandoned{Promise<int>{}.getFuture().then([](int value)
+                                                          { return value; })};
+    ASSERT_FALSE(abandoned.get().has_value());
+}
+
+/**
+ * @brief Test for combining futures of the same and of different types.
+ */
+TEST(FutureTest, WhenAll)
+{
+    std::vector<Promise<int>> promises(3);
+    std::vector<Future<int>> futures;
+    for (auto& promise : promises)
+    {
+        futures.push_back(promise.getFuture());
+    }
+    Future<std::vector<int>> all{trlc::threadsafe::whenAll(std::move(futures))};
+
+    std::vector<std::thread> setters;
+    for (int i = 0; i < 3; ++i)
+    {
+        setters.emplace_back([&promises, i]()
+                             { promises[i].setValue(i); });
+    }
+    ASSERT_EQ(all.get(), (std::vector<int>{0, 1, 2}));
+    for (auto& setter : setters)
+    {
+        setter.join();
+    }
+
+    Promise<int> number;
+    Promise<std::string> text;
+    Future<std::tuple<int, std::string>> both{trlc::threadsafe::whenAll(number.getFuture(), text.getFuture())};
+    text.setValue("text");
+    ASSERT_FALSE(both.ready());
+    number.setValue(7);
+    ASSERT_EQ(both.get(), std::make_tuple(7, std::string("text")));
+
+    ASSERT_TRUE(trlc::threadsafe::whenAll(std::vector<Future<void>>{}).get());
+}
+
+/**
+ * @brief Test that an exception is rethrown by get and passed through then and whenAll.
+ */
+TEST(FutureTest, Exceptions)
+{
+    Promise<int> promise;
+    Future<int> failed{promise.getFuture()};
+    ASSERT_TRUE(promise.setException(std::make_exception_ptr(std::runtime_error("failed"))));
+    ASSERT_FALSE(promise.setValue(1)); // Already completed.
+    ASSERT_TRUE(failed.ready());
+    ASSERT_THROW(failed.get(), std::runtime_error);
+    ASSERT_FALSE(failed.get().has_value()); // Rethrown once.
+
+    Promise<int> chained_promise;
+    int called{0};
+    Future<std::string> chained{chained_promise.getFuture()
+                                    .then([&called](int value)
+                                          { ++called; return value; })
+                                    .then([](int value)
+                                          { return std::to_string(value); })};
+    chained_promise.setException(std::make_exception_ptr(std::logic_error("chained")));
+    ASSERT_EQ(called, 0); // Skipped by the exception.
+    ASSERT_THROW(chained.get(), std::logic_error);
+
+    Promise<void> ready_promise;
+    ASSERT_TRUE(ready_promise.setValue());
+    Future<int> throwing{ready_promise.getFuture().then([]() -> int
+                                                        { throw std::out_of_range("continuation"); })};
+    ASSERT_THROW(throwing.get(), std::out_of_range);
+
+    std::vector<Promise<int>> promises(3);
+    std::vector<Future<int>> futures;
+    for (auto& each : promises)
+    {
+        futures.push_back(each.getFuture());
+    }
+    Future<std::vector<int>> all{trlc::threadsafe::whenAll(std::move(futures))};
+    promises[0].setValue(0);
+    promises[1].setException(std::make_exception_ptr(std::runtime_error("first")));
+    ASSERT_TRUE(all.ready()); // Fails without waiting for the others.
+    promises[2].setException(std::make_exception_ptr(std::logic_error("second")));
+    ASSERT_THROW(all.get(), std::runtime_error);
+
+    Promise<int> number;
+    Promise<std::string> text;
+    Future<std::tuple<int, std::string>> both{trlc::threadsafe::whenAll(number.getFuture(), text.getFuture())};
+    text.setException(std::make_exception_ptr(std::runtime_error("text")));
+    number.setValue(7);
+    ASSERT_THROW(both.get(), std::runtime_error);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,112 @@
+#include "trlc/threadsafe/map.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Test inserting, assigning, finding and erasing keys.
+ */
+TEST(MapTest, InsertFindErase)
+{
+    trlc::threadsafe::Map<int, std::string> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.find(1).has_value());
+
+    EXPECT_TRUE(map.insertOrAssign(1, "one"));
+    EXPECT_TRUE(map.insertOrAssign(2, "two"));
+    EXPECT_FALSE(map.insertOrAssign(1, "uno"));
+    EXPECT_EQ(map.find(1).value(), "uno");
+    EXPECT_TRUE(map.contains(2));
+    EXPECT_EQ(map.size(), 2u);
+
+    EXPECT_TRUE(map.erase(1));
+    EXPECT_FALSE(map.erase(1));
+    EXPECT_FALSE(map.contains(1));
+    EXPECT_EQ(map.size(), 1u);
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+}
+
+/**
+ * @brief Test that computeIfAbsent calls the factory once per key across threads.
+ */
+TEST(MapTest, ComputeIfAbsent)
+{
+    trlc::threadsafe::Map<int, int> map;
+    std::atomic<int> calls{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&]()
+                             {
+            for (int key = 0; key < 1000; ++key)
+            {
+                const int value{map.computeIfAbsent(key, [&]()
+                                                    {
+                    calls.fetch_add(1);
+                    return key * 2; })};
+                ASSERT_EQ(value, key * 2);
+            } });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(calls.load(), 1000);
+    EXPECT_EQ(map.size(), 1000u);
+}
+
+/**
+ * @brief Test that concurrent writers on distinct keys all land and visits see every element.
+ */
+TEST(MapTest, ConcurrentWritersAndVisit)
+{
+    trlc::threadsafe::Map<int, int, 8> map;
+    constexpr int THREADS{4};
+    constexpr int KEYS{2000};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i)
+    {
+        threads.emplace_back([&map, i]()
+                             {
+            for (int key = i; key < KEYS; key += THREADS)
+            {
+                map.insertOrAssign(key, key + 1);
+                ASSERT_EQ(map.find(key).value_or(0), key + 1);
+            } });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    long long sum{0};
+    map.visit([&sum](const int& key, const int& value)
+              {
+        EXPECT_EQ(value, key + 1);
+        sum += value; });
+    EXPECT_EQ(sum, static_cast<long long>(KEYS) * (KEYS + 1) / 2);
+
+    std::size_t total{0};
+    std::size_t used_shards{0};
+    for (std::size_t index = 0; index < map.shardCount(); ++index)
+    {
+        map.visitShard(index, [&](const trlc::threadsafe::Map<int, int, 8>::Shard& shard)
+                       {
+            total += shard.size();
+            used_shards += shard.empty() ? 0 : 1; });
+    }
+    EXPECT_EQ(total, static_cast<std::size_t>(KEYS));
+    // Consecutive integer keys must spread over the shards despite the identity hash.
+    EXPECT_EQ(used_shards, map.shardCount());
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,644 @@
+#include "trlc/threadsafe/mpmc_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using MpmcQueue = trlc::threadsafe::MpmcQueue<int>;
+
+/**
+ * @brief Test for basic push and pop functionality.
+ */
+TEST(MpmcQueueTest, BasicPushPop)
+{
+    MpmcQueue::Settings settings;
+    MpmcQueue queue(settings);
+
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value, 100)); // Queue is empty, pop should fail.
+
+    ASSERT_TRUE(queue.push(42));          // Push should succeed.
+    ASSERT_TRUE(queue.pop(popped_value)); // Pop should succeed.
+    ASSERT_EQ(popped_value, 42);          // Check popped value.
+}
+
+/**
+ * @brief Test that the capacity follows the settings and falls back to the default when unbounded.
+ */
+TEST(MpmcQueueTest, Capacity)
+{
+    MpmcQueue::Settings settings;
+    MpmcQueue unbounded(settings);
+    ASSERT_EQ(unbounded.capacity(), MpmcQueue::DEFAULT_CAPACITY);
+
+    settings.size = 3;
+    MpmcQueue bounded(settings);
+    ASSERT_EQ(bounded.capacity(), 3u);
+    ASSERT_TRUE(bounded.push(1));
+    ASSERT_TRUE(bounded.push(2));
+    ASSERT_TRUE(bounded.push(3));
+    ASSERT_FALSE(bounded.push(4, 50)); // The logical size is honored even though the ring holds 4 slots.
+}
+
+/**
+ * @brief Test for queue size limitation and discard policy (DISCARD_OLDEST).
+ */
+TEST(MpmcQueueTest, DiscardOldest)
+{
+    MpmcQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = MpmcQueue::Discard::DISCARD_OLDEST;
+
+    MpmcQueue queue(settings);
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const int& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_TRUE(queue.push(3)); // This will discard the oldest (1).
+
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 2);
+    ASSERT_EQ(discarded, 1);
+}
+
+/**
+ * @brief Test for queue size limitation and discard policy (DISCARD_NEWEST).
+ */
+TEST(MpmcQueueTest, DiscardNewest)
+{
+    MpmcQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = MpmcQueue::Discard::DISCARD_NEWEST;
+
+    MpmcQueue queue(settings);
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const int& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_FALSE(queue.push(3)); // This will discard the newest (3).
+
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 1);
+    ASSERT_EQ(discarded, 3);
+}
+
+/**
+ * @brief Test for controlling push and pop operations.
+ */
+TEST(MpmcQueueTest, PushPopControl)
+{
+    MpmcQueue::Settings settings;
+    settings.control = MpmcQueue::Control::FULL_CONTROL;
+
+    MpmcQueue queue(settings);
+    ASSERT_FALSE(queue.push(1)); // Closed until explicitly opened.
+    queue.openPush();
+    queue.openPop();
+
+    int popped_value;
+    ASSERT_TRUE(queue.push(42));
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 42);
+
+    queue.closePush();
+    ASSERT_FALSE(queue.push(100));
+
+    queue.closePop();
+    ASSERT_FALSE(queue.pop(popped_value));
+}
+
+/**
+ * @brief Test that closing pop wakes up a blocked consumer.
+ */
+TEST(MpmcQueueTest, ClosePopWakesConsumer)
+{
+    MpmcQueue::Settings settings;
+    settings.control = MpmcQueue::Control::POP;
+    MpmcQueue queue(settings);
+    queue.openPop();
+
+    std::thread closer([&]()
+                       {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        queue.closePop(); });
+
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value)); // Waits forever until pop is closed.
+    closer.join();
+}
+
+/**
+ * @brief Test that remaining elements are destroyed with the queue.
+ */
+TEST(MpmcQueueTest, DestroysRemainingElements)
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        trlc::threadsafe::MpmcQueue<std::shared_ptr<int>>::Settings settings;
+        settings.size = 4;
+        trlc::threadsafe::MpmcQueue<std::shared_ptr<int>> queue(settings);
+        ASSERT_TRUE(queue.push(counter));
+        ASSERT_TRUE(queue.push(counter));
+        ASSERT_EQ(counter.use_count(), 3);
+    }
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+/**
+ * @brief Test that every element is popped exactly once with several producers and consumers.
+ */
+TEST(MpmcQueueTest, ConcurrentPushPop)
+{
+    constexpr int PRODUCERS{4};
+    constexpr int CONSUMERS{4};
+    constexpr int COUNT_PER_PRODUCER{20000};
+    MpmcQueue::Settings settings;
+    settings.size = 64;
+    MpmcQueue queue(settings);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&, p]()
+                               {
+            for (int i = 0; i < COUNT_PER_PRODUCER; ++i) {
+                ASSERT_TRUE(queue.push(p * COUNT_PER_PRODUCER + i));
+            } });
+    }
+
+    std::vector<std::atomic<int>> seen(PRODUCERS * COUNT_PER_PRODUCER);
+    std::atomic<int> remaining{PRODUCERS * COUNT_PER_PRODUCER};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; ++c)
+    {
+        consumers.emplace_back([&]()
+                               {
+            int popped_value;
+            while (remaining.load() > 0) {
+                if (queue.pop(popped_value, 10)) {
+                    seen[popped_value].fetch_add(1);
+                    remaining.fetch_sub(1);
+                }
+            } });
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    for (auto& consumer : consumers)
+    {
+        consumer.join();
+    }
+    for (const auto& count : seen)
+    {
+        ASSERT_EQ(count.load(), 1);
+    }
+}
+
+/**
+ * @brief Test that pushed elements are either popped or discarded when producers overrun the consumers.
+ */
+TEST(MpmcQueueTest, ConcurrentDiscardOldest)
+{
+    constexpr int PRODUCERS{4};
+    constexpr int COUNT_PER_PRODUCER{20000};
+    MpmcQueue::Settings settings;
+    settings.size = 8;
+    settings.discard = MpmcQueue::Discard::DISCARD_OLDEST;
+    MpmcQueue queue(settings);
+
+    std::atomic<int> discarded{0};
+    queue.setDiscardedCallback([&discarded](const int&)
+                               { discarded.fetch_add(1); });
+
+    std::atomic<bool> producing{true};
+    std::atomic<int> popped{0};
+    std::thread consumer([&]()
+                         {
+        int popped_value;
+        while (true) {
+            if (queue.pop(popped_value, 1)) {
+                popped.fetch_add(1);
+            } else if (!producing.load()) {
+                break;
+            }
+        } });
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&]()
+                               {
+            for (int i = 0; i < COUNT_PER_PRODUCER; ++i) {
+                ASSERT_TRUE(queue.push(i));
+            } });
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    producing.store(false);
+    consumer.join();
+
+    ASSERT_EQ(popped.load() + discarded.load(), PRODUCERS * COUNT_PER_PRODUCER);
+}
+
+/**
+ * @brief Test for pushing and popping move-only elements.
+ */
+TEST(MpmcQueueTest, MoveOnlyElements)
+{
+    using PtrQueue = trlc::threadsafe::MpmcQueue<std::unique_ptr<int>>;
+    PtrQueue::Settings settings;
+    settings.size = 2;
+    PtrQueue queue(settings);
+
+    ASSERT_TRUE(queue.push(std::make_unique<int>(1)));
+    ASSERT_TRUE(queue.emplace(new int(2)));
+
+    std::unique_ptr<int> popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(*popped_value, 1);
+
+    std::optional<std::unique_ptr<int>> tried{queue.tryPop()};
+    ASSERT_TRUE(tried.has_value());
+    ASSERT_EQ(**tried, 2);
+    ASSERT_FALSE(queue.tryPop().has_value()); // Queue is empty.
+}
+
+/**
+ * @brief Test that the discard-oldest path hands the moved-out element to the callback.
+ */
+TEST(MpmcQueueTest, MoveOnlyDiscardOldest)
+{
+    using PtrQueue = trlc::threadsafe::MpmcQueue<std::unique_ptr<int>>;
+    PtrQueue::Settings settings;
+    settings.size = 1;
+    settings.discard = PtrQueue::Discard::DISCARD_OLDEST;
+    PtrQueue queue(settings);
+
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const std::unique_ptr<int>& elem)
+                               { discarded = *elem; });
+
+    ASSERT_TRUE(queue.push(std::make_unique<int>(1)));
+    ASSERT_TRUE(queue.push(std::make_unique<int>(2))); // This will discard 1.
+    ASSERT_EQ(discarded, 1);
+
+    std::unique_ptr<int> popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(*popped_value, 2);
+}
+
+/**
+ * @brief Test that emplace with DISCARD_NEWEST constructs the discarded element for the callback.
+ */
+TEST(MpmcQueueTest, EmplaceDiscardNewest)
+{
+    using StringQueue = trlc::threadsafe::MpmcQueue<std::string>;
+    StringQueue::Settings settings;
+    settings.size = 1;
+    settings.discard = StringQueue::Discard::DISCARD_NEWEST;
+    StringQueue queue(settings);
+
+    std::string discarded;
+    queue.setDiscardedCallback([&discarded](const std::string& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.emplace(3, 'a'));
+    ASSERT_FALSE(queue.emplace(3, 'b')); // Queue is full, "bbb" is discarded.
+    ASSERT_EQ(discarded, "bbb");
+    ASSERT_EQ(queue.tryPop().value(), "aaa");
+}
+
+/**
+ * @brief Test that a reserved element is written and read in place, and only seen once committed.
+ */
+TEST(MpmcQueueTest, ReserveCommitPeekRelease)
+{
+    MpmcQueue::Settings settings;
+    settings.size = 4;
+    MpmcQueue queue(settings);
+
+    MpmcQueue::Reservation reserved{queue.reserve()};
+    ASSERT_TRUE(reserved);
+    *reserved = 7;
+    int* storage{&*reserved};
+    ASSERT_FALSE(queue.peek(10)); // Not committed yet.
+    ASSERT_TRUE(queue.commit(reserved));
+    ASSERT_FALSE(reserved);
+    ASSERT_FALSE(queue.commit(reserved));
+
+    MpmcQueue::Reservation peeked{queue.peek()};
+    ASSERT_TRUE(peeked);
+    ASSERT_EQ(&*peeked, storage); // Same storage, no copy.
+    ASSERT_EQ(*peeked, 7);
+    ASSERT_TRUE(queue.release(peeked));
+    ASSERT_FALSE(peeked);
+    ASSERT_FALSE(queue.tryPop().has_value());
+}
+
+/**
+ * @brief Test that reserve follows the control and discard policies.
+ */
+TEST(MpmcQueueTest, ReservePolicies)
+{
+    MpmcQueue::Settings settings;
+    settings.size = 1;
+    settings.control = MpmcQueue::Control::FULL_CONTROL;
+    MpmcQueue closed(settings);
+    ASSERT_FALSE(closed.reserve(10)); // Push is closed.
+    closed.openPush();
+    MpmcQueue::Reservation reserved{closed.reserve()};
+    ASSERT_TRUE(reserved);
+    closed.closePush();
+    ASSERT_TRUE(closed.commit(reserved)); // Committed even once closed.
+    ASSERT_FALSE(closed.peek(10));        // Pop is closed.
+
+    settings.control = MpmcQueue::Control::NO_CONTROL;
+    MpmcQueue no_discard(settings);
+    ASSERT_TRUE(no_discard.push(1));
+    ASSERT_FALSE(no_discard.reserve(10));
+
+    settings.discard = MpmcQueue::Discard::DISCARD_NEWEST;
+    MpmcQueue newest(settings);
+    ASSERT_TRUE(newest.push(1));
+    ASSERT_FALSE(newest.reserve());
+    ASSERT_EQ(newest.tryPop().value(), 1);
+
+    settings.discard = MpmcQueue::Discard::DISCARD_OLDEST;
+    MpmcQueue oldest(settings);
+    int discarded{-1};
+    oldest.setDiscardedCallback([&discarded](const int& elem)
+                                { discarded = elem; });
+    ASSERT_TRUE(oldest.push(1));
+    reserved = oldest.reserve();
+    ASSERT_TRUE(reserved);
+    ASSERT_EQ(discarded, 1);
+    *reserved = 2;
+    ASSERT_TRUE(oldest.commit(reserved));
+    ASSERT_EQ(oldest.tryPop().value(), 2);
+}
+
+/**
+ * @brief Test that a producer reaching a peeked slot waits for its release instead of discarding the others.
+ */
+TEST(MpmcQueueTest, DiscardOldestWaitsForPeekedSlot)
+{
+    MpmcQueue::Settings settings;
+    settings.size = 4;
+    settings.discard = MpmcQueue::Discard::DISCARD_OLDEST;
+    MpmcQueue queue(settings);
+    std::atomic<int> discarded{0};
+    queue.setDiscardedCallback([&discarded](const int&)
+                               { ++discarded; });
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(queue.push(i));
+    }
+    MpmcQueue::Reservation peeked{queue.peek()};
+    ASSERT_EQ(*peeked, 0);
+    ASSERT_FALSE(queue.push(99, 10)); // From the peeking thread, times out.
+    ASSERT_FALSE(queue.reserve(10));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&queue, &pushed]()
+                         {
+        ASSERT_TRUE(queue.push(100, 5000));
+        pushed = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_FALSE(pushed.load());
+    ASSERT_TRUE(queue.release(peeked));
+    producer.join();
+    ASSERT_EQ(discarded.load(), 0);
+    for (const int expected : {1, 2, 3, 100})
+    {
+        ASSERT_EQ(queue.tryPop().value(), expected);
+    }
+}
+
+/**
+ * @brief Test that every frame written in place is read exactly once with several producers and consumers.
+ */
+TEST(MpmcQueueTest, ConcurrentReservePeek)
+{
+    struct Frame
+    {
+        uint32_t sequence;
+        unsigned char bytes[64 * 1024];
+    };
+    constexpr uint32_t PRODUCERS{2};
+    constexpr uint32_t CONSUMERS{2};
+    constexpr uint32_t COUNT_PER_PRODUCER{1000};
+    trlc::threadsafe::MpmcQueue<Frame>::Settings settings;
+    settings.size = 4;
+    trlc::threadsafe::MpmcQueue<Frame> queue(settings);
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&, p]()
+                               {
+            for (uint32_t i = 0; i < COUNT_PER_PRODUCER; ++i) {
+                auto frame{queue.reserve()};
+                ASSERT_TRUE(frame);
+                frame->sequence = p * COUNT_PER_PRODUCER + i;
+                frame->bytes[sizeof(frame->bytes) - 1] = static_cast<unsigned char>(frame->sequence);
+                ASSERT_TRUE(queue.commit(frame));
+            } });
+    }
+
+    std::vector<std::atomic<int>> seen(PRODUCERS * COUNT_PER_PRODUCER);
+    std::atomic<int> remaining{static_cast<int>(PRODUCERS * COUNT_PER_PRODUCER)};
+    std::vector<std::thread> consumers;
+    for (uint32_t c = 0; c < CONSUMERS; ++c)
+    {
+        consumers.emplace_back([&]()
+                               {
+            while (remaining.load() > 0) {
+                auto frame{queue.peek(10)};
+                if (frame) {
+                    ASSERT_EQ(frame->bytes[sizeof(frame->bytes) - 1], static_cast<unsigned char>(frame->sequence));
+                    seen[frame->sequence].fetch_add(1);
+                    ASSERT_TRUE(queue.release(frame));
+                    remaining.fetch_sub(1);
+                }
+            } });
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    for (auto& consumer : consumers)
+    {
+        consumer.join();
+    }
+    for (const auto& count : seen)
+    {
+        ASSERT_EQ(count.load(), 1);
+    }
+}
+
+/**
+ * @brief Test that reservations dropped without commit or release keep the queue flowing.
+ */
+TEST(MpmcQueueTest, DropsUnfinishedReservations)
+{
+    static_assert(!std::is_copy_constructible_v<MpmcQueue::Reservation>);
+    static_assert(!std::is_copy_assignable_v<MpmcQueue::Reservation>);
+    trlc::threadsafe::MpmcQueue<std::shared_ptr<int>>::Settings settings;
+    settings.size = 4;
+    trlc::threadsafe::MpmcQueue<std::shared_ptr<int>> queue(settings);
+    auto token{std::make_shared<int>(1)};
+
+    {
+        auto reserved{queue.reserve()};
+        ASSERT_TRUE(reserved);
+        *reserved = token;
+    }
+    ASSERT_EQ(token.use_count(), 1); // Destroyed unpublished.
+    ASSERT_FALSE(queue.peek(10));    // Skipped.
+
+    ASSERT_TRUE(queue.push(token));
+    {
+        auto peeked{queue.peek()};
+        ASSERT_TRUE(peeked);
+    }
+    ASSERT_EQ(token.use_count(), 1); // Released.
+    ASSERT_FALSE(queue.tryPop().has_value());
+
+    // Assigning over a live reservation drops it first.
+    auto reserved{queue.reserve()};
+    *reserved = token;
+    reserved = queue.reserve();
+    ASSERT_EQ(token.use_count(), 1);
+    *reserved = std::make_shared<int>(2);
+    ASSERT_TRUE(queue.commit(reserved));
+    ASSERT_EQ(*queue.tryPop().value(), 2);
+    ASSERT_FALSE(queue.tryPop().has_value());
+}
+
+/**
+ * @brief Test that producers and consumers keep going while others drop their reservations.
+ */
+TEST(MpmcQueueTest, ConcurrentDroppedReservations)
+{
+    constexpr uint32_t PRODUCERS{2};
+    constexpr uint32_t CONSUMERS{2};
+    constexpr uint32_t COUNT_PER_PRODUCER{2000};
+    MpmcQueue::Settings settings;
+    settings.size = 4;
+    MpmcQueue queue(settings);
+
+    // Every fourth reservation is dropped unpublished, every third peek is dropped unreleased.
+    std::atomic<int> remaining{static_cast<int>(PRODUCERS * COUNT_PER_PRODUCER * 3 / 4)};
+    std::atomic<int> popped{0};
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&queue]()
+                               {
+            for (uint32_t i = 0; i < COUNT_PER_PRODUCER; ++i) {
+                auto reserved{queue.reserve()};
+                ASSERT_TRUE(reserved);
+                *reserved = static_cast<int>(i);
+                if (i % 4 != 0) {
+                    ASSERT_TRUE(queue.commit(reserved));
+                }
+            } });
+    }
+    std::vector<std::thread> consumers;
+    for (uint32_t c = 0; c < CONSUMERS; ++c)
+    {
+        consumers.emplace_back([&queue, &remaining, &popped]()
+                               {
+            for (uint32_t i = 0; remaining.load() > 0; ++i) {
+                auto peeked{queue.peek(10)};
+                if (!peeked) {
+                    continue;
+                }
+                ASSERT_NE(*peeked % 4, 0);
+                if (i % 3 != 0) {
+                    ASSERT_TRUE(queue.release(peeked));
+                }
+                popped.fetch_add(1);
+                remaining.fetch_sub(1);
+            } });
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    for (auto& consumer : consumers)
+    {
+        consumer.join();
+    }
+    ASSERT_EQ(popped.load(), static_cast<int>(PRODUCERS * COUNT_PER_PRODUCER * 3 / 4));
+    ASSERT_FALSE(queue.tryPop().has_value());
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_EQ(queue.tryPop().value(), 1);
+}
+
+/**
+ * @brief Test the timeouts and deadlines given as std::chrono durations and time points.
+ */
+TEST(MpmcQueueTest, ChronoTimeouts)
+{
+    MpmcQueue::Settings settings;
+    settings.size = 1;
+    settings.control = MpmcQueue::Control::FULL_CONTROL;
+    MpmcQueue queue(settings);
+    ASSERT_FALSE(queue.waitPushOpen(std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.waitPopOpen(std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+    queue.openPush();
+    queue.openPop();
+    ASSERT_TRUE(queue.waitPushOpen(std::chrono::system_clock::now() + std::chrono::microseconds(300)));
+    ASSERT_TRUE(queue.waitPopOpen(std::chrono::microseconds(300)));
+
+    int popped_value;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_FALSE(queue.pop(popped_value, std::chrono::microseconds(300))); // Empty, times out.
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(300));
+    ASSERT_FALSE(queue.pop(popped_value, std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.peek(std::chrono::system_clock::now() + std::chrono::microseconds(300)));
+
+    const int value{1};
+    ASSERT_TRUE(queue.push(value, std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.push(2, std::chrono::microseconds(300))); // Full, times out.
+    ASSERT_FALSE(queue.push(value, std::chrono::system_clock::now() + std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.reserve(std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.reserve(std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+
+    MpmcQueue::Reservation peeked{queue.peek(std::chrono::microseconds(300))};
+    ASSERT_TRUE(peeked);
+    ASSERT_EQ(*peeked, 1);
+    ASSERT_TRUE(queue.release(peeked));
+    MpmcQueue::Reservation reserved{queue.reserve(std::chrono::steady_clock::time_point::max())};
+    ASSERT_TRUE(reserved);
+    *reserved = 3;
+    ASSERT_TRUE(queue.commit(reserved));
+    ASSERT_TRUE(queue.pop(popped_value, std::chrono::steady_clock::time_point::max()));
+    ASSERT_EQ(popped_value, 3);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
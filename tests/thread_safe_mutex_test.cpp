@@ -0,0 +1,174 @@
+#include "trlc/threadsafe/mutex.hpp"
+
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/thread.hpp"
+#include "trlc/threadsafe/variable.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using trlc::threadsafe::PriorityInheritanceMutex;
+
+namespace
+{
+
+void spinFor(const std::chrono::milliseconds duration)
+{
+    const auto end{std::chrono::steady_clock::now() + duration};
+    while (std::chrono::steady_clock::now() < end)
+    {
+    }
+}
+
+/**
+ * @brief A `SCHED_FIFO` thread pinned to CPU 0, so that the priorities decide which thread runs.
+ */
+std::unique_ptr<trlc::threadsafe::Thread> fifoThread(const std::string& name, const int32_t priority)
+{
+    auto thread{std::make_unique<trlc::threadsafe::Thread>(name)};
+    trlc::threadsafe::ThreadScheduling scheduling;
+    scheduling.policy = trlc::threadsafe::SchedulingPolicy::FIFO;
+    scheduling.priority = priority;
+    thread->setScheduling(scheduling);
+    thread->setAffinity({0});
+    return thread;
+}
+
+} // namespace
+
+/**
+ * @brief Test locking, unlocking and try_lock from another thread.
+ */
+TEST(MutexTest, LockUnlock)
+{
+    PriorityInheritanceMutex mutex;
+#ifdef __linux__
+    ASSERT_TRUE(mutex.inheritsPriority());
+#endif
+    mutex.lock();
+    bool locked{true};
+    std::thread other([&mutex, &locked]()
+                      { locked = mutex.try_lock(); });
+    other.join();
+    ASSERT_FALSE(locked);
+    mutex.unlock();
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+/**
+ * @brief Test that the mutex excludes concurrent critical sections.
+ */
+TEST(MutexTest, MutualExclusion)
+{
+    constexpr int THREADS{4};
+    constexpr int INCREMENTS{20000};
+    PriorityInheritanceMutex mutex;
+    int counter{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&mutex, &counter]()
+                             {
+            for (int i = 0; i < INCREMENTS; ++i)
+            {
+                std::lock_guard<PriorityInheritanceMutex> lock{mutex};
+                ++counter;
+            } });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    ASSERT_EQ(counter, THREADS * INCREMENTS);
+}
+
+/**
+ * @brief Test the mutex as the lock policy of Queue and Variable.
+ */
+TEST(MutexTest, LockPolicy)
+{
+    using Queue = trlc::threadsafe::Queue<int, std::allocator<int>, trlc::threadsafe::NoQueueStats, PriorityInheritanceMutex>;
+    constexpr int COUNT{10000};
+    Queue queue(Queue::Settings{});
+    trlc::threadsafe::Variable<std::string, PriorityInheritanceMutex> last{"none"};
+    std::thread consumer([&queue, &last]()
+                         {
+        int value{0};
+        for (int i = 0; i < COUNT; ++i)
+        {
+            ASSERT_TRUE(queue.pop(value, 1000));
+            ASSERT_EQ(value, i);
+            last = std::to_string(value);
+        } });
+    for (int i = 0; i < COUNT; ++i)
+    {
+        ASSERT_TRUE(queue.push(i));
+    }
+    consumer.join();
+    ASSERT_FALSE(queue.tryPop().has_value());
+    ASSERT_EQ(last.get(), std::to_string(COUNT - 1));
+}
+
+/**
+ * @brief Test that a high-priority thread waiting for the mutex is not held up by a medium-priority one.
+ *
+ * On one CPU, a low-priority thread holds the mutex when a medium-priority thread starts spinning and a
+ * high-priority one blocks on the mutex. The low-priority owner inherits the high priority, so that the
+ * high-priority thread gets the mutex while the medium-priority one still spins.
+ */
+TEST(MutexTest, BoundsPriorityInversion)
+{
+    PriorityInheritanceMutex mutex;
+    std::atomic<bool> high_done{false};
+    std::atomic<bool> high_done_while_spinning{false};
+
+    auto low{fifoThread("low", 10)};
+    low->invoke([&mutex]()
+                {
+        std::lock_guard<PriorityInheritanceMutex> lock{mutex};
+        spinFor(std::chrono::milliseconds{20}); });
+    auto medium{fifoThread("medium", 20)};
+    medium->invoke([&high_done, &high_done_while_spinning]()
+                   {
+        spinFor(std::chrono::milliseconds{100});
+        high_done_while_spinning = high_done.load(); });
+    auto high{fifoThread("high", 30)};
+    high->invoke([&mutex, &high_done]()
+                 {
+        std::lock_guard<PriorityInheritanceMutex> lock{mutex};
+        high_done = true; });
+
+    // Preempts the three others to start them in order.
+    auto starter{fifoThread("starter", 40)};
+    starter->invoke([&]()
+                    {
+        low->run(trlc::threadsafe::Thread::RunMode::ONCE);
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        medium->run(trlc::threadsafe::Thread::RunMode::ONCE);
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        high->run(trlc::threadsafe::Thread::RunMode::ONCE); });
+    starter->run(trlc::threadsafe::Thread::RunMode::ONCE);
+    starter->stop();
+    high->stop();
+    medium->stop();
+    low->stop();
+    if (starter->schedulingError() || low->schedulingError() || medium->schedulingError() || high->schedulingError())
+    {
+        GTEST_SKIP() << "SCHED_FIFO is not permitted: " << starter->schedulingError().message();
+    }
+    ASSERT_TRUE(high_done.load());
+    ASSERT_TRUE(high_done_while_spinning.load());
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,128 @@
+#include "trlc/threadsafe/mpmc_queue.hpp"
+#include "trlc/threadsafe/numa.hpp"
+#include "trlc/threadsafe/spsc_queue.hpp"
+#include "trlc/threadsafe/thread.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <memory>
+#include <system_error>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace threadsafe = trlc::threadsafe;
+
+/**
+ * @brief Test for the NUMA topology queries.
+ */
+TEST(NumaTest, Topology)
+{
+    ASSERT_GE(threadsafe::numaNodeCount(), 1u);
+    const int32_t node{threadsafe::currentNumaNode()};
+    ASSERT_GE(node, 0);
+    ASSERT_LT(static_cast<uint32_t>(node), threadsafe::numaNodeCount());
+    ASSERT_FALSE(threadsafe::numaNodeCpus(node).empty());
+    ASSERT_TRUE(threadsafe::numaNodeCpus(threadsafe::NO_NUMA_NODE).empty());
+}
+
+/**
+ * @brief Test that NUMA arrays construct, expose and destroy their elements on and off a node.
+ */
+TEST(NumaTest, NumaArray)
+{
+    auto counter = std::make_shared<int>(0);
+    for (const int32_t node : {threadsafe::NO_NUMA_NODE, int32_t{0}})
+    {
+        {
+            threadsafe::NumaArray<std::shared_ptr<int>> array{threadsafe::makeNumaArray<std::shared_ptr<int>>(100, node)};
+            for (std::size_t index = 0; index < 100; ++index)
+            {
+                ASSERT_EQ(array[index], nullptr);
+                array[index] = counter;
+            }
+            ASSERT_EQ(counter.use_count(), 101);
+        }
+        ASSERT_EQ(counter.use_count(), 1);
+    }
+}
+
+/**
+ * @brief Test that a thread applies its affinity and NUMA node before running the function.
+ */
+TEST(NumaTest, ThreadAffinity)
+{
+    const threadsafe::CpuSet cpus{threadsafe::numaNodeCpus(0)};
+    ASSERT_FALSE(cpus.empty());
+
+    threadsafe::Thread thread("PinnedThread");
+    thread.setNumaNode(0);
+    thread.setAffinity({cpus.front()});
+    auto cpu = thread.submit([]() -> int
+                             {
+#ifdef __linux__
+        return ::sched_getcpu();
+#else
+        return -1;
+#endif
+                             });
+#ifdef __linux__
+    ASSERT_EQ(cpu.get(), static_cast<int>(cpus.front()));
+#else
+    ASSERT_TRUE(cpu.get().has_value());
+#endif
+    ASSERT_TRUE(thread.stop());
+    ASSERT_FALSE(thread.affinityError()) << thread.affinityError().message();
+
+    thread.setAffinity({std::numeric_limits<uint32_t>::max()}); // No such CPU.
+    ASSERT_TRUE(thread.submit([]() {}).get());
+    ASSERT_TRUE(thread.stop());
+    ASSERT_EQ(thread.affinityError(), std::errc::invalid_argument);
+}
+
+/**
+ * @brief Test that the affinity and NUMA binding report why they could not be applied.
+ */
+TEST(NumaTest, PlacementErrors)
+{
+    // Every call below is rejected, so the calling thread is not moved.
+    const auto self{threadsafe::currentNativeThreadHandle()};
+    ASSERT_EQ(threadsafe::setNativeThreadAffinity({}, self), std::errc::invalid_argument);
+#ifdef __linux__
+    // Fits in the CPU set, but the kernel rejects a set without an online CPU.
+    const std::error_code error{threadsafe::setNativeThreadAffinity({CPU_SETSIZE - 1}, self)};
+    ASSERT_EQ(error, std::errc::invalid_argument);
+    ASSERT_EQ(error.category(), std::system_category());
+#endif
+    ASSERT_EQ(threadsafe::bindCurrentThreadToNumaNode(threadsafe::NO_NUMA_NODE), std::errc::invalid_argument);
+    ASSERT_TRUE(threadsafe::bindCurrentThreadToNumaNode(static_cast<int32_t>(threadsafe::numaNodeCount()) + 1));
+}
+
+/**
+ * @brief Test that the ring queues work with storage placed on a NUMA node.
+ */
+TEST(NumaTest, QueueOnNode)
+{
+    threadsafe::SpscQueue<int>::Settings settings;
+    settings.size = 8;
+    settings.numa_node = 0;
+    threadsafe::SpscQueue<int> spsc(settings);
+    threadsafe::MpmcQueue<int> mpmc(settings);
+
+    int popped_value;
+    ASSERT_TRUE(spsc.push(1));
+    ASSERT_TRUE(spsc.pop(popped_value));
+    ASSERT_EQ(popped_value, 1);
+    ASSERT_TRUE(mpmc.push(2));
+    ASSERT_TRUE(mpmc.pop(popped_value));
+    ASSERT_EQ(popped_value, 2);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,237 @@
+#include "trlc/threadsafe/object_pool.hpp"
+#include "trlc/threadsafe/queue.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::atomic<std::size_t> g_allocations{0}; ///< Calls of the global operator new.
+
+struct Buffer
+{
+    explicit Buffer(const int value)
+        : id{value}
+    {
+    }
+
+    int id{0};
+    char payload[120]{};
+};
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr{std::malloc(size == 0 ? 1 : size)})
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align{static_cast<std::size_t>(alignment)};
+    if (void* ptr{std::aligned_alloc(align, (size + align - 1) / align * align)})
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+/**
+ * @brief Test that destroyed objects are reused without growing the pool.
+ */
+TEST(ObjectPoolTest, ReusesDestroyedObjects)
+{
+    trlc::threadsafe::ObjectPool<Buffer>::Settings settings;
+    settings.chunk_size = 8;
+    settings.batch_size = 2;
+    trlc::threadsafe::ObjectPool<Buffer> pool{settings};
+
+    Buffer* first{pool.create(1)};
+    EXPECT_EQ(first->id, 1);
+    EXPECT_EQ(pool.capacity(), 8u);
+    pool.destroy(first);
+    Buffer* second{pool.create(2)};
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(second->id, 2);
+    pool.destroy(second);
+
+    std::vector<trlc::threadsafe::ObjectPool<Buffer>::Pointer> buffers;
+    for (int i = 0; i < 20; ++i)
+    {
+        buffers.push_back(pool.make(i));
+    }
+    EXPECT_EQ(pool.capacity(), 24u);
+    buffers.clear();
+    for (int i = 0; i < 20; ++i)
+    {
+        buffers.push_back(pool.make(i));
+    }
+    EXPECT_EQ(pool.capacity(), 24u);
+}
+
+/**
+ * @brief Test that the discarded callback of a queue recycles into the pool.
+ */
+TEST(ObjectPoolTest, RecyclesDiscardedElements)
+{
+    trlc::threadsafe::ObjectPool<Buffer> pool;
+    trlc::threadsafe::Queue<Buffer*>::Settings settings;
+    settings.size = 2;
+    settings.discard = trlc::threadsafe::Queue<Buffer*>::Discard::DISCARD_OLDEST;
+    trlc::threadsafe::Queue<Buffer*> queue{settings};
+    queue.setDiscardedCallback(pool.recycler());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(queue.push(pool.create(i)));
+    }
+    Buffer* buffer{nullptr};
+    EXPECT_TRUE(queue.pop(buffer, 0));
+    EXPECT_EQ(buffer->id, 998);
+    pool.destroy(buffer);
+    EXPECT_TRUE(queue.pop(buffer, 0));
+    EXPECT_EQ(buffer->id, 999);
+    pool.destroy(buffer);
+    EXPECT_EQ(pool.capacity(), trlc::threadsafe::ObjectPool<Buffer>::Settings{}.chunk_size);
+}
+
+/**
+ * @brief Test that a warmed-up pipeline with pooled buffers and queue chunks stops calling operator new.
+ */
+TEST(ObjectPoolTest, NoSteadyStateAllocations)
+{
+    using Pointer = trlc::threadsafe::ObjectPool<Buffer>::Pointer;
+    using PipelineQueue = trlc::threadsafe::Queue<Pointer, trlc::threadsafe::PoolAllocator<Pointer>>;
+    constexpr int WARMUP{20000};
+    constexpr int MESSAGES{40000};
+
+    trlc::threadsafe::ObjectPool<Buffer> pool;
+    PipelineQueue::Settings settings;
+    settings.size = 64;
+    PipelineQueue queue{settings};
+
+    std::size_t steady_allocations{0};
+    std::thread producer([&]()
+                         {
+        std::size_t start{0};
+        for (int i = 0; i < MESSAGES; ++i)
+        {
+            if (i == WARMUP)
+            {
+                start = g_allocations.load();
+            }
+            queue.push(pool.make(i));
+        }
+        steady_allocations = g_allocations.load() - start; });
+
+    long long sum{0};
+    for (int i = 0; i < MESSAGES; ++i)
+    {
+        Pointer buffer{};
+        ASSERT_TRUE(queue.pop(buffer));
+        sum += buffer->id;
+    }
+    producer.join();
+    EXPECT_EQ(sum, static_cast<long long>(MESSAGES) * (MESSAGES - 1) / 2);
+    EXPECT_EQ(steady_allocations, 0u);
+}
+
+/**
+ * @brief Test that a thread using more pools than it remembers hands its forgotten caches back.
+ */
+TEST(ObjectPoolTest, EvictedCachesReturnBlocks)
+{
+    constexpr std::size_t POOLS{9};
+    std::vector<std::unique_ptr<trlc::threadsafe::ObjectPool<int>>> pools;
+    for (std::size_t i = 0; i < POOLS; ++i)
+    {
+        pools.push_back(std::make_unique<trlc::threadsafe::ObjectPool<int>>());
+    }
+    for (int round = 0; round < 2000; ++round)
+    {
+        for (auto& pool : pools)
+        {
+            pool->destroy(pool->create(round));
+        }
+    }
+    for (const auto& pool : pools)
+    {
+        EXPECT_EQ(pool->capacity(), trlc::threadsafe::ObjectPool<int>::Settings{}.chunk_size);
+    }
+}
+
+/**
+ * @brief Test that short-lived threads hand their caches back when they exit.
+ */
+TEST(ObjectPoolTest, ExitedThreadsReturnBlocks)
+{
+    trlc::threadsafe::ObjectPool<int> pool;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::thread worker([&pool, i]()
+                           { pool.destroy(pool.create(i)); });
+        worker.join();
+    }
+    EXPECT_EQ(pool.capacity(), trlc::threadsafe::ObjectPool<int>::Settings{}.chunk_size);
+}
+
+/**
+ * @brief Test that a thread exiting after its pool was destroyed leaves the pool alone.
+ */
+TEST(ObjectPoolTest, ThreadOutlivesPool)
+{
+    auto pool{std::make_unique<trlc::threadsafe::ObjectPool<int>>()};
+    std::atomic<bool> used{false};
+    std::atomic<bool> destroyed{false};
+    std::thread worker([&]()
+                       {
+        pool->destroy(pool->create(1));
+        used = true;
+        while (!destroyed.load())
+        {
+            std::this_thread::yield();
+        } });
+    while (!used.load())
+    {
+        std::this_thread::yield();
+    }
+    pool.reset();
+    destroyed = true;
+    worker.join();
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
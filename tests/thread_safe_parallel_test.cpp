@@ -0,0 +1,245 @@
+#include "trlc/threadsafe/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <gtest/gtest.h>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using ThreadPool = trlc::threadsafe::ThreadPool;
+
+namespace
+{
+
+ThreadPool::Settings poolSettings(const std::size_t size)
+{
+    ThreadPool::Settings settings;
+    settings.size = size;
+    return settings;
+}
+
+} // namespace
+
+/**
+ * @brief Test that parallelFor visits every index exactly once, with automatic and explicit grain sizes.
+ */
+TEST(ParallelTest, ParallelForVisitsEachIndexOnce)
+{
+    constexpr int COUNT{100000};
+    ThreadPool pool(poolSettings(4));
+    for (const std::size_t grain : {trlc::threadsafe::AUTO_GRAIN, std::size_t{1}, std::size_t{7}, std::size_t{COUNT}})
+    {
+        std::vector<std::atomic<int>> seen(COUNT);
+        trlc::threadsafe::parallelFor(
+            pool, 0, COUNT, [&seen](const int index)
+            { seen[index].fetch_add(1, std::memory_order_relaxed); },
+            grain);
+        for (const auto& count : seen)
+        {
+            ASSERT_EQ(count.load(), 1);
+        }
+    }
+}
+
+/**
+ * @brief Test that parallelFor handles empty, reversed and offset ranges.
+ */
+TEST(ParallelTest, ParallelForRanges)
+{
+    ThreadPool pool(poolSettings(2));
+    std::atomic<int> calls{0};
+    trlc::threadsafe::parallelFor(pool, 5, 5, [&calls](int)
+                                  { calls.fetch_add(1); });
+    trlc::threadsafe::parallelFor(pool, 5, -5, [&calls](int)
+                                  { calls.fetch_add(1); });
+    ASSERT_EQ(calls.load(), 0);
+
+    std::atomic<int64_t> sum{0};
+    trlc::threadsafe::parallelFor(
+        pool, int64_t{-1000}, int64_t{1002}, [&sum](const int64_t index)
+        { sum.fetch_add(index); },
+        3);
+    ASSERT_EQ(sum.load(), 1001);
+}
+
+/**
+ * @brief Test that the caller participates, so that a pool of one worker and nested calls do not deadlock.
+ */
+TEST(ParallelTest, NestedParallelFor)
+{
+    constexpr int OUTER{16};
+    constexpr int INNER{1000};
+    ThreadPool pool(poolSettings(1));
+    std::atomic<int> count{0};
+    std::atomic<bool> caller_ran{false};
+    const std::thread::id caller{std::this_thread::get_id()};
+    trlc::threadsafe::parallelFor(
+        pool, 0, OUTER, [&](int)
+        {
+            if (std::this_thread::get_id() == caller)
+            {
+                caller_ran.store(true);
+            }
+            trlc::threadsafe::parallelFor(
+                pool, 0, INNER, [&count](int)
+                { count.fetch_add(1, std::memory_order_relaxed); },
+                10); },
+        1);
+    ASSERT_EQ(count.load(), OUTER * INNER);
+    ASSERT_TRUE(caller_ran.load());
+}
+
+/**
+ * @brief Test that parallelReduce matches a sequential reduction and keeps the order of the elements.
+ */
+TEST(ParallelTest, ParallelReduce)
+{
+    ThreadPool pool(poolSettings(4));
+    std::vector<int> values(1000000);
+    std::iota(values.begin(), values.end(), 0);
+    const int64_t sum{trlc::threadsafe::parallelReduce(pool, values.begin(), values.end(), int64_t{0}, std::plus<>{})};
+    ASSERT_EQ(sum, int64_t{999999} * 1000000 / 2);
+    ASSERT_EQ(trlc::threadsafe::parallelReduce(pool, values.begin(), values.begin(), int64_t{42}, std::plus<>{}), 42);
+
+    // Concatenation is associative but not commutative.
+    std::vector<std::string> letters;
+    for (int i = 0; i < 500; ++i)
+    {
+        letters.emplace_back(1, static_cast<char>('a' + i % 26));
+    }
+    const std::string expected{std::accumulate(letters.begin(), letters.end(), std::string{">"})};
+    const std::string joined{trlc::threadsafe::parallelReduce(pool, letters.begin(), letters.end(), std::string{">"}, std::plus<>{}, 3)};
+    ASSERT_EQ(joined, expected);
+}
+
+/**
+ * @brief Test that parallelTransform writes every result in place, also into its own input.
+ */
+TEST(ParallelTest, ParallelTransform)
+{
+    ThreadPool pool(poolSettings(4));
+    std::vector<int> values(100003);
+    std::iota(values.begin(), values.end(), 0);
+    std::vector<int64_t> squares(values.size());
+    const auto end{trlc::threadsafe::parallelTransform(pool, values.begin(), values.end(), squares.begin(), [](const int value)
+                                                       { return int64_t{value} * value; })};
+    ASSERT_EQ(end, squares.end());
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        ASSERT_EQ(squares[i], int64_t{values[i]} * values[i]);
+    }
+
+    trlc::threadsafe::parallelTransform(
+        pool, values.begin(), values.end(), values.begin(), [](const int value)
+        { return -value; },
+        100);
+    ASSERT_EQ(values[100002], -100002);
+}
+
+/**
+ * @brief Test that parallelSort sorts random, duplicated, presorted and reversed input.
+ */
+TEST(ParallelTest, ParallelSort)
+{
+    ThreadPool pool(poolSettings(4));
+    std::mt19937 random{12345};
+
+    std::vector<uint32_t> values(500000);
+    for (auto& value : values)
+    {
+        value = random();
+    }
+    std::vector<uint32_t> expected{values};
+    std::sort(expected.begin(), expected.end());
+    trlc::threadsafe::parallelSort(pool, values.begin(), values.end());
+    ASSERT_EQ(values, expected);
+
+    // Already sorted, and then reversed with a custom ordering.
+    trlc::threadsafe::parallelSort(pool, values.begin(), values.end());
+    ASSERT_EQ(values, expected);
+    trlc::threadsafe::parallelSort(pool, values.begin(), values.end(), std::greater<>{});
+    ASSERT_TRUE(std::is_sorted(values.begin(), values.end(), std::greater<>{}));
+
+    // Few distinct keys and a small grain, so that many partitions are made of equal elements.
+    std::vector<int> keys(200000);
+    for (auto& key : keys)
+    {
+        key = static_cast<int>(random() % 4);
+    }
+    std::vector<int> sorted_keys{keys};
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    trlc::threadsafe::parallelSort(pool, keys.begin(), keys.end(), std::less<>{}, 16);
+    ASSERT_EQ(keys, sorted_keys);
+}
+
+/**
+ * @brief Test that parallelSort sorts move-only elements.
+ */
+TEST(ParallelTest, ParallelSortMoveOnly)
+{
+    ThreadPool pool(poolSettings(2));
+    std::vector<std::unique_ptr<int>> values;
+    for (int i = 0; i < 20000; ++i)
+    {
+        values.push_back(std::make_unique<int>((i * 7919) % 20000));
+    }
+    trlc::threadsafe::parallelSort(
+        pool, values.begin(), values.end(), [](const std::unique_ptr<int>& lhs, const std::unique_ptr<int>& rhs)
+        { return *lhs < *rhs; },
+        64);
+    for (int i = 0; i < 20000; ++i)
+    {
+        ASSERT_EQ(*values[i], i);
+    }
+}
+
+/**
+ * @brief Test that the first exception of a chunk, on the pool or on the caller, is rethrown after every chunk is done.
+ */
+TEST(ParallelTest, ParallelForRethrows)
+{
+    constexpr int COUNT{1000};
+    ThreadPool pool(poolSettings(2));
+    for (const int failing : {0, COUNT - 1})
+    {
+        std::atomic<int> visited{0};
+        ASSERT_THROW(trlc::threadsafe::parallelFor(
+                         pool, 0, COUNT, [&visited, failing](const int index)
+                         {
+                if (index == failing)
+                {
+                    throw std::runtime_error("chunk failed");
+                }
+                visited.fetch_add(1); },
+                         1),
+                     std::runtime_error);
+        ASSERT_EQ(visited.load(), COUNT - 1); // Every other chunk ran before the rethrow.
+    }
+
+    std::vector<int> values(10000);
+    std::iota(values.begin(), values.end(), 0);
+    ASSERT_THROW(trlc::threadsafe::parallelSort(
+                     pool, values.begin(), values.end(), [](const int a, const int b)
+                     {
+            if (a == 5000 || b == 5000)
+            {
+                throw std::invalid_argument("comparison failed");
+            }
+            return a < b; },
+                     16),
+                 std::invalid_argument);
+    pool.waitIdle();
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,230 @@
+#include "trlc/threadsafe/pipeline.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using trlc::threadsafe::Pipeline;
+using trlc::threadsafe::PipelineStageStats;
+
+/**
+ * @brief Test that every element goes through every stage, with a change of type, and is counted.
+ */
+TEST(PipelineTest, ProcessesEveryElement)
+{
+    constexpr int COUNT{10000};
+    constexpr int BATCH{100};
+    std::atomic<long> sum{0};
+    std::atomic<int> count{0};
+    Pipeline<int> pipeline{Pipeline<int>::Settings{}};
+
+    auto strings{pipeline.stage("double", 2, [](int value) -> long
+                                { return 2L * value; })
+                     .stage("format", 1, [](long value) -> std::string
+                            { return std::to_string(value); })};
+    ASSERT_TRUE(strings.valid());
+    ASSERT_TRUE(strings.sink("parse", 3, [&](std::string&& text)
+                             {
+        sum.fetch_add(std::stol(text));
+        count.fetch_add(1); }));
+    ASSERT_TRUE(pipeline.start());
+
+    for (int first = 1; first <= COUNT; first += BATCH)
+    {
+        Pipeline<int>::Batch batch{};
+        for (int value = first; value < first + BATCH; ++value)
+        {
+            batch.push_back(value);
+        }
+        ASSERT_TRUE(pipeline.push(std::move(batch)));
+    }
+    pipeline.close();
+    pipeline.wait();
+
+    EXPECT_EQ(count.load(), COUNT);
+    EXPECT_EQ(sum.load(), static_cast<long>(COUNT) * (COUNT + 1));
+
+    const std::vector<PipelineStageStats> stats{pipeline.stats()};
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[0].name, "double");
+    EXPECT_EQ(stats[0].parallelism, 2u);
+    for (const PipelineStageStats& stage : stats)
+    {
+        EXPECT_EQ(stage.items, static_cast<uint64_t>(COUNT));
+        EXPECT_EQ(stage.batches, static_cast<uint64_t>(COUNT / BATCH));
+        EXPECT_EQ(stage.queued, 0u);
+        EXPECT_GE(stage.max_queued, 1u);
+        EXPECT_GT(stage.items_per_second, 0.0);
+        EXPECT_GE(stage.utilization, 0.0);
+        EXPECT_LE(stage.utilization, 1.0);
+    }
+}
+
+/**
+ * @brief Test that the queue type follows the parallelism on both sides of each link.
+ */
+TEST(PipelineTest, QueueSelection)
+{
+    Pipeline<int> pipeline{Pipeline<int>::Settings{}};
+    auto identity{[](int value) -> int
+                  { return value; }};
+    ASSERT_TRUE(pipeline.stage("a", 1, identity)
+                    .stage("b", 1, identity)
+                    .stage("c", 2, identity)
+                    .sink("d", 1, [](int) {}));
+
+    const std::vector<PipelineStageStats> stats{pipeline.stats()};
+    ASSERT_EQ(stats.size(), 4u);
+    EXPECT_FALSE(stats[0].spsc); // Fed by any thread.
+    EXPECT_TRUE(stats[1].spsc);
+    EXPECT_FALSE(stats[2].spsc);
+    EXPECT_FALSE(stats[3].spsc);
+}
+
+/**
+ * @brief Test that the declaration order is enforced: one stage per link, a sink to start, no change once started.
+ */
+TEST(PipelineTest, Declaration)
+{
+    Pipeline<int> pipeline{Pipeline<int>::Settings{}};
+    EXPECT_FALSE(pipeline.start());
+    EXPECT_FALSE(pipeline.push(1));
+
+    auto link{pipeline.stage("a", 1, [](int value) -> int
+                             { return value; })};
+    EXPECT_FALSE(pipeline.stage("again", 1, [](int value) -> int
+                                { return value; })
+                     .valid());
+    EXPECT_FALSE(pipeline.start());
+    ASSERT_TRUE(link.sink("b", 1, [](int) {}));
+    EXPECT_FALSE(link.sink("b", 1, [](int) {}));
+    EXPECT_TRUE(pipeline.start());
+    EXPECT_FALSE(pipeline.start());
+    EXPECT_FALSE(pipeline.push(Pipeline<int>::Batch{}));
+    EXPECT_TRUE(pipeline.push(1));
+    pipeline.close();
+    pipeline.wait();
+    EXPECT_FALSE(pipeline.push(2));
+}
+
+/**
+ * @brief Test that a slow stage blocks the producer once the queues in front of it are full.
+ */
+TEST(PipelineTest, Backpressure)
+{
+    Pipeline<int>::Settings settings;
+    settings.capacity = 2;
+    std::atomic<bool> release{false};
+    std::atomic<int> consumed{0};
+    Pipeline<int> pipeline{settings};
+    ASSERT_TRUE(pipeline.sink("slow", 1, [&](int)
+                              {
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        }
+        consumed.fetch_add(1); }));
+    ASSERT_TRUE(pipeline.start());
+
+    std::atomic<int> pushed{0};
+    std::thread producer{[&]()
+                         {
+                             for (int i = 0; i < 10; ++i)
+                             {
+                                 pipeline.push(i);
+                                 pushed.fetch_add(1);
+                             }
+                         }};
+    // One batch held by the worker, two in the queue and the producer blocked on the fourth, counted as queued.
+    const auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{5}};
+    while ((pushed.load() < 3 || pipeline.stats()[0].queued < 3u) && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_EQ(pushed.load(), 3);
+    EXPECT_EQ(pipeline.stats()[0].queued, 3u);
+
+    release.store(true);
+    producer.join();
+    pipeline.close();
+    pipeline.wait();
+    EXPECT_EQ(consumed.load(), 10);
+}
+
+/**
+ * @brief Test that stop wakes blocked producers and workers and drops the queued batches.
+ */
+TEST(PipelineTest, Stop)
+{
+    Pipeline<int>::Settings settings;
+    settings.capacity = 1;
+    std::atomic<bool> release{false};
+    std::atomic<int> consumed{0};
+    Pipeline<int> pipeline{settings};
+    ASSERT_TRUE(pipeline.stage("forward", 1, [](int value) -> int
+                               { return value; })
+                    .sink("slow", 1, [&](int)
+                          {
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        }
+        consumed.fetch_add(1); }));
+    ASSERT_TRUE(pipeline.start());
+
+    std::atomic<bool> rejected{false};
+    std::thread producer{[&]()
+                         {
+                             for (int i = 0; i < 100; ++i)
+                             {
+                                 if (!pipeline.push(i))
+                                 {
+                                     rejected.store(true);
+                                     return;
+                                 }
+                             }
+                         }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    std::thread stopper{[&]()
+                        { pipeline.stop(); }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    release.store(true);
+    stopper.join();
+    producer.join();
+    EXPECT_TRUE(rejected.load());
+    EXPECT_LT(consumed.load(), 100);
+}
+
+/**
+ * @brief Test that each worker calls its own copy of a stateful function.
+ */
+TEST(PipelineTest, WorkerOwnsFunction)
+{
+    constexpr int COUNT{1000};
+    struct Counter
+    {
+        int total{0};
+
+        int operator()(int value)
+        {
+            return total += value;
+        }
+    };
+    std::atomic<int> last{0};
+    Pipeline<int> pipeline{Pipeline<int>::Settings{}};
+    ASSERT_TRUE(pipeline.stage("count", 1, Counter{})
+                    .sink("keep", 1, [&](int total)
+                          { last.store(total); }));
+    ASSERT_TRUE(pipeline.start());
+    for (int i = 1; i <= COUNT; ++i)
+    {
+        ASSERT_TRUE(pipeline.push(1));
+    }
+    pipeline.close();
+    pipeline.wait();
+    EXPECT_EQ(last.load(), COUNT);
+}
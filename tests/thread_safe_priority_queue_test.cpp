@@ -0,0 +1,139 @@
+#include "trlc/threadsafe/priority_queue.hpp"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using PriorityQueue = trlc::threadsafe::PriorityQueue<int, 4>;
+
+/**
+ * @brief Test that elements pop by priority and in push order within a priority.
+ */
+TEST(PriorityQueueTest, PopsByPriority)
+{
+    PriorityQueue::Settings settings;
+    PriorityQueue queue(settings);
+
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value, 10));
+
+    ASSERT_TRUE(queue.push(1, 0));
+    ASSERT_TRUE(queue.push(2, 2));
+    ASSERT_TRUE(queue.push(3, 0));
+    ASSERT_TRUE(queue.push(4, 100)); // Clamped to the highest priority.
+    ASSERT_TRUE(queue.emplace(2, 5));
+
+    std::vector<int> order;
+    while (std::optional<int> elem = queue.tryPop())
+    {
+        order.push_back(*elem);
+    }
+    EXPECT_EQ(order, (std::vector<int>{4, 2, 5, 1, 3}));
+}
+
+/**
+ * @brief Test that DISCARD_OLDEST drops the oldest element of the lowest priority.
+ */
+TEST(PriorityQueueTest, DiscardLowestPriority)
+{
+    PriorityQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = PriorityQueue::Discard::DISCARD_OLDEST;
+
+    PriorityQueue queue(settings);
+    std::vector<int> discarded;
+    queue.setDiscardedCallback([&discarded](const int& elem)
+                               { discarded.push_back(elem); });
+
+    ASSERT_TRUE(queue.push(10, 1));
+    ASSERT_TRUE(queue.push(20, 3));
+    ASSERT_TRUE(queue.push(30, 2));  // Replaces 10, the lowest priority.
+    ASSERT_FALSE(queue.push(40, 0)); // Below every queued element, discarded itself.
+    EXPECT_EQ(discarded, (std::vector<int>{10, 40}));
+
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    EXPECT_EQ(popped_value, 20);
+    ASSERT_TRUE(queue.pop(popped_value));
+    EXPECT_EQ(popped_value, 30);
+}
+
+/**
+ * @brief Test that a full queue blocks producers until a consumer pops, and DISCARD_NEWEST rejects.
+ */
+TEST(PriorityQueueTest, BoundedSize)
+{
+    PriorityQueue::Settings settings;
+    settings.size = 1;
+    PriorityQueue queue(settings);
+    ASSERT_TRUE(queue.push(1, 1));
+    ASSERT_FALSE(queue.push(2, 3, 20));
+
+    std::thread consumer([&queue]()
+                         {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        int popped_value;
+        queue.pop(popped_value); });
+    ASSERT_TRUE(queue.push(3, 0, 1000));
+    consumer.join();
+
+    settings.discard = PriorityQueue::Discard::DISCARD_NEWEST;
+    PriorityQueue newest(settings);
+    ASSERT_TRUE(newest.push(1, 0));
+    ASSERT_FALSE(newest.push(2, 3));
+}
+
+/**
+ * @brief Test that Control gates push and pop and wakes waitPushOpen and waitPopOpen callers.
+ */
+TEST(PriorityQueueTest, Control)
+{
+    PriorityQueue::Settings settings;
+    settings.control = PriorityQueue::Control::FULL_CONTROL;
+    PriorityQueue queue(settings);
+
+    ASSERT_FALSE(queue.push(1, 0));
+    ASSERT_FALSE(queue.waitPushOpen(10));
+    std::thread opener([&queue]()
+                       {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.openPush();
+        queue.openPop(); });
+    ASSERT_TRUE(queue.waitPushOpen(1000));
+    ASSERT_TRUE(queue.waitPopOpen(1000));
+    opener.join();
+
+    ASSERT_TRUE(queue.push(1, 0));
+    queue.closePop();
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value, 10));
+    ASSERT_FALSE(queue.tryPop().has_value());
+}
+
+/**
+ * @brief Test that urgent elements overtake queued bulk elements for a blocked consumer.
+ */
+TEST(PriorityQueueTest, UrgentOvertakesBulk)
+{
+    trlc::threadsafe::PriorityQueue<std::unique_ptr<int>>::Settings settings;
+    trlc::threadsafe::PriorityQueue<std::unique_ptr<int>> queue(settings);
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_TRUE(queue.push(std::make_unique<int>(i), 0));
+    }
+    ASSERT_TRUE(queue.push(std::make_unique<int>(-1), trlc::threadsafe::PriorityQueue<std::unique_ptr<int>>::HIGHEST_PRIORITY));
+    std::unique_ptr<int> popped;
+    ASSERT_TRUE(queue.pop(popped));
+    EXPECT_EQ(*popped, -1);
+    ASSERT_TRUE(queue.pop(popped));
+    EXPECT_EQ(*popped, 0);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,171 @@
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/queue_stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using StatsQueue = trlc::threadsafe::Queue<int, std::allocator<int>, trlc::threadsafe::QueueStats>;
+using Snapshot = trlc::threadsafe::QueueStatsSnapshot;
+
+/**
+ * @brief Test the push, pop, discard and high-water mark counters.
+ */
+TEST(QueueStatsTest, Counters)
+{
+    StatsQueue::Settings settings;
+    settings.size = 3;
+    settings.discard = StatsQueue::Discard::DISCARD_OLDEST;
+    StatsQueue queue(settings);
+
+    for (int value = 0; value < 5; ++value)
+    {
+        ASSERT_TRUE(queue.push(value));
+    }
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 2);
+    ASSERT_TRUE(queue.tryPop().has_value());
+
+    Snapshot snapshot{queue.stats().snapshot()};
+    EXPECT_EQ(snapshot.pushed, 5u);
+    EXPECT_EQ(snapshot.popped, 2u);
+    EXPECT_EQ(snapshot.discarded_oldest, 2u);
+    EXPECT_EQ(snapshot.discarded_newest, 0u);
+    EXPECT_EQ(snapshot.high_water_mark, 3u);
+    EXPECT_EQ(snapshot.latency.count(), 2u);
+
+    queue.stats().reset();
+    snapshot = queue.stats().snapshot();
+    EXPECT_EQ(snapshot.pushed, 0u);
+    EXPECT_EQ(snapshot.latency.count(), 0u);
+}
+
+/**
+ * @brief Test that bulk operations keep the counters and the element timestamps in step.
+ */
+TEST(QueueStatsTest, BulkOperations)
+{
+    StatsQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = StatsQueue::Discard::DISCARD_OLDEST;
+    StatsQueue queue(settings);
+
+    const std::vector<int> input{1, 2, 3, 4, 5};
+    ASSERT_EQ(queue.pushBulk(input.begin(), input.end()), 5u);
+    std::vector<int> output;
+    ASSERT_EQ(queue.drainTo(output), 2u);
+
+    Snapshot snapshot{queue.stats().snapshot()};
+    EXPECT_EQ(snapshot.pushed, 5u);
+    EXPECT_EQ(snapshot.discarded_oldest, 3u);
+    EXPECT_EQ(snapshot.popped, 2u);
+    EXPECT_EQ(snapshot.latency.count(), 2u);
+
+    StatsQueue::Settings newest_settings;
+    newest_settings.size = 2;
+    newest_settings.discard = StatsQueue::Discard::DISCARD_NEWEST;
+    StatsQueue newest_queue(newest_settings);
+    ASSERT_EQ(newest_queue.pushBulk(input.begin(), input.end()), 2u);
+    ASSERT_FALSE(newest_queue.push(6));
+    EXPECT_EQ(newest_queue.stats().snapshot().discarded_newest, 4u);
+}
+
+/**
+ * @brief Test the time spent blocked and the enqueue-to-dequeue latency.
+ */
+TEST(QueueStatsTest, BlockedTimeAndLatency)
+{
+    StatsQueue::Settings settings;
+    settings.size = 1;
+    StatsQueue queue(settings);
+
+    // Each side starts its 50 ms delay once the other is about to block, the bounds leave room for the
+    // time it takes to actually get into the wait.
+    std::atomic<bool> popping{false};
+    std::atomic<bool> pushing{false};
+    std::thread producer([&]()
+                         {
+        while (!popping.load())
+        {
+            std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ASSERT_TRUE(queue.push(1));
+        ASSERT_TRUE(queue.push(2));
+        pushing.store(true);
+        ASSERT_TRUE(queue.push(3)); }); // Blocks until the consumer pops again.
+
+    int popped_value;
+    popping.store(true);
+    ASSERT_TRUE(queue.pop(popped_value));
+    while (!pushing.load())
+    {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_TRUE(queue.pop(popped_value));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(queue.pop(popped_value));
+    producer.join();
+
+    const Snapshot snapshot{queue.stats().snapshot()};
+    EXPECT_GE(snapshot.blocked_pops, 1u);
+    EXPECT_GE(snapshot.pop_blocked_time, std::chrono::milliseconds(10));
+    EXPECT_GE(snapshot.blocked_pushes, 1u);
+    EXPECT_GE(snapshot.push_blocked_time, std::chrono::milliseconds(10));
+    EXPECT_EQ(snapshot.latency.count(), 3u);
+    EXPECT_GE(snapshot.latency.percentile(1.0), std::chrono::milliseconds(5));
+}
+
+/**
+ * @brief Test the buckets and percentiles of a duration histogram.
+ */
+TEST(QueueStatsTest, HistogramPercentile)
+{
+    trlc::threadsafe::DurationHistogram histogram;
+    EXPECT_EQ(histogram.snapshot().percentile(0.5), std::chrono::nanoseconds::zero());
+
+    for (int count = 0; count < 90; ++count)
+    {
+        histogram.record(std::chrono::nanoseconds(12)); // [8, 16) ns
+    }
+    for (int count = 0; count < 10; ++count)
+    {
+        histogram.record(std::chrono::microseconds(1)); // [512, 1024) ns
+    }
+    const trlc::threadsafe::DurationHistogramSnapshot snapshot{histogram.snapshot()};
+    EXPECT_EQ(snapshot.buckets[3], 90u);
+    EXPECT_EQ(snapshot.buckets[9], 10u);
+    EXPECT_EQ(snapshot.count(), 100u);
+    EXPECT_EQ(snapshot.percentile(0.5), std::chrono::nanoseconds(15));
+    EXPECT_EQ(snapshot.percentile(0.9), std::chrono::nanoseconds(15));
+    EXPECT_EQ(snapshot.percentile(0.99), std::chrono::nanoseconds(1023));
+
+    histogram.record(std::chrono::hours(1000)); // Clamped to the last bucket.
+    EXPECT_EQ(histogram.snapshot().buckets[trlc::threadsafe::DurationHistogramSnapshot::BUCKETS - 1], 1u);
+}
+
+/**
+ * @brief Test that the default policy records nothing and adds no state.
+ */
+TEST(QueueStatsTest, DisabledByDefault)
+{
+    static_assert(std::is_empty_v<trlc::threadsafe::NoQueueStats>);
+    static_assert(std::is_same_v<trlc::threadsafe::Queue<int>, trlc::threadsafe::Queue<int, std::allocator<int>, trlc::threadsafe::NoQueueStats>>);
+
+    trlc::threadsafe::Queue<int>::Settings settings;
+    trlc::threadsafe::Queue<int> queue(settings);
+    ASSERT_TRUE(queue.push(1));
+    EXPECT_EQ(queue.stats().snapshot().pushed, 0u);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -2,7 +2,11 @@
 
 #include <chrono>
 #include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <string>
 #include <thread>
+#include <vector>
 
 using Queue = trlc::threadsafe::Queue<int>;
 
@@ -156,6 +160,65 @@ TEST(QueueTest, ConcurrentPushPop)
     consumer.join();
 }
 
+/**
+ * @brief Test that every element wakes a consumer when several consumers are blocked.
+ */
+TEST(QueueTest, WakesEveryBlockedConsumer)
+{
+    constexpr int CONSUMERS{4};
+    Queue::Settings settings;
+    Queue queue(settings);
+
+    std::atomic<int> popped{0};
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < CONSUMERS; ++i)
+    {
+        consumers.emplace_back([&]()
+                               {
+            int popped_value;
+            ASSERT_TRUE(queue.pop(popped_value, 2000));
+            popped.fetch_add(1); });
+    }
+    sleep_ms(50); // Let every consumer block on the empty queue.
+
+    for (int i = 0; i < CONSUMERS; ++i)
+    {
+        ASSERT_TRUE(queue.push(i));
+    }
+    for (auto& consumer : consumers)
+    {
+        consumer.join();
+    }
+    ASSERT_EQ(popped.load(), CONSUMERS);
+}
+
+/**
+ * @brief Test for concurrent push and pop with the adaptive wait strategy on a small queue.
+ */
+TEST(QueueTest, AdaptiveWaitStrategy)
+{
+    constexpr int COUNT{10000};
+    Queue::Settings settings;
+    settings.size = 4;
+    settings.wait_strategy = trlc::threadsafe::Wait::Strategy::ADAPTIVE;
+    Queue queue(settings);
+
+    std::thread producer([&]()
+                         {
+        for (int i = 0; i < COUNT; ++i) {
+            ASSERT_TRUE(queue.push(i));
+        } });
+
+    int popped_value;
+    for (int i = 0; i < COUNT; ++i)
+    {
+        ASSERT_TRUE(queue.pop(popped_value));
+        ASSERT_EQ(popped_value, i);
+    }
+    producer.join();
+    ASSERT_FALSE(queue.pop(popped_value, 10)); // Timeouts still apply after spinning.
+}
+
 /**
  * @brief Test for push timeout.
  */
@@ -261,6 +324,232 @@ TEST(QueueTest, WaitOpenTest)
     ASSERT_TRUE(queue.waitPopOpen(100)); // Now it should succeed.
 }
 
+/**
+ * @brief Test for push, pop and wait open with chrono durations and deadlines.
+ */
+TEST(QueueTest, ChronoTimeouts)
+{
+    Queue::Settings settings;
+    settings.size = 1;
+    settings.control = Queue::Control::FULL_CONTROL;
+    Queue queue(settings);
+    queue.openPush();
+    queue.openPop();
+
+    int popped_value;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_FALSE(queue.pop(popped_value, std::chrono::microseconds(300))); // Empty, times out.
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(300));
+    ASSERT_FALSE(queue.pop(popped_value, std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+
+    const int value = 1;
+    ASSERT_TRUE(queue.push(value, std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.push(2, std::chrono::microseconds(300))); // Full, times out.
+    ASSERT_FALSE(queue.push(value, std::chrono::system_clock::now() + std::chrono::microseconds(300)));
+    ASSERT_TRUE(queue.pop(popped_value, std::chrono::steady_clock::time_point::max()));
+    ASSERT_EQ(popped_value, 1);
+    ASSERT_TRUE(queue.push(3, std::chrono::steady_clock::now()));
+    ASSERT_TRUE(queue.pop(popped_value, std::chrono::nanoseconds::zero()));
+    ASSERT_EQ(popped_value, 3);
+
+    queue.closePush();
+    ASSERT_FALSE(queue.waitPushOpen(std::chrono::microseconds(300)));
+    queue.openPush();
+    ASSERT_TRUE(queue.waitPushOpen(std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+    queue.closePop();
+    ASSERT_FALSE(queue.waitPopOpen(std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+    queue.openPop();
+    ASSERT_TRUE(queue.waitPopOpen(std::chrono::microseconds(300)));
+}
+
+/**
+ * @brief Test that a pop without deadline, by duration or time point, blocks until a push.
+ */
+TEST(QueueTest, ChronoWaitForever)
+{
+    Queue::Settings settings;
+    Queue queue(settings);
+
+    std::thread producer([&]()
+                         {
+        sleep_ms(100);
+        ASSERT_TRUE(queue.push(42, std::chrono::hours::max()));
+        sleep_ms(100);
+        ASSERT_TRUE(queue.push(43)); });
+
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value, std::chrono::nanoseconds::max()));
+    ASSERT_EQ(popped_value, 42);
+    ASSERT_TRUE(queue.pop(popped_value, std::chrono::system_clock::time_point::max()));
+    ASSERT_EQ(popped_value, 43);
+
+    producer.join();
+}
+
+/**
+ * @brief Test for pushing and popping a range of elements at once.
+ */
+TEST(QueueTest, BulkPushPop)
+{
+    Queue::Settings settings;
+    Queue queue(settings);
+
+    std::vector<int> input{1, 2, 3, 4, 5};
+    ASSERT_EQ(queue.pushBulk(input.begin(), input.end()), 5u);
+
+    std::vector<int> output;
+    ASSERT_EQ(queue.popBulk(std::back_inserter(output), 3), 3u); // Pop at most 3 elements.
+    ASSERT_EQ(output, (std::vector<int>{1, 2, 3}));
+
+    ASSERT_EQ(queue.popBulk(std::back_inserter(output), 10), 2u); // Only 2 elements are left.
+    ASSERT_EQ(output, (std::vector<int>{1, 2, 3, 4, 5}));
+
+    ASSERT_EQ(queue.popBulk(std::back_inserter(output), 10, 50), 0u); // Empty queue times out.
+}
+
+/**
+ * @brief Test for bulk push with the discard policies.
+ */
+TEST(QueueTest, BulkPushDiscard)
+{
+    std::vector<int> input{1, 2, 3, 4, 5};
+    std::vector<int> discarded;
+    std::vector<int> output;
+
+    Queue::Settings settings;
+    settings.size = 3;
+    settings.discard = Queue::Discard::DISCARD_OLDEST;
+    Queue oldest(settings);
+    oldest.setDiscardedCallback([&discarded](const int& elem)
+                                { discarded.push_back(elem); });
+    ASSERT_EQ(oldest.pushBulk(input.begin(), input.end()), 5u);
+    ASSERT_EQ(discarded, (std::vector<int>{1, 2}));
+    ASSERT_EQ(oldest.drainTo(output), 3u);
+    ASSERT_EQ(output, (std::vector<int>{3, 4, 5}));
+
+    discarded.clear();
+    output.clear();
+    settings.discard = Queue::Discard::DISCARD_NEWEST;
+    Queue newest(settings);
+    newest.setDiscardedCallback([&discarded](const int& elem)
+                                { discarded.push_back(elem); });
+    ASSERT_EQ(newest.pushBulk(input.begin(), input.end()), 3u);
+    ASSERT_EQ(discarded, (std::vector<int>{4, 5}));
+    ASSERT_EQ(newest.drainTo(output), 3u);
+    ASSERT_EQ(output, (std::vector<int>{1, 2, 3}));
+
+    settings.discard = Queue::Discard::NO_DISCARD;
+    Queue no_discard(settings);
+    ASSERT_EQ(no_discard.pushBulk(input.begin(), input.end(), 50), 3u); // Times out once full.
+}
+
+/**
+ * @brief Test that a blocked bulk push completes once a consumer makes room.
+ */
+TEST(QueueTest, BulkPushWaitsForRoom)
+{
+    Queue::Settings settings;
+    settings.size = 2;
+    Queue queue(settings);
+
+    std::thread consumer([&]()
+                         {
+        std::vector<int> output;
+        while (output.size() < 6) {
+            sleep_ms(10);
+            queue.popBulk(std::back_inserter(output), 6 - output.size(), 100);
+        }
+        ASSERT_EQ(output, (std::vector<int>{1, 2, 3, 4, 5, 6})); });
+
+    std::vector<int> input{1, 2, 3, 4, 5, 6};
+    ASSERT_EQ(queue.pushBulk(input.begin(), input.end()), 6u);
+    consumer.join();
+}
+
+/**
+ * @brief Test that draining a closed queue does nothing.
+ */
+TEST(QueueTest, DrainClosedQueue)
+{
+    Queue::Settings settings;
+    settings.control = Queue::Control::POP;
+    Queue queue(settings);
+
+    ASSERT_TRUE(queue.push(1));
+    std::vector<int> output;
+    ASSERT_EQ(queue.drainTo(output), 0u); // Pop is not open yet.
+    queue.openPop();
+    ASSERT_EQ(queue.drainTo(output), 1u);
+}
+
+/**
+ * @brief Test for pushing and popping move-only elements.
+ */
+TEST(QueueTest, MoveOnlyElements)
+{
+    using PtrQueue = trlc::threadsafe::Queue<std::unique_ptr<int>>;
+    PtrQueue::Settings settings;
+    settings.size = 2;
+    PtrQueue queue(settings);
+
+    ASSERT_TRUE(queue.push(std::make_unique<int>(1)));
+    ASSERT_TRUE(queue.emplace(new int(2)));
+
+    std::unique_ptr<int> popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(*popped_value, 1);
+
+    std::optional<std::unique_ptr<int>> tried{queue.tryPop()};
+    ASSERT_TRUE(tried.has_value());
+    ASSERT_EQ(**tried, 2);
+    ASSERT_FALSE(queue.tryPop().has_value()); // Queue is empty.
+}
+
+/**
+ * @brief Test that the discard-oldest path hands the moved-out element to the callback.
+ */
+TEST(QueueTest, MoveOnlyDiscardOldest)
+{
+    using PtrQueue = trlc::threadsafe::Queue<std::unique_ptr<int>>;
+    PtrQueue::Settings settings;
+    settings.size = 1;
+    settings.discard = PtrQueue::Discard::DISCARD_OLDEST;
+    PtrQueue queue(settings);
+
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const std::unique_ptr<int>& elem)
+                               { discarded = *elem; });
+
+    ASSERT_TRUE(queue.push(std::make_unique<int>(1)));
+    ASSERT_TRUE(queue.push(std::make_unique<int>(2))); // This will discard 1.
+    ASSERT_EQ(discarded, 1);
+
+    std::unique_ptr<int> popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(*popped_value, 2);
+}
+
+/**
+ * @brief Test that emplace with DISCARD_NEWEST constructs the discarded element for the callback.
+ */
+TEST(QueueTest, EmplaceDiscardNewest)
+{
+    using StringQueue = trlc::threadsafe::Queue<std::string>;
+    StringQueue::Settings settings;
+    settings.size = 1;
+    settings.discard = StringQueue::Discard::DISCARD_NEWEST;
+    StringQueue queue(settings);
+
+    std::string discarded;
+    queue.setDiscardedCallback([&discarded](const std::string& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.emplace(3, 'a'));
+    ASSERT_FALSE(queue.emplace(3, 'b')); // Queue is full, "bbb" is discarded.
+    ASSERT_EQ(discarded, "bbb");
+    ASSERT_EQ(queue.tryPop().value(), "aaa");
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,288 @@
+#include "trlc/threadsafe/scheduler.hpp"
+#include "trlc/threadsafe/thread_pool.hpp"
+#include "trlc/threadsafe/wait.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using Scheduler = trlc::threadsafe::Scheduler;
+using trlc::threadsafe::ThreadPool;
+using trlc::threadsafe::Wait;
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief Test that scheduleAfter runs a task once, not before its delay.
+ */
+TEST(SchedulerTest, ScheduleAfter)
+{
+    Wait done;
+    std::atomic<int> runs{0};
+    const auto start{std::chrono::steady_clock::now()};
+    std::atomic<std::chrono::steady_clock::time_point> ran_at{start};
+    Scheduler scheduler{Scheduler::Settings{}};
+
+    Scheduler::Token token{scheduler.scheduleAfter(20ms, [&]()
+                                                   {
+        ran_at.store(std::chrono::steady_clock::now());
+        runs.fetch_add(1);
+        done.notify(); })};
+    EXPECT_TRUE(token.active());
+    EXPECT_EQ(scheduler.size(), 1u);
+
+    ASSERT_EQ(done.waitFor(5s, [&]() -> bool
+                           { return runs.load() == 1; }),
+              Wait::Status::SUCCESS);
+    EXPECT_GE(ran_at.load() - start, 20ms);
+    EXPECT_FALSE(token.active());
+    EXPECT_FALSE(token.cancel());
+    EXPECT_EQ(scheduler.size(), 0u);
+    std::this_thread::sleep_for(30ms);
+    EXPECT_EQ(runs.load(), 1);
+}
+
+/**
+ * @brief Test that scheduleAt accepts deadlines of other clocks and runs past deadlines right away.
+ */
+TEST(SchedulerTest, ScheduleAt)
+{
+    Wait done;
+    std::atomic<int> runs{0};
+    auto task{[&]()
+              {
+                  runs.fetch_add(1);
+                  done.notify();
+              }};
+    Scheduler scheduler{Scheduler::Settings{}};
+
+    scheduler.scheduleAt(std::chrono::system_clock::now() + 10ms, task);
+    scheduler.scheduleAt(std::chrono::steady_clock::now() - 1s, task);
+    ASSERT_EQ(done.waitFor(5s, [&]() -> bool
+                           { return runs.load() == 2; }),
+              Wait::Status::SUCCESS);
+}
+
+/**
+ * @brief Test that an empty task is rejected with an inactive token.
+ */
+TEST(SchedulerTest, EmptyTask)
+{
+    Scheduler scheduler{Scheduler::Settings{}};
+    Scheduler::Token token{scheduler.scheduleAfter(1ms, Scheduler::Task{})};
+    EXPECT_FALSE(token.active());
+    EXPECT_FALSE(token.cancel());
+    EXPECT_EQ(scheduler.size(), 0u);
+}
+
+/**
+ * @brief Test that a cancelled task does not run and releases its captures right away.
+ */
+TEST(SchedulerTest, Cancel)
+{
+    std::atomic<int> runs{0};
+    auto capture{std::make_shared<int>(0)};
+    std::weak_ptr<int> alive{capture};
+    Scheduler scheduler{Scheduler::Settings{}};
+
+    Scheduler::Token token{scheduler.scheduleAfter(30ms, [&runs, capture]()
+                                                   { runs.fetch_add(1); })};
+    capture.reset();
+    EXPECT_FALSE(alive.expired());
+    EXPECT_TRUE(token.cancel());
+    EXPECT_FALSE(token.active());
+    EXPECT_FALSE(token.cancel());
+    EXPECT_TRUE(alive.expired());
+    EXPECT_EQ(scheduler.size(), 0u);
+
+    std::this_thread::sleep_for(60ms);
+    EXPECT_EQ(runs.load(), 0);
+}
+
+/**
+ * @brief Test that a fixed-rate task keeps its rate until it is cancelled.
+ */
+TEST(SchedulerTest, EveryFixedRate)
+{
+    Wait done;
+    std::atomic<int> runs{0};
+    const auto start{std::chrono::steady_clock::now()};
+    Scheduler scheduler{Scheduler::Settings{}};
+
+    Scheduler::Token token{scheduler.scheduleEvery(5ms, [&]()
+                                                   {
+        runs.fetch_add(1);
+        done.notify(); })};
+    ASSERT_EQ(done.waitFor(5s, [&]() -> bool
+                           { return runs.load() >= 10; }),
+              Wait::Status::SUCCESS);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+    EXPECT_TRUE(token.active());
+    EXPECT_EQ(scheduler.size(), 1u);
+
+    EXPECT_TRUE(token.cancel());
+    EXPECT_FALSE(token.active());
+    EXPECT_EQ(scheduler.size(), 0u);
+    std::this_thread::sleep_for(20ms);
+    const int after_cancel{runs.load()};
+    std::this_thread::sleep_for(30ms);
+    EXPECT_EQ(runs.load(), after_cancel);
+}
+
+/**
+ * @brief Test that a fixed-delay task waits one period after the end of each run.
+ */
+TEST(SchedulerTest, EveryFixedDelay)
+{
+    Wait done;
+    std::atomic<int> runs{0};
+    std::vector<std::chrono::steady_clock::time_point> starts{};
+    std::vector<std::chrono::steady_clock::time_point> ends{};
+    Scheduler scheduler{Scheduler::Settings{}};
+
+    Scheduler::Token token{scheduler.scheduleEvery(
+        5ms, [&]()
+        {
+            if (runs.load() >= 4)
+            {
+                return;
+            }
+            starts.push_back(std::chrono::steady_clock::now());
+            std::this_thread::sleep_for(10ms);
+            ends.push_back(std::chrono::steady_clock::now());
+            runs.fetch_add(1);
+            done.notify(); },
+        Scheduler::Period::FIXED_DELAY)};
+    ASSERT_EQ(done.waitFor(5s, [&]() -> bool
+                           { return runs.load() == 4; }),
+              Wait::Status::SUCCESS);
+    token.cancel();
+    for (std::size_t run = 1; run < starts.size(); ++run)
+    {
+        EXPECT_GE(starts[run] - ends[run - 1], 5ms);
+    }
+}
+
+/**
+ * @brief Test that a periodic task can cancel itself from its own run.
+ */
+TEST(SchedulerTest, CancelFromTask)
+{
+    Wait done;
+    std::atomic<int> runs{0};
+    Scheduler::Token token{};
+    std::atomic<bool> scheduled{false};
+    Scheduler scheduler{Scheduler::Settings{}};
+
+    token = scheduler.scheduleEvery(2ms, [&]()
+                                    {
+        while (!scheduled.load())
+        {
+            std::this_thread::yield();
+        }
+        if (runs.fetch_add(1) == 2)
+        {
+            EXPECT_TRUE(token.cancel());
+            done.notify();
+        } });
+    scheduled.store(true);
+    ASSERT_EQ(done.waitFor(5s, [&]() -> bool
+                           { return runs.load() == 3; }),
+              Wait::Status::SUCCESS);
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(runs.load(), 3);
+    EXPECT_EQ(scheduler.size(), 0u);
+}
+
+/**
+ * @brief Test that the tasks run in the pool when one is given.
+ */
+TEST(SchedulerTest, DispatchToPool)
+{
+    Wait done;
+    std::atomic<int> in_pool{0};
+    std::atomic<int> runs{0};
+    ThreadPool::Settings pool_settings;
+    pool_settings.size = 2;
+    ThreadPool pool{pool_settings};
+    Scheduler::Settings settings;
+    settings.pool = &pool;
+    Scheduler scheduler{settings};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        scheduler.scheduleAfter(std::chrono::milliseconds{i}, [&]()
+                                {
+            if (pool.workerIndex() != ThreadPool::NOT_A_WORKER)
+            {
+                in_pool.fetch_add(1);
+            }
+            runs.fetch_add(1);
+            done.notify(); });
+    }
+    ASSERT_EQ(done.waitFor(5s, [&]() -> bool
+                           { return runs.load() == 10; }),
+              Wait::Status::SUCCESS);
+    EXPECT_EQ(in_pool.load(), 10);
+}
+
+/**
+ * @brief Test many timers spread over several wheels, half of them cancelled.
+ */
+TEST(SchedulerTest, ManyTimers)
+{
+    constexpr int COUNT{50000};
+    Scheduler::Settings settings;
+    settings.tick = 1us;
+    Wait done;
+    std::atomic<int> runs{0};
+    Scheduler scheduler{settings};
+    std::vector<Scheduler::Token> tokens{};
+    tokens.reserve(COUNT);
+
+    for (int i = 0; i < COUNT; ++i)
+    {
+        // Up to 327 ms of 1 us ticks, so that the timers cascade down from the second and third wheels.
+        tokens.push_back(scheduler.scheduleAfter(std::chrono::microseconds{(i % 3277) * 100}, [&]()
+                                                 {
+            runs.fetch_add(1);
+            done.notify(); }));
+    }
+    int cancelled{0};
+    for (int i = 0; i < COUNT; i += 2)
+    {
+        if (tokens[i].cancel())
+        {
+            ++cancelled;
+        }
+    }
+    ASSERT_EQ(done.waitFor(10s, [&]() -> bool
+                           { return runs.load() == COUNT - cancelled; }),
+              Wait::Status::SUCCESS);
+    EXPECT_EQ(scheduler.size(), 0u);
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(runs.load(), COUNT - cancelled);
+}
+
+/**
+ * @brief Test that a far deadline does not keep the destructor waiting and its task is dropped.
+ */
+TEST(SchedulerTest, DestroyWithPendingTimers)
+{
+    std::atomic<int> runs{0};
+    Scheduler::Token token{};
+    {
+        Scheduler scheduler{Scheduler::Settings{}};
+        token = scheduler.scheduleAfter(std::chrono::hours{24 * 365}, [&]()
+                                        { runs.fetch_add(1); });
+        scheduler.scheduleAt(std::chrono::steady_clock::time_point::max(), [&]()
+                             { runs.fetch_add(1); });
+        EXPECT_EQ(scheduler.size(), 2u);
+    }
+    EXPECT_FALSE(token.active());
+    EXPECT_FALSE(token.cancel());
+    EXPECT_EQ(runs.load(), 0);
+}
@@ -0,0 +1,339 @@
+#include "trlc/threadsafe/segmented_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using SegmentedQueue = trlc::threadsafe::SegmentedQueue<int>;
+
+/**
+ * @brief Test for basic push and pop functionality.
+ */
+TEST(SegmentedQueueTest, BasicPushPop)
+{
+    SegmentedQueue::Settings settings;
+    SegmentedQueue queue(settings);
+
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value, 100)); // Queue is empty, pop should fail.
+
+    ASSERT_TRUE(queue.push(42));          // Push should succeed.
+    ASSERT_TRUE(queue.pop(popped_value)); // Pop should succeed.
+    ASSERT_EQ(popped_value, 42);          // Check popped value.
+}
+
+/**
+ * @brief Test that the order and the size are kept across many segments.
+ */
+TEST(SegmentedQueueTest, FifoAcrossSegments)
+{
+    constexpr int COUNT{static_cast<int>(SegmentedQueue::SEGMENT_SIZE) * 10 + 7};
+    SegmentedQueue queue(SegmentedQueue::Settings{});
+    ASSERT_EQ(queue.capacity(), std::numeric_limits<std::size_t>::max());
+
+    for (int i = 0; i < COUNT; ++i)
+    {
+        ASSERT_TRUE(queue.push(i));
+        ASSERT_EQ(queue.size(), static_cast<std::size_t>(i + 1));
+    }
+    ASSERT_GE(queue.allocatedSegments(), 11u);
+    for (int i = 0; i < COUNT; ++i)
+    {
+        std::optional<int> popped{queue.tryPop()};
+        ASSERT_TRUE(popped.has_value());
+        ASSERT_EQ(*popped, i);
+        ASSERT_EQ(queue.size(), static_cast<std::size_t>(COUNT - i - 1));
+    }
+    ASSERT_FALSE(queue.tryPop().has_value());
+}
+
+/**
+ * @brief Test that drained segments are reused instead of allocating new ones.
+ */
+TEST(SegmentedQueueTest, RecyclesSegments)
+{
+    SegmentedQueue queue(SegmentedQueue::Settings{});
+    for (int round = 0; round < 1000; ++round)
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            ASSERT_TRUE(queue.push(i));
+        }
+        int popped_value;
+        for (int i = 0; i < 10; ++i)
+        {
+            ASSERT_TRUE(queue.pop(popped_value));
+        }
+    }
+    // 10000 elements went through more than 300 segments, all carved from the first chunk of the pool.
+    ASSERT_LE(queue.allocatedSegments(), 16u);
+}
+
+/**
+ * @brief Test that segments stay bounded for a thread serving more queues than its pool caches remember,
+ * and across short-lived threads.
+ */
+TEST(SegmentedQueueTest, RecyclesSegmentsAcrossQueuesAndThreads)
+{
+    constexpr std::size_t QUEUES{12};
+    constexpr int PER_ROUND{static_cast<int>(SegmentedQueue::SEGMENT_SIZE) + 9};
+    std::vector<std::unique_ptr<SegmentedQueue>> queues;
+    for (std::size_t i = 0; i < QUEUES; ++i)
+    {
+        queues.push_back(std::make_unique<SegmentedQueue>(SegmentedQueue::Settings{}));
+    }
+    auto roundTrip = [](SegmentedQueue& queue)
+    {
+        for (int i = 0; i < PER_ROUND; ++i)
+        {
+            ASSERT_TRUE(queue.push(i));
+        }
+        int popped_value;
+        for (int i = 0; i < PER_ROUND; ++i)
+        {
+            ASSERT_TRUE(queue.pop(popped_value));
+            ASSERT_EQ(popped_value, i);
+        }
+    };
+    for (int round = 0; round < 200; ++round)
+    {
+        for (auto& queue : queues)
+        {
+            roundTrip(*queue);
+        }
+    }
+    for (int i = 0; i < 50; ++i)
+    {
+        std::thread worker([&]()
+                           { roundTrip(*queues.front()); });
+        worker.join();
+    }
+    for (const auto& queue : queues)
+    {
+        ASSERT_LE(queue->allocatedSegments(), 16u);
+    }
+}
+
+/**
+ * @brief Test for queue size limitation and discard policy (DISCARD_OLDEST).
+ */
+TEST(SegmentedQueueTest, DiscardOldest)
+{
+    SegmentedQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = SegmentedQueue::Discard::DISCARD_OLDEST;
+
+    SegmentedQueue queue(settings);
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const int& elem)
+                               { discarded = elem; });
+
+    ASSERT_EQ(queue.capacity(), 2u);
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_TRUE(queue.push(3)); // This will discard 1.
+    ASSERT_EQ(discarded, 1);
+
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 2);
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 3);
+}
+
+/**
+ * @brief Test for queue size limitation and discard policy (DISCARD_NEWEST).
+ */
+TEST(SegmentedQueueTest, DiscardNewest)
+{
+    SegmentedQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = SegmentedQueue::Discard::DISCARD_NEWEST;
+
+    SegmentedQueue queue(settings);
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const int& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_FALSE(queue.push(3)); // Queue is full, 3 is discarded.
+    ASSERT_EQ(discarded, 3);
+
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 1);
+}
+
+/**
+ * @brief Test that a bounded queue without discard blocks the producer until there is room.
+ */
+TEST(SegmentedQueueTest, BoundedNoDiscard)
+{
+    SegmentedQueue::Settings settings;
+    settings.size = 3;
+    SegmentedQueue queue(settings);
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_TRUE(queue.push(3));
+    ASSERT_FALSE(queue.push(4, 50));
+
+    std::thread consumer([&queue]()
+                         {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        int popped_value;
+        queue.pop(popped_value); });
+    ASSERT_TRUE(queue.push(4));
+    consumer.join();
+    ASSERT_EQ(queue.size(), 3u);
+}
+
+/**
+ * @brief Test for controlling push and pop operations.
+ */
+TEST(SegmentedQueueTest, PushPopControl)
+{
+    SegmentedQueue::Settings settings;
+    settings.control = SegmentedQueue::Control::FULL_CONTROL;
+
+    SegmentedQueue queue(settings);
+    ASSERT_FALSE(queue.push(1)); // Push should fail because push is closed.
+
+    queue.openPush();
+    ASSERT_TRUE(queue.push(1));
+
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value, 10)); // Pop should fail because pop is closed.
+    queue.openPop();
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 1);
+
+    queue.closePush();
+    ASSERT_FALSE(queue.push(2));
+    ASSERT_TRUE(queue.waitPopOpen(0));
+    ASSERT_FALSE(queue.waitPushOpen(10));
+}
+
+/**
+ * @brief Test that closing pop wakes up a blocked consumer.
+ */
+TEST(SegmentedQueueTest, ClosePopWakesConsumer)
+{
+    SegmentedQueue::Settings settings;
+    settings.control = SegmentedQueue::Control::FULL_CONTROL;
+    SegmentedQueue queue(settings);
+    queue.openPop();
+
+    std::thread closer([&queue]()
+                       {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.closePop(); });
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value));
+    closer.join();
+}
+
+/**
+ * @brief Test that remaining elements and segments are destroyed with the queue.
+ */
+TEST(SegmentedQueueTest, DestroysRemainingElements)
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        trlc::threadsafe::SegmentedQueue<std::shared_ptr<int>> queue(trlc::threadsafe::SegmentedQueue<std::shared_ptr<int>>::Settings{});
+        for (int i = 0; i < 100; ++i)
+        {
+            ASSERT_TRUE(queue.push(counter));
+        }
+        for (int i = 0; i < 40; ++i)
+        {
+            ASSERT_TRUE(queue.tryPop().has_value());
+        }
+        ASSERT_EQ(counter.use_count(), 61);
+    }
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+/**
+ * @brief Test that every element is popped exactly once with several producers and consumers.
+ */
+TEST(SegmentedQueueTest, ConcurrentPushPop)
+{
+    constexpr int PRODUCERS{4};
+    constexpr int CONSUMERS{4};
+    constexpr int COUNT_PER_PRODUCER{20000};
+    SegmentedQueue queue(SegmentedQueue::Settings{});
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&, p]()
+                               {
+            for (int i = 0; i < COUNT_PER_PRODUCER; ++i) {
+                ASSERT_TRUE(queue.push(p * COUNT_PER_PRODUCER + i));
+            } });
+    }
+
+    std::vector<std::atomic<int>> seen(PRODUCERS * COUNT_PER_PRODUCER);
+    std::atomic<int> remaining{PRODUCERS * COUNT_PER_PRODUCER};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; ++c)
+    {
+        consumers.emplace_back([&]()
+                               {
+            int popped_value;
+            while (remaining.load() > 0) {
+                if (queue.pop(popped_value, 10)) {
+                    seen[popped_value].fetch_add(1);
+                    remaining.fetch_sub(1);
+                }
+            } });
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    for (auto& consumer : consumers)
+    {
+        consumer.join();
+    }
+    for (const auto& count : seen)
+    {
+        ASSERT_EQ(count.load(), 1);
+    }
+    ASSERT_EQ(queue.size(), 0u);
+}
+
+/**
+ * @brief Test that emplace with DISCARD_NEWEST constructs the discarded element for the callback.
+ */
+TEST(SegmentedQueueTest, EmplaceDiscardNewest)
+{
+    using StringQueue = trlc::threadsafe::SegmentedQueue<std::string>;
+    StringQueue::Settings settings;
+    settings.size = 1;
+    settings.discard = StringQueue::Discard::DISCARD_NEWEST;
+    StringQueue queue(settings);
+
+    std::string discarded;
+    queue.setDiscardedCallback([&discarded](const std::string& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.emplace(3, 'a'));
+    ASSERT_FALSE(queue.emplace(3, 'b')); // Queue is full, "bbb" is discarded.
+    ASSERT_EQ(discarded, "bbb");
+    ASSERT_EQ(queue.tryPop().value(), "aaa");
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,114 @@
+#include "trlc/threadsafe/priority_queue.hpp"
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/selector.hpp"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using IntQueue = trlc::threadsafe::Queue<int>;
+using StringQueue = trlc::threadsafe::Queue<std::string>;
+
+/**
+ * @brief Test that wait reports every ready queue and times out when none is ready.
+ */
+TEST(SelectorTest, ReportsReadyQueues)
+{
+    IntQueue ints{IntQueue::Settings{}};
+    StringQueue strings{StringQueue::Settings{}};
+    trlc::threadsafe::PriorityQueue<int> priorities{trlc::threadsafe::PriorityQueue<int>::Settings{}};
+
+    trlc::threadsafe::Selector selector;
+    const std::size_t ints_index{selector.add(ints)};
+    const std::size_t strings_index{selector.add(strings)};
+    const std::size_t priorities_index{selector.add(priorities)};
+
+    std::vector<std::size_t> ready;
+    EXPECT_EQ(selector.wait(ready, 10), 0u);
+    EXPECT_EQ(selector.waitAny(10), trlc::threadsafe::Selector::NONE);
+
+    ASSERT_TRUE(strings.push("hello"));
+    ASSERT_TRUE(priorities.push(1, 3));
+    EXPECT_EQ(selector.wait(ready, 10), 2u);
+    EXPECT_EQ(ready, (std::vector<std::size_t>{strings_index, priorities_index}));
+
+    ASSERT_TRUE(selector.remove(priorities_index));
+    EXPECT_FALSE(selector.remove(priorities_index));
+    EXPECT_EQ(selector.wait(ready, 10), 1u);
+    EXPECT_EQ(ready.front(), strings_index);
+    EXPECT_NE(ints_index, strings_index);
+}
+
+/**
+ * @brief Test that one blocked thread is woken by pushes to any of the queues.
+ */
+TEST(SelectorTest, WakesOnPushToAnyQueue)
+{
+    IntQueue first{IntQueue::Settings{}};
+    StringQueue second{StringQueue::Settings{}};
+    trlc::threadsafe::Selector selector;
+    const std::size_t first_index{selector.add(first)};
+    const std::size_t second_index{selector.add(second)};
+
+    constexpr int MESSAGES{200};
+    std::thread producer([&]()
+                         {
+        for (int i = 0; i < MESSAGES; ++i)
+        {
+            if (i % 2 == 0)
+            {
+                first.push(i);
+            }
+            else
+            {
+                second.push(std::to_string(i));
+            }
+        } });
+
+    int received{0};
+    while (received < MESSAGES)
+    {
+        const std::size_t index{selector.waitAny(1000)};
+        ASSERT_NE(index, trlc::threadsafe::Selector::NONE);
+        if (index == first_index)
+        {
+            received += first.tryPop().has_value() ? 1 : 0;
+        }
+        else if (index == second_index)
+        {
+            received += second.tryPop().has_value() ? 1 : 0;
+        }
+    }
+    producer.join();
+    EXPECT_EQ(received, MESSAGES);
+}
+
+/**
+ * @brief Test that a queue opened for pop operations wakes the selector.
+ */
+TEST(SelectorTest, WakesOnOpenPop)
+{
+    IntQueue::Settings settings;
+    settings.control = IntQueue::Control::POP;
+    IntQueue queue{settings};
+    ASSERT_TRUE(queue.push(7));
+
+    trlc::threadsafe::Selector selector;
+    const std::size_t index{selector.add(queue)};
+    EXPECT_EQ(selector.waitAny(10), trlc::threadsafe::Selector::NONE);
+
+    std::thread opener([&queue]()
+                       {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.openPop(); });
+    EXPECT_EQ(selector.waitAny(1000), index);
+    opener.join();
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,253 @@
+#include "trlc/threadsafe/shm_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using ShmQueue = trlc::threadsafe::ShmQueue<uint64_t>;
+
+namespace
+{
+
+/**
+ * @brief Region name unique to the test process, removed before and after each test.
+ */
+class ShmQueueTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+#ifdef _WIN32
+        m_name = "trlc_shm_queue_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed());
+#else
+        m_name = "trlc_shm_queue_test_" + std::to_string(::getpid());
+#endif
+        ShmQueue::remove(m_name);
+    }
+
+    void TearDown() override
+    {
+        ShmQueue::remove(m_name);
+    }
+
+    std::string m_name{};
+};
+
+} // namespace
+
+/**
+ * @brief Test for basic push and pop functionality.
+ */
+TEST_F(ShmQueueTest, BasicPushPop)
+{
+    ShmQueue::Settings settings;
+    settings.size = 8;
+    ShmQueue queue(m_name, settings);
+    ASSERT_TRUE(queue.valid());
+    ASSERT_TRUE(queue.created());
+    ASSERT_EQ(queue.capacity(), 8u);
+
+    uint64_t popped_value;
+    ASSERT_FALSE(queue.pop(popped_value, 50)); // Queue is empty, pop should fail.
+    ASSERT_TRUE(queue.push(42));
+    ASSERT_EQ(queue.size(), 1u);
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 42u);
+}
+
+/**
+ * @brief Test that a second queue of the same name attaches to the region and follows its settings.
+ */
+TEST_F(ShmQueueTest, AttachSharesState)
+{
+    ShmQueue::Settings settings;
+    settings.size = 4;
+    ShmQueue producer(m_name, settings);
+
+    ShmQueue::Settings other;
+    other.size = 1000;
+    ShmQueue consumer(m_name, other);
+    ASSERT_TRUE(consumer.valid());
+    ASSERT_FALSE(consumer.created());
+    ASSERT_EQ(consumer.capacity(), 4u); // The capacity of the creator.
+
+    for (uint64_t value = 1; value <= 4; ++value)
+    {
+        ASSERT_TRUE(producer.push(value));
+    }
+    ASSERT_FALSE(producer.push(5, 20)); // Full.
+    for (uint64_t value = 1; value <= 4; ++value)
+    {
+        ASSERT_EQ(consumer.tryPop().value(), value);
+    }
+    ASSERT_FALSE(consumer.tryPop().has_value());
+}
+
+/**
+ * @brief Test that a consumer attaching again resumes after the elements it popped.
+ */
+TEST_F(ShmQueueTest, ReattachResumes)
+{
+    ShmQueue::Settings settings;
+    settings.size = 16;
+    ShmQueue producer(m_name, settings);
+    for (uint64_t value = 0; value < 10; ++value)
+    {
+        ASSERT_TRUE(producer.push(value));
+    }
+    {
+        ShmQueue consumer(m_name, settings);
+        ASSERT_EQ(consumer.tryPop().value(), 0u);
+        ASSERT_EQ(consumer.tryPop().value(), 1u);
+    }
+    ShmQueue consumer(m_name, settings);
+    ASSERT_FALSE(consumer.created());
+    ASSERT_EQ(consumer.size(), 8u);
+    ASSERT_EQ(consumer.tryPop().value(), 2u);
+}
+
+/**
+ * @brief Test that a queue of another element type does not attach to the region.
+ */
+TEST_F(ShmQueueTest, LayoutMismatch)
+{
+    struct Frame
+    {
+        uint64_t words[16];
+    };
+    ShmQueue queue(m_name, ShmQueue::Settings{});
+    ASSERT_TRUE(queue.valid());
+
+    trlc::threadsafe::ShmQueue<Frame> other(m_name, trlc::threadsafe::ShmQueue<Frame>::Settings{});
+    ASSERT_FALSE(other.valid());
+    ASSERT_FALSE(other.push(Frame{}));
+    ASSERT_EQ(other.capacity(), 0u);
+}
+
+/**
+ * @brief Test for queue size limitation and discard policies.
+ */
+TEST_F(ShmQueueTest, Discard)
+{
+    ShmQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = ShmQueue::Discard::DISCARD_OLDEST;
+    ShmQueue queue(m_name, settings);
+    uint64_t discarded{0};
+    queue.setDiscardedCallback([&discarded](const uint64_t& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_TRUE(queue.push(3)); // This will discard 1.
+    ASSERT_EQ(discarded, 1u);
+    ASSERT_EQ(queue.tryPop().value(), 2u);
+    ASSERT_EQ(queue.tryPop().value(), 3u);
+    ShmQueue::remove(m_name);
+
+    settings.discard = ShmQueue::Discard::DISCARD_NEWEST;
+    ShmQueue newest(m_name, settings);
+    newest.setDiscardedCallback([&discarded](const uint64_t& elem)
+                                { discarded = elem; });
+    ASSERT_TRUE(newest.push(1));
+    ASSERT_TRUE(newest.push(2));
+    ASSERT_FALSE(newest.push(3)); // Queue is full, 3 is discarded.
+    ASSERT_EQ(discarded, 3u);
+    ASSERT_EQ(newest.tryPop().value(), 1u);
+}
+
+/**
+ * @brief Test that the open flags are shared and that closing wakes a blocked consumer.
+ */
+TEST_F(ShmQueueTest, ControlIsShared)
+{
+    ShmQueue::Settings settings;
+    settings.control = ShmQueue::Control::FULL_CONTROL;
+    ShmQueue producer(m_name, settings);
+    ShmQueue consumer(m_name, settings);
+    ASSERT_FALSE(producer.push(1)); // Push is closed.
+
+    producer.openPush();
+    consumer.openPop();
+    ASSERT_TRUE(consumer.waitPushOpen(0));
+    ASSERT_TRUE(producer.push(1));
+    uint64_t popped_value;
+    ASSERT_TRUE(consumer.pop(popped_value));
+
+    std::thread closer([&producer]()
+                       {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        producer.closePop(); });
+    ASSERT_FALSE(consumer.pop(popped_value));
+    closer.join();
+}
+
+/**
+ * @brief Test that a blocked consumer is woken by a push from another thread.
+ */
+TEST_F(ShmQueueTest, PushWakesConsumer)
+{
+    ShmQueue::Settings settings;
+    settings.size = 4;
+    ShmQueue queue(m_name, settings);
+    std::thread producer([&queue]()
+                         {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.push(7); });
+    uint64_t popped_value{0};
+    ASSERT_TRUE(queue.pop(popped_value, 5000));
+    ASSERT_EQ(popped_value, 7u);
+    producer.join();
+}
+
+#ifndef _WIN32
+/**
+ * @brief Test that elements cross from a child process in order, with both sides blocking on a small ring.
+ */
+TEST_F(ShmQueueTest, CrossProcess)
+{
+    constexpr uint64_t COUNT{20000};
+    ShmQueue::Settings settings;
+    settings.size = 16;
+    ShmQueue queue(m_name, settings);
+    ASSERT_TRUE(queue.valid());
+
+    const pid_t child{::fork()};
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        ShmQueue producer(m_name, settings);
+        bool pushed{producer.valid()};
+        for (uint64_t value = 0; pushed && value < COUNT; ++value)
+        {
+            pushed = producer.push(value, 5000);
+        }
+        ::_exit(pushed ? 0 : 1);
+    }
+
+    uint64_t popped_value;
+    for (uint64_t value = 0; value < COUNT; ++value)
+    {
+        ASSERT_TRUE(queue.pop(popped_value, 5000));
+        ASSERT_EQ(popped_value, value);
+    }
+    int status{0};
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
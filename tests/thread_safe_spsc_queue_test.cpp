@@ -0,0 +1,525 @@
+#include "trlc/threadsafe/spsc_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+using SpscQueue = trlc::threadsafe::SpscQueue<int>;
+
+/**
+ * @brief Test for basic push and pop functionality.
+ */
+TEST(SpscQueueTest, BasicPushPop)
+{
+    SpscQueue::Settings settings;
+    SpscQueue queue(settings);
+
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value, 100)); // Queue is empty, pop should fail.
+
+    ASSERT_TRUE(queue.push(42));          // Push should succeed.
+    ASSERT_TRUE(queue.pop(popped_value)); // Pop should succeed.
+    ASSERT_EQ(popped_value, 42);          // Check popped value.
+}
+
+/**
+ * @brief Test that the capacity follows the settings and falls back to the default when unbounded.
+ */
+TEST(SpscQueueTest, Capacity)
+{
+    SpscQueue::Settings settings;
+    SpscQueue unbounded(settings);
+    ASSERT_EQ(unbounded.capacity(), SpscQueue::DEFAULT_CAPACITY);
+
+    settings.size = 3;
+    SpscQueue bounded(settings);
+    ASSERT_EQ(bounded.capacity(), 3u);
+    ASSERT_TRUE(bounded.push(1));
+    ASSERT_TRUE(bounded.push(2));
+    ASSERT_TRUE(bounded.push(3));
+    ASSERT_FALSE(bounded.push(4, 50)); // The logical size is honored even though the ring holds 4 slots.
+}
+
+/**
+ * @brief Test for queue size limitation and discard policy (DISCARD_OLDEST).
+ */
+TEST(SpscQueueTest, DiscardOldest)
+{
+    SpscQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = SpscQueue::Discard::DISCARD_OLDEST;
+
+    SpscQueue queue(settings);
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const int& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_TRUE(queue.push(3)); // This will discard the oldest (1).
+
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 2);
+    ASSERT_EQ(discarded, 1);
+}
+
+/**
+ * @brief Test for queue size limitation and discard policy (DISCARD_NEWEST).
+ */
+TEST(SpscQueueTest, DiscardNewest)
+{
+    SpscQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = SpscQueue::Discard::DISCARD_NEWEST;
+
+    SpscQueue queue(settings);
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const int& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_FALSE(queue.push(3)); // This will discard the newest (3).
+
+    int popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 1);
+    ASSERT_EQ(discarded, 3);
+}
+
+/**
+ * @brief Test for controlling push and pop operations.
+ */
+TEST(SpscQueueTest, PushPopControl)
+{
+    SpscQueue::Settings settings;
+    settings.control = SpscQueue::Control::FULL_CONTROL;
+
+    SpscQueue queue(settings);
+    ASSERT_FALSE(queue.push(1)); // Closed until explicitly opened.
+    queue.openPush();
+    queue.openPop();
+
+    int popped_value;
+    ASSERT_TRUE(queue.push(42));
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(popped_value, 42);
+
+    queue.closePush();
+    ASSERT_FALSE(queue.push(100));
+
+    queue.closePop();
+    ASSERT_FALSE(queue.pop(popped_value));
+}
+
+/**
+ * @brief Test that closing pop wakes up a blocked consumer.
+ */
+TEST(SpscQueueTest, ClosePopWakesConsumer)
+{
+    SpscQueue::Settings settings;
+    settings.control = SpscQueue::Control::POP;
+    SpscQueue queue(settings);
+    queue.openPop();
+
+    std::thread closer([&]()
+                       {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        queue.closePop(); });
+
+    int popped_value;
+    ASSERT_FALSE(queue.pop(popped_value)); // Waits forever until pop is closed.
+    closer.join();
+}
+
+/**
+ * @brief Test that remaining elements are destroyed with the queue.
+ */
+TEST(SpscQueueTest, DestroysRemainingElements)
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        trlc::threadsafe::SpscQueue<std::shared_ptr<int>>::Settings settings;
+        settings.size = 4;
+        trlc::threadsafe::SpscQueue<std::shared_ptr<int>> queue(settings);
+        ASSERT_TRUE(queue.push(counter));
+        ASSERT_TRUE(queue.push(counter));
+        ASSERT_EQ(counter.use_count(), 3);
+    }
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+/**
+ * @brief Test for ordering and completeness with one producer and one consumer.
+ */
+TEST(SpscQueueTest, ConcurrentPushPop)
+{
+    constexpr int COUNT{100000};
+    SpscQueue::Settings settings;
+    settings.size = 64;
+    SpscQueue queue(settings);
+
+    std::thread producer([&]()
+                         {
+        for (int i = 0; i < COUNT; ++i) {
+            ASSERT_TRUE(queue.push(i));
+        } });
+
+    int popped_value;
+    for (int i = 0; i < COUNT; ++i)
+    {
+        ASSERT_TRUE(queue.pop(popped_value));
+        ASSERT_EQ(popped_value, i);
+    }
+    producer.join();
+}
+
+/**
+ * @brief Test that every element is either popped in order or discarded when the producer overruns.
+ */
+TEST(SpscQueueTest, ConcurrentDiscardOldest)
+{
+    constexpr int COUNT{100000};
+    SpscQueue::Settings settings;
+    settings.size = 8;
+    settings.discard = SpscQueue::Discard::DISCARD_OLDEST;
+    SpscQueue queue(settings);
+
+    std::atomic<int> discarded{0};
+    queue.setDiscardedCallback([&discarded](const int&)
+                               { discarded.fetch_add(1); });
+
+    std::thread producer([&]()
+                         {
+        for (int i = 0; i < COUNT; ++i) {
+            ASSERT_TRUE(queue.push(i));
+        }
+        ASSERT_TRUE(queue.push(COUNT)); });
+
+    int popped{0};
+    int previous{-1};
+    int popped_value{-1};
+    while (popped_value != COUNT)
+    {
+        ASSERT_TRUE(queue.pop(popped_value));
+        ASSERT_GT(popped_value, previous);
+        previous = popped_value;
+        ++popped;
+    }
+    producer.join();
+
+    while (queue.pop(popped_value, 0))
+    {
+        ++popped;
+    }
+    ASSERT_EQ(popped + discarded.load(), COUNT + 1);
+}
+
+/**
+ * @brief Test for pushing and popping move-only elements.
+ */
+TEST(SpscQueueTest, MoveOnlyElements)
+{
+    using PtrQueue = trlc::threadsafe::SpscQueue<std::unique_ptr<int>>;
+    PtrQueue::Settings settings;
+    settings.size = 2;
+    PtrQueue queue(settings);
+
+    ASSERT_TRUE(queue.push(std::make_unique<int>(1)));
+    ASSERT_TRUE(queue.emplace(new int(2)));
+
+    std::unique_ptr<int> popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(*popped_value, 1);
+
+    std::optional<std::unique_ptr<int>> tried{queue.tryPop()};
+    ASSERT_TRUE(tried.has_value());
+    ASSERT_EQ(**tried, 2);
+    ASSERT_FALSE(queue.tryPop().has_value()); // Queue is empty.
+}
+
+/**
+ * @brief Test that the discard-oldest path hands the moved-out element to the callback.
+ */
+TEST(SpscQueueTest, MoveOnlyDiscardOldest)
+{
+    using PtrQueue = trlc::threadsafe::SpscQueue<std::unique_ptr<int>>;
+    PtrQueue::Settings settings;
+    settings.size = 1;
+    settings.discard = PtrQueue::Discard::DISCARD_OLDEST;
+    PtrQueue queue(settings);
+
+    int discarded = -1;
+    queue.setDiscardedCallback([&discarded](const std::unique_ptr<int>& elem)
+                               { discarded = *elem; });
+
+    ASSERT_TRUE(queue.push(std::make_unique<int>(1)));
+    ASSERT_TRUE(queue.push(std::make_unique<int>(2))); // This will discard 1.
+    ASSERT_EQ(discarded, 1);
+
+    std::unique_ptr<int> popped_value;
+    ASSERT_TRUE(queue.pop(popped_value));
+    ASSERT_EQ(*popped_value, 2);
+}
+
+/**
+ * @brief Test that emplace with DISCARD_NEWEST constructs the discarded element for the callback.
+ */
+TEST(SpscQueueTest, EmplaceDiscardNewest)
+{
+    using StringQueue = trlc::threadsafe::SpscQueue<std::string>;
+    StringQueue::Settings settings;
+    settings.size = 1;
+    settings.discard = StringQueue::Discard::DISCARD_NEWEST;
+    StringQueue queue(settings);
+
+    std::string discarded;
+    queue.setDiscardedCallback([&discarded](const std::string& elem)
+                               { discarded = elem; });
+
+    ASSERT_TRUE(queue.emplace(3, 'a'));
+    ASSERT_FALSE(queue.emplace(3, 'b')); // Queue is full, "bbb" is discarded.
+    ASSERT_EQ(discarded, "bbb");
+    ASSERT_EQ(queue.tryPop().value(), "aaa");
+}
+
+/**
+ * @brief Test that a reserved element is written and read in place, and only seen once committed.
+ */
+TEST(SpscQueueTest, ReserveCommitPeekRelease)
+{
+    SpscQueue::Settings settings;
+    settings.size = 4;
+    SpscQueue queue(settings);
+
+    SpscQueue::Reservation reserved{queue.reserve()};
+    ASSERT_TRUE(reserved);
+    *reserved = 7;
+    int* storage{&*reserved};
+    ASSERT_FALSE(queue.peek(10)); // Not committed yet.
+    ASSERT_TRUE(queue.commit(reserved));
+    ASSERT_FALSE(reserved);
+    ASSERT_FALSE(queue.commit(reserved));
+
+    SpscQueue::Reservation peeked{queue.peek()};
+    ASSERT_TRUE(peeked);
+    ASSERT_EQ(&*peeked, storage); // Same storage, no copy.
+    ASSERT_EQ(*peeked, 7);
+    ASSERT_TRUE(queue.release(peeked));
+    ASSERT_FALSE(peeked);
+    ASSERT_FALSE(queue.tryPop().has_value());
+}
+
+/**
+ * @brief Test that reserve follows the control and discard policies.
+ */
+TEST(SpscQueueTest, ReservePolicies)
+{
+    SpscQueue::Settings settings;
+    settings.size = 1;
+    settings.control = SpscQueue::Control::FULL_CONTROL;
+    SpscQueue closed(settings);
+    ASSERT_FALSE(closed.reserve(10)); // Push is closed.
+    closed.openPush();
+    SpscQueue::Reservation reserved{closed.reserve()};
+    ASSERT_TRUE(reserved);
+    closed.closePush();
+    ASSERT_TRUE(closed.commit(reserved)); // Committed even once closed.
+    ASSERT_FALSE(closed.peek(10));        // Pop is closed.
+
+    settings.control = SpscQueue::Control::NO_CONTROL;
+    SpscQueue no_discard(settings);
+    ASSERT_TRUE(no_discard.push(1));
+    ASSERT_FALSE(no_discard.reserve(10));
+
+    settings.discard = SpscQueue::Discard::DISCARD_NEWEST;
+    SpscQueue newest(settings);
+    ASSERT_TRUE(newest.push(1));
+    ASSERT_FALSE(newest.reserve());
+    ASSERT_EQ(newest.tryPop().value(), 1);
+
+    settings.discard = SpscQueue::Discard::DISCARD_OLDEST;
+    SpscQueue oldest(settings);
+    int discarded{-1};
+    oldest.setDiscardedCallback([&discarded](const int& elem)
+                                { discarded = elem; });
+    ASSERT_TRUE(oldest.push(1));
+    reserved = oldest.reserve();
+    ASSERT_TRUE(reserved);
+    ASSERT_EQ(discarded, 1);
+    *reserved = 2;
+    ASSERT_TRUE(oldest.commit(reserved));
+    ASSERT_EQ(oldest.tryPop().value(), 2);
+}
+
+/**
+ * @brief Test that large frames go from producer to consumer in place and in order.
+ */
+TEST(SpscQueueTest, ConcurrentReservePeek)
+{
+    struct Frame
+    {
+        uint32_t sequence;
+        unsigned char bytes[64 * 1024];
+    };
+    constexpr uint32_t COUNT{2000};
+    trlc::threadsafe::SpscQueue<Frame>::Settings settings;
+    settings.size = 4;
+    trlc::threadsafe::SpscQueue<Frame> queue(settings);
+
+    std::thread producer([&]()
+                         {
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            auto frame{queue.reserve()};
+            ASSERT_TRUE(frame);
+            frame->sequence = i;
+            frame->bytes[sizeof(frame->bytes) - 1] = static_cast<unsigned char>(i);
+            ASSERT_TRUE(queue.commit(frame));
+        } });
+
+    for (uint32_t i = 0; i < COUNT; ++i)
+    {
+        auto frame{queue.peek()};
+        ASSERT_TRUE(frame);
+        ASSERT_EQ(frame->sequence, i);
+        ASSERT_EQ(frame->bytes[sizeof(frame->bytes) - 1], static_cast<unsigned char>(i));
+        ASSERT_TRUE(queue.release(frame));
+    }
+    producer.join();
+}
+
+/**
+ * @brief Test that the reservations are move-only, so that a slot is committed once.
+ */
+TEST(SpscQueueTest, ReservationMoveOnly)
+{
+    static_assert(!std::is_copy_constructible_v<SpscQueue::Reservation>);
+    static_assert(!std::is_copy_assignable_v<SpscQueue::Reservation>);
+    SpscQueue::Settings settings;
+    settings.size = 4;
+    SpscQueue queue(settings);
+
+    SpscQueue::Reservation reserved{queue.reserve()};
+    *reserved = 5;
+    SpscQueue::Reservation moved{std::move(reserved)};
+    ASSERT_FALSE(reserved);
+    ASSERT_FALSE(queue.commit(reserved));
+    ASSERT_TRUE(queue.commit(moved));
+    ASSERT_EQ(queue.tryPop().value(), 5);
+    ASSERT_FALSE(queue.tryPop().has_value());
+}
+
+/**
+ * @brief Test that a reservation dropped without commit or release destroys its element.
+ */
+TEST(SpscQueueTest, DropsUnfinishedReservations)
+{
+    trlc::threadsafe::SpscQueue<std::shared_ptr<int>>::Settings settings;
+    settings.size = 2;
+    trlc::threadsafe::SpscQueue<std::shared_ptr<int>> queue(settings);
+    auto token{std::make_shared<int>(1)};
+
+    {
+        auto reserved{queue.reserve()};
+        ASSERT_TRUE(reserved);
+        *reserved = token;
+    }
+    ASSERT_EQ(token.use_count(), 1); // Destroyed unpublished.
+    ASSERT_FALSE(queue.peek(10));
+
+    ASSERT_TRUE(queue.push(token));
+    {
+        auto peeked{queue.peek()};
+        ASSERT_TRUE(peeked);
+    }
+    ASSERT_EQ(token.use_count(), 1); // Released.
+    ASSERT_FALSE(queue.tryPop().has_value());
+    ASSERT_TRUE(queue.push(token));
+    ASSERT_TRUE(queue.push(token));
+    ASSERT_EQ(queue.tryPop().value(), token);
+}
+
+/**
+ * @brief Test that under DISCARD_OLDEST the producer blocks, within its timeout, on a slot being peeked.
+ */
+TEST(SpscQueueTest, DiscardOldestWaitsForPeekedSlot)
+{
+    SpscQueue::Settings settings;
+    settings.size = 2;
+    settings.discard = SpscQueue::Discard::DISCARD_OLDEST;
+    SpscQueue queue(settings);
+    ASSERT_TRUE(queue.push(0));
+    ASSERT_TRUE(queue.push(1));
+    SpscQueue::Reservation peeked{queue.peek()};
+    ASSERT_EQ(*peeked, 0);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&queue, &pushed]()
+                         {
+        ASSERT_FALSE(queue.push(2, 20)); // The next slot still holds the peeked element.
+        ASSERT_TRUE(queue.push(3, 5000));
+        pushed = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    ASSERT_FALSE(pushed.load());
+    ASSERT_TRUE(queue.release(peeked));
+    producer.join();
+    ASSERT_TRUE(pushed.load());
+    ASSERT_EQ(queue.tryPop().value(), 1);
+    ASSERT_EQ(queue.tryPop().value(), 3);
+}
+
+/**
+ * @brief Test the timeouts and deadlines given as std::chrono durations and time points.
+ */
+TEST(SpscQueueTest, ChronoTimeouts)
+{
+    SpscQueue::Settings settings;
+    settings.size = 1;
+    settings.control = SpscQueue::Control::FULL_CONTROL;
+    SpscQueue queue(settings);
+    ASSERT_FALSE(queue.waitPushOpen(std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.waitPopOpen(std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+    queue.openPush();
+    queue.openPop();
+    ASSERT_TRUE(queue.waitPushOpen(std::chrono::system_clock::now() + std::chrono::microseconds(300)));
+    ASSERT_TRUE(queue.waitPopOpen(std::chrono::microseconds(300)));
+
+    int popped_value;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_FALSE(queue.pop(popped_value, std::chrono::microseconds(300))); // Empty, times out.
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(300));
+    ASSERT_FALSE(queue.pop(popped_value, std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.peek(std::chrono::system_clock::now() + std::chrono::microseconds(300)));
+
+    const int value{1};
+    ASSERT_TRUE(queue.push(value, std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.push(2, std::chrono::microseconds(300))); // Full, times out.
+    ASSERT_FALSE(queue.push(value, std::chrono::system_clock::now() + std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.reserve(std::chrono::microseconds(300)));
+    ASSERT_FALSE(queue.reserve(std::chrono::steady_clock::now() + std::chrono::microseconds(300)));
+
+    SpscQueue::Reservation peeked{queue.peek(std::chrono::microseconds(300))};
+    ASSERT_TRUE(peeked);
+    ASSERT_EQ(*peeked, 1);
+    ASSERT_TRUE(queue.release(peeked));
+    SpscQueue::Reservation reserved{queue.reserve(std::chrono::steady_clock::time_point::max())};
+    ASSERT_TRUE(reserved);
+    *reserved = 3;
+    ASSERT_TRUE(queue.commit(reserved));
+    ASSERT_TRUE(queue.pop(popped_value, std::chrono::steady_clock::time_point::max()));
+    ASSERT_EQ(popped_value, 3);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
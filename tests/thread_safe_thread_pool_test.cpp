@@ -0,0 +1,203 @@
+#include "trlc/threadsafe/thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+
+using ThreadPool = trlc::threadsafe::ThreadPool;
+
+/**
+ * @brief Test that every posted task runs.
+ */
+TEST(ThreadPoolTest, RunsAllTasks)
+{
+    constexpr int COUNT{10000};
+    ThreadPool::Settings settings;
+    settings.size = 4;
+    ThreadPool pool(settings);
+    ASSERT_EQ(pool.size(), 4u);
+
+    std::atomic<int> counter{0};
+    for (int i = 0; i < COUNT; ++i)
+    {
+        ASSERT_TRUE(pool.post([&counter]()
+                              { counter.fetch_add(1); }));
+    }
+    pool.waitIdle();
+    ASSERT_EQ(counter.load(), COUNT);
+}
+
+/**
+ * @brief Test that tasks posted by a task go to the local deque and are waited for.
+ */
+TEST(ThreadPoolTest, NestedTasks)
+{
+    constexpr int CHILDREN{100};
+    ThreadPool::Settings settings;
+    settings.size = 3;
+    ThreadPool pool(settings);
+    ASSERT_EQ(pool.workerIndex(), ThreadPool::NOT_A_WORKER);
+
+    std::atomic<int> counter{0};
+    std::atomic<bool> on_worker{false};
+    ASSERT_TRUE(pool.post([&]()
+                          {
+        on_worker.store(pool.workerIndex() < pool.size());
+        for (int i = 0; i < CHILDREN; ++i)
+        {
+            pool.post([&counter]()
+                      { counter.fetch_add(1); });
+        } }));
+    pool.waitIdle();
+    ASSERT_TRUE(on_worker.load());
+    ASSERT_EQ(counter.load(), CHILDREN);
+}
+
+/**
+ * @brief Test that the callbacks run once per worker and that stop runs the remaining tasks.
+ */
+TEST(ThreadPoolTest, CallbacksAndStop)
+{
+    std::atomic<int> started{0};
+    std::atomic<int> exited{0};
+    std::atomic<int> counter{0};
+    {
+        ThreadPool::Settings settings;
+        settings.size = 2;
+        settings.name = "worker";
+        settings.start_callback = [&started]()
+        { started.fetch_add(1); };
+        settings.exit_callback = [&exited]()
+        { exited.fetch_add(1); };
+        ThreadPool pool(settings);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            ASSERT_TRUE(pool.post([&counter]()
+                                  {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                counter.fetch_add(1); }));
+        }
+        pool.stop();
+        ASSERT_EQ(counter.load(), 10);
+        ASSERT_FALSE(pool.post([]() {})); // Stopped pool rejects tasks.
+        ASSERT_FALSE(pool.post(nullptr));
+    }
+    ASSERT_EQ(started.load(), 2);
+    ASSERT_EQ(exited.load(), 2);
+}
+
+/**
+ * @brief Test for submitting functions and chaining their futures.
+ */
+TEST(ThreadPoolTest, Submit)
+{
+    ThreadPool::Settings settings;
+    settings.size = 2;
+    ThreadPool pool(settings);
+
+    auto sum = pool.submit([](int a, int b)
+                           { return a + b; },
+                           1, 2)
+                   .then([](int value)
+                         { return value * 10; });
+    auto done = pool.submit([]() {});
+    auto failed = pool.submit([]() -> int
+                              { throw std::runtime_error("task failed"); })
+                      .then([](int value)
+                            { return value * 10; });
+    EXPECT_EQ(sum.get(), 30);
+    EXPECT_TRUE(done.get());
+    EXPECT_THROW(failed.get(), std::runtime_error);
+
+    pool.stop();
+    EXPECT_FALSE(pool.submit([]()
+                             { return 1; })
+                     .get()
+                     .has_value()); // Abandoned by the stopped pool.
+}
+
+/**
+ * @brief Test that a thread outside the pool can run a queued task while the workers are busy.
+ */
+TEST(ThreadPoolTest, TryRunOne)
+{
+    ThreadPool::Settings settings;
+    settings.size = 1;
+    ThreadPool pool(settings);
+    ASSERT_FALSE(pool.tryRunOne()); // Nothing queued.
+
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    ASSERT_TRUE(pool.post([&started, &release]()
+                          {
+        started.store(true);
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        } }));
+    while (!started.load())
+    {
+        std::this_thread::yield();
+    }
+
+    std::thread::id runner{};
+    ASSERT_TRUE(pool.post([&runner]()
+                          { runner = std::this_thread::get_id(); }));
+    ASSERT_TRUE(pool.tryRunOne()); // The only worker is busy, so the caller runs the task.
+    ASSERT_EQ(runner, std::this_thread::get_id());
+    ASSERT_FALSE(pool.tryRunOne());
+    release.store(true);
+    pool.waitIdle();
+}
+
+/**
+ * @brief Test that a throwing task does not take down its worker.
+ */
+TEST(ThreadPoolTest, ThrowingTask)
+{
+    ThreadPool::Settings settings;
+    settings.size = 1;
+    ThreadPool pool(settings);
+    std::atomic<int> counter{0};
+    ASSERT_TRUE(pool.post([]()
+                          { throw std::runtime_error("task failed"); }));
+    ASSERT_TRUE(pool.post([&counter]()
+                          { counter.fetch_add(1); }));
+    pool.waitIdle();
+    ASSERT_EQ(counter.load(), 1);
+}
+
+/**
+ * @brief Test that stop called from a task stops accepting tasks without waiting for itself.
+ */
+TEST(ThreadPoolTest, StopFromWorker)
+{
+    ThreadPool::Settings settings;
+    settings.size = 2;
+    ThreadPool pool(settings);
+    std::atomic<bool> stopped{false};
+    std::atomic<int> counter{0};
+    ASSERT_TRUE(pool.post([&]()
+                          {
+        for (int i = 0; i < 10; ++i)
+        {
+            pool.post([&counter]()
+                      { counter.fetch_add(1); });
+        }
+        pool.stop();
+        stopped = !pool.post([]() {}); }));
+    pool.waitIdle();
+    ASSERT_TRUE(stopped.load());
+    ASSERT_EQ(counter.load(), 10); // The remaining tasks still ran.
+    pool.stop();
+    ASSERT_FALSE(pool.post([]() {}));
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
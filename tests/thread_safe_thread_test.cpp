@@ -1,9 +1,12 @@
 #include "trlc/threadsafe/thread.hpp"
 
+#include <any>
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <gtest/gtest.h>
 #include <string>
+#include <thread>
 
 using Thread = trlc::threadsafe::Thread;
 
@@ -258,6 +261,257 @@ TEST(ThreadTest, StartStopMultipleTimes)
     SUCCEED(); // Ensure no errors occurred
 }
 
+/**
+ * @brief Test for submitting a function and getting its typed result through a future.
+ */
+TEST(ThreadTest, SubmitReturnsFuture)
+{
+    Thread thread("SubmitThread");
+    auto future = thread.submit([](int a, const std::string& b)
+                                { return b + std::to_string(a); },
+                                42, std::string("answer="));
+    EXPECT_FALSE(thread.submit([]() {}).valid()); // Already started.
+    EXPECT_EQ(future.get(), "answer=42");
+    EXPECT_TRUE(thread.stop());
+}
+
+/**
+ * @brief Test that submit leaves the function set with invoke and the result callback alone.
+ */
+TEST(ThreadTest, SubmitKeepsInvokedFunction)
+{
+    Thread thread("SubmitInvokeThread");
+    std::atomic<int> results{0};
+    std::atomic<int> last_result{0};
+    thread.invoke([]()
+                  { return 7; });
+    thread.setResultCallback([&results, &last_result](const Thread::ResultType& result)
+                             {
+        ++results;
+        last_result = std::any_cast<int>(result); });
+
+    auto future = thread.submit([]()
+                                { return std::string("typed"); });
+    EXPECT_EQ(future.get(), "typed");
+    EXPECT_TRUE(thread.stop());
+    EXPECT_EQ(results.load(), 0);
+
+    EXPECT_TRUE(thread.run(Thread::RunMode::ONCE));
+    EXPECT_TRUE(thread.stop());
+    EXPECT_EQ(results.load(), 1);
+    EXPECT_EQ(last_result.load(), 7);
+}
+
+/**
+ * @brief Test that submit on a running thread returns an invalid future and leaves the thread running.
+ */
+TEST(ThreadTest, SubmitOnRunningThread)
+{
+    Thread thread("SubmitRunningThread");
+    std::atomic<bool> release{false};
+    std::atomic<int> calls{0};
+    thread.invoke([&release, &calls]()
+                  {
+        ++calls;
+        while (!release.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } });
+    EXPECT_TRUE(thread.run(Thread::RunMode::ONCE));
+    std::atomic<bool> submitted_ran{false};
+    auto future = thread.submit([&submitted_ran]()
+                                { submitted_ran = true; });
+    EXPECT_FALSE(future.valid());
+    release = true;
+    EXPECT_TRUE(thread.stop());
+    EXPECT_EQ(calls.load(), 1);
+    EXPECT_FALSE(submitted_ran.load());
+
+    EXPECT_TRUE(thread.submit([]() {}).valid());
+    EXPECT_TRUE(thread.stop());
+}
+
+/**
+ * @brief Test the iteration counts and call durations recorded by the loop stats.
+ */
+TEST(ThreadTest, LoopStats)
+{
+    std::atomic<int> calls{0};
+    Thread thread("StatsThread");
+    thread.invoke([&calls]()
+                  {
+        ++calls;
+        std::this_thread::sleep_for(std::chrono::microseconds(200)); });
+    thread.setPredicate([&calls]() -> bool
+                        { return calls < 20; });
+    thread.enableStats(true);
+    EXPECT_TRUE(thread.run(Thread::RunMode::LOOP));
+    while (thread.stats().running || thread.stats().iterations < 20)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(thread.stop());
+
+    const trlc::threadsafe::ThreadStatsSnapshot stats{thread.stats()};
+    EXPECT_FALSE(stats.running);
+    EXPECT_EQ(stats.iterations, 20u);
+    EXPECT_EQ(stats.predicate_stops, 1u);
+    EXPECT_EQ(stats.call_duration.count(), 20u);
+    EXPECT_GE(stats.call_duration.percentile(0.5), std::chrono::microseconds(200));
+    EXPECT_GE(stats.busy_time, std::chrono::milliseconds(4));
+    EXPECT_GE(stats.wall_time, stats.busy_time);
+    EXPECT_GT(stats.iterationRate(), 0.0);
+    EXPECT_LE(stats.busyRatio(), 1.0);
+
+    thread.resetStats();
+    EXPECT_EQ(thread.stats().iterations, 0u);
+    EXPECT_EQ(thread.stats().wall_time.count(), 0);
+}
+
+/**
+ * @brief Test reading the CPU time and context switches of a running thread from another thread.
+ */
+TEST(ThreadTest, StatsWhileRunning)
+{
+    Thread thread("BusyThread");
+    thread.invoke([]()
+                  {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+        while (std::chrono::steady_clock::now() < until)
+        {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+    thread.enableStats(true);
+    EXPECT_TRUE(thread.run(Thread::RunMode::LOOP));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const trlc::threadsafe::ThreadStatsSnapshot running{thread.stats()};
+    EXPECT_TRUE(running.running);
+    EXPECT_GT(running.iterations, 0u);
+    EXPECT_GT(running.cpu_time, std::chrono::milliseconds(0));
+    EXPECT_LE(running.cpu_time, running.wall_time);
+#ifdef __linux__
+    EXPECT_GT(running.voluntary_switches, 0u); // Every call sleeps.
+#endif
+
+    EXPECT_TRUE(thread.stop());
+    const trlc::threadsafe::ThreadStatsSnapshot stopped{thread.stats()};
+    EXPECT_FALSE(stopped.running);
+    EXPECT_GE(stopped.cpu_time, running.cpu_time);
+    EXPECT_GE(stopped.iterations, running.iterations);
+    EXPECT_EQ(stopped.predicate_stops, 0u);
+}
+
+/**
+ * @brief Test that the stats stay empty unless enabled.
+ */
+TEST(ThreadTest, StatsDisabledByDefault)
+{
+    Thread thread("PlainThread");
+    thread.invoke([]() {});
+    EXPECT_TRUE(thread.run(Thread::RunMode::ONCE));
+    EXPECT_TRUE(thread.stop());
+    EXPECT_EQ(thread.stats().iterations, 0u);
+    EXPECT_EQ(thread.stats().wall_time.count(), 0);
+}
+
+/**
+ * @brief Test that a time sharing policy with a nice value is applied when the thread starts.
+ */
+TEST(ThreadTest, SchedulingOther)
+{
+    trlc::threadsafe::ThreadScheduling scheduling;
+    scheduling.nice = 5; // Raising the nice value needs no privilege.
+    trlc::threadsafe::ThreadScheduling applied;
+    Thread thread("NiceThread");
+    thread.setScheduling(scheduling);
+    thread.invoke([&applied]()
+                  { applied = trlc::threadsafe::currentThreadScheduling(); });
+    EXPECT_TRUE(thread.run(Thread::RunMode::ONCE));
+    EXPECT_TRUE(thread.stop());
+    EXPECT_FALSE(thread.schedulingError()) << thread.schedulingError().message();
+    EXPECT_EQ(applied.policy, trlc::threadsafe::SchedulingPolicy::OTHER);
+    EXPECT_EQ(applied.nice, 5);
+}
+
+/**
+ * @brief Test that a thread with the default priority runs time-shared, without a scheduling error.
+ */
+TEST(ThreadTest, DefaultPriorityIsTimeSharing)
+{
+    Thread thread("DefaultPriorityThread");
+    trlc::threadsafe::ThreadScheduling applied{};
+    applied.policy = trlc::threadsafe::SchedulingPolicy::FIFO;
+    thread.invoke([&applied]()
+                  { applied = trlc::threadsafe::currentThreadScheduling(); });
+    EXPECT_TRUE(thread.run(Thread::RunMode::ONCE));
+    EXPECT_TRUE(thread.stop());
+    EXPECT_FALSE(thread.schedulingError()) << thread.schedulingError().message();
+    EXPECT_EQ(applied.policy, trlc::threadsafe::SchedulingPolicy::OTHER);
+}
+
+/**
+ * @brief Test that a policy which cannot be applied is reported, and that the function still runs.
+ */
+TEST(ThreadTest, SchedulingErrorReported)
+{
+    trlc::threadsafe::ThreadScheduling scheduling;
+    scheduling.policy = trlc::threadsafe::SchedulingPolicy::FIFO;
+    scheduling.priority = 1000;
+    bool called{false};
+    Thread thread("InvalidPriorityThread");
+    thread.setScheduling(scheduling);
+    thread.invoke([&called]()
+                  { called = true; });
+    EXPECT_FALSE(thread.schedulingError());
+    EXPECT_TRUE(thread.run(Thread::RunMode::ONCE));
+    EXPECT_TRUE(thread.stop());
+    EXPECT_TRUE(called);
+    EXPECT_EQ(thread.schedulingError(), std::errc::invalid_argument);
+
+    scheduling.policy = trlc::threadsafe::SchedulingPolicy::DEADLINE; // Without a runtime.
+    thread.setScheduling(scheduling);
+    EXPECT_TRUE(thread.run(Thread::RunMode::ONCE));
+    EXPECT_TRUE(thread.stop());
+    EXPECT_TRUE(thread.schedulingError());
+}
+
+/**
+ * @brief Test the real-time policies where the process may use them.
+ */
+TEST(ThreadTest, SchedulingRealTime)
+{
+    using trlc::threadsafe::SchedulingPolicy;
+    trlc::threadsafe::ThreadScheduling deadline;
+    deadline.policy = SchedulingPolicy::DEADLINE;
+    deadline.runtime = std::chrono::milliseconds{1};
+    deadline.period = std::chrono::milliseconds{10};
+    trlc::threadsafe::ThreadScheduling round_robin;
+    round_robin.policy = SchedulingPolicy::RR;
+    round_robin.priority = 10;
+    for (const trlc::threadsafe::ThreadScheduling& scheduling : {round_robin, deadline})
+    {
+        trlc::threadsafe::ThreadScheduling applied;
+        Thread thread("RealTimeThread");
+        thread.setScheduling(scheduling);
+        thread.invoke([&applied]()
+                      { applied = trlc::threadsafe::currentThreadScheduling(); });
+        EXPECT_TRUE(thread.run(Thread::RunMode::ONCE));
+        EXPECT_TRUE(thread.stop());
+        if (thread.schedulingError())
+        {
+            // Missing privilege, or no SCHED_DEADLINE where the affinity or the CPUs do not allow it.
+            EXPECT_EQ(applied.policy, SchedulingPolicy::OTHER);
+            continue;
+        }
+        EXPECT_EQ(applied.policy, scheduling.policy);
+        EXPECT_EQ(applied.priority, scheduling.priority);
+        EXPECT_EQ(applied.runtime, scheduling.runtime);
+        EXPECT_EQ(applied.period, scheduling.period);
+        EXPECT_EQ(applied.deadline, scheduling.deadline.count() == 0 ? scheduling.period : scheduling.deadline);
+    }
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,240 @@
+#include "trlc/threadsafe/trace.hpp"
+
+#include "trlc/threadsafe/queue.hpp"
+#include "trlc/threadsafe/thread.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using trlc::threadsafe::TraceEvent;
+using trlc::threadsafe::TraceFileHeader;
+using trlc::threadsafe::Tracer;
+using trlc::threadsafe::TraceSettings;
+
+namespace
+{
+
+std::string tempPath(const std::string& name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+TraceFileHeader readHeader(const std::string& path)
+{
+    TraceFileHeader header{};
+    std::ifstream in(path, std::ios::binary);
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    return header;
+}
+
+std::size_t countOf(const std::string& text, const std::string& pattern)
+{
+    std::size_t count{0};
+    for (std::size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+    {
+        ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+/**
+ * @brief Test that records of several threads, also exited ones, reach the file and the exported JSON.
+ */
+TEST(TraceTest, RecordsAndExports)
+{
+    constexpr int THREADS{4};
+    constexpr int RECORDS{1000};
+    TraceSettings settings;
+    settings.path = tempPath("trlc_trace_test_records.trace");
+    const std::string json{tempPath("trlc_trace_test_records.json")};
+
+    int object{0};
+    Tracer::record(TraceEvent::USER, &object); // Not running, not recorded.
+    ASSERT_FALSE(Tracer::running());
+    ASSERT_TRUE(Tracer::start(settings));
+    ASSERT_TRUE(Tracer::running());
+    ASSERT_FALSE(Tracer::start(settings)); // Already running.
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([t, &object]()
+                             {
+            Tracer::setThreadName("worker " + std::to_string(t));
+            for (int i = 0; i < RECORDS; ++i)
+            {
+                Tracer::record(static_cast<TraceEvent>(static_cast<uint16_t>(TraceEvent::USER) + t), &object, i);
+            } });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    Tracer::stop();
+    ASSERT_FALSE(Tracer::running());
+    ASSERT_EQ(Tracer::dropped(), 0u);
+
+    const TraceFileHeader header{readHeader(settings.path)};
+    ASSERT_EQ(header.magic, TraceFileHeader::MAGIC);
+    ASSERT_EQ(header.written, static_cast<uint64_t>(THREADS * RECORDS));
+    ASSERT_GE(header.latest_ns, header.start_ns);
+
+    ASSERT_TRUE(Tracer::exportChromeTrace(settings.path, json));
+    const std::string text{readFile(json)};
+    ASSERT_EQ(text.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    for (int t = 0; t < THREADS; ++t)
+    {
+        ASSERT_EQ(countOf(text, "\"name\":\"event " + std::to_string(256 + t) + "\""), static_cast<std::size_t>(RECORDS));
+        ASSERT_EQ(countOf(text, "\"name\":\"worker " + std::to_string(t) + "\""), 1u);
+    }
+    std::remove(settings.path.c_str());
+    std::remove(json.c_str());
+}
+
+/**
+ * @brief Test that the file keeps the latest records once its ring wraps around.
+ */
+TEST(TraceTest, RingKeepsLatest)
+{
+    TraceSettings settings;
+    settings.path = tempPath("trlc_trace_test_ring.trace");
+    settings.file_records = 16;
+    const std::string json{tempPath("trlc_trace_test_ring.json")};
+    ASSERT_TRUE(Tracer::start(settings));
+    int object{0};
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        Tracer::record(TraceEvent::USER, &object, i);
+    }
+    Tracer::stop();
+
+    const TraceFileHeader header{readHeader(settings.path)};
+    ASSERT_EQ(header.capacity, 16u);
+    ASSERT_EQ(header.written, 100u);
+    ASSERT_TRUE(Tracer::exportChromeTrace(settings.path, json));
+    const std::string text{readFile(json)};
+    ASSERT_EQ(countOf(text, "\"name\":\"event 256\""), 16u);
+    ASSERT_EQ(countOf(text, "\"value\":99,"), 1u);
+    ASSERT_EQ(countOf(text, "\"value\":83,"), 0u); // Overwritten.
+    std::remove(settings.path.c_str());
+    std::remove(json.c_str());
+}
+
+/**
+ * @brief Test that a full thread buffer drops records instead of blocking, and counts them.
+ */
+TEST(TraceTest, DropsWhenThreadBufferFull)
+{
+    constexpr uint64_t RECORDS{1000};
+    TraceSettings settings;
+    settings.path = tempPath("trlc_trace_test_drops.trace");
+    settings.thread_records = 8;
+    settings.flush_interval_ms = 10000;
+    ASSERT_TRUE(Tracer::start(settings));
+    std::thread recorder([]()
+                         {
+        int object{0};
+        for (uint64_t i = 0; i < RECORDS; ++i)
+        {
+            Tracer::record(TraceEvent::USER, &object, i);
+        } });
+    recorder.join();
+    Tracer::stop();
+
+    const TraceFileHeader header{readHeader(settings.path)};
+    ASSERT_GT(Tracer::dropped(), 0u);
+    ASSERT_EQ(header.dropped, Tracer::dropped());
+    ASSERT_EQ(header.written + header.dropped, RECORDS);
+    std::remove(settings.path.c_str());
+}
+
+/**
+ * @brief Test that an invalid trace file is rejected.
+ */
+TEST(TraceTest, ExportRejectsInvalidFile)
+{
+    const std::string path{tempPath("trlc_trace_test_invalid.trace")};
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a trace file";
+    }
+    ASSERT_FALSE(Tracer::exportChromeTrace(path, tempPath("trlc_trace_test_invalid.json")));
+    ASSERT_FALSE(Tracer::exportChromeTrace(tempPath("trlc_trace_test_missing.trace"), tempPath("trlc_trace_test_invalid.json")));
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Test that the tracepoints of the library record pushes, pops, waits and calls of named threads.
+ */
+TEST(TraceTest, Tracepoints)
+{
+#ifndef TRLC_THREADSAFE_TRACING
+    GTEST_SKIP() << "The library is built without TRLC_THREADSAFE_TRACING";
+#else
+    constexpr int COUNT{100};
+    TraceSettings settings;
+    settings.path = tempPath("trlc_trace_test_tracepoints.trace");
+    const std::string json{tempPath("trlc_trace_test_tracepoints.json")};
+    ASSERT_TRUE(Tracer::start(settings));
+    {
+        trlc::threadsafe::Queue<int> queue(trlc::threadsafe::Queue<int>::Settings{});
+        std::atomic<int> popped{0};
+        trlc::threadsafe::Thread consumer{"consumer"};
+        consumer.invoke([&queue, &popped]()
+                        {
+            int value;
+            if (queue.pop(value, 1000))
+            {
+                ++popped;
+            } });
+        consumer.setPredicate([&popped]() -> bool
+                              { return popped < COUNT; });
+        consumer.run(trlc::threadsafe::Thread::RunMode::LOOP);
+        for (int i = 0; i < COUNT; ++i)
+        {
+            ASSERT_TRUE(queue.push(i));
+        }
+        while (popped.load() < COUNT)
+        {
+            std::this_thread::yield();
+        }
+        consumer.stop();
+    }
+    Tracer::stop();
+
+    ASSERT_TRUE(Tracer::exportChromeTrace(settings.path, json));
+    const std::string text{readFile(json)};
+    ASSERT_EQ(countOf(text, "\"name\":\"push\""), static_cast<std::size_t>(COUNT));
+    ASSERT_EQ(countOf(text, "\"name\":\"pop\""), static_cast<std::size_t>(COUNT));
+    ASSERT_GE(countOf(text, "\"name\":\"call\",\"cat\":\"thread\",\"ph\":\"B\""), static_cast<std::size_t>(COUNT));
+    ASSERT_EQ(countOf(text, "\"name\":\"consumer\""), 1u);
+    ASSERT_EQ(countOf(text, "\"name\":\"start\""), 1u);
+    ASSERT_EQ(countOf(text, "\"name\":\"exit\""), 1u);
+    std::remove(settings.path.c_str());
+    std::remove(json.c_str());
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
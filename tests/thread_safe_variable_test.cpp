@@ -1,7 +1,11 @@
 #include "trlc/threadsafe/variable.hpp"
 
+#include <atomic>
 #include <gtest/gtest.h>
+#include <shared_mutex>
+#include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 // Test for basic functionality of Variable
@@ -116,6 +120,208 @@ TEST(ThreadSafeVariableTests, EmptyConstructor)
     EXPECT_EQ(var.get(), "");
 }
 
+// Test read-only access through a shared lock while another thread writes
+TEST(ThreadSafeVariableTests, SharedMutexPolicy)
+{
+    trlc::threadsafe::Variable<std::vector<int>, std::shared_mutex> var{1, 2, 3};
+    const auto& const_var = var;
+
+    EXPECT_EQ(const_var.invoke([](const std::vector<int>& values)
+                               { return values.size(); }),
+              3u);
+    EXPECT_EQ(const_var.invoke(&std::vector<int>::size), 3u);
+    EXPECT_TRUE((var == std::vector<int>{1, 2, 3}));
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]()
+                       {
+        for (int i = 0; i < 1000; ++i)
+        {
+            var.invoke([](std::vector<int>& values)
+                       { values.push_back(values.back() + 1); });
+        }
+        done = true; });
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back([&]()
+                             {
+            while (!done)
+            {
+                // Values stay consecutive because readers never observe a partial write.
+                const std::vector<int> values{const_var.get()};
+                EXPECT_EQ(values.back(), static_cast<int>(values.size()));
+            } });
+    }
+    writer.join();
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(var.get().size(), 1003u);
+}
+
+// Test that seqlock readers always observe a value written as a whole
+TEST(ThreadSafeVariableTests, SeqLockPolicy)
+{
+    struct Pair
+    {
+        int64_t first{0};
+        int64_t second{0};
+        int64_t third{0};
+
+        int64_t shift(const int64_t delta)
+        {
+            first += delta;
+            return first;
+        }
+    };
+    trlc::threadsafe::Variable<Pair, trlc::threadsafe::SeqLock> var;
+    EXPECT_EQ(var.get().first, 0);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]()
+                       {
+        for (int64_t i = 1; i <= 100000; ++i)
+        {
+            var = Pair{i, -i, 2 * i};
+        }
+        done = true; });
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i)
+    {
+        readers.emplace_back([&]()
+                             {
+            while (!done)
+            {
+                const Pair pair{var.get()};
+                ASSERT_EQ(pair.second, -pair.first);
+                ASSERT_EQ(pair.third, 2 * pair.first);
+            } });
+    }
+    writer.join();
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    var.invoke([](Pair& pair)
+               { pair.third += 1; });
+    const Pair pair = var;
+    EXPECT_EQ(pair.first, 100000);
+    EXPECT_EQ(pair.third, 200001);
+    EXPECT_EQ(var.invoke(&Pair::shift, int64_t{5}), 100005);
+    EXPECT_EQ(var.get().first, 100005);
+
+    trlc::threadsafe::Variable<int, trlc::threadsafe::SeqLock> number{5};
+    EXPECT_TRUE(number == 5);
+    EXPECT_TRUE(number < 6);
+    EXPECT_EQ(number.invoke([](int& value)
+                            { return ++value; }),
+              6);
+    EXPECT_EQ(number.get(), 6);
+}
+
+// Test that RCU snapshots stay unchanged while writers publish new values
+TEST(ThreadSafeVariableTests, RcuPolicy)
+{
+    using RcuVector = trlc::threadsafe::Variable<std::vector<int>, trlc::threadsafe::Rcu>;
+    RcuVector var{std::vector<int>{1, 2, 3}};
+    const RcuVector::Snapshot first{var.snapshot()};
+    var.update([](std::vector<int>& values)
+               { values.push_back(4); });
+    EXPECT_EQ(first->size(), 3u);
+    EXPECT_EQ(var.snapshot()->size(), 4u);
+    EXPECT_TRUE((var == std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(var.invoke(&std::vector<int>::size), 4u);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]()
+                       {
+        for (int i = 5; i <= 2000; ++i)
+        {
+            var.update([i](std::vector<int>& values)
+                       { values.push_back(i); });
+        }
+        done = true; });
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i)
+    {
+        readers.emplace_back([&]()
+                             {
+            while (!done)
+            {
+                const RcuVector::Snapshot values{var.snapshot()};
+                ASSERT_EQ(values->back(), static_cast<int>(values->size()));
+            } });
+    }
+    writer.join();
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(var.get().size(), 2000u);
+
+    var = std::vector<int>{7};
+    const RcuVector& const_var{var};
+    EXPECT_EQ(const_var.invoke([](const std::vector<int>& values)
+                               { return values.front(); }),
+              7);
+    EXPECT_EQ(var.invoke([](std::vector<int>& values)
+                         { values.front() = 8;
+                           return values.front(); }),
+              8);
+    var.invoke(&std::vector<int>::reserve, std::size_t{64});
+    EXPECT_GE(var.snapshot()->capacity(), 64u); // Published copy.
+    var.invoke(&std::vector<int>::pop_back);
+    EXPECT_TRUE(var.get().empty());
+    EXPECT_EQ(first->size(), 3u);
+}
+
+// Test that lock-free capable types use the atomic policy with counters and compare-exchange
+TEST(ThreadSafeVariableTests, AtomicPolicy)
+{
+    static_assert(std::is_same_v<trlc::threadsafe::DefaultVariableLock<int>, trlc::threadsafe::Atomic>);
+    static_assert(std::is_same_v<trlc::threadsafe::DefaultVariableLock<double>, trlc::threadsafe::Atomic>);
+    static_assert(std::is_same_v<trlc::threadsafe::DefaultVariableLock<std::string>, std::mutex>);
+
+    trlc::threadsafe::Variable<int> counter{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&]()
+                             {
+            for (int j = 0; j < 10000; ++j)
+            {
+                counter.fetchAdd(1);
+                counter.update([](int& value)
+                               { value += 2; });
+            } });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(counter.get(), 120000);
+
+    int expected{0};
+    EXPECT_FALSE(counter.compareExchange(expected, 1));
+    EXPECT_EQ(expected, 120000);
+    EXPECT_TRUE(counter.compareExchange(expected, 1));
+    EXPECT_TRUE(counter == 1);
+
+    trlc::threadsafe::Variable<double> ratio{0.5};
+    EXPECT_DOUBLE_EQ(ratio.fetchAdd(0.25), 0.5);
+    EXPECT_TRUE(ratio > 0.7);
+
+    trlc::threadsafe::Variable<bool> flag;
+    EXPECT_TRUE(flag == false);
+    flag = true;
+    EXPECT_TRUE(flag.get());
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -1,11 +1,31 @@
 #include "trlc/threadsafe/wait.hpp"
 
 #include <chrono>
+#include <atomic>
 #include <gtest/gtest.h>
 #include <thread>
 
 using Wait = trlc::threadsafe::Wait;
 
+namespace
+{
+
+constexpr std::chrono::seconds TEST_TIMEOUT{5}; ///< Bound of the waits expected to succeed.
+
+/**
+ * @brief Block until a thread is registered in one of the wait functions, so that a notification reaches it.
+ */
+void waitForWaiter(const Wait& w)
+{
+    const auto deadline{std::chrono::steady_clock::now() + TEST_TIMEOUT};
+    while (!w.hasWaiters() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
 /**
  * @brief Test for notify function
  */
@@ -14,7 +34,7 @@ TEST(WaitTest, notifyTest)
     Wait w;
     std::thread notifier([&]()
                          {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        waitForWaiter(w);
         w.notify(); });
 
     EXPECT_EQ(w.wait(), Wait::Status::SUCCESS);
@@ -65,7 +85,7 @@ TEST(WaitTest, WaitForWithPredicateAndTimeoutTest)
         predCalled = true;
         w.notify(); });
 
-    auto status = w.waitFor(std::chrono::milliseconds(100), [&]() -> bool
+    auto status = w.waitFor(TEST_TIMEOUT, [&]() -> bool
                             { return predCalled.load(); });
     EXPECT_EQ(status, Wait::Status::SUCCESS);
     predTrigger.join();
@@ -90,7 +110,7 @@ TEST(WaitTest, WaitExitTest)
     Wait w;
     std::thread exitTrigger([&]()
                             {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        waitForWaiter(w);
         w.notify(); });
 
     auto status = w.wait();
@@ -115,6 +135,137 @@ TEST(WaitTest, WaitWithExitTest)
     predTrigger.join();
 }
 
+/**
+ * @brief Test that notifyOne wakes a single waiter and that waiters are tracked
+ */
+TEST(WaitTest, NotifyOneTest)
+{
+    Wait w;
+    std::atomic<int> tokens{0};
+    std::atomic<int> woken{0};
+    EXPECT_FALSE(w.hasWaiters());
+
+    auto consumer = [&]()
+    {
+        auto status = w.wait([&]() -> bool
+                             {
+            int available{tokens.load()};
+            while (available > 0)
+            {
+                if (tokens.compare_exchange_weak(available, available - 1))
+                {
+                    return true;
+                }
+            }
+            return false; });
+        EXPECT_EQ(status, Wait::Status::SUCCESS);
+        woken.fetch_add(1);
+    };
+    std::thread first(consumer);
+    std::thread second(consumer);
+    waitForWaiter(w);
+
+    tokens.store(1);
+    w.notifyOne();
+    const auto deadline{std::chrono::steady_clock::now() + TEST_TIMEOUT};
+    while (woken.load() == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(woken.load(), 1);
+    waitForWaiter(w);
+    EXPECT_TRUE(w.hasWaiters()); // The other consumer is still blocked.
+
+    tokens.store(1);
+    w.notifyOne();
+    first.join();
+    second.join();
+    EXPECT_EQ(woken.load(), 2);
+    EXPECT_FALSE(w.hasWaiters());
+}
+
+/**
+ * @brief Test that the spinning strategies meet the predicate and still honor timeouts
+ */
+TEST(WaitTest, SpinStrategyTest)
+{
+    for (auto strategy : {Wait::Strategy::SPIN, Wait::Strategy::ADAPTIVE})
+    {
+        Wait w{strategy};
+        std::atomic<bool> ready{false};
+        std::thread setter([&]()
+                           { ready.store(true); });
+        EXPECT_EQ(w.waitFor(TEST_TIMEOUT, [&]() -> bool
+                            { return ready.load(); }),
+                  Wait::Status::SUCCESS);
+        setter.join();
+
+        EXPECT_EQ(w.waitFor(std::chrono::milliseconds(20), []() -> bool
+                            { return false; }),
+                  Wait::Status::TIMEOUT);
+
+        std::thread notifier([&]()
+                             {
+            waitForWaiter(w);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            w.notify(); });
+        EXPECT_EQ(w.wait(), Wait::Status::SUCCESS); // Outlasts the spin phase and blocks.
+        notifier.join();
+    }
+}
+
+/**
+ * @brief Test for waiting until a deadline, with sub-millisecond timeouts
+ */
+TEST(WaitTest, WaitUntilTest)
+{
+    Wait w;
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(w.waitUntil(start + std::chrono::microseconds(500), []() -> bool
+                          { return false; }),
+              Wait::Status::TIMEOUT);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(500));
+
+    EXPECT_EQ(w.waitFor(std::chrono::microseconds(200), []() -> bool
+                        { return false; }),
+              Wait::Status::TIMEOUT);
+    EXPECT_EQ(w.waitUntil(std::chrono::system_clock::now() + std::chrono::microseconds(200)), Wait::Status::TIMEOUT);
+    EXPECT_EQ(w.waitUntil(start, []() -> bool
+                          { return false; }),
+              Wait::Status::TIMEOUT); // Deadline already passed.
+
+    std::atomic<bool> ready{false};
+    std::thread setter([&]()
+                       {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ready = true;
+        w.notify(); });
+    EXPECT_EQ(w.waitUntil(std::chrono::steady_clock::time_point::max(), [&]() -> bool
+                          { return ready.load(); }),
+              Wait::Status::SUCCESS); // No deadline, waits without timeout.
+    setter.join();
+}
+
+/**
+ * @brief Test the conversion of timeouts and foreign clock deadlines to steady clock deadlines
+ */
+TEST(WaitTest, DeadlineConversionTest)
+{
+    EXPECT_EQ(Wait::deadlineAfter(std::chrono::nanoseconds::max()), Wait::NO_DEADLINE);
+    EXPECT_EQ(Wait::deadlineAfter(std::chrono::hours::max()), Wait::NO_DEADLINE);
+    EXPECT_EQ(Wait::toDeadline(std::chrono::system_clock::time_point::max()), Wait::NO_DEADLINE);
+
+    const auto before = std::chrono::steady_clock::now();
+    const auto deadline = Wait::deadlineAfter(std::chrono::microseconds(10));
+    EXPECT_GE(deadline, before + std::chrono::microseconds(10));
+    const auto expired = Wait::deadlineAfter(std::chrono::milliseconds(-5));
+    EXPECT_LE(expired, std::chrono::steady_clock::now());
+
+    const auto converted = Wait::toDeadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+    EXPECT_GT(converted, std::chrono::steady_clock::now() + std::chrono::seconds(9));
+    EXPECT_LT(converted, std::chrono::steady_clock::now() + std::chrono::seconds(11));
+}
+
 class MultithreadWaitTest : public ::testing::Test
 {
 protected:
@@ -131,26 +282,33 @@ protected:
 
     void runNotifyTest(std::function<void()> notifyFunc)
     {
-        // Start thread that will notify the waiting threads
+        // Start thread that will notify the waiting threads, again until every one of them has returned,
+        // since a notification reaches only the threads already registered.
+        std::atomic<int> returned{0};
         std::thread notifier([&]()
                              {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            notifyFunc(); });
+            waitForWaiter(w);
+            const auto deadline{std::chrono::steady_clock::now() + TEST_TIMEOUT};
+            while (returned.load() < 4 && std::chrono::steady_clock::now() < deadline)
+            {
+                notifyFunc();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            } });
 
         // Start multiple threads that will call wait functions
         std::thread t1([&]()
-                       { EXPECT_EQ(w.wait(), Wait::Status::SUCCESS); });
+                       { EXPECT_EQ(w.wait(), Wait::Status::SUCCESS); returned.fetch_add(1); });
         std::thread t2(
             [&]()
             { EXPECT_EQ(w.wait([this]() -> bool
                                { return predCalled.load(); }),
-                        Wait::Status::SUCCESS); });
+                        Wait::Status::SUCCESS); returned.fetch_add(1); });
         std::thread t3([&]()
-                       { EXPECT_EQ(w.waitFor(std::chrono::milliseconds(200)), Wait::Status::SUCCESS); });
+                       { EXPECT_EQ(w.waitFor(TEST_TIMEOUT), Wait::Status::SUCCESS); returned.fetch_add(1); });
         std::thread t4([&]()
-                       { EXPECT_EQ(w.waitFor(std::chrono::milliseconds(200), [this]() -> bool
+                       { EXPECT_EQ(w.waitFor(TEST_TIMEOUT, [this]() -> bool
                                              { return predCalled.load(); }),
-                                   Wait::Status::SUCCESS); });
+                                   Wait::Status::SUCCESS); returned.fetch_add(1); });
 
         // Join threads to wait for completion
         notifier.join();
@@ -196,9 +354,9 @@ TEST_F(MultithreadWaitTest, ExitTest)
     std::thread t1([&]()
                    { EXPECT_EQ(w.wait(), Wait::Status::EXIT); });
     std::thread t2([&]()
-                   { EXPECT_EQ(w.waitFor(std::chrono::milliseconds(200)), Wait::Status::EXIT); });
+                   { EXPECT_EQ(w.waitFor(TEST_TIMEOUT), Wait::Status::EXIT); });
     std::thread t3([&]()
-                   { EXPECT_EQ(w.waitFor(std::chrono::milliseconds(200), [this]() -> bool
+                   { EXPECT_EQ(w.waitFor(TEST_TIMEOUT, [this]() -> bool
                                          { return predCalled.load(); }),
                                Wait::Status::EXIT); });
 
@@ -0,0 +1,117 @@
+#include "trlc/threadsafe/work_stealing_deque.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using Deque = trlc::threadsafe::WorkStealingDeque<int*>;
+
+/**
+ * @brief Test that the owner pops in LIFO order and thieves steal in FIFO order.
+ */
+TEST(WorkStealingDequeTest, PopAndStealOrder)
+{
+    int values[3]{0, 1, 2};
+    Deque deque;
+    ASSERT_TRUE(deque.empty());
+    ASSERT_FALSE(deque.pop().has_value());
+    ASSERT_FALSE(deque.steal().has_value());
+
+    for (int& value : values)
+    {
+        deque.push(&value);
+    }
+    ASSERT_EQ(deque.size(), 3u);
+    ASSERT_EQ(deque.steal().value(), &values[0]); // Oldest element.
+    ASSERT_EQ(deque.pop().value(), &values[2]);   // Newest element.
+    ASSERT_EQ(deque.pop().value(), &values[1]);
+    ASSERT_TRUE(deque.empty());
+}
+
+/**
+ * @brief Test that the deque grows beyond its initial capacity without losing elements.
+ */
+TEST(WorkStealingDequeTest, Grow)
+{
+    constexpr int COUNT{100};
+    std::vector<int> values(COUNT);
+    Deque deque{4};
+    for (int& value : values)
+    {
+        deque.push(&value);
+    }
+    ASSERT_EQ(deque.size(), static_cast<std::size_t>(COUNT));
+    for (int i = COUNT - 1; i >= 0; --i)
+    {
+        ASSERT_EQ(deque.pop().value(), &values[i]);
+    }
+}
+
+/**
+ * @brief Test that every element is taken exactly once with one owner and several thieves.
+ */
+TEST(WorkStealingDequeTest, ConcurrentSteal)
+{
+    constexpr int COUNT{100000};
+    constexpr int THIEVES{3};
+    std::vector<std::atomic<int>> taken(COUNT);
+    std::vector<int> values(COUNT);
+    for (int i = 0; i < COUNT; ++i)
+    {
+        values[i] = i;
+    }
+
+    Deque deque{16};
+    std::atomic<int> total{0};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < THIEVES; ++i)
+    {
+        thieves.emplace_back([&]()
+                             {
+            while (!done.load() || !deque.empty())
+            {
+                if (std::optional<int*> elem{deque.steal()})
+                {
+                    taken[**elem].fetch_add(1);
+                    total.fetch_add(1);
+                }
+            } });
+    }
+
+    for (int i = 0; i < COUNT; ++i)
+    {
+        deque.push(&values[i]);
+        if (i % 3 == 0)
+        {
+            if (std::optional<int*> elem{deque.pop()})
+            {
+                taken[**elem].fetch_add(1);
+                total.fetch_add(1);
+            }
+        }
+    }
+    while (std::optional<int*> elem{deque.pop()})
+    {
+        taken[**elem].fetch_add(1);
+        total.fetch_add(1);
+    }
+    done.store(true);
+    for (auto& thief : thieves)
+    {
+        thief.join();
+    }
+
+    ASSERT_EQ(total.load(), COUNT);
+    for (int i = 0; i < COUNT; ++i)
+    {
+        ASSERT_EQ(taken[i].load(), 1);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}